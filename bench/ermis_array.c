@@ -0,0 +1,111 @@
+// Compares ermis arrays backed by the dynamic `HeliosAllocator` against the `_A` variant using
+// `HeliosArena` as a static allocator type.
+//
+//     cc -O2 -o ermis_array bench/ermis_array.c && ./ermis_array
+
+#define ASTRON_HELIOS_IMPLEMENTATION
+#include "../helios.h"
+#include "../ermis.h"
+
+ERMIS_DECL_ARRAY(S32, DynIntArray)
+ERMIS_IMPL_ARRAY(S32, DynIntArray)
+
+ERMIS_DECL_ARRAY_A(S32, ArenaIntArray, HeliosArena)
+ERMIS_IMPL_ARRAY_A(S32, ArenaIntArray, HeliosArena)
+
+#define SMALL_ARRAY_PUSHES 24
+#define BIG_ARRAY_PUSHES   (1 << 24)
+// Small arrays are allocated back to back, the arena is reset once this many are in it.
+#define SMALL_ARRAYS_PER_RESET (1 << 16)
+
+static void SmallArraysDynamic(void *arg, U64 iterations) {
+    HeliosArena *arena = (HeliosArena *)arg;
+    HeliosAllocator allocator = HeliosNewArenaAllocator(arena);
+    HeliosArenaReset(arena);
+
+    for (U64 i = 0; i < iterations; ++i) {
+        if (i % SMALL_ARRAYS_PER_RESET == 0) HeliosArenaReset(arena);
+
+        DynIntArray arr;
+        DynIntArrayInit(&arr, allocator, 1);
+        for (S32 j = 0; j < SMALL_ARRAY_PUSHES; ++j) DynIntArrayPush(&arr, j);
+        HeliosBenchDoNotOptimize(arr.items);
+    }
+}
+
+static void SmallArraysStatic(void *arg, U64 iterations) {
+    HeliosArena *arena = (HeliosArena *)arg;
+    HeliosArenaReset(arena);
+
+    for (U64 i = 0; i < iterations; ++i) {
+        if (i % SMALL_ARRAYS_PER_RESET == 0) HeliosArenaReset(arena);
+
+        ArenaIntArray arr;
+        ArenaIntArrayInit(&arr, arena, 1);
+        for (S32 j = 0; j < SMALL_ARRAY_PUSHES; ++j) ArenaIntArrayPush(&arr, j);
+        HeliosBenchDoNotOptimize(arr.items);
+    }
+}
+
+static void BigArrayDynamic(void *arg, U64 iterations) {
+    HeliosArena *arena = (HeliosArena *)arg;
+    HeliosAllocator allocator = HeliosNewArenaAllocator(arena);
+
+    for (U64 i = 0; i < iterations; ++i) {
+        HeliosArenaReset(arena);
+
+        DynIntArray arr;
+        DynIntArrayInit(&arr, allocator, 1);
+        for (S32 j = 0; j < BIG_ARRAY_PUSHES; ++j) DynIntArrayPush(&arr, j);
+        HeliosBenchDoNotOptimize(arr.items);
+    }
+}
+
+static void BigArrayStatic(void *arg, U64 iterations) {
+    HeliosArena *arena = (HeliosArena *)arg;
+
+    for (U64 i = 0; i < iterations; ++i) {
+        HeliosArenaReset(arena);
+
+        ArenaIntArray arr;
+        ArenaIntArrayInit(&arr, arena, 1);
+        for (S32 j = 0; j < BIG_ARRAY_PUSHES; ++j) ArenaIntArrayPush(&arr, j);
+        HeliosBenchDoNotOptimize(arr.items);
+    }
+}
+
+int main(int argc, char **argv) {
+    HeliosBench bench;
+    HeliosBenchInit(&bench, argc, argv);
+
+    HeliosArena arena;
+    HeliosArenaInit(&arena, (UZ)1 << 30);
+
+    HeliosBenchRun(&bench, &(HeliosBenchCase) {
+        .name = "ermis_array/small_arrays/vtable",
+        .func = SmallArraysDynamic,
+        .arg = &arena,
+        .items_per_iteration = SMALL_ARRAY_PUSHES,
+    });
+    HeliosBenchRun(&bench, &(HeliosBenchCase) {
+        .name = "ermis_array/small_arrays/static",
+        .func = SmallArraysStatic,
+        .arg = &arena,
+        .items_per_iteration = SMALL_ARRAY_PUSHES,
+    });
+    HeliosBenchRun(&bench, &(HeliosBenchCase) {
+        .name = "ermis_array/big_array/vtable",
+        .func = BigArrayDynamic,
+        .arg = &arena,
+        .items_per_iteration = BIG_ARRAY_PUSHES,
+    });
+    HeliosBenchRun(&bench, &(HeliosBenchCase) {
+        .name = "ermis_array/big_array/static",
+        .func = BigArrayStatic,
+        .arg = &arena,
+        .items_per_iteration = BIG_ARRAY_PUSHES,
+    });
+
+    HeliosArenaRelease(&arena);
+    return 0;
+}
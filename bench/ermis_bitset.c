@@ -0,0 +1,201 @@
+// Ermis bitset operations against the plain word loops they replace.
+//
+//     cc -O2 -o ermis_bitset bench/ermis_bitset.c && ./ermis_bitset
+//
+// Cases are named `bitset/<bits>/<operation>/<variant>`, where `loop` is a hand written loop over the
+// words and `ermis` the bitset routine. Bulk operations and counting are per word, `next` is per set bit
+// and `rank`/`select` per query against a set with about half of its bits set.
+
+#define ASTRON_HELIOS_IMPLEMENTATION
+#include "../helios.h"
+#include "../ermis.h"
+
+// The count of precomputed query positions, must be a power of two.
+#define QUERY_COUNT (1 << 16)
+#define QUERY_MASK (QUERY_COUNT - 1)
+
+typedef struct BitsetContext {
+    ErmisBitset a;
+    ErmisBitset b;
+    UZ set_bits;
+    UZ *positions;
+    UZ *ranks;
+    U64 position;
+} BitsetContext;
+
+static U64 Mix64(U64 x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+static void BenchAndLoop(void *arg, U64 iterations) {
+    BitsetContext *ctx = (BitsetContext *)arg;
+    UZ word_count = ErmisBitsetWordCount(&ctx->a);
+    for (U64 i = 0; i < iterations; ++i) {
+        // Alternating and/or keeps the contents from collapsing to a fixed point.
+        if (i & 1) for (UZ w = 0; w < word_count; ++w) ctx->a.words[w] |= ctx->b.words[w];
+        else for (UZ w = 0; w < word_count; ++w) ctx->a.words[w] &= ctx->b.words[w];
+        HeliosBenchDoNotOptimize(ctx->a.words);
+    }
+}
+
+static void BenchAndErmis(void *arg, U64 iterations) {
+    BitsetContext *ctx = (BitsetContext *)arg;
+    for (U64 i = 0; i < iterations; ++i) {
+        if (i & 1) ErmisBitsetOr(&ctx->a, &ctx->b);
+        else ErmisBitsetAnd(&ctx->a, &ctx->b);
+        HeliosBenchDoNotOptimize(ctx->a.words);
+    }
+}
+
+static void BenchCountLoop(void *arg, U64 iterations) {
+    BitsetContext *ctx = (BitsetContext *)arg;
+    UZ word_count = ErmisBitsetWordCount(&ctx->b);
+    UZ total = 0;
+    for (U64 i = 0; i < iterations; ++i) {
+        for (UZ w = 0; w < word_count; ++w) total += HeliosPopCountU64(ctx->b.words[w]);
+        HeliosBenchDoNotOptimize(ctx->b.words);
+    }
+    HeliosBenchDoNotOptimize(&total);
+}
+
+static void BenchCountErmis(void *arg, U64 iterations) {
+    BitsetContext *ctx = (BitsetContext *)arg;
+    UZ total = 0;
+    for (U64 i = 0; i < iterations; ++i) {
+        total += ErmisBitsetCount(&ctx->b);
+        HeliosBenchDoNotOptimize(ctx->b.words);
+    }
+    HeliosBenchDoNotOptimize(&total);
+}
+
+static void BenchNextLoop(void *arg, U64 iterations) {
+    BitsetContext *ctx = (BitsetContext *)arg;
+    UZ total = 0;
+    for (U64 i = 0; i < iterations; ++i) {
+        for (UZ bit = 0; bit < ctx->b.bit_count; ++bit) {
+            if ((ctx->b.words[bit / 64] >> (bit % 64)) & 1) total += bit;
+        }
+    }
+    HeliosBenchDoNotOptimize(&total);
+}
+
+static void BenchNextErmis(void *arg, U64 iterations) {
+    BitsetContext *ctx = (BitsetContext *)arg;
+    UZ total = 0;
+    for (U64 i = 0; i < iterations; ++i) {
+        ERMIS_BITS_FOREACH(ctx->b.words, ErmisBitsetWordCount(&ctx->b), bit, total += bit);
+    }
+    HeliosBenchDoNotOptimize(&total);
+}
+
+static void BenchRankLoop(void *arg, U64 iterations) {
+    BitsetContext *ctx = (BitsetContext *)arg;
+    UZ total = 0;
+    for (U64 i = ctx->position; i < ctx->position + iterations; ++i) {
+        UZ bit = ctx->positions[i & QUERY_MASK];
+        UZ rank = 0;
+        for (UZ w = 0; w < bit / 64; ++w) rank += HeliosPopCountU64(ctx->b.words[w]);
+        if (bit % 64 != 0) rank += HeliosPopCountU64(ctx->b.words[bit / 64] & (((U64)1 << (bit % 64)) - 1));
+        total += rank;
+    }
+    ctx->position += iterations;
+    HeliosBenchDoNotOptimize(&total);
+}
+
+static void BenchRankErmis(void *arg, U64 iterations) {
+    BitsetContext *ctx = (BitsetContext *)arg;
+    UZ total = 0;
+    for (U64 i = ctx->position; i < ctx->position + iterations; ++i) {
+        total += ErmisBitsetRank(&ctx->b, ctx->positions[i & QUERY_MASK]);
+    }
+    ctx->position += iterations;
+    HeliosBenchDoNotOptimize(&total);
+}
+
+static void BenchSelectLoop(void *arg, U64 iterations) {
+    BitsetContext *ctx = (BitsetContext *)arg;
+    UZ total = 0;
+    for (U64 i = ctx->position; i < ctx->position + iterations; ++i) {
+        UZ k = ctx->ranks[i & QUERY_MASK];
+        UZ w = 0;
+        for (UZ count; k >= (count = HeliosPopCountU64(ctx->b.words[w])); ++w) k -= count;
+        U64 bits = ctx->b.words[w];
+        for (; k != 0; --k) bits &= bits - 1;
+        total += w * 64 + HeliosCountTrailingZerosU64(bits);
+    }
+    ctx->position += iterations;
+    HeliosBenchDoNotOptimize(&total);
+}
+
+static void BenchSelectErmis(void *arg, U64 iterations) {
+    BitsetContext *ctx = (BitsetContext *)arg;
+    UZ total = 0;
+    for (U64 i = ctx->position; i < ctx->position + iterations; ++i) {
+        total += ErmisBitsetSelect(&ctx->b, ctx->ranks[i & QUERY_MASK]);
+    }
+    ctx->position += iterations;
+    HeliosBenchDoNotOptimize(&total);
+}
+
+static void RunCase(HeliosBench *bench, BitsetContext *ctx, const char *op, const char *variant,
+                    HeliosBenchFunc *func, U64 items) {
+    char name[128];
+    snprintf(name, sizeof(name), "bitset/%llu/%s/%s", (unsigned long long)ctx->b.bit_count, op, variant);
+    HeliosBenchRun(bench, &(HeliosBenchCase) {
+        .name = name,
+        .func = func,
+        .arg = ctx,
+        .items_per_iteration = items,
+    });
+}
+
+int main(int argc, char **argv) {
+    HeliosBench bench;
+    HeliosBenchInit(&bench, argc, argv);
+
+    const UZ sizes[] = {1 << 12, 1 << 16, 1 << 22};
+    for (UZ s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+        BitsetContext ctx = {0};
+        ErmisBitsetInit(&ctx.a, HeliosNewMallocAllocator(), sizes[s]);
+        ErmisBitsetInit(&ctx.b, HeliosNewMallocAllocator(), sizes[s]);
+        UZ word_count = ErmisBitsetWordCount(&ctx.b);
+        for (UZ w = 0; w < word_count; ++w) {
+            ctx.a.words[w] = Mix64(w);
+            ctx.b.words[w] = Mix64(w + word_count);
+        }
+        ErmisBitsetBuildRank(&ctx.b);
+        ctx.set_bits = ErmisBitsetCount(&ctx.b);
+
+        ctx.positions = (UZ *)malloc(sizeof(UZ) * QUERY_COUNT);
+        ctx.ranks = (UZ *)malloc(sizeof(UZ) * QUERY_COUNT);
+        for (UZ i = 0; i < QUERY_COUNT; ++i) {
+            ctx.positions[i] = Mix64(i) % sizes[s];
+            ctx.ranks[i] = Mix64(i ^ 0x5555) % ctx.set_bits;
+        }
+
+        RunCase(&bench, &ctx, "and_or", "loop", BenchAndLoop, word_count);
+        RunCase(&bench, &ctx, "and_or", "ermis", BenchAndErmis, word_count);
+        RunCase(&bench, &ctx, "count", "loop", BenchCountLoop, word_count);
+        RunCase(&bench, &ctx, "count", "ermis", BenchCountErmis, word_count);
+        RunCase(&bench, &ctx, "next", "loop", BenchNextLoop, ctx.set_bits);
+        RunCase(&bench, &ctx, "next", "ermis", BenchNextErmis, ctx.set_bits);
+        // The plain loops are linear in the size, which the largest set makes too slow to bother.
+        if (sizes[s] <= (1 << 16)) {
+            RunCase(&bench, &ctx, "rank", "loop", BenchRankLoop, 1);
+            RunCase(&bench, &ctx, "select", "loop", BenchSelectLoop, 1);
+        }
+        RunCase(&bench, &ctx, "rank", "ermis", BenchRankErmis, 1);
+        RunCase(&bench, &ctx, "select", "ermis", BenchSelectErmis, 1);
+
+        free(ctx.positions);
+        free(ctx.ranks);
+        ErmisBitsetFree(&ctx.a);
+        ErmisBitsetFree(&ctx.b);
+    }
+    return 0;
+}
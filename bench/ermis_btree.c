@@ -0,0 +1,181 @@
+// Ermis B+trees with U64 keys: building by random and ascending inserts and by bulk loading, point lookups
+// with the AVX2 and the scalar in-node search, and range scans, with an ermis hashmap for reference.
+//
+//     cc -O2 -o ermis_btree bench/ermis_btree.c && ./ermis_btree
+//
+// Cases are named `btree/<keys>/<operation>`. `lookup_simd` and `lookup_scalar` look up random stored
+// keys, `range_<n>` visits the n keys from a random stored key on. `hashmap/<keys>/lookup` is the same
+// lookup in a hashmap.
+
+#define ASTRON_HELIOS_IMPLEMENTATION
+#include "../helios.h"
+#include "../ermis.h"
+
+ERMIS_DECL_BTREE(U64, U64, U64Tree)
+ERMIS_IMPL_BTREE_SEARCH(U64, U64, U64Tree, ErmisLessFuncU64, ErmisBTreeSearchU64)
+
+ERMIS_DECL_HASHMAP(U64, U64, U64Map)
+ERMIS_IMPL_HASHMAP(U64, U64, U64Map, ErmisEqFuncU64, ErmisHashFuncU64)
+
+// The count of precomputed lookup keys, must be a power of two.
+#define LOOKUP_KEYS (1 << 20)
+#define LOOKUP_MASK (LOOKUP_KEYS - 1)
+#define RANGE_KEYS 100 // Matches the `range_100` case name.
+#define BUILD_SAMPLES 5
+
+static U64 Mix64(U64 x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+static int CompareU64(const void *a, const void *b) {
+    U64 x = *(const U64 *)a;
+    U64 y = *(const U64 *)b;
+    return (x > y) - (x < y);
+}
+
+typedef struct TreeContext {
+    U64 count;
+    // Distinct random keys in insertion order, and the same keys sorted.
+    const U64 *keys;
+    const U64 *sorted;
+    const U64 *lookups;
+    U64Tree tree;
+    U64Map map;
+    U64 position;
+} TreeContext;
+
+static void BenchInsertRandom(void *arg, U64 iterations) {
+    TreeContext *ctx = (TreeContext *)arg;
+    for (U64 i = 0; i < iterations; ++i) {
+        U64Tree tree;
+        U64TreeInit(&tree);
+        for (U64 j = 0; j < ctx->count; ++j) U64TreeInsert(&tree, ctx->keys[j], j);
+        HeliosBenchDoNotOptimize(tree.root);
+        U64TreeFree(&tree);
+    }
+}
+
+static void BenchInsertAscending(void *arg, U64 iterations) {
+    TreeContext *ctx = (TreeContext *)arg;
+    for (U64 i = 0; i < iterations; ++i) {
+        U64Tree tree;
+        U64TreeInit(&tree);
+        for (U64 j = 0; j < ctx->count; ++j) U64TreeInsert(&tree, ctx->sorted[j], j);
+        HeliosBenchDoNotOptimize(tree.root);
+        U64TreeFree(&tree);
+    }
+}
+
+static void BenchBulkLoad(void *arg, U64 iterations) {
+    TreeContext *ctx = (TreeContext *)arg;
+    for (U64 i = 0; i < iterations; ++i) {
+        U64Tree tree;
+        U64TreeInit(&tree);
+        U64TreeBulkLoad(&tree, ctx->sorted, ctx->sorted, ctx->count);
+        HeliosBenchDoNotOptimize(tree.root);
+        U64TreeFree(&tree);
+    }
+}
+
+static void BenchLookup(void *arg, U64 iterations) {
+    TreeContext *ctx = (TreeContext *)arg;
+    U64 sum = 0;
+    for (U64 i = ctx->position; i < ctx->position + iterations; ++i) {
+        sum += *U64TreeFindPtr(&ctx->tree, ctx->lookups[i & LOOKUP_MASK]);
+    }
+    ctx->position += iterations;
+    HeliosBenchDoNotOptimize(&sum);
+}
+
+static void BenchMapLookup(void *arg, U64 iterations) {
+    TreeContext *ctx = (TreeContext *)arg;
+    U64 sum = 0;
+    for (U64 i = ctx->position; i < ctx->position + iterations; ++i) {
+        sum += *U64MapFindPtr(&ctx->map, ctx->lookups[i & LOOKUP_MASK]);
+    }
+    ctx->position += iterations;
+    HeliosBenchDoNotOptimize(&sum);
+}
+
+static void BenchRange(void *arg, U64 iterations) {
+    TreeContext *ctx = (TreeContext *)arg;
+    U64 sum = 0;
+    for (U64 i = ctx->position; i < ctx->position + iterations; ++i) {
+        U64TreeIter it = U64TreeLowerBound(&ctx->tree, ctx->lookups[i & LOOKUP_MASK]);
+        for (UZ n = 0; n < RANGE_KEYS && U64TreeIterValid(&it); ++n, U64TreeIterNext(&it)) sum += *U64TreeIterValue(&it);
+    }
+    ctx->position += iterations;
+    HeliosBenchDoNotOptimize(&sum);
+}
+
+static void RunCase(HeliosBench *bench, TreeContext *ctx, const char *container, const char *op,
+                    HeliosBenchFunc *func, U64 items) {
+    char name[128];
+    snprintf(name, sizeof(name), "%s/%llu/%s", container, (unsigned long long)ctx->count, op);
+
+    // Every iteration of a build case builds the whole tree, a few samples are plenty.
+    U32 samples = bench->samples;
+    if (items == ctx->count) bench->samples = HELIOS_MIN(samples, BUILD_SAMPLES);
+
+    HeliosBenchRun(bench, &(HeliosBenchCase) {
+        .name = name,
+        .func = func,
+        .arg = ctx,
+        .items_per_iteration = items,
+    });
+
+    bench->samples = samples;
+}
+
+int main(int argc, char **argv) {
+    HeliosBench bench;
+    HeliosBenchInit(&bench, argc, argv);
+
+    const U64 sizes[] = {1 << 16, 1 << 20, 1 << 23};
+    U64 *lookups = (U64 *)malloc(sizeof(U64) * LOOKUP_KEYS);
+
+    for (UZ s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+        TreeContext ctx = {.count = sizes[s]};
+
+        // Mix64 is a bijection, so the keys are distinct.
+        U64 *keys = (U64 *)malloc(sizeof(U64) * ctx.count);
+        U64 *sorted = (U64 *)malloc(sizeof(U64) * ctx.count);
+        for (U64 i = 0; i < ctx.count; ++i) keys[i] = Mix64(i);
+        memcpy(sorted, keys, sizeof(U64) * ctx.count);
+        qsort(sorted, ctx.count, sizeof(U64), CompareU64);
+        for (U64 i = 0; i < LOOKUP_KEYS; ++i) lookups[i] = keys[Mix64(i ^ 0x5555) % ctx.count];
+        ctx.keys = keys;
+        ctx.sorted = sorted;
+        ctx.lookups = lookups;
+
+        RunCase(&bench, &ctx, "btree", "insert_random", BenchInsertRandom, ctx.count);
+        RunCase(&bench, &ctx, "btree", "insert_ascending", BenchInsertAscending, ctx.count);
+        RunCase(&bench, &ctx, "btree", "bulk_load", BenchBulkLoad, ctx.count);
+
+        U64TreeInit(&ctx.tree);
+        for (U64 i = 0; i < ctx.count; ++i) U64TreeInsert(&ctx.tree, keys[i], i);
+        B32 simd = ctx.tree.simd;
+        if (simd) RunCase(&bench, &ctx, "btree", "lookup_simd", BenchLookup, 1);
+        ctx.tree.simd = 0;
+        RunCase(&bench, &ctx, "btree", "lookup_scalar", BenchLookup, 1);
+        ctx.tree.simd = simd;
+        RunCase(&bench, &ctx, "btree", "range_100", BenchRange, RANGE_KEYS);
+
+        U64MapInit(&ctx.map, HeliosNewMallocAllocator(), 0);
+        for (U64 i = 0; i < ctx.count; ++i) U64MapInsert(&ctx.map, keys[i], i);
+        RunCase(&bench, &ctx, "hashmap", "lookup", BenchMapLookup, 1);
+
+        U64TreeFree(&ctx.tree);
+        U64MapFree(&ctx.map);
+        free(keys);
+        free(sorted);
+    }
+
+    free(lookups);
+    return 0;
+}
@@ -0,0 +1,217 @@
+// Ermis bloom and xor filters: false positive rates, lookup throughput on their own and in front of an
+// ermis hashmap, and build times.
+//
+//     cc -O2 -o ermis_filter bench/ermis_filter.c && ./ermis_filter
+//
+// Cases are named `filter/<keys>/<filter>/<operation>`, where the filters are `bloom` at 10 bits per key
+// with the AVX2 test (`bloom_simd`) or without it (`bloom_scalar`), and `xor8`. Hit lookups use keys in
+// the set, miss lookups keys that are not. `hashmap/miss` is a plain hashmap miss, `bloom+hashmap/miss`
+// the same miss with the bloom filter asked first.
+//
+// The measured false positive rates for bloom filters at 8 to 16 bits per key and for the xor filter are
+// reported before the cases of each size, on stdout or on stderr with `--tsv`.
+
+#define ASTRON_HELIOS_IMPLEMENTATION
+#include "../helios.h"
+#include "../ermis.h"
+
+ERMIS_DECL_BLOOM(U64, U64Bloom)
+ERMIS_IMPL_BLOOM(U64, U64Bloom, ErmisHashFuncU64)
+
+ERMIS_DECL_XORFILTER(U64, U64XorFilter)
+ERMIS_IMPL_XORFILTER(U64, U64XorFilter, ErmisHashFuncU64)
+
+ERMIS_DECL_HASHMAP(U64, U64, U64Map)
+ERMIS_IMPL_HASHMAP(U64, U64, U64Map, ErmisEqFuncU64, ErmisHashFuncU64)
+
+// The count of precomputed lookup keys, must be a power of two.
+#define LOOKUP_KEYS (1 << 20)
+#define LOOKUP_MASK (LOOKUP_KEYS - 1)
+#define BENCH_BITS_PER_KEY 10
+#define LARGE_SET_KEYS (1 << 20)
+#define LARGE_SET_SAMPLES 5
+
+static U64 Mix64(U64 x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+typedef struct FilterContext {
+    const U64 *keys;
+    U64 count;
+    const U64 *lookups;
+    U64Bloom bloom;
+    U64XorFilter xor_filter;
+    U64Map map;
+    U64 position;
+} FilterContext;
+
+static void BenchBloomAdd(void *arg, U64 iterations) {
+    FilterContext *ctx = (FilterContext *)arg;
+    for (U64 i = 0; i < iterations; ++i) {
+        U64Bloom bloom;
+        U64BloomInit(&bloom, HeliosNewMallocAllocator(), ctx->count, BENCH_BITS_PER_KEY);
+        for (U64 j = 0; j < ctx->count; ++j) U64BloomAdd(&bloom, ctx->keys[j]);
+        HeliosBenchDoNotOptimize(bloom.blocks);
+        U64BloomFree(&bloom);
+    }
+}
+
+static void BenchXorBuild(void *arg, U64 iterations) {
+    FilterContext *ctx = (FilterContext *)arg;
+    for (U64 i = 0; i < iterations; ++i) {
+        U64XorFilter xor_filter;
+        HELIOS_VERIFY(U64XorFilterBuild(&xor_filter, HeliosNewMallocAllocator(), ctx->keys, ctx->count));
+        HeliosBenchDoNotOptimize(xor_filter.fingerprints);
+        U64XorFilterFree(&xor_filter);
+    }
+}
+
+static void BenchBloomQuery(void *arg, U64 iterations) {
+    FilterContext *ctx = (FilterContext *)arg;
+    U64 found = 0;
+    for (U64 i = ctx->position; i < ctx->position + iterations; ++i) {
+        found += U64BloomMayContain(&ctx->bloom, ctx->lookups[i & LOOKUP_MASK]);
+    }
+    ctx->position += iterations;
+    HeliosBenchDoNotOptimize(&found);
+}
+
+static void BenchXorQuery(void *arg, U64 iterations) {
+    FilterContext *ctx = (FilterContext *)arg;
+    U64 found = 0;
+    for (U64 i = ctx->position; i < ctx->position + iterations; ++i) {
+        found += U64XorFilterMayContain(&ctx->xor_filter, ctx->lookups[i & LOOKUP_MASK]);
+    }
+    ctx->position += iterations;
+    HeliosBenchDoNotOptimize(&found);
+}
+
+static void BenchMapQuery(void *arg, U64 iterations) {
+    FilterContext *ctx = (FilterContext *)arg;
+    U64 found = 0;
+    for (U64 i = ctx->position; i < ctx->position + iterations; ++i) {
+        found += U64MapFindPtr(&ctx->map, ctx->lookups[i & LOOKUP_MASK]) != NULL;
+    }
+    ctx->position += iterations;
+    HeliosBenchDoNotOptimize(&found);
+}
+
+static void BenchGuardedMapQuery(void *arg, U64 iterations) {
+    FilterContext *ctx = (FilterContext *)arg;
+    U64 found = 0;
+    for (U64 i = ctx->position; i < ctx->position + iterations; ++i) {
+        U64 key = ctx->lookups[i & LOOKUP_MASK];
+        found += U64BloomMayContain(&ctx->bloom, key) && U64MapFindPtr(&ctx->map, key) != NULL;
+    }
+    ctx->position += iterations;
+    HeliosBenchDoNotOptimize(&found);
+}
+
+static void RunCase(HeliosBench *bench, FilterContext *ctx, const char *filter, const char *op,
+                    HeliosBenchFunc *func, U64 items) {
+    char name[128];
+    snprintf(name, sizeof(name), "filter/%llu/%s/%s", (unsigned long long)ctx->count, filter, op);
+
+    // Builds of large sets take long enough that a few samples are plenty.
+    U32 samples = bench->samples;
+    if (items == ctx->count && ctx->count >= LARGE_SET_KEYS) bench->samples = HELIOS_MIN(samples, LARGE_SET_SAMPLES);
+
+    HeliosBenchRun(bench, &(HeliosBenchCase) {
+        .name = name,
+        .func = func,
+        .arg = ctx,
+        .items_per_iteration = items,
+    });
+
+    bench->samples = samples;
+}
+
+static void ReportFalsePositives(HeliosBench *bench, FilterContext *ctx, const U64 *missing) {
+    FILE *out = bench->tsv ? stderr : bench->out;
+    if (out == NULL) return;
+
+    const UZ bits_per_key[] = {8, 10, 12, 16};
+    for (UZ b = 0; b < sizeof(bits_per_key) / sizeof(bits_per_key[0]); ++b) {
+        U64Bloom bloom;
+        U64BloomInit(&bloom, HeliosNewMallocAllocator(), ctx->count, bits_per_key[b]);
+        for (U64 i = 0; i < ctx->count; ++i) U64BloomAdd(&bloom, ctx->keys[i]);
+
+        U64 false_positives = 0;
+        for (U64 i = 0; i < LOOKUP_KEYS; ++i) false_positives += U64BloomMayContain(&bloom, missing[i]);
+        fprintf(out, "filter/%llu/bloom: %.2f bits/key, %.3f%% false positives\n",
+                (unsigned long long)ctx->count, (F64)bloom.block_count * ERMIS_BLOOM_BLOCK_BITS / (F64)ctx->count,
+                (F64)false_positives * 100.0 / LOOKUP_KEYS);
+        U64BloomFree(&bloom);
+    }
+
+    U64 false_positives = 0;
+    for (U64 i = 0; i < LOOKUP_KEYS; ++i) false_positives += U64XorFilterMayContain(&ctx->xor_filter, missing[i]);
+    fprintf(out, "filter/%llu/xor8: %.2f bits/key, %.3f%% false positives\n",
+            (unsigned long long)ctx->count, (F64)ctx->xor_filter.segment_length * 3 * 8 / (F64)ctx->count,
+            (F64)false_positives * 100.0 / LOOKUP_KEYS);
+}
+
+int main(int argc, char **argv) {
+    HeliosBench bench;
+    HeliosBenchInit(&bench, argc, argv);
+
+    const U64 sizes[] = {1 << 16, 1 << 20, 1 << 24};
+    U64 *missing = (U64 *)malloc(sizeof(U64) * LOOKUP_KEYS);
+    U64 *hits = (U64 *)malloc(sizeof(U64) * LOOKUP_KEYS);
+
+    for (UZ s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+        FilterContext ctx = {.count = sizes[s]};
+
+        // Mix64 is a bijection, so indices past the set give keys that are not in it.
+        U64 *keys = (U64 *)malloc(sizeof(U64) * ctx.count);
+        for (U64 i = 0; i < ctx.count; ++i) keys[i] = Mix64(i);
+        for (U64 i = 0; i < LOOKUP_KEYS; ++i) {
+            missing[i] = Mix64(ctx.count + i);
+            hits[i] = keys[Mix64(i ^ 0x5555) % ctx.count];
+        }
+        ctx.keys = keys;
+
+        U64BloomInit(&ctx.bloom, HeliosNewMallocAllocator(), ctx.count, BENCH_BITS_PER_KEY);
+        for (U64 i = 0; i < ctx.count; ++i) U64BloomAdd(&ctx.bloom, keys[i]);
+        HELIOS_VERIFY(U64XorFilterBuild(&ctx.xor_filter, HeliosNewMallocAllocator(), keys, ctx.count));
+        U64MapInit(&ctx.map, HeliosNewMallocAllocator(), 0);
+        for (U64 i = 0; i < ctx.count; ++i) U64MapInsert(&ctx.map, keys[i], i);
+
+        ReportFalsePositives(&bench, &ctx, missing);
+
+        RunCase(&bench, &ctx, "bloom", "add", BenchBloomAdd, ctx.count);
+        RunCase(&bench, &ctx, "xor8", "build", BenchXorBuild, ctx.count);
+
+        B32 simd = ctx.bloom.simd;
+        const U64 *lookups[] = {hits, missing};
+        const char *ops[] = {"hit", "miss"};
+        for (UZ l = 0; l < 2; ++l) {
+            ctx.lookups = lookups[l];
+            ctx.bloom.simd = 0;
+            RunCase(&bench, &ctx, "bloom_scalar", ops[l], BenchBloomQuery, 1);
+            if (simd) {
+                ctx.bloom.simd = 1;
+                RunCase(&bench, &ctx, "bloom_simd", ops[l], BenchBloomQuery, 1);
+            }
+            RunCase(&bench, &ctx, "xor8", ops[l], BenchXorQuery, 1);
+        }
+
+        ctx.lookups = missing;
+        RunCase(&bench, &ctx, "hashmap", "miss", BenchMapQuery, 1);
+        RunCase(&bench, &ctx, "bloom+hashmap", "miss", BenchGuardedMapQuery, 1);
+
+        U64BloomFree(&ctx.bloom);
+        U64XorFilterFree(&ctx.xor_filter);
+        U64MapFree(&ctx.map);
+        free(keys);
+    }
+
+    free(missing);
+    free(hits);
+    return 0;
+}
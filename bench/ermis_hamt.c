@@ -0,0 +1,158 @@
+// Ermis HAMT versions against an ermis hashmap that is copied whole for every published update.
+//
+//     cc -O2 -o ermis_hamt bench/ermis_hamt.c && ./ermis_hamt
+//
+// Cases are named `hamt/<keys>/<map>/<operation>`. `update` makes a new version with one key changed and
+// drops the old one: a path copy for `hamt`, a copy of the tables and an insert for `hashmap_copy`. `lookup`
+// finds a present key, `snapshot` loads a version from a cell, finds a key in it and releases it.
+
+#define ASTRON_HELIOS_IMPLEMENTATION
+#include "../helios.h"
+#include "../ermis.h"
+
+ERMIS_DECL_HAMT(U64, U64, U64Hamt)
+ERMIS_IMPL_HAMT(U64, U64, U64Hamt, ErmisEqFuncU64, ErmisHashFuncU64)
+
+ERMIS_DECL_HASHMAP(U64, U64, U64Map)
+ERMIS_IMPL_HASHMAP(U64, U64, U64Map, ErmisEqFuncU64, ErmisHashFuncU64)
+
+// The count of precomputed lookup keys, must be a power of two.
+#define LOOKUP_KEYS (1 << 16)
+#define LOOKUP_MASK (LOOKUP_KEYS - 1)
+#define LARGE_SET_SAMPLES 5
+
+typedef struct HamtContext {
+    U64 count;
+    const U64 *lookups;
+    U64Hamt hamt;
+    U64HamtCell cell;
+    U64Map map;
+    U64 position;
+} HamtContext;
+
+static U64 Mix64(U64 x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+static void CopyMap(U64Map *dst, const U64Map *src) {
+    *dst = *src;
+    dst->keys = (U64 *)HeliosAllocUninit(src->allocator, sizeof(U64) * src->capacity);
+    dst->values = (U64 *)HeliosAllocUninit(src->allocator, sizeof(U64) * src->capacity);
+    dst->meta = (U8 *)HeliosAllocUninit(src->allocator, sizeof(U8) * src->capacity);
+    memcpy(dst->keys, src->keys, sizeof(U64) * src->capacity);
+    memcpy(dst->values, src->values, sizeof(U64) * src->capacity);
+    memcpy(dst->meta, src->meta, sizeof(U8) * src->capacity);
+}
+
+static void BenchHamtUpdate(void *arg, U64 iterations) {
+    HamtContext *ctx = (HamtContext *)arg;
+    for (U64 i = ctx->position; i < ctx->position + iterations; ++i) {
+        U64Hamt next = U64HamtInsert(&ctx->hamt, ctx->lookups[i & LOOKUP_MASK], i);
+        U64HamtRelease(&ctx->hamt);
+        ctx->hamt = next;
+    }
+    ctx->position += iterations;
+}
+
+static void BenchMapUpdate(void *arg, U64 iterations) {
+    HamtContext *ctx = (HamtContext *)arg;
+    for (U64 i = ctx->position; i < ctx->position + iterations; ++i) {
+        U64Map next;
+        CopyMap(&next, &ctx->map);
+        U64MapInsert(&next, ctx->lookups[i & LOOKUP_MASK], i);
+        U64MapFree(&ctx->map);
+        ctx->map = next;
+    }
+    ctx->position += iterations;
+}
+
+static void BenchHamtLookup(void *arg, U64 iterations) {
+    HamtContext *ctx = (HamtContext *)arg;
+    U64 sum = 0;
+    for (U64 i = ctx->position; i < ctx->position + iterations; ++i) {
+        sum += *U64HamtFindPtr(&ctx->hamt, ctx->lookups[i & LOOKUP_MASK]);
+    }
+    ctx->position += iterations;
+    HeliosBenchDoNotOptimize(&sum);
+}
+
+static void BenchMapLookup(void *arg, U64 iterations) {
+    HamtContext *ctx = (HamtContext *)arg;
+    U64 sum = 0;
+    for (U64 i = ctx->position; i < ctx->position + iterations; ++i) {
+        sum += *U64MapFindPtr(&ctx->map, ctx->lookups[i & LOOKUP_MASK]);
+    }
+    ctx->position += iterations;
+    HeliosBenchDoNotOptimize(&sum);
+}
+
+static void BenchHamtSnapshot(void *arg, U64 iterations) {
+    HamtContext *ctx = (HamtContext *)arg;
+    U64 sum = 0;
+    for (U64 i = ctx->position; i < ctx->position + iterations; ++i) {
+        U64Hamt snapshot = U64HamtCellLoad(&ctx->cell);
+        sum += *U64HamtFindPtr(&snapshot, ctx->lookups[i & LOOKUP_MASK]);
+        U64HamtRelease(&snapshot);
+    }
+    ctx->position += iterations;
+    HeliosBenchDoNotOptimize(&sum);
+}
+
+static void RunCase(HeliosBench *bench, HamtContext *ctx, const char *map, const char *op, HeliosBenchFunc *func) {
+    char name[128];
+    snprintf(name, sizeof(name), "hamt/%llu/%s/%s", (unsigned long long)ctx->count, map, op);
+
+    // Whole map copies of large sets take long enough that a few samples are plenty.
+    U32 samples = bench->samples;
+    if (func == BenchMapUpdate && ctx->count >= (1 << 20)) bench->samples = HELIOS_MIN(samples, LARGE_SET_SAMPLES);
+
+    HeliosBenchRun(bench, &(HeliosBenchCase) {
+        .name = name,
+        .func = func,
+        .arg = ctx,
+        .items_per_iteration = 1,
+    });
+
+    bench->samples = samples;
+}
+
+int main(int argc, char **argv) {
+    HeliosBench bench;
+    HeliosBenchInit(&bench, argc, argv);
+
+    const U64 sizes[] = {1 << 10, 1 << 16, 1 << 20};
+    U64 *lookups = (U64 *)malloc(sizeof(U64) * LOOKUP_KEYS);
+
+    for (UZ s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+        HamtContext ctx = {.count = sizes[s], .lookups = lookups};
+        for (U64 i = 0; i < LOOKUP_KEYS; ++i) lookups[i] = Mix64(Mix64(i) % ctx.count);
+
+        U64HamtInit(&ctx.hamt, HeliosNewMallocAllocator());
+        U64MapInit(&ctx.map, HeliosNewMallocAllocator(), 0);
+        for (U64 i = 0; i < ctx.count; ++i) {
+            U64Hamt next = U64HamtInsert(&ctx.hamt, Mix64(i), i);
+            U64HamtRelease(&ctx.hamt);
+            ctx.hamt = next;
+            U64MapInsert(&ctx.map, Mix64(i), i);
+        }
+        U64HamtCellInit(&ctx.cell, U64HamtRetain(&ctx.hamt));
+
+        RunCase(&bench, &ctx, "hamt", "lookup", BenchHamtLookup);
+        RunCase(&bench, &ctx, "hashmap", "lookup", BenchMapLookup);
+        RunCase(&bench, &ctx, "hamt", "snapshot", BenchHamtSnapshot);
+        RunCase(&bench, &ctx, "hamt", "update", BenchHamtUpdate);
+        RunCase(&bench, &ctx, "hashmap_copy", "update", BenchMapUpdate);
+
+        U64HamtCellFree(&ctx.cell);
+        U64HamtRelease(&ctx.hamt);
+        U64MapFree(&ctx.map);
+    }
+
+    free(lookups);
+    return 0;
+}
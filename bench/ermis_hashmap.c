@@ -0,0 +1,506 @@
+// Ermis hashmaps against a plain chaining map and `std::unordered_map` (bench/ermis_hashmap_ref.cpp), for
+// U32, U64 and string view keys. Each map stores U64 values.
+//
+//     cc -O2 -c -o ref.o -x c++ bench/ermis_hashmap_ref.cpp
+//     cc -O2 -o ermis_hashmap bench/ermis_hashmap.c ref.o -lstdc++ -lm && ./ermis_hashmap
+//
+// Cases are named `hashmap/<key>/<entries>/<map>/<operation>`:
+//
+//   insert         building the whole map from empty and freeing it, per iteration
+//   hit_uniform    one successful lookup of a uniformly chosen key
+//   hit_zipf       the same with Zipf distributed keys, so that a few keys are very hot
+//   miss           one lookup of a key that is not in the map
+//   iterate        a full pass over all entries
+//   churn_uniform  one operation out of 4 lookups and 1 update of an existing key
+//   churn_zipf     the same with Zipf distributed keys
+//
+// Ermis maps cannot remove entries, so churn only updates values in place.
+//
+// The memory per entry and the probe lengths of every map are reported before its cases, on stdout or on
+// stderr with `--tsv`. Sizes go up to ERMIS_HASHMAP_BENCH_MAX_ENTRIES entries, 1 << 22 by default, set it
+// to 100000000 to also run with 100M entries.
+
+#define ASTRON_HELIOS_IMPLEMENTATION
+#include "../helios.h"
+#include "../ermis.h"
+
+#include <math.h>
+
+// The count of precomputed lookup keys, must be a power of two.
+#define LOOKUP_STREAM_SIZE (1 << 20)
+#define LOOKUP_STREAM_MASK (LOOKUP_STREAM_SIZE - 1)
+#define LARGE_MAP_ENTRIES (1 << 20)
+#define LARGE_MAP_SAMPLES 5
+
+typedef struct ProbeStats {
+    F64 avg_hit;
+    F64 avg_miss;
+    U64 max_hit;
+} ProbeStats;
+
+typedef struct HashMapImpl {
+    const char *name;
+    void *(*create)(void);
+    void (*destroy)(void *);
+    // The value of each key is its index.
+    void (*insert)(void *, const void *keys, U64 count);
+    // Looks up `count` keys starting at `start`, taken from `keys[stream[i & mask]]` or from
+    // `keys[i & mask]` when `stream` is NULL. With `churn`, every fifth key gets updated instead.
+    U64 (*lookup)(void *, const void *keys, const U32 *stream, U64 mask, U64 start, U64 count, B32 churn);
+    U64 (*iterate)(void *);
+    U64 (*bytes)(void *);
+    // NULL when the layout of the map is not known.
+    void (*probes)(void *, ProbeStats *);
+} HashMapImpl;
+
+#define DEFINE_ERMIS_MAP(K, Kn, eqfunc, hashfunc)                                                         \
+    ERMIS_DECL_HASHMAP(K, U64, Ermis##Kn##Map)                                                            \
+    ERMIS_IMPL_HASHMAP(K, U64, Ermis##Kn##Map, eqfunc, hashfunc)                                          \
+                                                                                                          \
+    static void *Ermis##Kn##Create(void) {                                                                \
+        Ermis##Kn##Map *map = (Ermis##Kn##Map *)malloc(sizeof(*map));                                     \
+        Ermis##Kn##MapInit(map, HeliosNewMallocAllocator(), 0);                                           \
+        return map;                                                                                       \
+    }                                                                                                     \
+                                                                                                          \
+    static void Ermis##Kn##Destroy(void *map) {                                                           \
+        Ermis##Kn##MapFree((Ermis##Kn##Map *)map);                                                        \
+        free(map);                                                                                        \
+    }                                                                                                     \
+                                                                                                          \
+    static void Ermis##Kn##Insert(void *map, const void *keys, U64 count) {                               \
+        for (U64 i = 0; i < count; ++i) Ermis##Kn##MapInsert((Ermis##Kn##Map *)map, ((const K *)keys)[i], i); \
+    }                                                                                                     \
+                                                                                                          \
+    static U64 Ermis##Kn##Lookup(void *map, const void *keys, const U32 *stream, U64 mask, U64 start, U64 count, B32 churn) { \
+        const K *k = (const K *)keys;                                                                     \
+        U64 sum = 0;                                                                                      \
+        for (U64 i = start; i < start + count; ++i) {                                                     \
+            K key = k[stream != NULL ? stream[i & mask] : i & mask];                                      \
+            if (churn && i % 5 == 0) {                                                                    \
+                Ermis##Kn##MapInsert((Ermis##Kn##Map *)map, key, i);                                      \
+                continue;                                                                                 \
+            }                                                                                             \
+                                                                                                          \
+            U64 *value = Ermis##Kn##MapFindPtr((Ermis##Kn##Map *)map, key);                               \
+            if (value != NULL) sum += *value;                                                             \
+        }                                                                                                 \
+        return sum;                                                                                       \
+    }                                                                                                     \
+                                                                                                          \
+    static U64 Ermis##Kn##Iterate(void *map) {                                                            \
+        U64 sum = 0;                                                                                      \
+        ERMIS_HASHMAP_FOREACH((Ermis##Kn##Map *)map, key, value, {                                        \
+                HELIOS_UNUSED(key);                                                                       \
+                sum += value;                                                                             \
+            });                                                                                           \
+        return sum;                                                                                       \
+    }                                                                                                     \
+                                                                                                          \
+    static U64 Ermis##Kn##Bytes(void *map) {                                                              \
+        return ((Ermis##Kn##Map *)map)->capacity * (sizeof(K) + sizeof(U64) + 1);                         \
+    }                                                                                                     \
+                                                                                                          \
+    static void Ermis##Kn##Probes(void *map, ProbeStats *stats) {                                         \
+        ErmisHashMapStats map_stats;                                                                      \
+        Ermis##Kn##MapStats((Ermis##Kn##Map *)map, &map_stats);                                           \
+        stats->avg_hit = map_stats.avg_probe;                                                             \
+        stats->max_hit = map_stats.max_probe;                                                             \
+        stats->avg_miss = map_stats.avg_miss_probe;                                                       \
+    }
+
+// A textbook separately chained map with a node allocation per entry, as the baseline.
+#define DEFINE_CHAIN_MAP(K, Kn, eqfunc, hashfunc)                                                         \
+    typedef struct Chain##Kn##Node {                                                                      \
+        struct Chain##Kn##Node *next;                                                                     \
+        U64 hash;                                                                                         \
+        K key;                                                                                            \
+        U64 value;                                                                                        \
+    } Chain##Kn##Node;                                                                                    \
+                                                                                                          \
+    typedef struct Chain##Kn##Map {                                                                       \
+        Chain##Kn##Node **buckets;                                                                        \
+        U64 bucket_count;                                                                                 \
+        U64 count;                                                                                        \
+    } Chain##Kn##Map;                                                                                     \
+                                                                                                          \
+    static void *Chain##Kn##Create(void) {                                                                \
+        Chain##Kn##Map *map = (Chain##Kn##Map *)malloc(sizeof(*map));                                     \
+        map->bucket_count = 16;                                                                           \
+        map->buckets = (Chain##Kn##Node **)calloc(map->bucket_count, sizeof(Chain##Kn##Node *));          \
+        map->count = 0;                                                                                   \
+        return map;                                                                                       \
+    }                                                                                                     \
+                                                                                                          \
+    static void Chain##Kn##Destroy(void *map) {                                                           \
+        Chain##Kn##Map *m = (Chain##Kn##Map *)map;                                                        \
+        for (U64 i = 0; i < m->bucket_count; ++i) {                                                       \
+            Chain##Kn##Node *node = m->buckets[i];                                                        \
+            while (node != NULL) {                                                                        \
+                Chain##Kn##Node *next = node->next;                                                       \
+                free(node);                                                                               \
+                node = next;                                                                              \
+            }                                                                                             \
+        }                                                                                                 \
+        free(m->buckets);                                                                                 \
+        free(m);                                                                                          \
+    }                                                                                                     \
+                                                                                                          \
+    static void Chain##Kn##Put(Chain##Kn##Map *m, K key, U64 value) {                                     \
+        U64 hash = hashfunc(key);                                                                         \
+        for (Chain##Kn##Node *node = m->buckets[hash & (m->bucket_count - 1)]; node != NULL; node = node->next) { \
+            if (node->hash == hash && eqfunc(node->key, key)) {                                           \
+                node->value = value;                                                                      \
+                return;                                                                                   \
+            }                                                                                             \
+        }                                                                                                 \
+                                                                                                          \
+        if (m->count >= m->bucket_count) {                                                                \
+            U64 new_count = m->bucket_count * 2;                                                          \
+            Chain##Kn##Node **buckets = (Chain##Kn##Node **)calloc(new_count, sizeof(Chain##Kn##Node *)); \
+            for (U64 i = 0; i < m->bucket_count; ++i) {                                                   \
+                Chain##Kn##Node *node = m->buckets[i];                                                    \
+                while (node != NULL) {                                                                    \
+                    Chain##Kn##Node *next = node->next;                                                   \
+                    node->next = buckets[node->hash & (new_count - 1)];                                   \
+                    buckets[node->hash & (new_count - 1)] = node;                                         \
+                    node = next;                                                                          \
+                }                                                                                         \
+            }                                                                                             \
+            free(m->buckets);                                                                             \
+            m->buckets = buckets;                                                                         \
+            m->bucket_count = new_count;                                                                  \
+        }                                                                                                 \
+                                                                                                          \
+        Chain##Kn##Node *node = (Chain##Kn##Node *)malloc(sizeof(*node));                                 \
+        node->hash = hash;                                                                                \
+        node->key = key;                                                                                  \
+        node->value = value;                                                                              \
+        node->next = m->buckets[hash & (m->bucket_count - 1)];                                            \
+        m->buckets[hash & (m->bucket_count - 1)] = node;                                                  \
+        ++m->count;                                                                                       \
+    }                                                                                                     \
+                                                                                                          \
+    static void Chain##Kn##Insert(void *map, const void *keys, U64 count) {                               \
+        for (U64 i = 0; i < count; ++i) Chain##Kn##Put((Chain##Kn##Map *)map, ((const K *)keys)[i], i);   \
+    }                                                                                                     \
+                                                                                                          \
+    static U64 Chain##Kn##Lookup(void *map, const void *keys, const U32 *stream, U64 mask, U64 start, U64 count, B32 churn) { \
+        Chain##Kn##Map *m = (Chain##Kn##Map *)map;                                                        \
+        const K *k = (const K *)keys;                                                                     \
+        U64 sum = 0;                                                                                      \
+        for (U64 i = start; i < start + count; ++i) {                                                     \
+            K key = k[stream != NULL ? stream[i & mask] : i & mask];                                      \
+            if (churn && i % 5 == 0) {                                                                    \
+                Chain##Kn##Put(m, key, i);                                                                \
+                continue;                                                                                 \
+            }                                                                                             \
+                                                                                                          \
+            U64 hash = hashfunc(key);                                                                     \
+            for (Chain##Kn##Node *node = m->buckets[hash & (m->bucket_count - 1)]; node != NULL; node = node->next) { \
+                if (node->hash == hash && eqfunc(node->key, key)) {                                       \
+                    sum += node->value;                                                                   \
+                    break;                                                                                \
+                }                                                                                         \
+            }                                                                                             \
+        }                                                                                                 \
+        return sum;                                                                                       \
+    }                                                                                                     \
+                                                                                                          \
+    static U64 Chain##Kn##Iterate(void *map) {                                                            \
+        Chain##Kn##Map *m = (Chain##Kn##Map *)map;                                                        \
+        U64 sum = 0;                                                                                      \
+        for (U64 i = 0; i < m->bucket_count; ++i) {                                                       \
+            for (Chain##Kn##Node *node = m->buckets[i]; node != NULL; node = node->next) sum += node->value; \
+        }                                                                                                 \
+        return sum;                                                                                       \
+    }                                                                                                     \
+                                                                                                          \
+    static U64 Chain##Kn##Bytes(void *map) {                                                              \
+        Chain##Kn##Map *m = (Chain##Kn##Map *)map;                                                        \
+        return m->bucket_count * sizeof(Chain##Kn##Node *) + m->count * sizeof(Chain##Kn##Node);          \
+    }                                                                                                     \
+                                                                                                          \
+    static void Chain##Kn##Probes(void *map, ProbeStats *stats) {                                         \
+        Chain##Kn##Map *m = (Chain##Kn##Map *)map;                                                        \
+        U64 total = 0;                                                                                    \
+        stats->max_hit = 0;                                                                               \
+        for (U64 i = 0; i < m->bucket_count; ++i) {                                                       \
+            U64 length = 0;                                                                               \
+            for (Chain##Kn##Node *node = m->buckets[i]; node != NULL; node = node->next) total += ++length; \
+            if (length > stats->max_hit) stats->max_hit = length;                                         \
+        }                                                                                                 \
+        stats->avg_hit = (F64)total / (F64)m->count;                                                      \
+        stats->avg_miss = (F64)m->count / (F64)m->bucket_count;                                           \
+    }
+
+#define DEFINE_STD_MAP(Kn)                                                                                \
+    void *RefStd##Kn##Create(void);                                                                       \
+    void RefStd##Kn##Destroy(void *);                                                                     \
+    void RefStd##Kn##Insert(void *, const void *keys, U64 count);                                         \
+    U64 RefStd##Kn##Lookup(void *, const void *keys, const U32 *stream, U64 mask, U64 start, U64 count, B32 churn); \
+    U64 RefStd##Kn##Iterate(void *);                                                                      \
+    U64 RefStd##Kn##Bytes(void *);
+
+#define HASH_MAP_IMPLS(Kn) {                                                                              \
+        {"ermis", Ermis##Kn##Create, Ermis##Kn##Destroy, Ermis##Kn##Insert, Ermis##Kn##Lookup,            \
+         Ermis##Kn##Iterate, Ermis##Kn##Bytes, Ermis##Kn##Probes},                                        \
+        {"chain", Chain##Kn##Create, Chain##Kn##Destroy, Chain##Kn##Insert, Chain##Kn##Lookup,            \
+         Chain##Kn##Iterate, Chain##Kn##Bytes, Chain##Kn##Probes},                                        \
+        {"std", RefStd##Kn##Create, RefStd##Kn##Destroy, RefStd##Kn##Insert, RefStd##Kn##Lookup,          \
+         RefStd##Kn##Iterate, RefStd##Kn##Bytes, NULL},                                                   \
+    }
+
+DEFINE_ERMIS_MAP(U32, U32, ErmisEqFuncU32, ErmisHashFuncU32)
+DEFINE_ERMIS_MAP(U64, U64, ErmisEqFuncU64, ErmisHashFuncU64)
+DEFINE_ERMIS_MAP(HeliosStringView, StringView, ErmisEqFuncStringView, ErmisHashFuncStringView)
+
+DEFINE_CHAIN_MAP(U32, U32, ErmisEqFuncU32, ErmisHashFuncU32)
+DEFINE_CHAIN_MAP(U64, U64, ErmisEqFuncU64, ErmisHashFuncU64)
+DEFINE_CHAIN_MAP(HeliosStringView, StringView, ErmisEqFuncStringView, ErmisHashFuncStringView)
+
+DEFINE_STD_MAP(U32)
+DEFINE_STD_MAP(U64)
+DEFINE_STD_MAP(StringView)
+
+#define HASH_MAP_IMPL_COUNT 3
+
+static const HashMapImpl u32_impls[HASH_MAP_IMPL_COUNT] = HASH_MAP_IMPLS(U32);
+static const HashMapImpl u64_impls[HASH_MAP_IMPL_COUNT] = HASH_MAP_IMPLS(U64);
+static const HashMapImpl string_view_impls[HASH_MAP_IMPL_COUNT] = HASH_MAP_IMPLS(StringView);
+
+// Bijective mixers, so that distinct indices give distinct, randomly spread keys.
+static U32 Mix32(U32 x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+static U64 Mix64(U64 x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+typedef struct KeySet {
+    const char *name;
+    const HashMapImpl *impls;
+    UZ key_size;
+    U64 count;
+    // `count` keys in the maps, and LOOKUP_STREAM_SIZE keys that are not.
+    void *keys;
+    void *missing;
+    // Only for string keys.
+    U8 *string_bytes;
+} KeySet;
+
+// Key `index` as a string of 0 to 7 'x's followed by the hex digits of a mixed index.
+static HeliosStringView MakeStringKey(U8 **cursor, U64 index) {
+    U8 *start = *cursor;
+    for (U64 i = 0; i < index % 8; ++i) *(*cursor)++ = 'x';
+    *cursor += sprintf((char *)*cursor, "%llx", (unsigned long long)Mix64(index));
+    return (HeliosStringView) {.data = start, .count = (UZ)(*cursor - start)};
+}
+
+static void KeySetInit(KeySet *set, const char *name, U64 count) {
+    set->name = name;
+    set->count = count;
+    set->string_bytes = NULL;
+
+    if (strcmp(name, "u32") == 0) {
+        U32 *keys = (U32 *)malloc(sizeof(U32) * count);
+        U32 *missing = (U32 *)malloc(sizeof(U32) * LOOKUP_STREAM_SIZE);
+        for (U64 i = 0; i < count; ++i) keys[i] = Mix32((U32)i);
+        for (U64 i = 0; i < LOOKUP_STREAM_SIZE; ++i) missing[i] = Mix32((U32)(count + i));
+
+        set->impls = u32_impls;
+        set->key_size = sizeof(U32);
+        set->keys = keys;
+        set->missing = missing;
+    } else if (strcmp(name, "u64") == 0) {
+        U64 *keys = (U64 *)malloc(sizeof(U64) * count);
+        U64 *missing = (U64 *)malloc(sizeof(U64) * LOOKUP_STREAM_SIZE);
+        for (U64 i = 0; i < count; ++i) keys[i] = Mix64(i);
+        for (U64 i = 0; i < LOOKUP_STREAM_SIZE; ++i) missing[i] = Mix64(count + i);
+
+        set->impls = u64_impls;
+        set->key_size = sizeof(U64);
+        set->keys = keys;
+        set->missing = missing;
+    } else {
+        HeliosStringView *keys = (HeliosStringView *)malloc(sizeof(HeliosStringView) * count);
+        HeliosStringView *missing = (HeliosStringView *)malloc(sizeof(HeliosStringView) * LOOKUP_STREAM_SIZE);
+        // At most 7 'x's, 16 hex digits and the NUL from sprintf.
+        set->string_bytes = (U8 *)malloc((count + LOOKUP_STREAM_SIZE) * 24);
+        U8 *cursor = set->string_bytes;
+        for (U64 i = 0; i < count; ++i) keys[i] = MakeStringKey(&cursor, i);
+        for (U64 i = 0; i < LOOKUP_STREAM_SIZE; ++i) missing[i] = MakeStringKey(&cursor, count + i);
+
+        set->impls = string_view_impls;
+        set->key_size = sizeof(HeliosStringView);
+        set->keys = keys;
+        set->missing = missing;
+    }
+}
+
+static void KeySetRelease(KeySet *set) {
+    free(set->keys);
+    free(set->missing);
+    free(set->string_bytes);
+}
+
+static U64 NextRandom(U64 *state) {
+    *state += 0x9e3779b97f4a7c15ULL;
+    return Mix64(*state);
+}
+
+// Indices into the present keys. The Zipf stream draws ranks from a continuous approximation of a Zipf
+// distribution with exponent 1, P(rank <= r) ~ ln(r) / ln(count), and scatters the ranks over the keys.
+static void FillStreams(U32 *uniform, U32 *zipf, U64 count) {
+    U64 state = 42;
+    F64 log_count = log((F64)count);
+    for (U64 i = 0; i < LOOKUP_STREAM_SIZE; ++i) {
+        uniform[i] = (U32)(NextRandom(&state) % count);
+
+        F64 u = (F64)(NextRandom(&state) >> 11) / (F64)(1ULL << 53);
+        U64 rank = (U64)exp(u * log_count) - 1;
+        if (rank >= count) rank = count - 1;
+        zipf[i] = (U32)(rank * 2654435761ULL % count);
+    }
+}
+
+typedef struct CaseContext {
+    const HashMapImpl *impl;
+    const KeySet *keys;
+    void *map;
+    const void *lookup_keys;
+    const U32 *stream;
+    B32 churn;
+    U64 position;
+} CaseContext;
+
+static void BenchInsert(void *arg, U64 iterations) {
+    CaseContext *ctx = (CaseContext *)arg;
+    for (U64 i = 0; i < iterations; ++i) {
+        void *map = ctx->impl->create();
+        ctx->impl->insert(map, ctx->keys->keys, ctx->keys->count);
+        HeliosBenchDoNotOptimize(map);
+        ctx->impl->destroy(map);
+    }
+}
+
+static void BenchLookup(void *arg, U64 iterations) {
+    CaseContext *ctx = (CaseContext *)arg;
+    U64 sum = ctx->impl->lookup(ctx->map, ctx->lookup_keys, ctx->stream, LOOKUP_STREAM_MASK, ctx->position, iterations, ctx->churn);
+    ctx->position += iterations;
+    HeliosBenchDoNotOptimize(&sum);
+}
+
+static void BenchIterate(void *arg, U64 iterations) {
+    CaseContext *ctx = (CaseContext *)arg;
+    U64 sum = 0;
+    for (U64 i = 0; i < iterations; ++i) sum += ctx->impl->iterate(ctx->map);
+    HeliosBenchDoNotOptimize(&sum);
+}
+
+static void RunCase(HeliosBench *bench, CaseContext *ctx, const char *op, HeliosBenchFunc *func, U64 items) {
+    char name[128];
+    snprintf(name, sizeof(name), "hashmap/%s/%llu/%s/%s",
+             ctx->keys->name, (unsigned long long)ctx->keys->count, ctx->impl->name, op);
+
+    // Whole map passes over large maps take long enough that a few samples are plenty.
+    U32 samples = bench->samples;
+    if (items == ctx->keys->count && ctx->keys->count >= LARGE_MAP_ENTRIES) bench->samples = HELIOS_MIN(samples, LARGE_MAP_SAMPLES);
+
+    HeliosBenchRun(bench, &(HeliosBenchCase) {
+        .name = name,
+        .func = func,
+        .arg = ctx,
+        .items_per_iteration = items,
+    });
+
+    bench->samples = samples;
+}
+
+static void ReportMap(HeliosBench *bench, const CaseContext *ctx) {
+    FILE *out = bench->tsv ? stderr : bench->out;
+    if (out == NULL) return;
+
+    fprintf(out, "hashmap/%s/%llu/%s: %.1f bytes/entry",
+            ctx->keys->name, (unsigned long long)ctx->keys->count, ctx->impl->name,
+            (F64)ctx->impl->bytes(ctx->map) / (F64)ctx->keys->count);
+
+    if (ctx->impl->probes != NULL) {
+        ProbeStats stats;
+        ctx->impl->probes(ctx->map, &stats);
+        fprintf(out, ", probes: %.2f avg hit, %llu max hit, %.2f avg miss",
+                stats.avg_hit, (unsigned long long)stats.max_hit, stats.avg_miss);
+    }
+    fputc('\n', out);
+}
+
+int main(int argc, char **argv) {
+    HeliosBench bench;
+    HeliosBenchInit(&bench, argc, argv);
+
+    U64 max_entries = 1 << 22;
+    const char *max_env = getenv("ERMIS_HASHMAP_BENCH_MAX_ENTRIES");
+    if (max_env != NULL) max_entries = strtoull(max_env, NULL, 10);
+
+    const U64 sizes[] = {1 << 10, 1 << 14, 1 << 18, 1 << 22, 100000000};
+    const char *key_types[] = {"u32", "u64", "sv"};
+
+    U32 *uniform = (U32 *)malloc(sizeof(U32) * LOOKUP_STREAM_SIZE);
+    U32 *zipf = (U32 *)malloc(sizeof(U32) * LOOKUP_STREAM_SIZE);
+
+    for (UZ s = 0; s < sizeof(sizes) / sizeof(sizes[0]) && sizes[s] <= max_entries; ++s) {
+        FillStreams(uniform, zipf, sizes[s]);
+
+        for (UZ k = 0; k < sizeof(key_types) / sizeof(key_types[0]); ++k) {
+            KeySet keys;
+            KeySetInit(&keys, key_types[k], sizes[s]);
+
+            for (UZ m = 0; m < HASH_MAP_IMPL_COUNT; ++m) {
+                CaseContext ctx = {.impl = &keys.impls[m], .keys = &keys};
+                RunCase(&bench, &ctx, "insert", BenchInsert, keys.count);
+
+                ctx.map = ctx.impl->create();
+                ctx.impl->insert(ctx.map, keys.keys, keys.count);
+                ReportMap(&bench, &ctx);
+
+                ctx.lookup_keys = keys.keys;
+                ctx.stream = uniform;
+                RunCase(&bench, &ctx, "hit_uniform", BenchLookup, 1);
+                ctx.stream = zipf;
+                RunCase(&bench, &ctx, "hit_zipf", BenchLookup, 1);
+
+                ctx.lookup_keys = keys.missing;
+                ctx.stream = NULL;
+                RunCase(&bench, &ctx, "miss", BenchLookup, 1);
+
+                RunCase(&bench, &ctx, "iterate", BenchIterate, keys.count);
+
+                ctx.lookup_keys = keys.keys;
+                ctx.churn = 1;
+                ctx.stream = uniform;
+                RunCase(&bench, &ctx, "churn_uniform", BenchLookup, 1);
+                ctx.stream = zipf;
+                RunCase(&bench, &ctx, "churn_zipf", BenchLookup, 1);
+
+                ctx.impl->destroy(ctx.map);
+            }
+
+            KeySetRelease(&keys);
+        }
+    }
+
+    free(uniform);
+    free(zipf);
+    return 0;
+}
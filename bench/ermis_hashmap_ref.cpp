@@ -0,0 +1,117 @@
+// The `std::unordered_map` side of bench/ermis_hashmap.c. Exposes the same batch operations as the C
+// maps over an opaque handle, so that the timed loops are the same in both languages. Allocations are
+// counted to report the memory per entry.
+
+#include "../helios.h"
+
+#include <string_view>
+#include <unordered_map>
+
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    U64 *bytes;
+
+    explicit CountingAllocator(U64 *bytes) : bytes(bytes) {}
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U> &other) : bytes(other.bytes) {}
+
+    T *allocate(std::size_t n) {
+        *bytes += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T *p, std::size_t n) {
+        *bytes -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U> &other) const { return bytes == other.bytes; }
+    template <typename U>
+    bool operator!=(const CountingAllocator<U> &other) const { return bytes != other.bytes; }
+};
+
+template <typename K>
+struct KeyTraits {
+    using Key = K;
+    static Key Convert(K key) { return key; }
+};
+
+template <>
+struct KeyTraits<HeliosStringView> {
+    using Key = std::string_view;
+    static Key Convert(HeliosStringView key) { return Key((const char *)key.data, key.count); }
+};
+
+template <typename K>
+struct RefMap {
+    using Key = typename KeyTraits<K>::Key;
+    using Allocator = CountingAllocator<std::pair<const Key, U64>>;
+    using Map = std::unordered_map<Key, U64, std::hash<Key>, std::equal_to<Key>, Allocator>;
+
+    U64 bytes = 0;
+    Map map{0, std::hash<Key>(), std::equal_to<Key>(), Allocator(&bytes)};
+};
+
+template <typename K>
+static void *Create() {
+    return new RefMap<K>();
+}
+
+template <typename K>
+static void Destroy(void *map) {
+    delete (RefMap<K> *)map;
+}
+
+template <typename K>
+static void Insert(void *map, const void *keys, U64 count) {
+    RefMap<K> *ref = (RefMap<K> *)map;
+    const K *k = (const K *)keys;
+    for (U64 i = 0; i < count; ++i) ref->map[KeyTraits<K>::Convert(k[i])] = i;
+}
+
+template <typename K>
+static U64 Lookup(void *map, const void *keys, const U32 *stream, U64 mask, U64 start, U64 count, B32 churn) {
+    RefMap<K> *ref = (RefMap<K> *)map;
+    const K *k = (const K *)keys;
+    U64 sum = 0;
+    for (U64 i = start; i < start + count; ++i) {
+        auto key = KeyTraits<K>::Convert(k[stream != NULL ? stream[i & mask] : i & mask]);
+        if (churn && i % 5 == 0) {
+            ref->map[key] = i;
+            continue;
+        }
+
+        auto it = ref->map.find(key);
+        if (it != ref->map.end()) sum += it->second;
+    }
+    return sum;
+}
+
+template <typename K>
+static U64 Iterate(void *map) {
+    U64 sum = 0;
+    for (const auto &entry : ((RefMap<K> *)map)->map) sum += entry.second;
+    return sum;
+}
+
+template <typename K>
+static U64 Bytes(void *map) {
+    return ((RefMap<K> *)map)->bytes;
+}
+
+#define REF_DEFINE(K, Kn)                                                                                    \
+    extern "C" void *RefStd##Kn##Create(void) { return Create<K>(); }                                       \
+    extern "C" void RefStd##Kn##Destroy(void *map) { Destroy<K>(map); }                                     \
+    extern "C" void RefStd##Kn##Insert(void *map, const void *keys, U64 count) { Insert<K>(map, keys, count); } \
+    extern "C" U64 RefStd##Kn##Lookup(void *map, const void *keys, const U32 *stream, U64 mask, U64 start, U64 count, B32 churn) { \
+        return Lookup<K>(map, keys, stream, mask, start, count, churn);                                      \
+    }                                                                                                        \
+    extern "C" U64 RefStd##Kn##Iterate(void *map) { return Iterate<K>(map); }                               \
+    extern "C" U64 RefStd##Kn##Bytes(void *map) { return Bytes<K>(map); }
+
+REF_DEFINE(U32, U32)
+REF_DEFINE(U64, U64)
+REF_DEFINE(HeliosStringView, StringView)
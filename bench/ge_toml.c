@@ -0,0 +1,400 @@
+// Parsing throughput of `GeTomlParseBuffer` over generated documents.
+//
+//     cc -O2 -o ge_toml bench/ge_toml.c && ./ge_toml
+//
+// The corpus is deterministic, every run parses the same bytes. Each shape stresses a different part of
+// the parser:
+//
+//   wide      tables with a few hundred keys of mixed scalar types
+//   dotted    tables behind deep dotted headers, with dotted keys in inline tables
+//   numeric   long single line integer arrays and small nested arrays
+//   inline    lines of nested inline tables
+//   strings   long prose strings and string arrays
+//
+// Cases are named `ge_toml/<shape>/<size>` and parse one document per iteration into an arena that is
+// reset in between, so the numbers cover the parser and not the allocator. The allocations per document
+// and the peak memory of one parse through a `HeliosTrackingAllocator` are reported before each case, on
+// stdout or on stderr with `--tsv`, next to the size of the same document as a `GeTomlTape`.
+//
+// `ge_toml/<shape>/<size>/flatten` turns the parsed tables into a tape. The `walk_tables` and `walk_tape`
+// cases visit every value of the document once, summing the integers and string lengths, through the
+// linked tables and through a tape cursor.
+//
+// Documents go up to GE_TOML_BENCH_MAX_BYTES bytes, 16MB by default, set it to 268435456 to also run with
+// 256MB documents. With GE_TOML_BENCH_CORPUS_DIR set, every document is also written to that directory.
+//
+// The generator only emits what the parser supports: no floats, no negative integers, single line arrays,
+// strings without escapes and plain keys outside of table headers and inline tables. Top level tables are
+// spread over groups of GROUP_SIZE, since finding a key walks the whole table.
+
+#define ASTRON_HELIOS_IMPLEMENTATION
+#include "../helios.h"
+#define ASTRON_GE_USE_TOML
+#include "../ge.h"
+
+#define GROUP_SIZE 64
+#define WIDE_TABLE_KEYS 256
+#define NUMERIC_ARRAY_COUNT 1024
+#define INLINE_TABLE_LINES 32
+#define LARGE_DOCUMENT_BYTES (16 << 20)
+#define LARGE_DOCUMENT_SAMPLES 5
+
+typedef struct Corpus {
+    HeliosStringBuilder sb;
+    U64 state;
+} Corpus;
+
+typedef void CorpusTableFunc(Corpus *, U64 index);
+
+static U64 CorpusRandom(Corpus *corpus) {
+    U64 x = (corpus->state += 0x9e3779b97f4a7c15ULL);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+static const char *corpus_words[] = {
+    "the", "parser", "reads", "every", "byte", "of", "a", "document", "once", "and", "builds", "tables",
+    "from", "keys", "values", "arrays", "strings", "with", "no", "escapes", "configuration", "service",
+    "cluster", "region", "latency", "budget", "memory", "allocation", "throughput", "benchmark", "cache",
+    "line", "branch", "predictor", "vector", "register", "pipeline", "stall", "queue", "worker", "thread",
+    "lock", "atomic", "ring", "buffer", "arena", "page", "mapping", "kernel", "syscall", "shader", "mesh",
+};
+
+static void CorpusWords(Corpus *corpus, U64 count) {
+    for (U64 i = 0; i < count; ++i) {
+        if (i != 0) HeliosStringBuilderAppendByte(&corpus->sb, ' ');
+        HeliosStringBuilderAppendCStr(&corpus->sb, corpus_words[CorpusRandom(corpus) % (sizeof(corpus_words) / sizeof(corpus_words[0]))]);
+    }
+}
+
+// An integer with a random count of digits, so that numbers are not all the same width.
+static U64 CorpusInt(Corpus *corpus) {
+    U64 r = CorpusRandom(corpus);
+    return (r >> 8) % ((U64)1 << ((r & 0x3f) % 48 + 1));
+}
+
+static void CorpusHeader(Corpus *corpus, const char *name, U64 index) {
+    HeliosStringBuilderFormat(&corpus->sb, "\n[%s_group_%llu.%s_%llu]\n",
+                              name, (unsigned long long)(index / GROUP_SIZE), name, (unsigned long long)index);
+}
+
+static void CorpusWideTable(Corpus *corpus, U64 index) {
+    CorpusHeader(corpus, "wide", index);
+    for (U64 i = 0; i < WIDE_TABLE_KEYS; ++i) {
+        HeliosStringBuilderFormat(&corpus->sb, "key_%llu = ", (unsigned long long)i);
+        switch (CorpusRandom(corpus) % 4) {
+        case 0: HeliosStringBuilderAppendU64(&corpus->sb, CorpusInt(corpus)); break;
+        case 1: HeliosStringBuilderFormat(&corpus->sb, "0x%llx", (unsigned long long)CorpusInt(corpus)); break;
+        case 2: HeliosStringBuilderAppendCStr(&corpus->sb, CorpusRandom(corpus) & 1 ? "true" : "false"); break;
+        case 3: {
+            HeliosStringBuilderAppendByte(&corpus->sb, '"');
+            CorpusWords(corpus, 1 + CorpusRandom(corpus) % 3);
+            HeliosStringBuilderAppendByte(&corpus->sb, '"');
+            break;
+        }
+        }
+        HeliosStringBuilderAppendByte(&corpus->sb, '\n');
+    }
+}
+
+static void CorpusDottedTable(Corpus *corpus, U64 index) {
+    // Eight children per level below the data center, so that prefixes are shared between headers.
+    HeliosStringBuilderFormat(&corpus->sb, "\n[dc_%llu.zone_%llu.rack_%llu.host_%llu.disk_%llu]\n",
+                              (unsigned long long)(index >> 12), (unsigned long long)(index >> 9 & 7),
+                              (unsigned long long)(index >> 6 & 7), (unsigned long long)(index >> 3 & 7),
+                              (unsigned long long)(index & 7));
+    HeliosStringBuilderFormat(&corpus->sb, "id = %llu\n", (unsigned long long)index);
+    HeliosStringBuilderFormat(&corpus->sb, "online = %s\n", CorpusRandom(corpus) % 8 ? "true" : "false");
+    HeliosStringBuilderFormat(&corpus->sb, "capacity = %llu\n", (unsigned long long)CorpusInt(corpus));
+    HeliosStringBuilderFormat(&corpus->sb,
+                              "labels = { app.name = \"svc-%llu\", app.tier.level = %llu, owner.team.name = \"team-%llu\" }\n",
+                              (unsigned long long)(CorpusRandom(corpus) % 1000),
+                              (unsigned long long)(CorpusRandom(corpus) % 4),
+                              (unsigned long long)(CorpusRandom(corpus) % 100));
+}
+
+static void CorpusNumericTable(Corpus *corpus, U64 index) {
+    CorpusHeader(corpus, "series", index);
+    HeliosStringBuilderFormat(&corpus->sb, "count = %d\nvalues = [", NUMERIC_ARRAY_COUNT);
+    for (U64 i = 0; i < NUMERIC_ARRAY_COUNT; ++i) {
+        if (i != 0) HeliosStringBuilderAppendCStr(&corpus->sb, ", ");
+        HeliosStringBuilderAppendU64(&corpus->sb, CorpusInt(corpus));
+    }
+    HeliosStringBuilderAppendCStr(&corpus->sb, "]\nmasks = [");
+    for (U64 i = 0; i < NUMERIC_ARRAY_COUNT / 16; ++i) {
+        if (i != 0) HeliosStringBuilderAppendCStr(&corpus->sb, ", ");
+        HeliosStringBuilderFormat(&corpus->sb, "0x%llx", (unsigned long long)(CorpusRandom(corpus) >> 4));
+    }
+    HeliosStringBuilderAppendCStr(&corpus->sb, "]\nmatrix = [");
+    for (U64 i = 0; i < 16; ++i) {
+        HeliosStringBuilderFormat(&corpus->sb, "%s[%llu, %llu, %llu]", i != 0 ? ", " : "",
+                                  (unsigned long long)(CorpusRandom(corpus) % 1000),
+                                  (unsigned long long)(CorpusRandom(corpus) % 1000),
+                                  (unsigned long long)(CorpusRandom(corpus) % 1000));
+    }
+    HeliosStringBuilderAppendCStr(&corpus->sb, "]\n");
+}
+
+static void CorpusInlineTable(Corpus *corpus, U64 index) {
+    CorpusHeader(corpus, "mesh", index);
+    for (U64 i = 0; i < INLINE_TABLE_LINES; ++i) {
+        HeliosStringBuilderFormat(&corpus->sb,
+                                  "v%llu = { x = %llu, y = %llu, z = %llu, color = \"#%06llx\", attr = { weight = %llu, visible = %s } }\n",
+                                  (unsigned long long)i,
+                                  (unsigned long long)(CorpusRandom(corpus) % 100000),
+                                  (unsigned long long)(CorpusRandom(corpus) % 100000),
+                                  (unsigned long long)(CorpusRandom(corpus) % 100000),
+                                  (unsigned long long)(CorpusRandom(corpus) & 0xffffff),
+                                  (unsigned long long)(CorpusRandom(corpus) % 256),
+                                  CorpusRandom(corpus) & 1 ? "true" : "false");
+    }
+}
+
+static void CorpusStringTable(Corpus *corpus, U64 index) {
+    CorpusHeader(corpus, "doc", index);
+    HeliosStringBuilderAppendCStr(&corpus->sb, "title = \"");
+    CorpusWords(corpus, 3 + CorpusRandom(corpus) % 6);
+    HeliosStringBuilderAppendCStr(&corpus->sb, "\"\nauthor = \"");
+    CorpusWords(corpus, 2);
+    HeliosStringBuilderAppendCStr(&corpus->sb, "\"\nbody = \"");
+    CorpusWords(corpus, 50 + CorpusRandom(corpus) % 350);
+    HeliosStringBuilderAppendCStr(&corpus->sb, "\"\ntags = [");
+    for (U64 i = 0, count = 1 + CorpusRandom(corpus) % 8; i < count; ++i) {
+        HeliosStringBuilderAppendCStr(&corpus->sb, i != 0 ? ", \"" : "\"");
+        CorpusWords(corpus, 1);
+        HeliosStringBuilderAppendByte(&corpus->sb, '"');
+    }
+    HeliosStringBuilderAppendCStr(&corpus->sb, "]\n");
+}
+
+typedef struct CorpusShape {
+    const char *name;
+    CorpusTableFunc *table;
+} CorpusShape;
+
+static const CorpusShape corpus_shapes[] = {
+    {"wide", CorpusWideTable},
+    {"dotted", CorpusDottedTable},
+    {"numeric", CorpusNumericTable},
+    {"inline", CorpusInlineTable},
+    {"strings", CorpusStringTable},
+};
+
+// Appends tables until the document is at least `size` bytes.
+static HeliosString8 GenerateDocument(const CorpusShape *shape, U64 size) {
+    Corpus corpus = {.state = 42};
+    HeliosStringBuilderInit(&corpus.sb, HeliosNewMallocAllocator(), 1 << 20);
+
+    HeliosStringBuilderFormat(&corpus.sb, "# generated %s corpus\nname = \"%s\"\nversion = 1\n", shape->name, shape->name);
+    for (U64 i = 0; corpus.sb.count < size; ++i) shape->table(&corpus, i);
+
+    HeliosString8 document = HeliosStringBuilderFinalize(&corpus.sb, HeliosNewMallocAllocator());
+    HeliosStringBuilderDestroy(&corpus.sb);
+    return document;
+}
+
+typedef struct ParseContext {
+    HeliosString8 document;
+    HeliosVirtualArena arena;
+    GeTomlTable *table;
+    GeTomlTape tape;
+} ParseContext;
+
+static void BenchParse(void *arg, U64 iterations) {
+    ParseContext *ctx = (ParseContext *)arg;
+    HeliosAllocator allocator = HeliosNewVirtualArenaAllocator(&ctx->arena);
+    char err_buf[256];
+
+    for (U64 i = 0; i < iterations; ++i) {
+        HeliosVirtualArenaReset(&ctx->arena);
+        GeTomlTable *table = GeTomlParseBuffer(allocator, (const char *)ctx->document.data, ctx->document.count,
+                                               err_buf, sizeof(err_buf));
+        HeliosBenchDoNotOptimize(table);
+    }
+}
+
+static void BenchFlatten(void *arg, U64 iterations) {
+    ParseContext *ctx = (ParseContext *)arg;
+    for (U64 i = 0; i < iterations; ++i) {
+        GeTomlTape tape;
+        GeTomlTapeFromTable(&tape, HeliosNewMallocAllocator(), ctx->table);
+        HeliosBenchDoNotOptimize(tape.entries);
+        GeTomlTapeFree(&tape);
+    }
+}
+
+static U64 WalkTable(const GeTomlTable *table);
+
+static U64 WalkValue(const GeTomlValue *value) {
+    switch (value->type) {
+    case GeTomlValueType_Int: return (U64)value->i;
+    case GeTomlValueType_String: return value->s.count;
+    case GeTomlValueType_Array: {
+        U64 sum = 0;
+        for (UZ i = 0; i < value->a.count; ++i) sum += WalkValue(&value->a.items[i]);
+        return sum;
+    }
+    case GeTomlValueType_Table: return WalkTable(value->t);
+    default: return 1;
+    }
+}
+
+static U64 WalkTable(const GeTomlTable *table) {
+    U64 sum = 0;
+    for (; table != NULL; table = table->next) {
+        if (table->key.data != NULL) sum += WalkValue(&table->value);
+    }
+    return sum;
+}
+
+static U64 WalkCursor(GeTomlCursor cursor) {
+    switch (GeTomlCursorType(cursor)) {
+    case GeTomlValueType_Int: return (U64)GeTomlCursorInt(cursor);
+    case GeTomlValueType_String: return GeTomlCursorString(cursor).count;
+    case GeTomlValueType_Array: {
+        U64 sum = 0;
+        for (GeTomlCursor item = GeTomlCursorFirst(cursor); !GeTomlCursorAtEnd(item); item = GeTomlCursorNext(item)) {
+            sum += WalkCursor(item);
+        }
+        return sum;
+    }
+    case GeTomlValueType_Table: {
+        U64 sum = 0;
+        for (GeTomlCursor key = GeTomlCursorFirst(cursor); !GeTomlCursorAtEnd(key); key = GeTomlCursorNext(key)) {
+            sum += WalkCursor(GeTomlCursorValue(key));
+        }
+        return sum;
+    }
+    default: return 1;
+    }
+}
+
+static void BenchWalkTables(void *arg, U64 iterations) {
+    ParseContext *ctx = (ParseContext *)arg;
+    for (U64 i = 0; i < iterations; ++i) {
+        U64 sum = WalkTable(ctx->table);
+        HeliosBenchDoNotOptimize(&sum);
+    }
+}
+
+static void BenchWalkTape(void *arg, U64 iterations) {
+    ParseContext *ctx = (ParseContext *)arg;
+    for (U64 i = 0; i < iterations; ++i) {
+        U64 sum = WalkCursor(GeTomlTapeRoot(&ctx->tape));
+        HeliosBenchDoNotOptimize(&sum);
+    }
+}
+
+// Parses once through a tracker, which also checks that the generated document is accepted.
+static void ReportDocument(HeliosBench *bench, const char *name, ParseContext *ctx) {
+    HeliosTrackingAllocator *tracker = (HeliosTrackingAllocator *)malloc(sizeof(HeliosTrackingAllocator));
+    HeliosTrackingAllocatorInit(tracker, HeliosNewVirtualArenaAllocator(&ctx->arena));
+    HeliosVirtualArenaReset(&ctx->arena);
+
+    char err_buf[256];
+    GeTomlTable *table = GeTomlParseBuffer(HeliosNewTrackingAllocator(tracker), (const char *)ctx->document.data,
+                                           ctx->document.count, err_buf, sizeof(err_buf));
+    if (table == NULL) {
+        fprintf(stderr, "%s: the generated document does not parse: %s\n", name, err_buf);
+        exit(1);
+    }
+
+    GeTomlTape tape;
+    GeTomlTapeFromTable(&tape, HeliosNewMallocAllocator(), table);
+    UZ tape_bytes = sizeof(U64) * tape.entry_count + tape.strings_count;
+    GeTomlTapeFree(&tape);
+
+    FILE *out = bench->tsv ? stderr : bench->out;
+    if (out != NULL) {
+        fprintf(out, "%s: %llu bytes, %llu allocations and %llu reallocations, %.2fMB peak live, %.2fMB arena, %.2f bytes per input byte\n",
+                name, (unsigned long long)ctx->document.count,
+                (unsigned long long)tracker->alloc_count, (unsigned long long)tracker->realloc_count,
+                (F64)tracker->peak_bytes / (1 << 20), (F64)ctx->arena.offset / (1 << 20),
+                (F64)ctx->arena.offset / (F64)ctx->document.count);
+        fprintf(out, "%s: %.2fMB tape, %.2f bytes per input byte\n", name, (F64)tape_bytes / (1 << 20),
+                (F64)tape_bytes / (F64)ctx->document.count);
+    }
+
+    free(tracker);
+}
+
+static void WriteDocument(const char *dir, const char *name, HeliosString8 document) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s.toml", dir, name);
+    for (char *c = path + strlen(dir) + 1; *c != '\0'; ++c) {
+        if (*c == '/') *c = '_';
+    }
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL || fwrite(document.data, 1, document.count, file) != document.count) {
+        fprintf(stderr, "could not write '%s'\n", path);
+        exit(1);
+    }
+    fclose(file);
+}
+
+int main(int argc, char **argv) {
+    HeliosBench bench;
+    HeliosBenchInit(&bench, argc, argv);
+
+    U64 max_bytes = LARGE_DOCUMENT_BYTES;
+    const char *max_env = getenv("GE_TOML_BENCH_MAX_BYTES");
+    if (max_env != NULL) max_bytes = strtoull(max_env, NULL, 10);
+    const char *corpus_dir = getenv("GE_TOML_BENCH_CORPUS_DIR");
+
+    const U64 sizes[] = {4 << 10, 256 << 10, 16 << 20, 256 << 20};
+
+    for (UZ s = 0; s < sizeof(sizes) / sizeof(sizes[0]) && sizes[s] <= max_bytes; ++s) {
+        for (UZ c = 0; c < sizeof(corpus_shapes) / sizeof(corpus_shapes[0]); ++c) {
+            char name[128];
+            snprintf(name, sizeof(name), "ge_toml/%s/%llu", corpus_shapes[c].name, (unsigned long long)sizes[s]);
+            if (bench.filter != NULL && strstr(name, bench.filter) == NULL) continue;
+
+            ParseContext ctx;
+            ctx.document = GenerateDocument(&corpus_shapes[c], sizes[s]);
+            // Only reserves address space, parsed documents take up to a few dozen times the source size.
+            HELIOS_VERIFY(HeliosVirtualArenaInit(&ctx.arena, (UZ)ctx.document.count * 64 + (1 << 24), 0));
+
+            if (corpus_dir != NULL) WriteDocument(corpus_dir, name, ctx.document);
+            ReportDocument(&bench, name, &ctx);
+
+            U32 samples = bench.samples;
+            if (sizes[s] >= LARGE_DOCUMENT_BYTES) bench.samples = HELIOS_MIN(samples, LARGE_DOCUMENT_SAMPLES);
+
+            HeliosBenchRun(&bench, &(HeliosBenchCase) {
+                .name = name,
+                .func = BenchParse,
+                .arg = &ctx,
+                .bytes_per_iteration = ctx.document.count,
+            });
+
+            // The parse cases reset the arena, the tables for the other cases are parsed once after them.
+            char err_buf[256];
+            HeliosVirtualArenaReset(&ctx.arena);
+            ctx.table = GeTomlParseBuffer(HeliosNewVirtualArenaAllocator(&ctx.arena), (const char *)ctx.document.data,
+                                          ctx.document.count, err_buf, sizeof(err_buf));
+            GeTomlTapeFromTable(&ctx.tape, HeliosNewMallocAllocator(), ctx.table);
+
+            const char *cases[] = {"flatten", "walk_tables", "walk_tape"};
+            HeliosBenchFunc *funcs[] = {BenchFlatten, BenchWalkTables, BenchWalkTape};
+            for (UZ k = 0; k < sizeof(cases) / sizeof(cases[0]); ++k) {
+                char case_name[160];
+                snprintf(case_name, sizeof(case_name), "%s/%s", name, cases[k]);
+                HeliosBenchRun(&bench, &(HeliosBenchCase) {
+                    .name = case_name,
+                    .func = funcs[k],
+                    .arg = &ctx,
+                    .bytes_per_iteration = ctx.document.count,
+                });
+            }
+
+            bench.samples = samples;
+            GeTomlTapeFree(&ctx.tape);
+            HeliosVirtualArenaRelease(&ctx.arena);
+            HeliosFree(ctx.document.allocator, ctx.document.data, ctx.document.capacity);
+        }
+    }
+
+    return 0;
+}
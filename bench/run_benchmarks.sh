@@ -0,0 +1,34 @@
+#!/bin/sh
+
+# Builds every benchmark in bench/ at each optimization level and runs it. Results go to stdout and to
+# bench_output.txt as tab separated lines:
+#
+#     bench  flags  case  iterations  samples  min_ns  median_ns  p99_ns  mean_ns  items  bytes
+#
+# where all times are per iteration. Arguments are passed on to the benchmarks, e.g. --filter=<substring>.
+# A bench/<name>_ref.cpp next to a benchmark holds its C++ reference implementations and is linked in.
+
+set -e
+
+CC="${CC:-cc}"
+CXX="${CXX:-c++}"
+OPT_LEVELS="${OPT_LEVELS:--O2 -O3}"
+BUILD_DIR="${BUILD_DIR:-_bench_build}"
+OUTPUT="${OUTPUT:-bench_output.txt}"
+
+mkdir -p "$BUILD_DIR"
+printf 'bench\tflags\tcase\titerations\tsamples\tmin_ns\tmedian_ns\tp99_ns\tmean_ns\titems\tbytes\n' > "$OUTPUT"
+
+for bench_file in ./bench/*.c; do
+    name=$(basename "$bench_file" .c)
+    for opt in $OPT_LEVELS; do
+        binary="$BUILD_DIR/$name$opt"
+        ref_objects=""
+        if [ -f "./bench/${name}_ref.cpp" ]; then
+            ref_objects="$BUILD_DIR/${name}_ref$opt.o -lstdc++"
+            $CXX $opt -std=gnu++20 -Wall -Wextra -c -o "$BUILD_DIR/${name}_ref$opt.o" "./bench/${name}_ref.cpp"
+        fi
+        $CC $opt -Wall -Wextra -pedantic -pthread -o "$binary" "$bench_file" $ref_objects -lm
+        "$binary" --tsv "$@" | awk -v prefix="$name\t$opt\t" '{ print prefix $0 }' | tee -a "$OUTPUT"
+    done
+done
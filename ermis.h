@@ -5,16 +5,35 @@
 #    error "ermis.h requires 'helios.h' to be included first"
 #endif // ASTRON_HELIOS_H
 
+#ifdef ASTRON_HELIOS_IMPLEMENTATION
+#    define ASTRON_ERMIS_IMPLEMENTATION
+#endif // ASTRON_HELIOS_IMPLEMENTATION
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
 #define ERMIS_ARRAY_GROW_FACTOR(x) ((((x) + 1) * 3) >> 1)
 
-#define ERMIS_DECL_ARRAY(T, arrname) typedef struct arrname {           \
-        HeliosAllocator allocator;                                      \
+// Every generator has an `_A` variant which takes an allocator type instead of working with the
+// dynamic `HeliosAllocator`. An allocator type `A` is a struct, which the container points to, along
+// with the following procedures, that are called directly and can thus be inlined:
+//
+//     void *A##Alloc(A *, UZ size);                       // contents are unspecified
+//     void *A##AllocZeroed(A *, UZ size);
+//     void *A##Realloc(A *, void *ptr, UZ old_size, UZ new_size);
+//     void  A##Free(A *, void *ptr, UZ size);
+//
+// `HeliosArena` from helios.h is one such type.
+
+#define _ERMIS_DECL_ARRAY_GENERIC(T, arrname, alloctype, freefunc) typedef struct arrname { \
+        alloctype allocator;                                            \
         T *items;                                                       \
         UZ count;                                                       \
         UZ capacity;                                                    \
     } arrname;                                                          \
                                                                         \
-    void arrname##Init(arrname *arr, HeliosAllocator allocator, UZ cap); \
+    void arrname##Init(arrname *arr, alloctype allocator, UZ cap);      \
     void arrname##Push(arrname *arr, T item);                           \
                                                                         \
     HELIOS_INLINE T arrname##Pop(arrname *arr) {                        \
@@ -33,39 +52,276 @@
     }                                                                   \
     \
     HELIOS_INLINE void arrname##Free(arrname *arr) {                    \
-        HeliosFree(arr->allocator, arr->items, sizeof(T) * arr->capacity); \
+        freefunc(arr->allocator, arr->items, sizeof(T) * arr->capacity); \
     }
 
-#define ERMIS_IMPL_ARRAY(T, arrname)                                    \
-    void arrname##Init(arrname *arr, HeliosAllocator allocator, UZ cap) { \
+#define _ERMIS_IMPL_ARRAY_GENERIC(T, arrname, alloctype, allocfunc, reallocfunc) \
+    void arrname##Init(arrname *arr, alloctype allocator, UZ cap) {     \
         arr->allocator = allocator;                                     \
         arr->capacity = cap;                                            \
-        arr->items = HeliosAlloc(allocator, sizeof(T) * cap);           \
+        arr->items = allocfunc(allocator, sizeof(T) * cap);             \
         arr->count = 0;                                                 \
     }                                                                   \
                                                                         \
     void arrname##Push(arrname *arr, T item) {                          \
         if (arr->count >= arr->capacity) {                              \
+            HELIOS_PROFILE_BEGIN(#arrname "Grow");                      \
             UZ new_capacity = ERMIS_ARRAY_GROW_FACTOR(arr->capacity);   \
-            arr->items = HeliosRealloc(arr->allocator, arr->items, sizeof(T) * arr->capacity, sizeof(T) * new_capacity); \
+            arr->items = reallocfunc(arr->allocator, arr->items, sizeof(T) * arr->capacity, sizeof(T) * new_capacity); \
             arr->capacity = new_capacity;                               \
+            HELIOS_PROFILE_END(#arrname "Grow");                        \
         }                                                               \
                                                                         \
         arr->items[arr->count++] = item;                                \
     }
 
-#define ERMIS_DECL_HASHMAP(K, V, hashmapname) typedef struct hashmapname { \
+#define ERMIS_DECL_ARRAY(T, arrname) _ERMIS_DECL_ARRAY_GENERIC(T, arrname, HeliosAllocator, HeliosFree)
+#define ERMIS_IMPL_ARRAY(T, arrname) _ERMIS_IMPL_ARRAY_GENERIC(T, arrname, HeliosAllocator, HeliosAllocUninit, HeliosRealloc)
+
+#define ERMIS_DECL_ARRAY_A(T, arrname, A) _ERMIS_DECL_ARRAY_GENERIC(T, arrname, A *, A##Free)
+#define ERMIS_IMPL_ARRAY_A(T, arrname, A) _ERMIS_IMPL_ARRAY_GENERIC(T, arrname, A *, A##Alloc, A##Realloc)
+
+// d-ary heap over contiguous storage, with `lessfunc(a, b)` ordering the items so that the least one is
+// on top. With four children per node a sift down compares four adjacent items, which span one or two
+// cache lines, and the tree is half as deep as a binary heap's, so heaps of millions of items miss the
+// cache on half as many levels. Items that need to find themselves again, like timers to cancel or
+// reschedule, get their position through `setindexfunc(T *item, UZ index)` every time they move, use
+// `ErmisHeapIndexNone` when they do not.
+//
+// `PushBounded` with a limit of K keeps the K greatest items under `lessfunc`, the least of them on top
+// as the first to drop out. A reversed `lessfunc` keeps the K least.
+
+#define ERMIS_HEAP_ARITY 4
+
+#define ERMIS_HEAP_PARENT(idx) (((idx) - 1) / ERMIS_HEAP_ARITY)
+#define ERMIS_HEAP_FIRST_CHILD(idx) ((idx) * ERMIS_HEAP_ARITY + 1)
+
+#define ErmisHeapIndexNone(item, index) ((void)0)
+
+#define _ERMIS_DECL_HEAP_GENERIC(T, heapname, alloctype, freefunc) typedef struct heapname { \
+        alloctype allocator;                                            \
+        T *items;                                                       \
+        UZ count;                                                       \
+        UZ capacity;                                                    \
+    } heapname;                                                         \
+                                                                        \
+    void heapname##Init(heapname *heap, alloctype allocator, UZ cap);   \
+    /* Copies `count` items and orders them in O(n), rather than O(n log n) for pushing them one by one. */ \
+    void heapname##InitFrom(heapname *heap, alloctype allocator, const T *items, UZ count); \
+    /* Restores the order after `items` were written directly, in O(n). */ \
+    void heapname##Heapify(heapname *heap);                             \
+    void heapname##Push(heapname *heap, T item);                        \
+    T heapname##Pop(heapname *heap);                                    \
+    /* Replaces the top with `item` in a single sift down and returns the old top. */ \
+    T heapname##ReplaceTop(heapname *heap, T item);                     \
+    /* Pushes while there are fewer than `limit` items, then only items that do not order before the */ \
+    /* top, which is dropped for them. Returns 0 when `item` was not kept. */ \
+    B32 heapname##PushBounded(heapname *heap, T item, UZ limit);        \
+    /* Moves the item at `index` into place after its key changed, in either direction. */ \
+    void heapname##Update(heapname *heap, UZ index);                    \
+    T heapname##Remove(heapname *heap, UZ index);                       \
+                                                                        \
+    HELIOS_INLINE T heapname##Peek(const heapname *heap) {              \
+        HELIOS_VERIFY(heap->count != 0);                                \
+        return heap->items[0];                                          \
+    }                                                                   \
+                                                                        \
+    HELIOS_INLINE void heapname##Free(heapname *heap) {                 \
+        freefunc(heap->allocator, heap->items, sizeof(T) * heap->capacity); \
+    }
+
+#define _ERMIS_IMPL_HEAP_GENERIC(T, heapname, lessfunc, setindexfunc, alloctype, allocfunc, reallocfunc) \
+    /* Both sifts carry the item along in a hole and write it once, where it stops. */ \
+    HELIOS_INTERNAL UZ heapname##SiftUp(heapname *heap, UZ idx, T item) { \
+        while (idx > 0) {                                               \
+            UZ parent = ERMIS_HEAP_PARENT(idx);                         \
+            if (!(lessfunc(item, heap->items[parent]))) break;          \
+            heap->items[idx] = heap->items[parent];                     \
+            setindexfunc(&heap->items[idx], idx);                       \
+            idx = parent;                                               \
+        }                                                               \
+        heap->items[idx] = item;                                        \
+        setindexfunc(&heap->items[idx], idx);                           \
+        return idx;                                                     \
+    }                                                                   \
+                                                                        \
+    HELIOS_INTERNAL void heapname##SiftDown(heapname *heap, UZ idx, T item) { \
+        UZ count = heap->count;                                         \
+        for (;;) {                                                      \
+            UZ first = ERMIS_HEAP_FIRST_CHILD(idx);                     \
+            if (first >= count) break;                                  \
+            UZ best = first;                                            \
+            UZ end = HELIOS_MIN(first + ERMIS_HEAP_ARITY, count);       \
+            for (UZ child = first + 1; child < end; ++child) {          \
+                if (lessfunc(heap->items[child], heap->items[best])) best = child; \
+            }                                                           \
+            if (!(lessfunc(heap->items[best], item))) break;            \
+            heap->items[idx] = heap->items[best];                       \
+            setindexfunc(&heap->items[idx], idx);                       \
+            idx = best;                                                 \
+        }                                                               \
+        heap->items[idx] = item;                                        \
+        setindexfunc(&heap->items[idx], idx);                           \
+    }                                                                   \
+                                                                        \
+    void heapname##Init(heapname *heap, alloctype allocator, UZ cap) {  \
+        heap->allocator = allocator;                                    \
+        heap->capacity = cap;                                           \
+        heap->items = allocfunc(allocator, sizeof(T) * cap);            \
+        heap->count = 0;                                                \
+    }                                                                   \
+                                                                        \
+    void heapname##InitFrom(heapname *heap, alloctype allocator, const T *items, UZ count) { \
+        heapname##Init(heap, allocator, count);                         \
+        memcpy(heap->items, items, sizeof(T) * count);                  \
+        heap->count = count;                                            \
+        heapname##Heapify(heap);                                        \
+    }                                                                   \
+                                                                        \
+    void heapname##Heapify(heapname *heap) {                            \
+        if (heap->count < 2) {                                          \
+            if (heap->count == 1) setindexfunc(&heap->items[0], 0);     \
+            return;                                                     \
+        }                                                               \
+        /* Leaves are only moved by the sifts of their parents, so they get their index up front. */ \
+        UZ last_parent = ERMIS_HEAP_PARENT(heap->count - 1);            \
+        for (UZ idx = last_parent + 1; idx < heap->count; ++idx) setindexfunc(&heap->items[idx], idx); \
+        for (UZ idx = last_parent + 1; idx-- > 0;) heapname##SiftDown(heap, idx, heap->items[idx]); \
+    }                                                                   \
+                                                                        \
+    void heapname##Push(heapname *heap, T item) {                       \
+        if (heap->count >= heap->capacity) {                            \
+            HELIOS_PROFILE_BEGIN(#heapname "Grow");                     \
+            UZ new_capacity = ERMIS_ARRAY_GROW_FACTOR(heap->capacity);  \
+            heap->items = reallocfunc(heap->allocator, heap->items, sizeof(T) * heap->capacity, sizeof(T) * new_capacity); \
+            heap->capacity = new_capacity;                              \
+            HELIOS_PROFILE_END(#heapname "Grow");                       \
+        }                                                               \
+                                                                        \
+        heapname##SiftUp(heap, heap->count++, item);                    \
+    }                                                                   \
+                                                                        \
+    T heapname##Pop(heapname *heap) {                                   \
+        HELIOS_VERIFY(heap->count != 0);                                \
+        T top = heap->items[0];                                         \
+        if (--heap->count != 0) heapname##SiftDown(heap, 0, heap->items[heap->count]); \
+        return top;                                                     \
+    }                                                                   \
+                                                                        \
+    T heapname##ReplaceTop(heapname *heap, T item) {                    \
+        HELIOS_VERIFY(heap->count != 0);                                \
+        T top = heap->items[0];                                         \
+        heapname##SiftDown(heap, 0, item);                              \
+        return top;                                                     \
+    }                                                                   \
+                                                                        \
+    B32 heapname##PushBounded(heapname *heap, T item, UZ limit) {       \
+        if (heap->count < limit) {                                      \
+            heapname##Push(heap, item);                                 \
+            return 1;                                                   \
+        }                                                               \
+        if (limit == 0 || lessfunc(item, heap->items[0])) return 0;     \
+        heapname##SiftDown(heap, 0, item);                              \
+        return 1;                                                       \
+    }                                                                   \
+                                                                        \
+    void heapname##Update(heapname *heap, UZ index) {                   \
+        HELIOS_VERIFY(index < heap->count);                             \
+        T item = heap->items[index];                                    \
+        if (heapname##SiftUp(heap, index, item) == index) heapname##SiftDown(heap, index, item); \
+    }                                                                   \
+                                                                        \
+    T heapname##Remove(heapname *heap, UZ index) {                      \
+        HELIOS_VERIFY(index < heap->count);                             \
+        T removed = heap->items[index];                                 \
+        if (index != --heap->count) {                                   \
+            heap->items[index] = heap->items[heap->count];              \
+            heapname##Update(heap, index);                              \
+        }                                                               \
+        return removed;                                                 \
+    }
+
+#define ERMIS_DECL_HEAP(T, heapname) _ERMIS_DECL_HEAP_GENERIC(T, heapname, HeliosAllocator, HeliosFree)
+#define ERMIS_IMPL_HEAP(T, heapname, lessfunc, setindexfunc)            \
+    _ERMIS_IMPL_HEAP_GENERIC(T, heapname, lessfunc, setindexfunc, HeliosAllocator, HeliosAllocUninit, HeliosRealloc)
+
+#define ERMIS_DECL_HEAP_A(T, heapname, A) _ERMIS_DECL_HEAP_GENERIC(T, heapname, A *, A##Free)
+#define ERMIS_IMPL_HEAP_A(T, heapname, lessfunc, setindexfunc, A)       \
+    _ERMIS_IMPL_HEAP_GENERIC(T, heapname, lessfunc, setindexfunc, A *, A##Alloc, A##Realloc)
+
+#define ERMIS_HASHMAP_PROBE_HISTOGRAM_BUCKETS 16
+
+// With `ERMIS_HASHMAP_COUNTERS` defined, every hashmap counts its lookups and the slots they probed. This
+// changes the layout of the map, so it has to be defined the same way everywhere a map is used.
+typedef struct ErmisHashMapCounters {
+    U64 hits;
+    U64 hit_probes;
+    U64 misses;
+    U64 miss_probes;
+} ErmisHashMapCounters;
+
+#ifdef ERMIS_HASHMAP_COUNTERS
+#    define _ERMIS_HASHMAP_COUNTERS_FIELD ErmisHashMapCounters counters;
+#    define _ERMIS_HASHMAP_COUNT_LOOKUP(map, hit, probes) do {          \
+        if (hit) {                                                      \
+            ++(map)->counters.hits;                                     \
+            (map)->counters.hit_probes += (probes);                     \
+        } else {                                                        \
+            ++(map)->counters.misses;                                   \
+            (map)->counters.miss_probes += (probes);                    \
+        }                                                               \
+    } while (0)
+#    define _ERMIS_HASHMAP_COPY_COUNTERS(stats, map) ((stats)->counters = (map)->counters)
+#    define _ERMIS_HASHMAP_INIT_COUNTERS(map) memset(&(map)->counters, 0, sizeof((map)->counters))
+#    define _ERMIS_HASHMAP_KEEP_COUNTERS(new_map, map) ((new_map)->counters = (map)->counters)
+#else
+#    define _ERMIS_HASHMAP_COUNTERS_FIELD
+#    define _ERMIS_HASHMAP_COUNT_LOOKUP(map, hit, probes) ((void)(probes))
+#    define _ERMIS_HASHMAP_COPY_COUNTERS(stats, map) ((void)0)
+#    define _ERMIS_HASHMAP_INIT_COUNTERS(map) ((void)0)
+#    define _ERMIS_HASHMAP_KEEP_COUNTERS(new_map, map) ((void)0)
+#endif // ERMIS_HASHMAP_COUNTERS
+
+// A snapshot of how well the keys of a hashmap are spread, from `hashmapname##Stats`. Probe lengths count
+// the slots compared, so a key in its home slot has a probe length of 1.
+typedef struct ErmisHashMapStats {
+    UZ count;
+    UZ capacity;
+    F64 load_factor;
+
+    F64 avg_probe;
+    UZ max_probe;
+    // Bucket `i` counts the keys with a probe length of `i + 1`, the last bucket also counts longer ones.
+    UZ probe_histogram[ERMIS_HASHMAP_PROBE_HISTOGRAM_BUCKETS];
+    // The average count of slots a miss probes, over all home slots.
+    F64 avg_miss_probe;
+
+    // Clusters are runs of occupied slots, misses have to walk to the end of one.
+    UZ cluster_count;
+    F64 avg_cluster;
+    UZ max_cluster;
+
+    UZ resize_count;
+    // Only filled in with `ERMIS_HASHMAP_COUNTERS`, zeroed otherwise.
+    ErmisHashMapCounters counters;
+} ErmisHashMapStats;
+
+#define _ERMIS_DECL_HASHMAP_GENERIC(K, V, hashmapname, alloctype, freefunc) typedef struct hashmapname { \
         K *keys;                                                        \
         V *values;                                                      \
         U8 *meta;                                                       \
         UZ capacity;                                                    \
         UZ count;                                                       \
-        HeliosAllocator allocator;                                      \
+        UZ resize_count;                                                \
+        alloctype allocator;                                            \
+        _ERMIS_HASHMAP_COUNTERS_FIELD                                   \
     } hashmapname;                                                      \
                                                                         \
-    void hashmapname##Init(hashmapname *map, HeliosAllocator allocator, UZ cap); \
+    void hashmapname##Init(hashmapname *map, alloctype allocator, UZ cap); \
     B32 hashmapname##Insert(hashmapname *map, K key, V value);          \
     V *hashmapname##FindPtr(hashmapname *map, K key);                   \
+    /* Walks the whole table, meant for diagnostics rather than hot paths. */ \
+    void hashmapname##Stats(const hashmapname *map, ErmisHashMapStats *stats); \
                                                                         \
     HELIOS_INLINE B32 hashmapname##Find(hashmapname *map, K key, V *value) { \
         V *found_ptr = hashmapname##FindPtr(map, key);                  \
@@ -78,9 +334,9 @@
     }                                                                   \
                                                                         \
     HELIOS_INLINE void hashmapname##Free(hashmapname *map) {            \
-        HeliosFree(map->allocator, map->keys, sizeof(K) * map->capacity); \
-        HeliosFree(map->allocator, map->values, sizeof(V) * map->capacity); \
-        HeliosFree(map->allocator, map->meta, sizeof(map->meta[0]) * map->capacity); \
+        freefunc(map->allocator, map->keys, sizeof(K) * map->capacity); \
+        freefunc(map->allocator, map->values, sizeof(V) * map->capacity); \
+        freefunc(map->allocator, map->meta, sizeof(map->meta[0]) * map->capacity); \
     }
 
 #define ERMIS_HASHMAP_DEFAULT_CAP (47)
@@ -97,19 +353,22 @@
         body;                                                           \
     }
 
-#define ERMIS_IMPL_HASHMAP(K, V, hashmapname, eqfunc, hashfunc)         \
-    void hashmapname##Init(hashmapname *map, HeliosAllocator allocator, UZ cap) { \
+#define _ERMIS_IMPL_HASHMAP_GENERIC(K, V, hashmapname, eqfunc, hashfunc, alloctype, allocfunc, alloczeroedfunc) \
+    void hashmapname##Init(hashmapname *map, alloctype allocator, UZ cap) { \
         map->allocator = allocator;                                     \
         map->capacity = cap ? cap : ERMIS_HASHMAP_DEFAULT_CAP;          \
-        map->keys = HeliosAlloc(allocator, sizeof(K) * map->capacity);            \
-        map->values = HeliosAlloc(allocator, sizeof(V) * map->capacity);          \
-        map->meta = HeliosAlloc(allocator, sizeof(map->meta[0]) * map->capacity); \
+        map->keys = allocfunc(allocator, sizeof(K) * map->capacity);    \
+        map->values = allocfunc(allocator, sizeof(V) * map->capacity);  \
+        map->meta = alloczeroedfunc(allocator, sizeof(map->meta[0]) * map->capacity); \
         map->count = 0;                                                 \
+        map->resize_count = 0;                                          \
+        _ERMIS_HASHMAP_INIT_COUNTERS(map);                              \
     }                                                                   \
                                                                         \
     int hashmapname##Insert(hashmapname *map, K key, V value) {         \
         UZ load_percentage = map->count * 100 / map->capacity;          \
         if (load_percentage >= 70) {                                    \
+            HELIOS_PROFILE_BEGIN(#hashmapname "Resize");                \
             UZ new_cap = ERMIS_HASHMAP_GROW_FACTOR(map->capacity);      \
             hashmapname new_map;                                        \
             hashmapname##Init(&new_map, map->allocator, new_cap);       \
@@ -118,8 +377,11 @@
                     HELIOS_ASSERT(hashmapname##Insert(&new_map, key, value)); \
                 });                                                     \
                                                                         \
+            new_map.resize_count = map->resize_count + 1;               \
+            _ERMIS_HASHMAP_KEEP_COUNTERS(&new_map, map);                \
             hashmapname##Free(map);                                     \
             *map = new_map;                                             \
+            HELIOS_PROFILE_END(#hashmapname "Resize");                  \
         }                                                               \
                                                                         \
         U64 idx = hashfunc(key) % map->capacity;                        \
@@ -147,9 +409,17 @@
     V *hashmapname##FindPtr(hashmapname *map, K key) {                  \
         U64 idx = hashfunc(key) % map->capacity;                        \
         U64 start_idx = idx;                                            \
+        UZ probes = 0;                                                  \
                                                                         \
         do {                                                            \
-            if ((map->meta[idx] & ERMIS_HASH_OCCUPIED) && eqfunc(key, map->keys[idx])) { \
+            ++probes;                                                   \
+            /* Entries are never removed, so a probe sequence ends at the first empty slot. */ \
+            if ((map->meta[idx] & ERMIS_HASH_OCCUPIED) == 0) {          \
+                _ERMIS_HASHMAP_COUNT_LOOKUP(map, 0, probes);            \
+                return NULL;                                            \
+            }                                                           \
+            if (eqfunc(key, map->keys[idx])) {                          \
+                _ERMIS_HASHMAP_COUNT_LOOKUP(map, 1, probes);            \
                 return &map->values[idx];                               \
             }                                                           \
                                                                         \
@@ -158,11 +428,1629 @@
             if (idx >= map->capacity) idx = 0;                          \
         } while (idx != start_idx);                                     \
                                                                         \
+        _ERMIS_HASHMAP_COUNT_LOOKUP(map, 0, probes);                    \
         return NULL;                                                    \
+    }                                                                   \
+                                                                        \
+    void hashmapname##Stats(const hashmapname *map, ErmisHashMapStats *stats) { \
+        memset(stats, 0, sizeof(*stats));                               \
+        UZ cap = map->capacity;                                         \
+        stats->count = map->count;                                      \
+        stats->capacity = cap;                                          \
+        stats->load_factor = (F64)map->count / (F64)cap;                \
+        stats->resize_count = map->resize_count;                        \
+        _ERMIS_HASHMAP_COPY_COUNTERS(stats, map);                       \
+                                                                        \
+        U64 total_probes = 0;                                           \
+        for (UZ i = 0; i < cap; ++i) {                                  \
+            if ((map->meta[i] & ERMIS_HASH_OCCUPIED) == 0) continue;    \
+            UZ probes = (UZ)((i + cap - hashfunc(map->keys[i]) % cap) % cap) + 1; \
+            total_probes += probes;                                     \
+            if (probes > stats->max_probe) stats->max_probe = probes;   \
+            ++stats->probe_histogram[HELIOS_MIN(probes, ERMIS_HASHMAP_PROBE_HISTOGRAM_BUCKETS) - 1]; \
+        }                                                               \
+        if (map->count != 0) stats->avg_probe = (F64)total_probes / (F64)map->count; \
+                                                                        \
+        if (map->count == cap) {                                        \
+            /* A full table is one cluster that wraps around, and misses scan all of it. */ \
+            stats->cluster_count = 1;                                   \
+            stats->avg_cluster = (F64)cap;                              \
+            stats->max_cluster = cap;                                   \
+            stats->avg_miss_probe = (F64)cap;                           \
+            return;                                                     \
+        }                                                               \
+                                                                        \
+        /* Starts right after an empty slot, so that no cluster wraps around the end. */ \
+        UZ empty = 0;                                                   \
+        while (map->meta[empty] & ERMIS_HASH_OCCUPIED) ++empty;         \
+                                                                        \
+        U64 miss_probes = 0;                                            \
+        UZ run = 0;                                                     \
+        for (UZ step = 1; step <= cap; ++step) {                        \
+            UZ i = (empty + step) % cap;                                \
+            if (map->meta[i] & ERMIS_HASH_OCCUPIED) {                   \
+                ++run;                                                  \
+                continue;                                               \
+            }                                                           \
+                                                                        \
+            /* A miss starting `j` slots into a run of `run` probes the rest of it and the empty slot. */ \
+            miss_probes += (U64)run * (run + 3) / 2 + 1;                \
+            if (run != 0) {                                             \
+                ++stats->cluster_count;                                 \
+                if (run > stats->max_cluster) stats->max_cluster = run; \
+            }                                                           \
+            run = 0;                                                    \
+        }                                                               \
+        if (stats->cluster_count != 0) stats->avg_cluster = (F64)map->count / (F64)stats->cluster_count; \
+        stats->avg_miss_probe = (F64)miss_probes / (F64)cap;            \
     }
 
+#define ERMIS_DECL_HASHMAP(K, V, hashmapname) _ERMIS_DECL_HASHMAP_GENERIC(K, V, hashmapname, HeliosAllocator, HeliosFree)
+#define ERMIS_IMPL_HASHMAP(K, V, hashmapname, eqfunc, hashfunc)         \
+    _ERMIS_IMPL_HASHMAP_GENERIC(K, V, hashmapname, eqfunc, hashfunc, HeliosAllocator, HeliosAllocUninit, HeliosAllocZeroed)
+
+#define ERMIS_DECL_HASHMAP_A(K, V, hashmapname, A) _ERMIS_DECL_HASHMAP_GENERIC(K, V, hashmapname, A *, A##Free)
+#define ERMIS_IMPL_HASHMAP_A(K, V, hashmapname, eqfunc, hashfunc, A)    \
+    _ERMIS_IMPL_HASHMAP_GENERIC(K, V, hashmapname, eqfunc, hashfunc, A *, A##Alloc, A##AllocZeroed)
+
 // Equality and hash functions
 
 HELIOS_INLINE B32 ErmisEqFuncU32(U32 lhs, U32 rhs) { return lhs == rhs; }
+// The identity, so keys with a common stride pile up in the same slots. `hashmapname##Stats` shows it.
 HELIOS_INLINE U64 ErmisHashFuncU32(U32 x) { return (U64)x; }
+
+HELIOS_INLINE B32 ErmisEqFuncU64(U64 lhs, U64 rhs) { return lhs == rhs; }
+HELIOS_INLINE U64 ErmisHashFuncU64(U64 x) { return x; }
+
+HELIOS_INLINE B32 ErmisEqFuncStringView(HeliosStringView lhs, HeliosStringView rhs) { return HeliosStringViewEqual(lhs, rhs); }
+HELIOS_INLINE U64 ErmisHashFuncStringView(HeliosStringView sv) { return HeliosStringViewHash(sv); }
+
+// Ordering functions
+
+HELIOS_INLINE B32 ErmisLessFuncU32(U32 lhs, U32 rhs) { return lhs < rhs; }
+HELIOS_INLINE B32 ErmisLessFuncU64(U64 lhs, U64 rhs) { return lhs < rhs; }
+
+// Bytewise, so a prefix orders before every string that starts with it.
+HELIOS_INLINE B32 ErmisLessFuncStringView(HeliosStringView lhs, HeliosStringView rhs) {
+    UZ count = HELIOS_MIN(lhs.count, rhs.count);
+    int cmp = count != 0 ? memcmp(lhs.data, rhs.data, count) : 0;
+    return cmp < 0 || (cmp == 0 && lhs.count < rhs.count);
+}
+
+// Filters
+//
+// Probabilistic set membership in front of a map or a static key set, for lookups that are mostly misses.
+// A filter never says no for a key it holds, and says yes for a small fraction of the keys it does not.
+// Filters run the key hash through `ErmisFilterMix` first, so the hash functions above work as they are,
+// the identity included.
+
+// The murmur3 finalizer, every output bit depends on every input bit.
+HELIOS_INLINE U64 ErmisFilterMix(U64 x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+// Blocked bloom filter: every key sets 8 bits within a single cache line, one per 64-bit word, so a
+// lookup costs one cache miss and the whole test fits in two AVX2 registers. At 10 bits per key the false
+// positive rate is about 1%, at 16 bits per key about 0.1%.
+
+#define ERMIS_BLOOM_BLOCK_WORDS 8
+#define ERMIS_BLOOM_BLOCK_BITS (ERMIS_BLOOM_BLOCK_WORDS * 64)
+#define ERMIS_BLOOM_DEFAULT_BITS_PER_KEY 10
+
+// Odd multipliers that turn 32 bits of hash into the bit index of each word.
+#define _ERMIS_BLOOM_SALTS 0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU, 0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+
+#if defined(HELIOS_ARCH_X86)
+HELIOS_DEF B32 _ErmisBloomBlockTestAVX2(const U64 *block, U32 hash);
+#endif // HELIOS_ARCH_X86
+
+// Whether the AVX2 paths of the bloom filters and the B+tree searches can run.
+HELIOS_INLINE B32 ErmisSimdAvailable(void) {
+#if defined(HELIOS_ARCH_X86)
+    return HeliosCpuHas(HeliosCpuFeature_AVX2);
+#else
+    return 0;
+#endif // HELIOS_ARCH_X86
+}
+
+// The high half of the hash picks the block, the low half the bits in it.
+HELIOS_INLINE UZ _ErmisBloomBlockIndex(U64 hash, UZ block_count) {
+    return (UZ)(((hash >> 32) * block_count) >> 32) * ERMIS_BLOOM_BLOCK_WORDS;
+}
+
+HELIOS_INLINE void _ErmisBloomBlockAdd(U64 *block, U32 hash) {
+    const U32 salts[ERMIS_BLOOM_BLOCK_WORDS] = {_ERMIS_BLOOM_SALTS};
+    for (UZ i = 0; i < ERMIS_BLOOM_BLOCK_WORDS; ++i) block[i] |= (U64)1 << ((hash * salts[i]) >> 26);
+}
+
+HELIOS_INLINE B32 _ErmisBloomBlockTest(const U64 *block, U32 hash, B32 simd) {
+#if defined(HELIOS_ARCH_X86)
+    if (simd) return _ErmisBloomBlockTestAVX2(block, hash);
+#else
+    HELIOS_UNUSED(simd);
+#endif // HELIOS_ARCH_X86
+
+    const U32 salts[ERMIS_BLOOM_BLOCK_WORDS] = {_ERMIS_BLOOM_SALTS};
+    for (UZ i = 0; i < ERMIS_BLOOM_BLOCK_WORDS; ++i) {
+        if ((block[i] & ((U64)1 << ((hash * salts[i]) >> 26))) == 0) return 0;
+    }
+    return 1;
+}
+
+// `blocks` points into `memory`, aligned to a cache line. `simd` is set by `Init` when AVX2 is available,
+// and can be cleared to force the scalar test.
+#define _ERMIS_DECL_BLOOM_GENERIC(K, bloomname, alloctype, freefunc) typedef struct bloomname { \
+        U64 *blocks;                                                    \
+        UZ block_count;                                                 \
+        B32 simd;                                                       \
+        void *memory;                                                   \
+        alloctype allocator;                                            \
+    } bloomname;                                                        \
+                                                                        \
+    /* Sized for `expected_count` keys at `bits_per_key`, ERMIS_BLOOM_DEFAULT_BITS_PER_KEY when 0. */ \
+    void bloomname##Init(bloomname *filter, alloctype allocator, UZ expected_count, UZ bits_per_key); \
+    void bloomname##Add(bloomname *filter, K key);                      \
+    B32 bloomname##MayContain(const bloomname *filter, K key);          \
+                                                                        \
+    HELIOS_INLINE void bloomname##Free(bloomname *filter) {             \
+        freefunc(filter->allocator, filter->memory, filter->block_count * ERMIS_BLOOM_BLOCK_WORDS * sizeof(U64) + 64); \
+    }
+
+#define _ERMIS_IMPL_BLOOM_GENERIC(K, bloomname, hashfunc, alloctype, alloczeroedfunc) \
+    void bloomname##Init(bloomname *filter, alloctype allocator, UZ expected_count, UZ bits_per_key) { \
+        if (bits_per_key == 0) bits_per_key = ERMIS_BLOOM_DEFAULT_BITS_PER_KEY; \
+        filter->allocator = allocator;                                  \
+        filter->block_count = HELIOS_MAX((expected_count * bits_per_key + ERMIS_BLOOM_BLOCK_BITS - 1) / ERMIS_BLOOM_BLOCK_BITS, 1); \
+        filter->simd = ErmisSimdAvailable();                            \
+        filter->memory = alloczeroedfunc(allocator, filter->block_count * ERMIS_BLOOM_BLOCK_WORDS * sizeof(U64) + 64); \
+        filter->blocks = (U64 *)HeliosRoundUp((UZ)filter->memory, 64);  \
+    }                                                                   \
+                                                                        \
+    void bloomname##Add(bloomname *filter, K key) {                     \
+        U64 hash = ErmisFilterMix(hashfunc(key));                       \
+        _ErmisBloomBlockAdd(filter->blocks + _ErmisBloomBlockIndex(hash, filter->block_count), (U32)hash); \
+    }                                                                   \
+                                                                        \
+    B32 bloomname##MayContain(const bloomname *filter, K key) {         \
+        U64 hash = ErmisFilterMix(hashfunc(key));                       \
+        return _ErmisBloomBlockTest(filter->blocks + _ErmisBloomBlockIndex(hash, filter->block_count), (U32)hash, filter->simd); \
+    }
+
+#define ERMIS_DECL_BLOOM(K, bloomname) _ERMIS_DECL_BLOOM_GENERIC(K, bloomname, HeliosAllocator, HeliosFree)
+#define ERMIS_IMPL_BLOOM(K, bloomname, hashfunc) _ERMIS_IMPL_BLOOM_GENERIC(K, bloomname, hashfunc, HeliosAllocator, HeliosAllocZeroed)
+
+#define ERMIS_DECL_BLOOM_A(K, bloomname, A) _ERMIS_DECL_BLOOM_GENERIC(K, bloomname, A *, A##Free)
+#define ERMIS_IMPL_BLOOM_A(K, bloomname, hashfunc, A) _ERMIS_IMPL_BLOOM_GENERIC(K, bloomname, hashfunc, A *, A##AllocZeroed)
+
+// Xor filter with 8-bit fingerprints, for key sets known up front: about 9.84 bits per key and a false
+// positive rate of 1/256, with three independent memory accesses per lookup. Built by peeling a random
+// 3-hypergraph, see "Xor Filters: Faster and Smaller Than Bloom and Cuckoo Filters" (Graf, Lemire).
+
+#define ERMIS_XOR_FILTER_MAX_ATTEMPTS 64
+
+// Bytes of scratch `_ErmisXorFilterPopulate` needs.
+#define _ERMIS_XOR_FILTER_SCRATCH_SIZE(count, segment_length) \
+    ((UZ)(segment_length) * 3 * (sizeof(U64) + 2 * sizeof(U32)) + (UZ)(count) * (sizeof(U64) + sizeof(U32)))
+
+// Fills `fingerprints` (3 * `segment_length` bytes, zeroed) for the keys with the given hashes, trying
+// seeds until the peeling succeeds. Duplicate hashes are removed from `key_hashes` if they get in the way.
+// Returns 0 when no seed worked out.
+HELIOS_DEF B32 _ErmisXorFilterPopulate(U64 *key_hashes, UZ count, U8 *fingerprints, U32 segment_length, U64 *out_seed, void *scratch);
+
+HELIOS_INLINE U32 _ErmisXorFilterReduce(U32 x, U32 n) {
+    return (U32)(((U64)x * n) >> 32);
+}
+
+HELIOS_INLINE void _ErmisXorFilterSlots(U64 hash, U32 segment_length, U32 slots[3]) {
+    slots[0] = _ErmisXorFilterReduce((U32)hash, segment_length);
+    slots[1] = _ErmisXorFilterReduce((U32)((hash << 21) | (hash >> 43)), segment_length) + segment_length;
+    slots[2] = _ErmisXorFilterReduce((U32)((hash << 42) | (hash >> 22)), segment_length) + 2 * segment_length;
+}
+
+HELIOS_INLINE U8 _ErmisXorFilterFingerprint(U64 hash) {
+    return (U8)(hash ^ (hash >> 32));
+}
+
+HELIOS_INLINE B32 _ErmisXorFilterContains(const U8 *fingerprints, U32 segment_length, U64 hash) {
+    U32 slots[3];
+    _ErmisXorFilterSlots(hash, segment_length, slots);
+    return _ErmisXorFilterFingerprint(hash) == (fingerprints[slots[0]] ^ fingerprints[slots[1]] ^ fingerprints[slots[2]]);
+}
+
+#define _ERMIS_DECL_XORFILTER_GENERIC(K, xorname, alloctype, freefunc) typedef struct xorname { \
+        U8 *fingerprints;                                               \
+        U32 segment_length;                                             \
+        U64 seed;                                                       \
+        alloctype allocator;                                            \
+    } xorname;                                                          \
+                                                                        \
+    /* Returns 0 if the filter could not be built, which takes distinct keys hashing to the same value. */ \
+    /* `Free` has to be called either way. */                           \
+    B32 xorname##Build(xorname *filter, alloctype allocator, const K *keys, UZ count); \
+    B32 xorname##MayContain(const xorname *filter, K key);              \
+                                                                        \
+    HELIOS_INLINE void xorname##Free(xorname *filter) {                 \
+        freefunc(filter->allocator, filter->fingerprints, (UZ)filter->segment_length * 3); \
+    }
+
+#define _ERMIS_IMPL_XORFILTER_GENERIC(K, xorname, hashfunc, alloctype, allocfunc, alloczeroedfunc, freefunc) \
+    B32 xorname##Build(xorname *filter, alloctype allocator, const K *keys, UZ count) { \
+        filter->allocator = allocator;                                  \
+        filter->segment_length = (U32)((32 + (count * 123 + 99) / 100) / 3); \
+        filter->seed = 0;                                               \
+        filter->fingerprints = (U8 *)alloczeroedfunc(allocator, (UZ)filter->segment_length * 3); \
+                                                                        \
+        UZ temp_size = sizeof(U64) * count + _ERMIS_XOR_FILTER_SCRATCH_SIZE(count, filter->segment_length); \
+        U64 *key_hashes = (U64 *)allocfunc(allocator, temp_size);       \
+        for (UZ i = 0; i < count; ++i) key_hashes[i] = hashfunc(keys[i]); \
+                                                                        \
+        B32 built = _ErmisXorFilterPopulate(key_hashes, count, filter->fingerprints, filter->segment_length, \
+                                            &filter->seed, key_hashes + count); \
+        freefunc(allocator, key_hashes, temp_size);                     \
+        return built;                                                   \
+    }                                                                   \
+                                                                        \
+    B32 xorname##MayContain(const xorname *filter, K key) {             \
+        U64 hash = ErmisFilterMix(hashfunc(key) + filter->seed);        \
+        return _ErmisXorFilterContains(filter->fingerprints, filter->segment_length, hash); \
+    }
+
+#define ERMIS_DECL_XORFILTER(K, xorname) _ERMIS_DECL_XORFILTER_GENERIC(K, xorname, HeliosAllocator, HeliosFree)
+#define ERMIS_IMPL_XORFILTER(K, xorname, hashfunc)                      \
+    _ERMIS_IMPL_XORFILTER_GENERIC(K, xorname, hashfunc, HeliosAllocator, HeliosAllocUninit, HeliosAllocZeroed, HeliosFree)
+
+#define ERMIS_DECL_XORFILTER_A(K, xorname, A) _ERMIS_DECL_XORFILTER_GENERIC(K, xorname, A *, A##Free)
+#define ERMIS_IMPL_XORFILTER_A(K, xorname, hashfunc, A)                 \
+    _ERMIS_IMPL_XORFILTER_GENERIC(K, xorname, hashfunc, A *, A##Alloc, A##AllocZeroed, A##Free)
+
+// B+tree: an ordered map for range scans. Every node holds ERMIS_BTREE_NODE_KEY_BYTES worth of keys, four
+// cache lines, which is 64 U32 or 32 U64 keys and keeps trees of millions of keys four or five levels
+// deep. Values only live in the leaves, which are linked both ways for iteration in key order.
+//
+// Nodes come from two `HeliosPoolAllocator`s embedded in the tree, one per node size, so there is no `_A`
+// variant, and `Free` releases whole slabs instead of walking the tree.
+//
+// Within a node, keys are found by `searchfunc(const K *keys, UZ count, K key, B32 simd)`, which returns
+// the number of keys ordered before `key`. `ERMIS_IMPL_BTREE` generates a binary search over `lessfunc`,
+// `ERMIS_IMPL_BTREE_SEARCH` takes the search, like `ErmisBTreeSearchU32` and `ErmisBTreeSearchU64`, which
+// scan the node with AVX2 while the tree's `simd` flag is set. A range or prefix scan starts at
+// `LowerBound` and walks the leaves:
+//
+//     for (TreeIter it = TreeLowerBound(&tree, lo); TreeIterValid(&it) && TreeIterKey(&it) < hi; TreeIterNext(&it))
+
+#define ERMIS_BTREE_NODE_KEY_BYTES 256
+#define ERMIS_BTREE_SLAB_SIZE (1024 * 64)
+#define ERMIS_BTREE_MAX_HEIGHT 32
+
+// Keys per node, at least 8 however big the keys are.
+#define ERMIS_BTREE_CAPACITY(K) (ERMIS_BTREE_NODE_KEY_BYTES / sizeof(K) > 8 ? ERMIS_BTREE_NODE_KEY_BYTES / sizeof(K) : 8)
+
+#if defined(HELIOS_ARCH_X86)
+HELIOS_DEF UZ _ErmisBTreeSearchU32AVX2(const U32 *keys, UZ count, U32 key);
+HELIOS_DEF UZ _ErmisBTreeSearchU64AVX2(const U64 *keys, UZ count, U64 key);
+#endif // HELIOS_ARCH_X86
+
+// For the keys of tree nodes only: the AVX2 path compares all ERMIS_BTREE_CAPACITY slots, counting on the
+// tree to keep the ones past `count` all ones. It has the shorter latency, and reads the node with a few
+// independent loads rather than a chain of dependent ones, so it wins once nodes miss the cache. The
+// scalar path is a branchless binary search, whose loop runs log2(count) times whatever the keys are.
+HELIOS_INLINE UZ ErmisBTreeSearchU32(const U32 *keys, UZ count, U32 key, B32 simd) {
+#if defined(HELIOS_ARCH_X86)
+    if (simd) return _ErmisBTreeSearchU32AVX2(keys, count, key);
+#else
+    HELIOS_UNUSED(simd);
+#endif // HELIOS_ARCH_X86
+
+    if (count == 0) return 0;
+    const U32 *base = keys;
+    while (count > 1) {
+        UZ half = count / 2;
+        base = base[half] < key ? base + half : base;
+        count -= half;
+    }
+    return (UZ)(base - keys) + (*base < key);
+}
+
+HELIOS_INLINE UZ ErmisBTreeSearchU64(const U64 *keys, UZ count, U64 key, B32 simd) {
+#if defined(HELIOS_ARCH_X86)
+    if (simd) return _ErmisBTreeSearchU64AVX2(keys, count, key);
+#else
+    HELIOS_UNUSED(simd);
+#endif // HELIOS_ARCH_X86
+
+    if (count == 0) return 0;
+    const U64 *base = keys;
+    while (count > 1) {
+        UZ half = count / 2;
+        base = base[half] < key ? base + half : base;
+        count -= half;
+    }
+    return (UZ)(base - keys) + (*base < key);
+}
+
+#define ERMIS_DECL_BTREE(K, V, treename) typedef struct treename##Leaf { \
+        U32 count;                                                      \
+        K keys[ERMIS_BTREE_CAPACITY(K)];                                \
+        V values[ERMIS_BTREE_CAPACITY(K)];                              \
+        struct treename##Leaf *next;                                    \
+        struct treename##Leaf *prev;                                    \
+    } treename##Leaf;                                                   \
+                                                                        \
+    /* `keys[i]` is the least key under `children[i + 1]`. */           \
+    typedef struct treename##Inner {                                    \
+        U32 count;                                                      \
+        K keys[ERMIS_BTREE_CAPACITY(K)];                                \
+        void *children[ERMIS_BTREE_CAPACITY(K) + 1];                    \
+    } treename##Inner;                                                  \
+                                                                        \
+    typedef struct treename {                                           \
+        void *root;                                                     \
+        treename##Leaf *first;                                          \
+        treename##Leaf *last;                                           \
+        UZ count;                                                       \
+        /* Levels of inner nodes above the leaves. */                   \
+        U32 height;                                                     \
+        B32 simd;                                                       \
+        HeliosPoolAllocator leaf_pool;                                  \
+        HeliosPoolAllocator inner_pool;                                 \
+    } treename;                                                         \
+                                                                        \
+    /* A position in the leaves, past either end when `leaf` is NULL. */ \
+    typedef struct treename##Iter {                                     \
+        treename##Leaf *leaf;                                           \
+        UZ index;                                                       \
+    } treename##Iter;                                                   \
+                                                                        \
+    void treename##Init(treename *tree);                                \
+    /* Fills an empty tree from `count` strictly ascending keys, spreading them evenly over full nodes. */ \
+    void treename##BulkLoad(treename *tree, const K *keys, const V *values, UZ count); \
+    B32 treename##Insert(treename *tree, K key, V value);               \
+    V *treename##FindPtr(treename *tree, K key);                        \
+    /* The first key that is not ordered before `key`. */               \
+    treename##Iter treename##LowerBound(treename *tree, K key);         \
+                                                                        \
+    HELIOS_INLINE B32 treename##Find(treename *tree, K key, V *value) { \
+        V *found_ptr = treename##FindPtr(tree, key);                    \
+        if (found_ptr == NULL) {                                        \
+            return 0;                                                   \
+        } else {                                                        \
+            *value = *found_ptr;                                        \
+            return 1;                                                   \
+        }                                                               \
+    }                                                                   \
+                                                                        \
+    HELIOS_INLINE treename##Iter treename##First(treename *tree) {      \
+        treename##Iter it = {tree->first, 0};                           \
+        return it;                                                      \
+    }                                                                   \
+                                                                        \
+    HELIOS_INLINE treename##Iter treename##Last(treename *tree) {       \
+        treename##Iter it = {tree->last, tree->last != NULL ? tree->last->count - 1 : 0}; \
+        return it;                                                      \
+    }                                                                   \
+                                                                        \
+    HELIOS_INLINE B32 treename##IterValid(const treename##Iter *it) {   \
+        return it->leaf != NULL;                                        \
+    }                                                                   \
+                                                                        \
+    HELIOS_INLINE K treename##IterKey(const treename##Iter *it) {       \
+        return it->leaf->keys[it->index];                               \
+    }                                                                   \
+                                                                        \
+    HELIOS_INLINE V *treename##IterValue(const treename##Iter *it) {    \
+        return &it->leaf->values[it->index];                            \
+    }                                                                   \
+                                                                        \
+    HELIOS_INLINE void treename##IterNext(treename##Iter *it) {         \
+        if (++it->index == it->leaf->count) {                           \
+            it->leaf = it->leaf->next;                                  \
+            it->index = 0;                                              \
+        }                                                               \
+    }                                                                   \
+                                                                        \
+    HELIOS_INLINE void treename##IterPrev(treename##Iter *it) {         \
+        if (it->index-- == 0) {                                         \
+            it->leaf = it->leaf->prev;                                  \
+            it->index = it->leaf != NULL ? it->leaf->count - 1 : 0;     \
+        }                                                               \
+    }                                                                   \
+                                                                        \
+    HELIOS_INLINE void treename##Free(treename *tree) {                 \
+        HeliosPoolAllocatorDestroy(&tree->leaf_pool);                   \
+        HeliosPoolAllocatorDestroy(&tree->inner_pool);                  \
+    }
+
+#define _ERMIS_BTREE_BINARY_SEARCH(K, treename, lessfunc)               \
+    HELIOS_INTERNAL UZ treename##BinarySearch(const K *keys, UZ count, K key, B32 simd) { \
+        HELIOS_UNUSED(simd);                                            \
+        if (count == 0) return 0;                                       \
+        const K *base = keys;                                           \
+        while (count > 1) {                                             \
+            UZ half = count / 2;                                        \
+            if (lessfunc(base[half], key)) base += half;                \
+            count -= half;                                              \
+        }                                                               \
+        return (UZ)(base - keys) + (lessfunc(*base, key) ? 1 : 0);      \
+    }
+
+#define _ERMIS_IMPL_BTREE_GENERIC(K, V, treename, lessfunc, searchfunc) \
+    /* Unused key slots are kept all ones, for the searches that compare whole nodes. */ \
+    HELIOS_INTERNAL void treename##ClearKeys(K *keys, UZ from) {        \
+        memset(keys + from, 0xFF, sizeof(K) * (ERMIS_BTREE_CAPACITY(K) - from)); \
+    }                                                                   \
+                                                                        \
+    HELIOS_INTERNAL treename##Leaf *treename##NewLeaf(treename *tree) { \
+        treename##Leaf *leaf = (treename##Leaf *)HeliosPoolAlloc(&tree->leaf_pool); \
+        treename##ClearKeys(leaf->keys, 0);                             \
+        leaf->count = 0;                                                \
+        leaf->next = NULL;                                              \
+        leaf->prev = NULL;                                              \
+        return leaf;                                                    \
+    }                                                                   \
+                                                                        \
+    HELIOS_INTERNAL treename##Inner *treename##NewInner(treename *tree) { \
+        treename##Inner *inner = (treename##Inner *)HeliosPoolAlloc(&tree->inner_pool); \
+        treename##ClearKeys(inner->keys, 0);                            \
+        inner->count = 0;                                               \
+        return inner;                                                   \
+    }                                                                   \
+                                                                        \
+    /* Keys equal to a separator live to the right of it. */            \
+    HELIOS_INTERNAL UZ treename##ChildIndex(const treename *tree, const treename##Inner *inner, K key) { \
+        UZ idx = searchfunc(inner->keys, inner->count, key, tree->simd); \
+        if (idx < inner->count && !(lessfunc(key, inner->keys[idx]))) ++idx; \
+        return idx;                                                     \
+    }                                                                   \
+                                                                        \
+    HELIOS_INTERNAL treename##Leaf *treename##FindLeaf(const treename *tree, K key) { \
+        void *node = tree->root;                                        \
+        for (U32 level = tree->height; level > 0; --level) {            \
+            treename##Inner *inner = (treename##Inner *)node;           \
+            node = inner->children[treename##ChildIndex(tree, inner, key)]; \
+        }                                                               \
+        return (treename##Leaf *)node;                                  \
+    }                                                                   \
+                                                                        \
+    HELIOS_INTERNAL K treename##LeastKey(void *node, U32 level) {       \
+        for (; level > 0; --level) node = ((treename##Inner *)node)->children[0]; \
+        return ((treename##Leaf *)node)->keys[0];                       \
+    }                                                                   \
+                                                                        \
+    HELIOS_INTERNAL void treename##LeafInsertAt(treename##Leaf *leaf, UZ idx, K key, V value) { \
+        memmove(leaf->keys + idx + 1, leaf->keys + idx, sizeof(K) * (leaf->count - idx)); \
+        memmove(leaf->values + idx + 1, leaf->values + idx, sizeof(V) * (leaf->count - idx)); \
+        leaf->keys[idx] = key;                                          \
+        leaf->values[idx] = value;                                      \
+        ++leaf->count;                                                  \
+    }                                                                   \
+                                                                        \
+    void treename##Init(treename *tree) {                               \
+        tree->root = NULL;                                              \
+        tree->first = NULL;                                             \
+        tree->last = NULL;                                              \
+        tree->count = 0;                                                \
+        tree->height = 0;                                               \
+        tree->simd = ErmisSimdAvailable();                              \
+        HeliosPoolAllocatorInit(&tree->leaf_pool, sizeof(treename##Leaf), ERMIS_BTREE_SLAB_SIZE); \
+        HeliosPoolAllocatorInit(&tree->inner_pool, sizeof(treename##Inner), ERMIS_BTREE_SLAB_SIZE); \
+    }                                                                   \
+                                                                        \
+    void treename##BulkLoad(treename *tree, const K *keys, const V *values, UZ count) { \
+        HELIOS_VERIFY(tree->root == NULL);                              \
+        if (count == 0) return;                                         \
+                                                                        \
+        const UZ capacity = ERMIS_BTREE_CAPACITY(K);                    \
+        UZ node_count = (count + capacity - 1) / capacity;              \
+        UZ nodes_size = sizeof(void *) * node_count;                    \
+        void **nodes = (void **)HeliosAllocUninit(HeliosNewMallocAllocator(), nodes_size); \
+                                                                        \
+        UZ begin = 0;                                                   \
+        for (UZ i = 0; i < node_count; ++i) {                           \
+            UZ end = count * (i + 1) / node_count;                      \
+            treename##Leaf *leaf = treename##NewLeaf(tree);             \
+            leaf->count = (U32)(end - begin);                           \
+            for (UZ j = begin; j < end; ++j) {                          \
+                HELIOS_VERIFY(j == 0 || lessfunc(keys[j - 1], keys[j])); \
+                leaf->keys[j - begin] = keys[j];                        \
+                leaf->values[j - begin] = values[j];                    \
+            }                                                           \
+                                                                        \
+            leaf->prev = tree->last;                                    \
+            if (tree->last != NULL) tree->last->next = leaf;            \
+            else tree->first = leaf;                                    \
+            tree->last = leaf;                                          \
+            nodes[i] = leaf;                                            \
+            begin = end;                                                \
+        }                                                               \
+        tree->count = count;                                            \
+                                                                        \
+        /* Every level groups the nodes of the one below, and is written over it. A group never starts */ \
+        /* before the slot its parent goes into. */                     \
+        while (node_count > 1) {                                        \
+            UZ parent_count = (node_count + capacity) / (capacity + 1); \
+            begin = 0;                                                  \
+            for (UZ i = 0; i < parent_count; ++i) {                     \
+                UZ end = node_count * (i + 1) / parent_count;           \
+                treename##Inner *inner = treename##NewInner(tree);      \
+                inner->count = (U32)(end - begin - 1);                  \
+                for (UZ j = begin; j < end; ++j) {                      \
+                    inner->children[j - begin] = nodes[j];              \
+                    if (j != begin) inner->keys[j - begin - 1] = treename##LeastKey(nodes[j], tree->height); \
+                }                                                       \
+                nodes[i] = inner;                                       \
+                begin = end;                                            \
+            }                                                           \
+            node_count = parent_count;                                  \
+            ++tree->height;                                             \
+        }                                                               \
+                                                                        \
+        tree->root = nodes[0];                                          \
+        HeliosFree(HeliosNewMallocAllocator(), nodes, nodes_size);      \
+    }                                                                   \
+                                                                        \
+    /* A node that overflows at its end splits off only the new key, so that ascending keys, like time */ \
+    /* series, leave full nodes behind instead of half empty ones. */   \
+    B32 treename##Insert(treename *tree, K key, V value) {              \
+        const UZ capacity = ERMIS_BTREE_CAPACITY(K);                    \
+        if (tree->root == NULL) {                                       \
+            tree->first = tree->last = treename##NewLeaf(tree);         \
+            tree->root = tree->first;                                   \
+        }                                                               \
+                                                                        \
+        treename##Inner *path[ERMIS_BTREE_MAX_HEIGHT];                  \
+        UZ slots[ERMIS_BTREE_MAX_HEIGHT];                               \
+        void *node = tree->root;                                        \
+        for (U32 depth = 0; depth < tree->height; ++depth) {            \
+            path[depth] = (treename##Inner *)node;                      \
+            slots[depth] = treename##ChildIndex(tree, path[depth], key); \
+            node = path[depth]->children[slots[depth]];                 \
+        }                                                               \
+                                                                        \
+        treename##Leaf *leaf = (treename##Leaf *)node;                  \
+        UZ pos = searchfunc(leaf->keys, leaf->count, key, tree->simd);  \
+        if (pos < leaf->count && !(lessfunc(key, leaf->keys[pos]))) {   \
+            leaf->values[pos] = value;                                  \
+            return 0;                                                   \
+        }                                                               \
+                                                                        \
+        ++tree->count;                                                  \
+        if (leaf->count < capacity) {                                   \
+            treename##LeafInsertAt(leaf, pos, key, value);              \
+            return 1;                                                   \
+        }                                                               \
+                                                                        \
+        HELIOS_PROFILE_BEGIN(#treename "Split");                        \
+        UZ split = pos == capacity ? capacity : capacity / 2;           \
+        treename##Leaf *right = treename##NewLeaf(tree);                \
+        right->count = (U32)(capacity - split);                         \
+        memcpy(right->keys, leaf->keys + split, sizeof(K) * right->count); \
+        memcpy(right->values, leaf->values + split, sizeof(V) * right->count); \
+        leaf->count = (U32)split;                                       \
+        treename##ClearKeys(leaf->keys, split);                         \
+        if (pos < split) treename##LeafInsertAt(leaf, pos, key, value); \
+        else treename##LeafInsertAt(right, pos - split, key, value);    \
+                                                                        \
+        right->prev = leaf;                                             \
+        right->next = leaf->next;                                       \
+        if (leaf->next != NULL) leaf->next->prev = right;               \
+        else tree->last = right;                                        \
+        leaf->next = right;                                             \
+                                                                        \
+        K separator = right->keys[0];                                   \
+        void *child = right;                                            \
+        for (U32 depth = tree->height; depth-- > 0;) {                  \
+            treename##Inner *inner = path[depth];                       \
+            UZ idx = slots[depth];                                      \
+            if (inner->count < capacity) {                              \
+                memmove(inner->keys + idx + 1, inner->keys + idx, sizeof(K) * (inner->count - idx)); \
+                memmove(inner->children + idx + 2, inner->children + idx + 1, sizeof(void *) * (inner->count - idx)); \
+                inner->keys[idx] = separator;                           \
+                inner->children[idx + 1] = child;                       \
+                ++inner->count;                                         \
+                HELIOS_PROFILE_END(#treename "Split");                  \
+                return 1;                                               \
+            }                                                           \
+                                                                        \
+            /* Lay out the overflowing node in full, then split it around a key that moves up. */ \
+            K split_keys[ERMIS_BTREE_CAPACITY(K) + 1];                  \
+            void *split_children[ERMIS_BTREE_CAPACITY(K) + 2];          \
+            memcpy(split_keys, inner->keys, sizeof(K) * idx);           \
+            split_keys[idx] = separator;                                \
+            memcpy(split_keys + idx + 1, inner->keys + idx, sizeof(K) * (capacity - idx)); \
+            memcpy(split_children, inner->children, sizeof(void *) * (idx + 1)); \
+            split_children[idx + 1] = child;                            \
+            memcpy(split_children + idx + 2, inner->children + idx + 1, sizeof(void *) * (capacity - idx)); \
+                                                                        \
+            UZ mid = idx == capacity ? capacity : capacity / 2;         \
+            treename##Inner *sibling = treename##NewInner(tree);        \
+            inner->count = (U32)mid;                                    \
+            memcpy(inner->keys, split_keys, sizeof(K) * mid);           \
+            treename##ClearKeys(inner->keys, mid);                      \
+            memcpy(inner->children, split_children, sizeof(void *) * (mid + 1)); \
+            sibling->count = (U32)(capacity - mid);                     \
+            memcpy(sibling->keys, split_keys + mid + 1, sizeof(K) * sibling->count); \
+            memcpy(sibling->children, split_children + mid + 1, sizeof(void *) * (sibling->count + 1)); \
+            separator = split_keys[mid];                                \
+            child = sibling;                                            \
+        }                                                               \
+                                                                        \
+        HELIOS_VERIFY(tree->height < ERMIS_BTREE_MAX_HEIGHT);           \
+        treename##Inner *root = treename##NewInner(tree);               \
+        root->count = 1;                                                \
+        root->keys[0] = separator;                                      \
+        root->children[0] = tree->root;                                 \
+        root->children[1] = child;                                      \
+        tree->root = root;                                              \
+        ++tree->height;                                                 \
+        HELIOS_PROFILE_END(#treename "Split");                          \
+        return 1;                                                       \
+    }                                                                   \
+                                                                        \
+    V *treename##FindPtr(treename *tree, K key) {                       \
+        if (tree->root == NULL) return NULL;                            \
+        treename##Leaf *leaf = treename##FindLeaf(tree, key);           \
+        UZ idx = searchfunc(leaf->keys, leaf->count, key, tree->simd);  \
+        if (idx < leaf->count && !(lessfunc(key, leaf->keys[idx]))) return &leaf->values[idx]; \
+        return NULL;                                                    \
+    }                                                                   \
+                                                                        \
+    treename##Iter treename##LowerBound(treename *tree, K key) {        \
+        treename##Iter it = {NULL, 0};                                  \
+        if (tree->root == NULL) return it;                              \
+        it.leaf = treename##FindLeaf(tree, key);                        \
+        it.index = searchfunc(it.leaf->keys, it.leaf->count, key, tree->simd); \
+        /* Past the last key of this leaf, the least key of the next one is the separator that led here. */ \
+        if (it.index == it.leaf->count) {                               \
+            it.leaf = it.leaf->next;                                    \
+            it.index = 0;                                               \
+        }                                                               \
+        return it;                                                      \
+    }
+
+#define ERMIS_IMPL_BTREE(K, V, treename, lessfunc)                      \
+    _ERMIS_BTREE_BINARY_SEARCH(K, treename, lessfunc)                   \
+    _ERMIS_IMPL_BTREE_GENERIC(K, V, treename, lessfunc, treename##BinarySearch)
+#define ERMIS_IMPL_BTREE_SEARCH(K, V, treename, lessfunc, searchfunc)   \
+    _ERMIS_IMPL_BTREE_GENERIC(K, V, treename, lessfunc, searchfunc)
+
+// Bitsets: bit `i` is bit `i % 64` of word `i / 64`. The fixed size bitsets from ERMIS_DECL_BITSET and the
+// dynamic `ErmisBitset` share the word array routines below, whose bulk operations and counting run on
+// AVX2 where available.
+//
+// Rank and select go through a directory with the count of set bits before every block of 8 words, a
+// cache line. A rank then takes at most 7 word counts, a select a binary search over the directory and
+// at most 8. The directory is built on request and goes stale with any change to the bits.
+
+#define ERMIS_BITS_WORDS(bits) (((bits) + 63) / 64)
+#define ERMIS_BITS_RANK_BLOCK_WORDS 8
+// Entries of the rank directory for `word_count` words, the last one is the count of all set bits.
+#define ERMIS_BITS_RANK_ENTRIES(word_count) (((word_count) + ERMIS_BITS_RANK_BLOCK_WORDS - 1) / ERMIS_BITS_RANK_BLOCK_WORDS + 1)
+
+// Visits the set bits in ascending order. `break` only leaves the current word.
+#define ERMIS_BITS_FOREACH(words, word_count, idxname, body)            \
+    for (UZ _word = 0; _word < (word_count); ++_word) {                 \
+        for (U64 _bits = (words)[_word]; _bits != 0; _bits &= _bits - 1) { \
+            UZ idxname = _word * 64 + HeliosCountTrailingZerosU64(_bits); \
+            body;                                                       \
+        }                                                               \
+    }
+
+typedef enum ErmisBitsOp {
+    ErmisBitsOp_And,
+    ErmisBitsOp_Or,
+    ErmisBitsOp_Xor,
+    // Clears the bits that are set in `src`.
+    ErmisBitsOp_AndNot,
+} ErmisBitsOp;
+
+// `dst = dst op src` for every word.
+HELIOS_DEF void ErmisBitsApply(U64 *dst, const U64 *src, UZ word_count, ErmisBitsOp op);
+HELIOS_DEF UZ ErmisBitsCount(const U64 *words, UZ word_count);
+// Fills `rank` with ERMIS_BITS_RANK_ENTRIES(word_count) entries.
+HELIOS_DEF void ErmisBitsBuildRank(const U64 *words, UZ word_count, U64 *rank);
+// The position of the set bit with `k` set bits before it, `word_count * 64` when there are not that many.
+HELIOS_DEF UZ ErmisBitsSelect(const U64 *words, UZ word_count, const U64 *rank, UZ k);
+
+// The first set bit at or after `from`, `word_count * 64` when there is none.
+HELIOS_INLINE UZ ErmisBitsNext(const U64 *words, UZ word_count, UZ from) {
+    UZ word = from / 64;
+    if (word >= word_count) return word_count * 64;
+
+    U64 bits = words[word] & (~(U64)0 << (from % 64));
+    while (bits == 0) {
+        if (++word == word_count) return word_count * 64;
+        bits = words[word];
+    }
+    return word * 64 + HeliosCountTrailingZerosU64(bits);
+}
+
+// The count of set bits before bit `i`, which can be one past the last bit.
+HELIOS_INLINE UZ ErmisBitsRank(const U64 *words, const U64 *rank, UZ i) {
+    UZ word = i / 64;
+    UZ result = (UZ)rank[word / ERMIS_BITS_RANK_BLOCK_WORDS];
+    for (UZ w = word - word % ERMIS_BITS_RANK_BLOCK_WORDS; w < word; ++w) result += HeliosPopCountU64(words[w]);
+    if (i % 64 != 0) result += HeliosPopCountU64(words[word] & (((U64)1 << (i % 64)) - 1));
+    return result;
+}
+
+// A fixed size bitset, with the words and the rank directory inline and nothing to allocate or free.
+#define ERMIS_DECL_BITSET(bitsetname, bits) typedef struct bitsetname { \
+        U64 words[ERMIS_BITS_WORDS(bits)];                              \
+        U64 rank[ERMIS_BITS_RANK_ENTRIES(ERMIS_BITS_WORDS(bits))];      \
+    } bitsetname;                                                       \
+                                                                        \
+    HELIOS_INLINE void bitsetname##ClearAll(bitsetname *set) {          \
+        memset(set->words, 0, sizeof(set->words));                      \
+    }                                                                   \
+                                                                        \
+    HELIOS_INLINE void bitsetname##Set(bitsetname *set, UZ i) {         \
+        HELIOS_ASSERT(i < (bits));                                      \
+        set->words[i / 64] |= (U64)1 << (i % 64);                       \
+    }                                                                   \
+                                                                        \
+    HELIOS_INLINE void bitsetname##Clear(bitsetname *set, UZ i) {       \
+        HELIOS_ASSERT(i < (bits));                                      \
+        set->words[i / 64] &= ~((U64)1 << (i % 64));                    \
+    }                                                                   \
+                                                                        \
+    HELIOS_INLINE B32 bitsetname##Test(const bitsetname *set, UZ i) {   \
+        HELIOS_ASSERT(i < (bits));                                      \
+        return (set->words[i / 64] >> (i % 64)) & 1;                    \
+    }                                                                   \
+                                                                        \
+    HELIOS_INLINE void bitsetname##And(bitsetname *dst, const bitsetname *src) { \
+        ErmisBitsApply(dst->words, src->words, ERMIS_BITS_WORDS(bits), ErmisBitsOp_And); \
+    }                                                                   \
+                                                                        \
+    HELIOS_INLINE void bitsetname##Or(bitsetname *dst, const bitsetname *src) { \
+        ErmisBitsApply(dst->words, src->words, ERMIS_BITS_WORDS(bits), ErmisBitsOp_Or); \
+    }                                                                   \
+                                                                        \
+    HELIOS_INLINE void bitsetname##Xor(bitsetname *dst, const bitsetname *src) { \
+        ErmisBitsApply(dst->words, src->words, ERMIS_BITS_WORDS(bits), ErmisBitsOp_Xor); \
+    }                                                                   \
+                                                                        \
+    HELIOS_INLINE void bitsetname##AndNot(bitsetname *dst, const bitsetname *src) { \
+        ErmisBitsApply(dst->words, src->words, ERMIS_BITS_WORDS(bits), ErmisBitsOp_AndNot); \
+    }                                                                   \
+                                                                        \
+    HELIOS_INLINE UZ bitsetname##Count(const bitsetname *set) {         \
+        return ErmisBitsCount(set->words, ERMIS_BITS_WORDS(bits));      \
+    }                                                                   \
+                                                                        \
+    /* The first set bit at or after `from`, `bits` when there is none. */ \
+    HELIOS_INLINE UZ bitsetname##Next(const bitsetname *set, UZ from) { \
+        return HELIOS_MIN(ErmisBitsNext(set->words, ERMIS_BITS_WORDS(bits), from), (UZ)(bits)); \
+    }                                                                   \
+                                                                        \
+    HELIOS_INLINE void bitsetname##BuildRank(bitsetname *set) {         \
+        ErmisBitsBuildRank(set->words, ERMIS_BITS_WORDS(bits), set->rank); \
+    }                                                                   \
+                                                                        \
+    HELIOS_INLINE UZ bitsetname##Rank(const bitsetname *set, UZ i) {    \
+        HELIOS_ASSERT(i <= (bits));                                     \
+        return ErmisBitsRank(set->words, set->rank, i);                 \
+    }                                                                   \
+                                                                        \
+    HELIOS_INLINE UZ bitsetname##Select(const bitsetname *set, UZ k) {  \
+        return HELIOS_MIN(ErmisBitsSelect(set->words, ERMIS_BITS_WORDS(bits), set->rank, k), (UZ)(bits)); \
+    }
+
+// A bitset sized at runtime. The bits past `bit_count` in the last word are always clear.
+typedef struct ErmisBitset {
+    U64 *words;
+    UZ bit_count;
+    // NULL until `ErmisBitsetBuildRank`.
+    U64 *rank;
+    HeliosAllocator allocator;
+} ErmisBitset;
+
+HELIOS_DEF void ErmisBitsetInit(ErmisBitset *set, HeliosAllocator allocator, UZ bit_count);
+// New bits are clear. Drops the rank directory.
+HELIOS_DEF void ErmisBitsetResize(ErmisBitset *set, UZ bit_count);
+HELIOS_DEF void ErmisBitsetFree(ErmisBitset *set);
+HELIOS_DEF void ErmisBitsetBuildRank(ErmisBitset *set);
+
+HELIOS_INLINE UZ ErmisBitsetWordCount(const ErmisBitset *set) {
+    return ERMIS_BITS_WORDS(set->bit_count);
+}
+
+HELIOS_INLINE void ErmisBitsetClearAll(ErmisBitset *set) {
+    memset(set->words, 0, sizeof(U64) * ErmisBitsetWordCount(set));
+}
+
+HELIOS_INLINE void ErmisBitsetSet(ErmisBitset *set, UZ i) {
+    HELIOS_ASSERT(i < set->bit_count);
+    set->words[i / 64] |= (U64)1 << (i % 64);
+}
+
+HELIOS_INLINE void ErmisBitsetClear(ErmisBitset *set, UZ i) {
+    HELIOS_ASSERT(i < set->bit_count);
+    set->words[i / 64] &= ~((U64)1 << (i % 64));
+}
+
+HELIOS_INLINE B32 ErmisBitsetTest(const ErmisBitset *set, UZ i) {
+    HELIOS_ASSERT(i < set->bit_count);
+    return (set->words[i / 64] >> (i % 64)) & 1;
+}
+
+// Both sets have to be the same size.
+HELIOS_INLINE void ErmisBitsetApply(ErmisBitset *dst, const ErmisBitset *src, ErmisBitsOp op) {
+    HELIOS_VERIFY(dst->bit_count == src->bit_count);
+    ErmisBitsApply(dst->words, src->words, ErmisBitsetWordCount(dst), op);
+}
+
+HELIOS_INLINE void ErmisBitsetAnd(ErmisBitset *dst, const ErmisBitset *src) { ErmisBitsetApply(dst, src, ErmisBitsOp_And); }
+HELIOS_INLINE void ErmisBitsetOr(ErmisBitset *dst, const ErmisBitset *src) { ErmisBitsetApply(dst, src, ErmisBitsOp_Or); }
+HELIOS_INLINE void ErmisBitsetXor(ErmisBitset *dst, const ErmisBitset *src) { ErmisBitsetApply(dst, src, ErmisBitsOp_Xor); }
+HELIOS_INLINE void ErmisBitsetAndNot(ErmisBitset *dst, const ErmisBitset *src) { ErmisBitsetApply(dst, src, ErmisBitsOp_AndNot); }
+
+HELIOS_INLINE UZ ErmisBitsetCount(const ErmisBitset *set) {
+    return ErmisBitsCount(set->words, ErmisBitsetWordCount(set));
+}
+
+// The first set bit at or after `from`, `bit_count` when there is none.
+HELIOS_INLINE UZ ErmisBitsetNext(const ErmisBitset *set, UZ from) {
+    return HELIOS_MIN(ErmisBitsNext(set->words, ErmisBitsetWordCount(set), from), set->bit_count);
+}
+
+HELIOS_INLINE UZ ErmisBitsetRank(const ErmisBitset *set, UZ i) {
+    HELIOS_VERIFY(set->rank != NULL);
+    HELIOS_ASSERT(i <= set->bit_count);
+    return ErmisBitsRank(set->words, set->rank, i);
+}
+
+// The position of the set bit with `k` set bits before it, `bit_count` when there are not that many.
+HELIOS_INLINE UZ ErmisBitsetSelect(const ErmisBitset *set, UZ k) {
+    HELIOS_VERIFY(set->rank != NULL);
+    return HELIOS_MIN(ErmisBitsSelect(set->words, ErmisBitsetWordCount(set), set->rank, k), set->bit_count);
+}
+
+// Persistent hash maps
+//
+// ERMIS_DECL_HAMT declares a hash array mapped trie whose versions never change once built. Inserting or
+// removing returns a new version that shares every node off the path to the key with the old one, so an
+// update copies one node per level, at most 14, instead of the whole map. Every level takes 5 bits of the
+// mixed key hash and keeps a 32 bit map of the slots holding an entry and another of the slots holding a
+// child. Keys whose hashes are equal in all 64 bits end up together in a collision node below the last
+// level.
+//
+// Nodes are reference counted: a version holds its root and every node holds its children, and the last
+// version to let go of a node frees it, on whichever thread that happens. The allocator has to be thread
+// safe when versions are released on other threads than the one that built them. Keys and values are
+// copied as they are and never freed, whatever they point to has to outlive every version holding them.
+//
+// `mapname##Cell` publishes versions to readers: the writer stores new versions, readers load one and then
+// use it without any locks for as long as they hold it. Loading only holds a spin lock for the time it
+// takes to copy the root and count a reference, which keeps the writer from freeing the root in between.
+
+#define ERMIS_HAMT_BITS 5
+// Node levels on the longest path, 13 taking hash bits and the collision level.
+#define ERMIS_HAMT_MAX_DEPTH 14
+#define ERMIS_HAMT_BIT(hash, shift) ((U32)1 << (((hash) >> (shift)) & 31))
+
+// Followed by the entries, then by the children at pointer alignment.
+typedef struct ErmisHamtNode {
+    HeliosAtomicU32 refs;
+    U32 entry_map;
+    U32 child_map;
+    // Matches the entry map, except in collision nodes which have neither map.
+    U32 entry_count;
+} ErmisHamtNode;
+
+HELIOS_INLINE void *ErmisHamtNodeEntries(const ErmisHamtNode *node) {
+    return (void *)(node + 1);
+}
+
+HELIOS_INLINE UZ _ErmisHamtChildrenOffset(UZ entry_size, U32 entry_count) {
+    UZ offset = sizeof(ErmisHamtNode) + entry_size * entry_count;
+    return (offset + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+}
+
+HELIOS_INLINE ErmisHamtNode **ErmisHamtNodeChildren(const ErmisHamtNode *node, UZ entry_size) {
+    return (ErmisHamtNode **)((U8 *)node + _ErmisHamtChildrenOffset(entry_size, node->entry_count));
+}
+
+HELIOS_INLINE void _ErmisHamtNodeRetain(ErmisHamtNode *node) {
+    HeliosAtomicFetchAddU32(&node->refs, 1, HeliosMemoryOrder_Relaxed);
+}
+
+// The node building blocks of the generated maps, which work on entries as `entry_size` bytes. New nodes
+// hold one reference, copies take a reference to every child they share with the original.
+HELIOS_DEF ErmisHamtNode *_ErmisHamtNodeNew(HeliosAllocator allocator, UZ entry_size, U32 entry_map, U32 child_map, U32 entry_count);
+HELIOS_DEF void _ErmisHamtNodeRelease(HeliosAllocator allocator, ErmisHamtNode *node, UZ entry_size);
+// Copies `node` with the slot `bit` holding `entry`, `child` or, when both are NULL, nothing. `child` is
+// moved into the copy.
+HELIOS_DEF ErmisHamtNode *_ErmisHamtNodeCopyWithSlot(HeliosAllocator allocator, const ErmisHamtNode *node, UZ entry_size,
+                                                     U32 bit, const void *entry, ErmisHamtNode *child);
+// Copies the collision node `node` with the entry at `index` replaced by `entry`, or removed when `entry` is
+// NULL. An `index` of `entry_count` appends.
+HELIOS_DEF ErmisHamtNode *_ErmisHamtCollisionCopy(HeliosAllocator allocator, const ErmisHamtNode *node, UZ entry_size,
+                                                  U32 index, const void *entry);
+// The subtree at `shift` holding the two entries.
+HELIOS_DEF ErmisHamtNode *_ErmisHamtMerge(HeliosAllocator allocator, UZ entry_size, const void *a, U64 a_hash,
+                                          const void *b, U64 b_hash, U32 shift);
+
+// Visits the trie depth first: the entries of a node in slot order, then each child in slot order. A node's
+// entries come before everything below it, so this is not hash order, and collision nodes keep their keys in
+// the order they were inserted. Two versions holding the same keys can visit them in different orders.
+typedef struct ErmisHamtIter {
+    const ErmisHamtNode *nodes[ERMIS_HAMT_MAX_DEPTH];
+    // The next slot of every node on the path, entries first and children after them.
+    U32 positions[ERMIS_HAMT_MAX_DEPTH];
+    U32 depth;
+    UZ entry_size;
+    // NULL once past the last entry.
+    const void *entry;
+} ErmisHamtIter;
+
+HELIOS_DEF void ErmisHamtIterInit(ErmisHamtIter *it, const ErmisHamtNode *root, UZ entry_size);
+HELIOS_DEF void ErmisHamtIterNext(ErmisHamtIter *it);
+
+#define ERMIS_DECL_HAMT(K, V, mapname) typedef struct mapname##Entry {  \
+        K key;                                                          \
+        V value;                                                        \
+    } mapname##Entry;                                                   \
+                                                                        \
+    /* A version of the map, NULL root when empty. Copying the struct does not count a reference, */ \
+    /* `mapname##Retain` does. */                                       \
+    typedef struct mapname {                                            \
+        ErmisHamtNode *root;                                            \
+        UZ count;                                                       \
+        HeliosAllocator allocator;                                      \
+    } mapname;                                                          \
+                                                                        \
+    typedef struct mapname##Cell {                                      \
+        HeliosSpinLock lock;                                            \
+        mapname current;                                                \
+    } mapname##Cell;                                                    \
+                                                                        \
+    typedef ErmisHamtIter mapname##Iter;                                \
+                                                                        \
+    const V *mapname##FindPtr(const mapname *map, K key);               \
+    /* A new version with `key` set to `value`, `map` stays as it was. */ \
+    mapname mapname##Insert(const mapname *map, K key, V value);        \
+    /* A new version without `key`, which is `map` retained when it has no `key`. */ \
+    mapname mapname##Remove(const mapname *map, K key);                 \
+                                                                        \
+    /* An empty version, which allocates nothing until the first insert. */ \
+    HELIOS_INLINE void mapname##Init(mapname *map, HeliosAllocator allocator) { \
+        map->root = NULL;                                               \
+        map->count = 0;                                                 \
+        map->allocator = allocator;                                     \
+    }                                                                   \
+                                                                        \
+    HELIOS_INLINE B32 mapname##Find(const mapname *map, K key, V *value) { \
+        const V *found_ptr = mapname##FindPtr(map, key);                \
+        if (found_ptr == NULL) return 0;                                \
+        *value = *found_ptr;                                            \
+        return 1;                                                       \
+    }                                                                   \
+                                                                        \
+    /* Another reference to the version, to be released on its own. */ \
+    HELIOS_INLINE mapname mapname##Retain(const mapname *map) {         \
+        if (map->root != NULL) _ErmisHamtNodeRetain(map->root);         \
+        return *map;                                                    \
+    }                                                                   \
+                                                                        \
+    HELIOS_INLINE void mapname##Release(mapname *map) {                 \
+        if (map->root != NULL) _ErmisHamtNodeRelease(map->allocator, map->root, sizeof(mapname##Entry)); \
+        map->root = NULL;                                               \
+        map->count = 0;                                                 \
+    }                                                                   \
+                                                                        \
+    HELIOS_INLINE void mapname##IterInit(mapname##Iter *it, const mapname *map) { \
+        ErmisHamtIterInit(it, map->root, sizeof(mapname##Entry));       \
+    }                                                                   \
+                                                                        \
+    HELIOS_INLINE B32 mapname##IterValid(const mapname##Iter *it) {     \
+        return it->entry != NULL;                                       \
+    }                                                                   \
+                                                                        \
+    HELIOS_INLINE K mapname##IterKey(const mapname##Iter *it) {         \
+        return ((const mapname##Entry *)it->entry)->key;                \
+    }                                                                   \
+                                                                        \
+    HELIOS_INLINE const V *mapname##IterValue(const mapname##Iter *it) { \
+        return &((const mapname##Entry *)it->entry)->value;             \
+    }                                                                   \
+                                                                        \
+    HELIOS_INLINE void mapname##IterNext(mapname##Iter *it) {           \
+        ErmisHamtIterNext(it);                                          \
+    }                                                                   \
+                                                                        \
+    /* Takes over the reference of `map`. */                            \
+    HELIOS_INLINE void mapname##CellInit(mapname##Cell *cell, mapname map) { \
+        HeliosSpinLock unlocked = HELIOS_SPIN_LOCK_INIT;                \
+        cell->lock = unlocked;                                          \
+        cell->current = map;                                            \
+    }                                                                   \
+                                                                        \
+    /* The current version with a reference of its own, to be released by the caller. */ \
+    HELIOS_INLINE mapname mapname##CellLoad(mapname##Cell *cell) {      \
+        HeliosSpinLockAcquire(&cell->lock);                             \
+        mapname snapshot = mapname##Retain(&cell->current);             \
+        HeliosSpinLockRelease(&cell->lock);                             \
+        return snapshot;                                                \
+    }                                                                   \
+                                                                        \
+    /* Takes over the reference of `map` and releases the one of the version it replaces. */ \
+    HELIOS_INLINE void mapname##CellStore(mapname##Cell *cell, mapname map) { \
+        HeliosSpinLockAcquire(&cell->lock);                             \
+        mapname previous = cell->current;                               \
+        cell->current = map;                                            \
+        HeliosSpinLockRelease(&cell->lock);                             \
+        mapname##Release(&previous);                                    \
+    }                                                                   \
+                                                                        \
+    HELIOS_INLINE void mapname##CellFree(mapname##Cell *cell) {         \
+        mapname##Release(&cell->current);                               \
+    }
+
+#define ERMIS_IMPL_HAMT(K, V, mapname, eqfunc, hashfunc)                \
+    HELIOS_INTERNAL U64 mapname##Hash(K key) {                          \
+        return ErmisFilterMix(hashfunc(key));                           \
+    }                                                                   \
+                                                                        \
+    const V *mapname##FindPtr(const mapname *map, K key) {              \
+        U64 hash = mapname##Hash(key);                                  \
+        const ErmisHamtNode *node = map->root;                          \
+        for (U32 shift = 0; node != NULL; shift += ERMIS_HAMT_BITS) {   \
+            const mapname##Entry *entries = (const mapname##Entry *)ErmisHamtNodeEntries(node); \
+            if (shift >= 64) {                                          \
+                for (U32 i = 0; i < node->entry_count; ++i) {           \
+                    if (eqfunc(entries[i].key, key)) return &entries[i].value; \
+                }                                                       \
+                return NULL;                                            \
+            }                                                           \
+                                                                        \
+            U32 bit = ERMIS_HAMT_BIT(hash, shift);                      \
+            if (node->entry_map & bit) {                                \
+                const mapname##Entry *entry = &entries[HeliosPopCountU32(node->entry_map & (bit - 1))]; \
+                return eqfunc(entry->key, key) ? &entry->value : NULL;  \
+            }                                                           \
+            if (!(node->child_map & bit)) return NULL;                  \
+            node = ErmisHamtNodeChildren(node, sizeof(mapname##Entry))[HeliosPopCountU32(node->child_map & (bit - 1))]; \
+        }                                                               \
+        return NULL;                                                    \
+    }                                                                   \
+                                                                        \
+    HELIOS_INTERNAL ErmisHamtNode *mapname##InsertNode(HeliosAllocator allocator, const ErmisHamtNode *node, U32 shift, \
+                                                       U64 hash, const mapname##Entry *entry, B32 *added) { \
+        const mapname##Entry *entries = (const mapname##Entry *)ErmisHamtNodeEntries(node); \
+        if (shift >= 64) {                                              \
+            U32 index = 0;                                              \
+            while (index < node->entry_count && !eqfunc(entries[index].key, entry->key)) ++index; \
+            *added = index == node->entry_count;                        \
+            return _ErmisHamtCollisionCopy(allocator, node, sizeof(mapname##Entry), index, entry); \
+        }                                                               \
+                                                                        \
+        U32 bit = ERMIS_HAMT_BIT(hash, shift);                          \
+        if (node->entry_map & bit) {                                    \
+            const mapname##Entry *existing = &entries[HeliosPopCountU32(node->entry_map & (bit - 1))]; \
+            if (eqfunc(existing->key, entry->key)) {                    \
+                *added = 0;                                             \
+                return _ErmisHamtNodeCopyWithSlot(allocator, node, sizeof(mapname##Entry), bit, entry, NULL); \
+            }                                                           \
+            *added = 1;                                                 \
+            ErmisHamtNode *child = _ErmisHamtMerge(allocator, sizeof(mapname##Entry), existing, mapname##Hash(existing->key), \
+                                                   entry, hash, shift + ERMIS_HAMT_BITS); \
+            return _ErmisHamtNodeCopyWithSlot(allocator, node, sizeof(mapname##Entry), bit, NULL, child); \
+        }                                                               \
+        if (node->child_map & bit) {                                    \
+            const ErmisHamtNode *child = ErmisHamtNodeChildren(node, sizeof(mapname##Entry))[HeliosPopCountU32(node->child_map & (bit - 1))]; \
+            ErmisHamtNode *new_child = mapname##InsertNode(allocator, child, shift + ERMIS_HAMT_BITS, hash, entry, added); \
+            return _ErmisHamtNodeCopyWithSlot(allocator, node, sizeof(mapname##Entry), bit, NULL, new_child); \
+        }                                                               \
+        *added = 1;                                                     \
+        return _ErmisHamtNodeCopyWithSlot(allocator, node, sizeof(mapname##Entry), bit, entry, NULL); \
+    }                                                                   \
+                                                                        \
+    mapname mapname##Insert(const mapname *map, K key, V value) {       \
+        mapname##Entry entry;                                           \
+        entry.key = key;                                                \
+        entry.value = value;                                            \
+        U64 hash = mapname##Hash(key);                                  \
+                                                                        \
+        mapname result = *map;                                          \
+        if (map->root == NULL) {                                        \
+            result.root = _ErmisHamtNodeNew(map->allocator, sizeof(mapname##Entry), ERMIS_HAMT_BIT(hash, 0), 0, 1); \
+            memcpy(ErmisHamtNodeEntries(result.root), &entry, sizeof(entry)); \
+            result.count = 1;                                           \
+            return result;                                              \
+        }                                                               \
+                                                                        \
+        B32 added = 0;                                                  \
+        result.root = mapname##InsertNode(map->allocator, map->root, 0, hash, &entry, &added); \
+        result.count += added;                                          \
+        return result;                                                  \
+    }                                                                   \
+                                                                        \
+    /* `node` itself when it has no `key`, NULL when nothing would be left. A node with a single */ \
+    /* entry and no children is merged into its parent, so that every version has the same shape */ \
+    /* as if it had been built with just its keys. */                   \
+    HELIOS_INTERNAL ErmisHamtNode *mapname##RemoveNode(HeliosAllocator allocator, ErmisHamtNode *node, U32 shift, \
+                                                       U64 hash, K key) { \
+        const mapname##Entry *entries = (const mapname##Entry *)ErmisHamtNodeEntries(node); \
+        if (shift >= 64) {                                              \
+            U32 index = 0;                                              \
+            while (index < node->entry_count && !eqfunc(entries[index].key, key)) ++index; \
+            if (index == node->entry_count) return node;                \
+            if (node->entry_count == 1) return NULL;                    \
+            return _ErmisHamtCollisionCopy(allocator, node, sizeof(mapname##Entry), index, NULL); \
+        }                                                               \
+                                                                        \
+        U32 bit = ERMIS_HAMT_BIT(hash, shift);                          \
+        U32 child_count = HeliosPopCountU32(node->child_map);           \
+        if (node->entry_map & bit) {                                    \
+            if (!eqfunc(entries[HeliosPopCountU32(node->entry_map & (bit - 1))].key, key)) return node; \
+            if (node->entry_count == 1 && child_count == 0) return NULL; \
+            return _ErmisHamtNodeCopyWithSlot(allocator, node, sizeof(mapname##Entry), bit, NULL, NULL); \
+        }                                                               \
+        if (!(node->child_map & bit)) return node;                      \
+                                                                        \
+        ErmisHamtNode *child = ErmisHamtNodeChildren(node, sizeof(mapname##Entry))[HeliosPopCountU32(node->child_map & (bit - 1))]; \
+        ErmisHamtNode *new_child = mapname##RemoveNode(allocator, child, shift + ERMIS_HAMT_BITS, hash, key); \
+        if (new_child == child) return node;                            \
+        if (new_child == NULL) {                                        \
+            if (node->entry_count == 0 && child_count == 1) return NULL; \
+            return _ErmisHamtNodeCopyWithSlot(allocator, node, sizeof(mapname##Entry), bit, NULL, NULL); \
+        }                                                               \
+        if (new_child->entry_count == 1 && new_child->child_map == 0) { \
+            ErmisHamtNode *copy = _ErmisHamtNodeCopyWithSlot(allocator, node, sizeof(mapname##Entry), bit, \
+                                                             ErmisHamtNodeEntries(new_child), NULL); \
+            _ErmisHamtNodeRelease(allocator, new_child, sizeof(mapname##Entry)); \
+            return copy;                                                \
+        }                                                               \
+        return _ErmisHamtNodeCopyWithSlot(allocator, node, sizeof(mapname##Entry), bit, NULL, new_child); \
+    }                                                                   \
+                                                                        \
+    mapname mapname##Remove(const mapname *map, K key) {                \
+        if (map->root == NULL) return *map;                             \
+                                                                        \
+        ErmisHamtNode *root = mapname##RemoveNode(map->allocator, map->root, 0, mapname##Hash(key), key); \
+        if (root == map->root) return mapname##Retain(map);             \
+                                                                        \
+        mapname result = *map;                                          \
+        result.root = root;                                             \
+        result.count -= 1;                                              \
+        return result;                                                  \
+    }
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#ifdef ASTRON_ERMIS_IMPLEMENTATION
+
+#if defined(HELIOS_ARCH_X86)
+HELIOS_DEF HELIOS_TARGET("avx2") B32 _ErmisBloomBlockTestAVX2(const U64 *block, U32 hash) {
+    __m256i bits = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32((int)hash), _mm256_setr_epi32(_ERMIS_BLOOM_SALTS)), 26);
+    __m256i one = _mm256_set1_epi64x(1);
+    __m256i low_mask = _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(bits)));
+    __m256i high_mask = _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(bits, 1)));
+
+    // testc is set when every bit of the mask is also set in the block.
+    return _mm256_testc_si256(_mm256_load_si256((const __m256i *)block), low_mask) &
+           _mm256_testc_si256(_mm256_load_si256((const __m256i *)block + 1), high_mask);
+}
+
+// Both compare every slot of the node, a fixed number of independent compares without a branch to
+// mispredict. The tree keeps the slots past `count` all ones, which is never before any key.
+HELIOS_DEF HELIOS_TARGET("avx2") UZ _ErmisBTreeSearchU32AVX2(const U32 *keys, UZ count, U32 key) {
+    HELIOS_UNUSED(count);
+    // AVX2 only compares signed lanes, flipping the sign bits keeps the unsigned order.
+    __m256i flip = _mm256_set1_epi32((int)0x80000000U);
+    __m256i needle = _mm256_xor_si256(_mm256_set1_epi32((int)key), flip);
+
+    // Lanes that compare true are all ones, so subtracting them counts.
+    __m256i before = _mm256_setzero_si256();
+    for (UZ i = 0; i < ERMIS_BTREE_CAPACITY(U32); i += 8) {
+        __m256i lanes = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(keys + i)), flip);
+        before = _mm256_sub_epi32(before, _mm256_cmpgt_epi32(needle, lanes));
+    }
+
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(before), _mm256_extracti128_si256(before, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return (UZ)(U32)_mm_cvtsi128_si32(sum);
+}
+
+HELIOS_DEF HELIOS_TARGET("avx2") UZ _ErmisBTreeSearchU64AVX2(const U64 *keys, UZ count, U64 key) {
+    HELIOS_UNUSED(count);
+    __m256i flip = _mm256_set1_epi64x((long long)0x8000000000000000ULL);
+    __m256i needle = _mm256_xor_si256(_mm256_set1_epi64x((long long)key), flip);
+
+    __m256i before = _mm256_setzero_si256();
+    for (UZ i = 0; i < ERMIS_BTREE_CAPACITY(U64); i += 4) {
+        __m256i lanes = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(keys + i)), flip);
+        before = _mm256_sub_epi64(before, _mm256_cmpgt_epi64(needle, lanes));
+    }
+
+    // The count fits the low 32 bits of each lane.
+    __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(before), _mm256_extracti128_si256(before, 1));
+    sum = _mm_add_epi64(sum, _mm_unpackhi_epi64(sum, sum));
+    return (UZ)(U32)_mm_cvtsi128_si32(sum);
+}
+#endif // HELIOS_ARCH_X86
+
+HELIOS_INTERNAL int _ErmisCompareU64(const void *a, const void *b) {
+    U64 x = *(const U64 *)a;
+    U64 y = *(const U64 *)b;
+    return (x > y) - (x < y);
+}
+
+HELIOS_DEF B32 _ErmisXorFilterPopulate(U64 *key_hashes, UZ count, U8 *fingerprints, U32 segment_length, U64 *out_seed, void *scratch) {
+    UZ slot_count = (UZ)segment_length * 3;
+    U64 *slot_xors = (U64 *)scratch;
+    U64 *stack_hashes = slot_xors + slot_count;
+    U32 *slot_counts = (U32 *)(stack_hashes + count);
+    U32 *queue = slot_counts + slot_count;
+    U32 *stack_slots = queue + slot_count;
+
+    for (U32 attempt = 0; attempt < ERMIS_XOR_FILTER_MAX_ATTEMPTS; ++attempt) {
+        U64 seed = ErmisFilterMix(0x9e3779b97f4a7c15ULL * (attempt + 1));
+        memset(slot_xors, 0, sizeof(U64) * slot_count);
+        memset(slot_counts, 0, sizeof(U32) * slot_count);
+
+        for (UZ i = 0; i < count; ++i) {
+            U64 hash = ErmisFilterMix(key_hashes[i] + seed);
+            U32 slots[3];
+            _ErmisXorFilterSlots(hash, segment_length, slots);
+            for (UZ j = 0; j < 3; ++j) {
+                slot_xors[slots[j]] ^= hash;
+                ++slot_counts[slots[j]];
+            }
+        }
+
+        // Peels keys that are alone in one of their slots, which can leave other keys alone in turn.
+        UZ queue_count = 0;
+        for (UZ i = 0; i < slot_count; ++i) {
+            if (slot_counts[i] == 1) queue[queue_count++] = (U32)i;
+        }
+
+        UZ stack_count = 0;
+        while (queue_count != 0) {
+            U32 slot = queue[--queue_count];
+            if (slot_counts[slot] != 1) continue;
+
+            U64 hash = slot_xors[slot];
+            stack_slots[stack_count] = slot;
+            stack_hashes[stack_count] = hash;
+            ++stack_count;
+
+            U32 slots[3];
+            _ErmisXorFilterSlots(hash, segment_length, slots);
+            for (UZ j = 0; j < 3; ++j) {
+                slot_xors[slots[j]] ^= hash;
+                if (--slot_counts[slots[j]] == 1) queue[queue_count++] = slots[j];
+            }
+        }
+
+        if (stack_count == count) {
+            // In reverse peeling order, each key's slot is the last of its three to be assigned.
+            while (stack_count != 0) {
+                --stack_count;
+                U64 hash = stack_hashes[stack_count];
+                U32 slots[3];
+                _ErmisXorFilterSlots(hash, segment_length, slots);
+                fingerprints[stack_slots[stack_count]] = _ErmisXorFilterFingerprint(hash) ^ fingerprints[slots[0]] ^
+                                                         fingerprints[slots[1]] ^ fingerprints[slots[2]];
+            }
+
+            *out_seed = seed;
+            return 1;
+        }
+
+        // Equal hashes can never be peeled, get rid of them once the first seed fails.
+        if (attempt == 0) {
+            qsort(key_hashes, count, sizeof(U64), _ErmisCompareU64);
+            UZ unique_count = 0;
+            for (UZ i = 0; i < count; ++i) {
+                if (unique_count == 0 || key_hashes[unique_count - 1] != key_hashes[i]) key_hashes[unique_count++] = key_hashes[i];
+            }
+            count = unique_count;
+        }
+    }
+
+    return 0;
+}
+
+HELIOS_INTERNAL void _ErmisBitsApplyScalar(U64 *dst, const U64 *src, UZ word_count, ErmisBitsOp op) {
+    switch (op) {
+    case ErmisBitsOp_And:    for (UZ i = 0; i < word_count; ++i) dst[i] &= src[i];  break;
+    case ErmisBitsOp_Or:     for (UZ i = 0; i < word_count; ++i) dst[i] |= src[i];  break;
+    case ErmisBitsOp_Xor:    for (UZ i = 0; i < word_count; ++i) dst[i] ^= src[i];  break;
+    case ErmisBitsOp_AndNot: for (UZ i = 0; i < word_count; ++i) dst[i] &= ~src[i]; break;
+    }
+}
+
+HELIOS_INTERNAL UZ _ErmisBitsCountScalar(const U64 *words, UZ word_count) {
+    UZ result = 0;
+    for (UZ i = 0; i < word_count; ++i) result += HeliosPopCountU64(words[i]);
+    return result;
+}
+
+#if defined(HELIOS_ARCH_X86)
+// The op is switched on once, each loop handles 4 words at a time.
+#define _ERMIS_BITS_APPLY_AVX2_LOOP(dst_vec, src_vec, expr)             \
+    for (; i + 4 <= word_count; i += 4) {                               \
+        __m256i dst_vec = _mm256_loadu_si256((const __m256i *)(dst + i)); \
+        __m256i src_vec = _mm256_loadu_si256((const __m256i *)(src + i)); \
+        _mm256_storeu_si256((__m256i *)(dst + i), expr);                \
+    }
+
+HELIOS_INTERNAL HELIOS_TARGET("avx2") void _ErmisBitsApplyAVX2(U64 *dst, const U64 *src, UZ word_count, ErmisBitsOp op) {
+    UZ i = 0;
+    switch (op) {
+    case ErmisBitsOp_And:    _ERMIS_BITS_APPLY_AVX2_LOOP(d, s, _mm256_and_si256(d, s));    break;
+    case ErmisBitsOp_Or:     _ERMIS_BITS_APPLY_AVX2_LOOP(d, s, _mm256_or_si256(d, s));     break;
+    case ErmisBitsOp_Xor:    _ERMIS_BITS_APPLY_AVX2_LOOP(d, s, _mm256_xor_si256(d, s));    break;
+    case ErmisBitsOp_AndNot: _ERMIS_BITS_APPLY_AVX2_LOOP(d, s, _mm256_andnot_si256(s, d)); break;
+    }
+    _ErmisBitsApplyScalar(dst + i, src + i, word_count - i, op);
+}
+
+#undef _ERMIS_BITS_APPLY_AVX2_LOOP
+
+// Counts the bits of every nibble with a 16 entry table in a shuffle, then sums the bytes of each word
+// with `sad`, see "Faster Population Counts Using AVX2 Instructions" (Muła, Kurz, Lemire).
+HELIOS_INTERNAL HELIOS_TARGET("avx2,popcnt") UZ _ErmisBitsCountAVX2(const U64 *words, UZ word_count) {
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                           0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_nibbles = _mm256_set1_epi8(0x0F);
+    __m256i totals = _mm256_setzero_si256();
+
+    UZ i = 0;
+    for (; i + 4 <= word_count; i += 4) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *)(words + i));
+        __m256i low = _mm256_shuffle_epi8(table, _mm256_and_si256(chunk, low_nibbles));
+        __m256i high = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(chunk, 4), low_nibbles));
+        totals = _mm256_add_epi64(totals, _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256()));
+    }
+
+    U64 lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, totals);
+    UZ result = (UZ)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+    for (; i < word_count; ++i) result += (UZ)_mm_popcnt_u32((U32)words[i]) + (UZ)_mm_popcnt_u32((U32)(words[i] >> 32));
+    return result;
+}
+#endif // HELIOS_ARCH_X86
+
+HELIOS_DEF void ErmisBitsApply(U64 *dst, const U64 *src, UZ word_count, ErmisBitsOp op) {
+#if defined(HELIOS_ARCH_X86)
+    if (ErmisSimdAvailable()) {
+        _ErmisBitsApplyAVX2(dst, src, word_count, op);
+        return;
+    }
+#endif // HELIOS_ARCH_X86
+    _ErmisBitsApplyScalar(dst, src, word_count, op);
+}
+
+HELIOS_DEF UZ ErmisBitsCount(const U64 *words, UZ word_count) {
+#if defined(HELIOS_ARCH_X86)
+    if (ErmisSimdAvailable()) return _ErmisBitsCountAVX2(words, word_count);
+#endif // HELIOS_ARCH_X86
+    return _ErmisBitsCountScalar(words, word_count);
+}
+
+HELIOS_DEF void ErmisBitsBuildRank(const U64 *words, UZ word_count, U64 *rank) {
+    UZ block_count = ERMIS_BITS_RANK_ENTRIES(word_count) - 1;
+    U64 total = 0;
+    for (UZ block = 0; block < block_count; ++block) {
+        rank[block] = total;
+        UZ first = block * ERMIS_BITS_RANK_BLOCK_WORDS;
+        total += _ErmisBitsCountScalar(words + first, HELIOS_MIN(ERMIS_BITS_RANK_BLOCK_WORDS, word_count - first));
+    }
+    rank[block_count] = total;
+}
+
+// Finds the byte of the bit from the running byte counts, then the bit within the byte.
+HELIOS_INTERNAL UZ _ErmisBitsSelectInWord(U64 word, UZ k) {
+    U64 counts = word - ((word >> 1) & 0x5555555555555555ULL);
+    counts = (counts & 0x3333333333333333ULL) + ((counts >> 2) & 0x3333333333333333ULL);
+    counts = (counts + (counts >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    // Byte `i` is now the count of bits in bytes 0 to `i`.
+    counts *= 0x0101010101010101ULL;
+
+    UZ byte = 0;
+    while (((counts >> (byte * 8)) & 0xFF) <= k) ++byte;
+    if (byte != 0) k -= (counts >> (byte * 8 - 8)) & 0xFF;
+
+    U64 bits = (word >> (byte * 8)) & 0xFF;
+    for (; k != 0; --k) bits &= bits - 1;
+    return byte * 8 + HeliosCountTrailingZerosU64(bits);
+}
+
+HELIOS_DEF UZ ErmisBitsSelect(const U64 *words, UZ word_count, const U64 *rank, UZ k) {
+    UZ block_count = ERMIS_BITS_RANK_ENTRIES(word_count) - 1;
+    if (k >= rank[block_count]) return word_count * 64;
+
+    // The last block with at most `k` set bits before it.
+    UZ low = 0;
+    UZ high = block_count;
+    while (high - low > 1) {
+        UZ mid = low + (high - low) / 2;
+        if (rank[mid] <= k) low = mid;
+        else high = mid;
+    }
+
+    k -= (UZ)rank[low];
+    for (UZ word = low * ERMIS_BITS_RANK_BLOCK_WORDS;; ++word) {
+        UZ count = HeliosPopCountU64(words[word]);
+        if (k < count) return word * 64 + _ErmisBitsSelectInWord(words[word], k);
+        k -= count;
+    }
+}
+
+HELIOS_DEF void ErmisBitsetInit(ErmisBitset *set, HeliosAllocator allocator, UZ bit_count) {
+    set->allocator = allocator;
+    set->bit_count = bit_count;
+    set->words = (U64 *)HeliosAllocZeroed(allocator, sizeof(U64) * ERMIS_BITS_WORDS(bit_count));
+    set->rank = NULL;
+}
+
+HELIOS_INTERNAL void _ErmisBitsetDropRank(ErmisBitset *set) {
+    if (set->rank == NULL) return;
+    HeliosFree(set->allocator, set->rank, sizeof(U64) * ERMIS_BITS_RANK_ENTRIES(ErmisBitsetWordCount(set)));
+    set->rank = NULL;
+}
+
+HELIOS_DEF void ErmisBitsetResize(ErmisBitset *set, UZ bit_count) {
+    _ErmisBitsetDropRank(set);
+
+    UZ old_words = ErmisBitsetWordCount(set);
+    UZ new_words = ERMIS_BITS_WORDS(bit_count);
+    if (new_words != old_words) {
+        set->words = (U64 *)HeliosRealloc(set->allocator, set->words, sizeof(U64) * old_words, sizeof(U64) * new_words);
+        if (new_words > old_words) memset(set->words + old_words, 0, sizeof(U64) * (new_words - old_words));
+    }
+
+    // Bits past the end stay clear, also when they were set before shrinking.
+    if (bit_count < set->bit_count && bit_count % 64 != 0) set->words[new_words - 1] &= ((U64)1 << (bit_count % 64)) - 1;
+    set->bit_count = bit_count;
+}
+
+HELIOS_DEF void ErmisBitsetFree(ErmisBitset *set) {
+    _ErmisBitsetDropRank(set);
+    HeliosFree(set->allocator, set->words, sizeof(U64) * ErmisBitsetWordCount(set));
+}
+
+HELIOS_DEF void ErmisBitsetBuildRank(ErmisBitset *set) {
+    UZ word_count = ErmisBitsetWordCount(set);
+    if (set->rank == NULL) set->rank = (U64 *)HeliosAllocUninit(set->allocator, sizeof(U64) * ERMIS_BITS_RANK_ENTRIES(word_count));
+    ErmisBitsBuildRank(set->words, word_count, set->rank);
+}
+
+HELIOS_INTERNAL UZ _ErmisHamtNodeSize(UZ entry_size, U32 entry_count, U32 child_map) {
+    return _ErmisHamtChildrenOffset(entry_size, entry_count) + sizeof(ErmisHamtNode *) * HeliosPopCountU32(child_map);
+}
+
+HELIOS_DEF ErmisHamtNode *_ErmisHamtNodeNew(HeliosAllocator allocator, UZ entry_size, U32 entry_map, U32 child_map, U32 entry_count) {
+    ErmisHamtNode *node = (ErmisHamtNode *)HeliosAllocUninit(allocator, _ErmisHamtNodeSize(entry_size, entry_count, child_map));
+    HeliosAtomicStoreU32(&node->refs, 1, HeliosMemoryOrder_Relaxed);
+    node->entry_map = entry_map;
+    node->child_map = child_map;
+    node->entry_count = entry_count;
+    return node;
+}
+
+HELIOS_DEF void _ErmisHamtNodeRelease(HeliosAllocator allocator, ErmisHamtNode *node, UZ entry_size) {
+    // The acquire half keeps the free after the last use of the node on the other threads that held it.
+    if (HeliosAtomicFetchSubU32(&node->refs, 1, HeliosMemoryOrder_AcqRel) != 1) return;
+
+    ErmisHamtNode **children = ErmisHamtNodeChildren(node, entry_size);
+    U32 child_count = HeliosPopCountU32(node->child_map);
+    for (U32 i = 0; i < child_count; ++i) _ErmisHamtNodeRelease(allocator, children[i], entry_size);
+    HeliosFree(allocator, node, _ErmisHamtNodeSize(entry_size, node->entry_count, node->child_map));
+}
+
+// Copies `entries` with the one at `index` replaced by `entry`, removed when `entry` is NULL, or with
+// `entry` inserted there when `skip` is 0.
+HELIOS_INTERNAL void _ErmisHamtCopyEntries(U8 *dst, const U8 *entries, U32 entry_count, UZ entry_size, U32 index,
+                                           U32 skip, const void *entry) {
+    memcpy(dst, entries, entry_size * index);
+    if (entry != NULL) memcpy(dst + entry_size * index, entry, entry_size);
+    memcpy(dst + entry_size * (index + (entry != NULL)), entries + entry_size * (index + skip),
+           entry_size * (entry_count - index - skip));
+}
+
+HELIOS_DEF ErmisHamtNode *_ErmisHamtNodeCopyWithSlot(HeliosAllocator allocator, const ErmisHamtNode *node, UZ entry_size,
+                                                     U32 bit, const void *entry, ErmisHamtNode *child) {
+    U32 had_entry = (node->entry_map & bit) != 0;
+    U32 had_child = (node->child_map & bit) != 0;
+    ErmisHamtNode *copy = _ErmisHamtNodeNew(allocator, entry_size, (node->entry_map & ~bit) | (entry != NULL ? bit : 0),
+                                            (node->child_map & ~bit) | (child != NULL ? bit : 0),
+                                            node->entry_count - had_entry + (entry != NULL));
+
+    _ErmisHamtCopyEntries((U8 *)ErmisHamtNodeEntries(copy), (const U8 *)ErmisHamtNodeEntries(node), node->entry_count,
+                          entry_size, HeliosPopCountU32(node->entry_map & (bit - 1)), had_entry, entry);
+
+    ErmisHamtNode **old_children = ErmisHamtNodeChildren(node, entry_size);
+    ErmisHamtNode **children = ErmisHamtNodeChildren(copy, entry_size);
+    U32 old_child_count = HeliosPopCountU32(node->child_map);
+    U32 index = HeliosPopCountU32(node->child_map & (bit - 1));
+    U32 out = 0;
+    for (U32 i = 0; i <= old_child_count; ++i) {
+        if (i == index && child != NULL) children[out++] = child;
+        if (i == old_child_count || (i == index && had_child)) continue;
+        _ErmisHamtNodeRetain(old_children[i]);
+        children[out++] = old_children[i];
+    }
+    return copy;
+}
+
+HELIOS_DEF ErmisHamtNode *_ErmisHamtCollisionCopy(HeliosAllocator allocator, const ErmisHamtNode *node, UZ entry_size,
+                                                  U32 index, const void *entry) {
+    U32 skip = index < node->entry_count;
+    ErmisHamtNode *copy = _ErmisHamtNodeNew(allocator, entry_size, 0, 0, node->entry_count - skip + (entry != NULL));
+    _ErmisHamtCopyEntries((U8 *)ErmisHamtNodeEntries(copy), (const U8 *)ErmisHamtNodeEntries(node), node->entry_count,
+                          entry_size, index, skip, entry);
+    return copy;
+}
+
+HELIOS_DEF ErmisHamtNode *_ErmisHamtMerge(HeliosAllocator allocator, UZ entry_size, const void *a, U64 a_hash,
+                                          const void *b, U64 b_hash, U32 shift) {
+    if (shift >= 64) {
+        ErmisHamtNode *node = _ErmisHamtNodeNew(allocator, entry_size, 0, 0, 2);
+        memcpy(ErmisHamtNodeEntries(node), a, entry_size);
+        memcpy((U8 *)ErmisHamtNodeEntries(node) + entry_size, b, entry_size);
+        return node;
+    }
+
+    U32 a_bit = ERMIS_HAMT_BIT(a_hash, shift);
+    U32 b_bit = ERMIS_HAMT_BIT(b_hash, shift);
+    if (a_bit == b_bit) {
+        ErmisHamtNode *node = _ErmisHamtNodeNew(allocator, entry_size, 0, a_bit, 0);
+        ErmisHamtNodeChildren(node, entry_size)[0] = _ErmisHamtMerge(allocator, entry_size, a, a_hash, b, b_hash,
+                                                                     shift + ERMIS_HAMT_BITS);
+        return node;
+    }
+
+    ErmisHamtNode *node = _ErmisHamtNodeNew(allocator, entry_size, a_bit | b_bit, 0, 2);
+    memcpy(ErmisHamtNodeEntries(node), a_bit < b_bit ? a : b, entry_size);
+    memcpy((U8 *)ErmisHamtNodeEntries(node) + entry_size, a_bit < b_bit ? b : a, entry_size);
+    return node;
+}
+
+HELIOS_DEF void ErmisHamtIterInit(ErmisHamtIter *it, const ErmisHamtNode *root, UZ entry_size) {
+    it->depth = 0;
+    it->entry_size = entry_size;
+    it->entry = NULL;
+    if (root == NULL) return;
+
+    it->nodes[0] = root;
+    it->positions[0] = 0;
+    it->depth = 1;
+    ErmisHamtIterNext(it);
+}
+
+HELIOS_DEF void ErmisHamtIterNext(ErmisHamtIter *it) {
+    while (it->depth > 0) {
+        const ErmisHamtNode *node = it->nodes[it->depth - 1];
+        U32 position = it->positions[it->depth - 1]++;
+        if (position < node->entry_count) {
+            it->entry = (const U8 *)ErmisHamtNodeEntries(node) + it->entry_size * position;
+            return;
+        }
+
+        position -= node->entry_count;
+        if (position < HeliosPopCountU32(node->child_map)) {
+            HELIOS_ASSERT(it->depth < ERMIS_HAMT_MAX_DEPTH);
+            it->nodes[it->depth] = ErmisHamtNodeChildren(node, it->entry_size)[position];
+            it->positions[it->depth] = 0;
+            ++it->depth;
+        } else {
+            --it->depth;
+        }
+    }
+    it->entry = NULL;
+}
+
+#endif // ASTRON_ERMIS_IMPLEMENTATION
 #endif // ASTRON_ERMIS_H
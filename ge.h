@@ -77,20 +77,216 @@ struct GeTomlValue {
 struct GeTomlTable {
     struct GeTomlTable *next;
     HeliosStringView key;
+    // Set when the table was parsed with an interner, HELIOS_INTERN_ID_NONE otherwise.
+    HeliosInternId key_id;
     GeTomlValue value;
 };
 
+typedef U32 GeTomlParseFlags;
+enum {
+    // Keys and string values point into the source buffer instead of being copied, so the buffer has
+    // to outlive the parsed table.
+    GeTomlParseFlag_BorrowStrings = 1 << 0,
+};
+
+typedef struct GeTomlParseOptions {
+    GeTomlParseFlags flags;
+    // When set, keys are stored once in the interner instead of per occurrence, and the parser compares
+    // them by pointer. Values are not interned. The interner has to outlive the parsed table.
+    HeliosInterner *interner;
+} GeTomlParseOptions;
+
 HELIOS_DEF GeTomlTable *GeTomlParseBuffer(HeliosAllocator allocator,
                                           const char *buf,
                                           UZ buf_count,
                                           char *err_buf,
                                           UZ err_buf_count);
 
+HELIOS_DEF GeTomlTable *GeTomlParseBufferEx(HeliosAllocator allocator,
+                                            const char *buf,
+                                            UZ buf_count,
+                                            const GeTomlParseOptions *options,
+                                            char *err_buf,
+                                            UZ err_buf_count);
+
+// Parses straight from a mapping of the file at `path`, with the strings of the table borrowed from it.
+// On success the mapping is stored in `out_file`, and must be unmapped once the table is not used anymore.
+HELIOS_DEF GeTomlTable *GeTomlParseFile(HeliosAllocator allocator,
+                                        HeliosStringView path,
+                                        HeliosMappedFile *out_file,
+                                        char *err_buf,
+                                        UZ err_buf_count);
+
 HELIOS_DEF GeTomlValue *GeTomlTableFind(GeTomlTable *table, const char *key);
 HELIOS_DEF GeTomlValue *GeTomlTableFindSV(GeTomlTable *table, HeliosStringView sv);
+// For tables parsed with an interner, with the id from `HeliosInternerFind` on the same interner.
+HELIOS_DEF GeTomlValue *GeTomlTableFindId(GeTomlTable *table, HeliosInternId id);
 
 HELIOS_DEF B32 GeTomlTableHas(GeTomlTable *table, const char *key);
 HELIOS_DEF B32 GeTomlTableHasSV(GeTomlTable *table, HeliosStringView sv);
+
+// A parsed document flattened into one array of 8 byte entries, in document order. The top byte of an
+// entry is its tag, the other 56 bits its payload:
+//
+//   Int, Float       the payload is unused, the value is the whole next entry
+//   Bool             0 or 1
+//   String, Key      the offset of the string in `strings`, a key entry is followed by its value
+//   Array, Table     the index of the matching end entry in the low 32 bits, the count of items or keys
+//                    in the high 24, saturated at GE_TOML_TAPE_MAX_COUNT
+//   ArrayEnd,
+//   TableEnd         the index of the matching start entry
+//
+// The root table starts at entry 0. Skipping a container is a jump to its end entry, so walking a document
+// reads both arrays front to back, and the whole tape takes a fraction of the memory of the linked tables.
+// Strings are stored as [U32 length][bytes][NUL], so they can also be passed on as C strings.
+typedef U8 GeTomlTapeTag;
+enum {
+    GeTomlTapeTag_Key = GeTomlValueType_Max,
+    GeTomlTapeTag_ArrayEnd,
+    GeTomlTapeTag_TableEnd,
+};
+
+#define GE_TOML_TAPE_PAYLOAD_BITS 56
+#define GE_TOML_TAPE_TAG(entry) ((GeTomlTapeTag)((entry) >> GE_TOML_TAPE_PAYLOAD_BITS))
+#define GE_TOML_TAPE_PAYLOAD(entry) ((entry) & (((U64)1 << GE_TOML_TAPE_PAYLOAD_BITS) - 1))
+#define GE_TOML_TAPE_MAX_COUNT 0xFFFFFF
+
+typedef struct GeTomlTape {
+    U64 *entries;
+    UZ entry_count;
+    U8 *strings;
+    UZ strings_count;
+    HeliosAllocator allocator;
+} GeTomlTape;
+
+// Points at one entry of a tape: a value, or a key inside a table.
+typedef struct GeTomlCursor {
+    const GeTomlTape *tape;
+    UZ index;
+} GeTomlCursor;
+
+// Parses into a temporary arena and flattens the result, nothing of `buf` is referenced afterwards.
+HELIOS_DEF B32 GeTomlTapeParseBuffer(GeTomlTape *tape,
+                                     HeliosAllocator allocator,
+                                     const char *buf,
+                                     UZ buf_count,
+                                     char *err_buf,
+                                     UZ err_buf_count);
+// Flattens an already parsed table, which is left as it is.
+HELIOS_DEF void GeTomlTapeFromTable(GeTomlTape *tape, HeliosAllocator allocator, const GeTomlTable *table);
+HELIOS_DEF void GeTomlTapeFree(GeTomlTape *tape);
+
+// Find the value of `key` in the table at `table`.
+HELIOS_DEF B32 GeTomlCursorFind(GeTomlCursor table, const char *key, GeTomlCursor *out);
+HELIOS_DEF B32 GeTomlCursorFindSV(GeTomlCursor table, HeliosStringView key, GeTomlCursor *out);
+// Counts by walking the items when the stored count is saturated.
+HELIOS_DEF UZ _GeTomlCursorCountSlow(GeTomlCursor container);
+
+HELIOS_INLINE GeTomlCursor GeTomlTapeRoot(const GeTomlTape *tape) {
+    GeTomlCursor cursor;
+    cursor.tape = tape;
+    cursor.index = 0;
+    return cursor;
+}
+
+HELIOS_INLINE U64 _GeTomlCursorEntry(GeTomlCursor cursor) {
+    HELIOS_ASSERT(cursor.index < cursor.tape->entry_count);
+    return cursor.tape->entries[cursor.index];
+}
+
+HELIOS_INLINE GeTomlTapeTag GeTomlCursorTag(GeTomlCursor cursor) {
+    return GE_TOML_TAPE_TAG(_GeTomlCursorEntry(cursor));
+}
+
+// Only meaningful on values, not on keys or end entries.
+HELIOS_INLINE GeTomlValueType GeTomlCursorType(GeTomlCursor cursor) {
+    HELIOS_ASSERT(GeTomlCursorTag(cursor) < GeTomlValueType_Max);
+    return (GeTomlValueType)GeTomlCursorTag(cursor);
+}
+
+HELIOS_INLINE S64 GeTomlCursorInt(GeTomlCursor cursor) {
+    HELIOS_ASSERT(GeTomlCursorTag(cursor) == GeTomlValueType_Int);
+    return (S64)cursor.tape->entries[cursor.index + 1];
+}
+
+HELIOS_INLINE F64 GeTomlCursorFloat(GeTomlCursor cursor) {
+    HELIOS_ASSERT(GeTomlCursorTag(cursor) == GeTomlValueType_Float);
+    F64 f;
+    memcpy(&f, &cursor.tape->entries[cursor.index + 1], sizeof(f));
+    return f;
+}
+
+HELIOS_INLINE B32 GeTomlCursorBool(GeTomlCursor cursor) {
+    HELIOS_ASSERT(GeTomlCursorTag(cursor) == GeTomlValueType_Bool);
+    return (B32)GE_TOML_TAPE_PAYLOAD(_GeTomlCursorEntry(cursor));
+}
+
+HELIOS_INLINE HeliosStringView _GeTomlTapeString(const GeTomlTape *tape, U64 entry) {
+    const U8 *at = tape->strings + GE_TOML_TAPE_PAYLOAD(entry);
+    U32 count;
+    memcpy(&count, at, sizeof(count));
+
+    HeliosStringView sv;
+    sv.data = at + sizeof(count);
+    sv.count = count;
+    return sv;
+}
+
+HELIOS_INLINE HeliosStringView GeTomlCursorString(GeTomlCursor cursor) {
+    HELIOS_ASSERT(GeTomlCursorTag(cursor) == GeTomlValueType_String);
+    return _GeTomlTapeString(cursor.tape, _GeTomlCursorEntry(cursor));
+}
+
+// The key of a key entry, as visited when iterating a table.
+HELIOS_INLINE HeliosStringView GeTomlCursorKey(GeTomlCursor cursor) {
+    HELIOS_ASSERT(GeTomlCursorTag(cursor) == GeTomlTapeTag_Key);
+    return _GeTomlTapeString(cursor.tape, _GeTomlCursorEntry(cursor));
+}
+
+// The value of a key entry.
+HELIOS_INLINE GeTomlCursor GeTomlCursorValue(GeTomlCursor cursor) {
+    HELIOS_ASSERT(GeTomlCursorTag(cursor) == GeTomlTapeTag_Key);
+    ++cursor.index;
+    return cursor;
+}
+
+// The items of an array or the keys of a table.
+HELIOS_INLINE UZ GeTomlCursorCount(GeTomlCursor container) {
+    UZ count = (UZ)(GE_TOML_TAPE_PAYLOAD(_GeTomlCursorEntry(container)) >> 32);
+    return count < GE_TOML_TAPE_MAX_COUNT ? count : _GeTomlCursorCountSlow(container);
+}
+
+// The first item of an array or key of a table, at the end entry when there is none.
+HELIOS_INLINE GeTomlCursor GeTomlCursorFirst(GeTomlCursor container) {
+    HELIOS_ASSERT(GeTomlCursorTag(container) == GeTomlValueType_Array || GeTomlCursorTag(container) == GeTomlValueType_Table);
+    ++container.index;
+    return container;
+}
+
+HELIOS_INLINE B32 GeTomlCursorAtEnd(GeTomlCursor cursor) {
+    GeTomlTapeTag tag = GeTomlCursorTag(cursor);
+    return tag == GeTomlTapeTag_ArrayEnd || tag == GeTomlTapeTag_TableEnd;
+}
+
+// The next item of an array or key of a table, skipping over the value at `cursor`.
+HELIOS_INLINE GeTomlCursor GeTomlCursorNext(GeTomlCursor cursor) {
+    U64 entry = _GeTomlCursorEntry(cursor);
+    GeTomlTapeTag tag = GE_TOML_TAPE_TAG(entry);
+    if (tag == GeTomlTapeTag_Key) {
+        ++cursor.index;
+        entry = _GeTomlCursorEntry(cursor);
+        tag = GE_TOML_TAPE_TAG(entry);
+    }
+
+    switch (tag) {
+    case GeTomlValueType_Int:
+    case GeTomlValueType_Float: cursor.index += 2; break;
+    case GeTomlValueType_Array:
+    case GeTomlValueType_Table: cursor.index = (UZ)(U32)entry + 1; break;
+    default: cursor.index += 1; break;
+    }
+    return cursor;
+}
 #endif // ASTRON_GE_USE_TOML
 
 #ifdef __cplusplus
@@ -165,8 +361,20 @@ typedef struct GeTomlParsingContext {
     char *err_buf;
     UZ err_buf_count;
     HeliosAllocator allocator;
+    GeTomlParseFlags flags;
+    HeliosInterner *interner;
 } GeTomlParsingContext;
 
+HELIOS_INTERNAL HeliosStringView _GeTomlStoreString(GeTomlParsingContext *ctx, HeliosStringView sv) {
+    if (ctx->flags & GeTomlParseFlag_BorrowStrings) return sv;
+    return HeliosStringViewClone(ctx->allocator, sv);
+}
+
+HELIOS_INTERNAL HeliosStringView _GeTomlStoreKey(GeTomlParsingContext *ctx, HeliosStringView sv) {
+    if (ctx->interner == NULL) return _GeTomlStoreString(ctx, sv);
+    return HeliosInternerString(ctx->interner, HeliosInternerIntern(ctx->interner, sv));
+}
+
 HELIOS_DEF GeTomlValue *GeTomlTableFindSV(GeTomlTable *table, HeliosStringView key) {
     for (; table != NULL; table = table->next) {
         if (HeliosStringViewEqual(table->key, key)) return &table->value;
@@ -175,6 +383,16 @@ HELIOS_DEF GeTomlValue *GeTomlTableFindSV(GeTomlTable *table, HeliosStringView k
     return NULL;
 }
 
+HELIOS_DEF GeTomlValue *GeTomlTableFindId(GeTomlTable *table, HeliosInternId id) {
+    if (id == HELIOS_INTERN_ID_NONE) return NULL;
+
+    for (; table != NULL; table = table->next) {
+        if (table->key_id == id) return &table->value;
+    }
+
+    return NULL;
+}
+
 HELIOS_DEF GeTomlValue *GeTomlTableFind(GeTomlTable *table, const char *key) {
     UZ sv_count = strlen(key);
     HeliosStringView sv = { .data = (const U8 *)key, .count = sv_count };
@@ -276,9 +494,7 @@ HELIOS_INTERNAL B32 _GeTomlNextToken(HeliosString8Stream *s, GeTomlToken *token)
     }
     case '"': {
         UZ start = s->byte_offset + 1;
-        while (HeliosString8StreamNext(s, &cur_char)) {
-            if (cur_char == '"') break;
-        }
+        HeliosString8StreamSkipTo(s, '"');
         UZ end = s->byte_offset;
 
         if (s->byte_offset >= s->count) {
@@ -312,7 +528,7 @@ HELIOS_INTERNAL B32 _GeTomlNextToken(HeliosString8Stream *s, GeTomlToken *token)
         return 1;
     }
     case '#': {
-        while (HeliosString8StreamNext(s, &cur_char) && cur_char != '\n');
+        HeliosString8StreamSkipTo(s, '\n');
         return _GeTomlNextToken(s, token);
     }
     default: {
@@ -426,7 +642,7 @@ HELIOS_INTERNAL HELIOS_INLINE void _GeTomlAdvanceTokens(HeliosString8Stream *s)
 #define TOML_ARRAY_GROW_FACTOR(x) ((((x) + 1) * 3) >> 1)
 
 HELIOS_INLINE void GeTomlArrayInit(GeTomlArray *arr, HeliosAllocator allocator, UZ cap) {
-    arr->items = (GeTomlValue *)HeliosAlloc(allocator, sizeof(GeTomlValue) * cap);
+    arr->items = (GeTomlValue *)HeliosAllocUninit(allocator, sizeof(GeTomlValue) * cap);
     arr->capacity = cap;
     arr->count = 0;
     arr->allocator = allocator;
@@ -473,7 +689,7 @@ typedef struct GeTomlKey {
 } GeTomlKey;
 
 HELIOS_INTERNAL void GeTomlKeyInit(HeliosAllocator allocator, GeTomlKey *key, UZ cap) {
-    key->items = HeliosAlloc(allocator, sizeof(HeliosStringView) * cap);
+    key->items = HeliosAllocUninit(allocator, sizeof(HeliosStringView) * cap);
     key->count = 0;
     key->capacity = cap;
     key->allocator = allocator;
@@ -503,13 +719,7 @@ HELIOS_INTERNAL B32 _GeTomlParseKey(GeTomlParsingContext *ctx, GeTomlKey *out_ke
             GE_TOML_BAIL_ON_TOKEN(*ctx, cur_token, "expected an identifier");
         }
 
-        UZ key_part_count = cur_token.value.count;
-        U8 *key_part_data = (U8 *)HeliosAlloc(ctx->allocator, key_part_count);
-        memcpy(key_part_data, cur_token.value.data, key_part_count);
-
-        HeliosStringView key_part = { .count = key_part_count, .data = key_part_data };
-
-        GeTomlKeyPush(out_key, key_part);
+        GeTomlKeyPush(out_key, _GeTomlStoreKey(ctx, cur_token.value));
 
         if (!_GeTomlPeekToken(&ctx->stream, &cur_token) || cur_token.type != GeTomlTokenType_Dot) break;
         _GeTomlAdvanceTokens(&ctx->stream);
@@ -518,18 +728,33 @@ HELIOS_INTERNAL B32 _GeTomlParseKey(GeTomlParsingContext *ctx, GeTomlKey *out_ke
     return 1;
 }
 
-HELIOS_INTERNAL GeTomlValue *_GeTomlTableInsert(HeliosAllocator allocator, GeTomlTable *table, HeliosStringView key, GeTomlValue value) {
+// Interned keys are unique per string, so comparing their pointers is enough.
+HELIOS_INTERNAL GeTomlValue *_GeTomlTableFindKey(GeTomlParsingContext *ctx, GeTomlTable *table, HeliosStringView key) {
+    if (ctx->interner == NULL) return GeTomlTableFindSV(table, key);
+
+    for (; table != NULL; table = table->next) {
+        if (table->key.data == key.data) return &table->value;
+    }
+
+    return NULL;
+}
+
+HELIOS_INTERNAL GeTomlValue *_GeTomlTableInsert(GeTomlParsingContext *ctx, GeTomlTable *table, HeliosStringView key, GeTomlValue value) {
+    HeliosInternId key_id = ctx->interner != NULL ? HeliosInternerIdOf(key) : HELIOS_INTERN_ID_NONE;
+
     // Check if the current table node is empty, and use it in that case.
     if (table->key.data == NULL) {
         table->key = key;
+        table->key_id = key_id;
         table->value = value;
         return &table->value;
     }
 
     for (; table->next != NULL; table = table->next);
 
-    table->next = (GeTomlTable *)HeliosAlloc(allocator, sizeof(GeTomlTable));
+    table->next = (GeTomlTable *)HeliosAlloc(ctx->allocator, sizeof(GeTomlTable));
     table->next->key = key;
+    table->next->key_id = key_id;
     table->next->value = value;
 
     return &table->next->value;
@@ -549,7 +774,7 @@ HELIOS_INTERNAL GeTomlValue *_GeTomlTableInsertKey(GeTomlParsingContext *ctx,
         HeliosStringView subtable_name = key.items[i];
         GeTomlTable *subtable;
 
-        GeTomlValue *existing_subtable_value = GeTomlTableFindSV(cur_table, subtable_name);
+        GeTomlValue *existing_subtable_value = _GeTomlTableFindKey(ctx, cur_table, subtable_name);
         if (existing_subtable_value) {
             if (existing_subtable_value->type != GeTomlValueType_Table) {
                 GE_TOML_BAIL_ON_STREAM_FMT(*ctx, "expected key '" HELIOS_SV_FMT "' to refer to a table", HELIOS_SV_ARG(subtable_name));
@@ -562,18 +787,18 @@ HELIOS_INTERNAL GeTomlValue *_GeTomlTableInsertKey(GeTomlParsingContext *ctx,
                 .type = GeTomlValueType_Table,
                 .t = subtable,
             };
-            _GeTomlTableInsert(ctx->allocator, cur_table, subtable_name, subtable_value);
+            _GeTomlTableInsert(ctx, cur_table, subtable_name, subtable_value);
         }
 
         cur_table = subtable;
     }
 
-    GeTomlValue *existing_value_for_key = GeTomlTableFindSV(cur_table, leaf_key);
+    GeTomlValue *existing_value_for_key = _GeTomlTableFindKey(ctx, cur_table, leaf_key);
     if (existing_value_for_key != NULL) {
         GE_TOML_BAIL_ON_STREAM_FMT(*ctx, "cannot redefine key '" HELIOS_SV_FMT "'", HELIOS_SV_ARG(leaf_key));
     }
 
-    return _GeTomlTableInsert(ctx->allocator, cur_table, leaf_key, value);
+    return _GeTomlTableInsert(ctx, cur_table, leaf_key, value);
 }
 
 HELIOS_INTERNAL B32 _GeTomlParseKeyValue(GeTomlParsingContext *ctx, GeTomlKey *key, GeTomlValue *value);
@@ -584,7 +809,7 @@ HELIOS_INTERNAL B32 _GeTomlParseValue(GeTomlParsingContext *ctx, GeTomlValue *ou
 
     switch (cur_token.type) {
     case GeTomlTokenType_String: {
-        HeliosStringView s = HeliosStringViewClone(ctx->allocator, cur_token.value);
+        HeliosStringView s = _GeTomlStoreString(ctx, cur_token.value);
 
         *out = (GeTomlValue) {
             .type = GeTomlValueType_String,
@@ -740,11 +965,25 @@ HELIOS_DEF GeTomlTable *GeTomlParseBuffer(HeliosAllocator allocator,
                                           UZ buf_count,
                                           char *err_buf,
                                           UZ err_buf_count) {
+    GeTomlParseOptions options = {0};
+    return GeTomlParseBufferEx(allocator, buf, buf_count, &options, err_buf, err_buf_count);
+}
+
+HELIOS_DEF GeTomlTable *GeTomlParseBufferEx(HeliosAllocator allocator,
+                                            const char *buf,
+                                            UZ buf_count,
+                                            const GeTomlParseOptions *options,
+                                            char *err_buf,
+                                            UZ err_buf_count) {
+    HELIOS_PROFILE_SCOPE("GeTomlParseBuffer");
+
     GeTomlParsingContext ctx;
     HeliosString8StreamInit(&ctx.stream, (const U8 *)buf, buf_count);
     ctx.err_buf = err_buf;
     ctx.err_buf_count = err_buf_count;
     ctx.allocator = allocator;
+    ctx.flags = options->flags;
+    ctx.interner = options->interner;
 
     GeTomlTable *root_table = (GeTomlTable *)HeliosAlloc(ctx.allocator, sizeof(GeTomlTable));
 
@@ -754,6 +993,8 @@ HELIOS_DEF GeTomlTable *GeTomlParseBuffer(HeliosAllocator allocator,
     while (_GeTomlNextToken(&ctx.stream, &cur_token)) {
         switch (cur_token.type) {
         case GeTomlTokenType_LeftBracket: {
+            HELIOS_PROFILE_SCOPE("GeTomlParseTableHeader");
+
             GeTomlKey child_table_key;
 
             if (!_GeTomlParseKey(&ctx, &child_table_key)) return NULL;
@@ -775,10 +1016,12 @@ HELIOS_DEF GeTomlTable *GeTomlParseBuffer(HeliosAllocator allocator,
                 .t = child_table,
             };
 
+            HELIOS_PROFILE_BEGIN("GeTomlTableInsert");
             GeTomlValue *child_table_value_in_table = _GeTomlTableInsertKey(&ctx,
                                                                             root_table,
                                                                             child_table_key,
                                                                             child_table_value);
+            HELIOS_PROFILE_END("GeTomlTableInsert");
             if (child_table_value_in_table == NULL) return NULL;
             HELIOS_ASSERT(child_table_value_in_table->type == GeTomlValueType_Table);
             current_table = child_table_value_in_table->t;
@@ -786,9 +1029,11 @@ HELIOS_DEF GeTomlTable *GeTomlParseBuffer(HeliosAllocator allocator,
         }
         case GeTomlTokenType_Newline: break;
         default: {
+            HELIOS_PROFILE_SCOPE("GeTomlParseKeyValue");
+
             if (cur_token.type != GeTomlTokenType_Identifier) GE_TOML_BAIL_ON_TOKEN(ctx, cur_token, "expected an identifier");
 
-            HeliosStringView key = HeliosStringViewClone(allocator, cur_token.value);
+            HeliosStringView key = _GeTomlStoreKey(&ctx, cur_token.value);
 
             GE_TOML_NEXT_TOKEN_OR_BAIL(ctx, cur_token);
 
@@ -801,7 +1046,9 @@ HELIOS_DEF GeTomlTable *GeTomlParseBuffer(HeliosAllocator allocator,
                 GE_TOML_BAIL_ON_TOKEN(ctx, cur_token, "expected a newline");
             }
 
-            _GeTomlTableInsert(ctx.allocator, current_table, key, value);
+            HELIOS_PROFILE_BEGIN("GeTomlTableInsert");
+            _GeTomlTableInsert(&ctx, current_table, key, value);
+            HELIOS_PROFILE_END("GeTomlTableInsert");
             break;
         }
         }
@@ -810,6 +1057,284 @@ HELIOS_DEF GeTomlTable *GeTomlParseBuffer(HeliosAllocator allocator,
     return root_table;
 }
 
+HELIOS_DEF GeTomlTable *GeTomlParseFile(HeliosAllocator allocator,
+                                        HeliosStringView path,
+                                        HeliosMappedFile *out_file,
+                                        char *err_buf,
+                                        UZ err_buf_count) {
+    HELIOS_PROFILE_BEGIN("GeTomlMapFile");
+    B32 mapped = HeliosMapFile(path, out_file);
+    HELIOS_PROFILE_END("GeTomlMapFile");
+
+    if (!mapped) {
+        snprintf(err_buf, err_buf_count, "could not map file '" HELIOS_SV_FMT "'", HELIOS_SV_ARG(path));
+        return NULL;
+    }
+
+    GeTomlParseOptions options = { .flags = GeTomlParseFlag_BorrowStrings };
+    GeTomlTable *table = GeTomlParseBufferEx(allocator,
+                                             (const char *)out_file->contents.data,
+                                             out_file->contents.count,
+                                             &options,
+                                             err_buf,
+                                             err_buf_count);
+    if (table == NULL) HeliosUnmapFile(out_file);
+
+    return table;
+}
+
+#define _GE_TOML_TAPE_STRING_SIZE(count) (sizeof(U32) + (count) + 1)
+
+HELIOS_INTERNAL void _GeTomlTapeMeasureTable(const GeTomlTable *table, UZ *entries, UZ *strings);
+
+HELIOS_INTERNAL void _GeTomlTapeMeasureValue(const GeTomlValue *value, UZ *entries, UZ *strings) {
+    switch (value->type) {
+    case GeTomlValueType_Int:
+    case GeTomlValueType_Float: *entries += 2; break;
+    case GeTomlValueType_Bool: *entries += 1; break;
+    case GeTomlValueType_String: {
+        *entries += 1;
+        *strings += _GE_TOML_TAPE_STRING_SIZE(value->s.count);
+        break;
+    }
+    case GeTomlValueType_Array: {
+        *entries += 2;
+        for (UZ i = 0; i < value->a.count; ++i) _GeTomlTapeMeasureValue(&value->a.items[i], entries, strings);
+        break;
+    }
+    case GeTomlValueType_Table: _GeTomlTapeMeasureTable(value->t, entries, strings); break;
+    default: HELIOS_PANIC("Date times aren't supported yet");
+    }
+}
+
+// Fresh tables start out with an empty node, which is skipped.
+HELIOS_INTERNAL void _GeTomlTapeMeasureTable(const GeTomlTable *table, UZ *entries, UZ *strings) {
+    *entries += 2;
+    for (; table != NULL; table = table->next) {
+        if (table->key.data == NULL) continue;
+        *entries += 1;
+        *strings += _GE_TOML_TAPE_STRING_SIZE(table->key.count);
+        _GeTomlTapeMeasureValue(&table->value, entries, strings);
+    }
+}
+
+HELIOS_INTERNAL HELIOS_INLINE U64 _GeTomlTapeEntry(GeTomlTapeTag tag, U64 payload) {
+    return ((U64)tag << GE_TOML_TAPE_PAYLOAD_BITS) | payload;
+}
+
+HELIOS_INTERNAL void _GeTomlTapeEmitString(GeTomlTape *tape, GeTomlTapeTag tag, HeliosStringView sv) {
+    HELIOS_VERIFY(sv.count <= UINT32_MAX);
+    tape->entries[tape->entry_count++] = _GeTomlTapeEntry(tag, tape->strings_count);
+
+    U32 count = (U32)sv.count;
+    U8 *at = tape->strings + tape->strings_count;
+    memcpy(at, &count, sizeof(count));
+    memcpy(at + sizeof(count), sv.data, sv.count);
+    at[sizeof(count) + sv.count] = '\0';
+    tape->strings_count += _GE_TOML_TAPE_STRING_SIZE(sv.count);
+}
+
+HELIOS_INTERNAL void _GeTomlTapeEmitEnd(GeTomlTape *tape, UZ start, GeTomlTapeTag end_tag, UZ count) {
+    UZ end = tape->entry_count++;
+    U64 saturated = HELIOS_MIN(count, (UZ)GE_TOML_TAPE_MAX_COUNT);
+    tape->entries[start] = _GeTomlTapeEntry(GE_TOML_TAPE_TAG(tape->entries[start]), (saturated << 32) | end);
+    tape->entries[end] = _GeTomlTapeEntry(end_tag, start);
+}
+
+HELIOS_INTERNAL void _GeTomlTapeEmitTable(GeTomlTape *tape, const GeTomlTable *table);
+
+HELIOS_INTERNAL void _GeTomlTapeEmitValue(GeTomlTape *tape, const GeTomlValue *value) {
+    switch (value->type) {
+    case GeTomlValueType_Int: {
+        tape->entries[tape->entry_count++] = _GeTomlTapeEntry(GeTomlValueType_Int, 0);
+        tape->entries[tape->entry_count++] = (U64)value->i;
+        break;
+    }
+    case GeTomlValueType_Float: {
+        tape->entries[tape->entry_count++] = _GeTomlTapeEntry(GeTomlValueType_Float, 0);
+        memcpy(&tape->entries[tape->entry_count++], &value->f, sizeof(value->f));
+        break;
+    }
+    case GeTomlValueType_Bool: {
+        tape->entries[tape->entry_count++] = _GeTomlTapeEntry(GeTomlValueType_Bool, value->b != 0);
+        break;
+    }
+    case GeTomlValueType_String: _GeTomlTapeEmitString(tape, GeTomlValueType_String, value->s); break;
+    case GeTomlValueType_Array: {
+        UZ start = tape->entry_count++;
+        tape->entries[start] = _GeTomlTapeEntry(GeTomlValueType_Array, 0);
+        for (UZ i = 0; i < value->a.count; ++i) _GeTomlTapeEmitValue(tape, &value->a.items[i]);
+        _GeTomlTapeEmitEnd(tape, start, GeTomlTapeTag_ArrayEnd, value->a.count);
+        break;
+    }
+    case GeTomlValueType_Table: _GeTomlTapeEmitTable(tape, value->t); break;
+    default: HELIOS_UNREACHABLE();
+    }
+}
+
+HELIOS_INTERNAL void _GeTomlTapeEmitTable(GeTomlTape *tape, const GeTomlTable *table) {
+    UZ start = tape->entry_count++;
+    tape->entries[start] = _GeTomlTapeEntry(GeTomlValueType_Table, 0);
+
+    UZ count = 0;
+    for (; table != NULL; table = table->next) {
+        if (table->key.data == NULL) continue;
+        _GeTomlTapeEmitString(tape, GeTomlTapeTag_Key, table->key);
+        _GeTomlTapeEmitValue(tape, &table->value);
+        ++count;
+    }
+    _GeTomlTapeEmitEnd(tape, start, GeTomlTapeTag_TableEnd, count);
+}
+
+HELIOS_DEF void GeTomlTapeFromTable(GeTomlTape *tape, HeliosAllocator allocator, const GeTomlTable *table) {
+    HELIOS_PROFILE_SCOPE("GeTomlTapeFromTable");
+
+    // Measuring first sizes both arrays exactly, which saves growing them while emitting.
+    UZ entry_count = 0;
+    UZ strings_count = 0;
+    _GeTomlTapeMeasureTable(table, &entry_count, &strings_count);
+    HELIOS_VERIFY(entry_count <= UINT32_MAX);
+
+    tape->allocator = allocator;
+    tape->entries = (U64 *)HeliosAllocUninit(allocator, sizeof(U64) * entry_count);
+    tape->strings = (U8 *)HeliosAllocUninit(allocator, strings_count);
+    tape->entry_count = 0;
+    tape->strings_count = 0;
+
+    _GeTomlTapeEmitTable(tape, table);
+    HELIOS_ASSERT(tape->entry_count == entry_count && tape->strings_count == strings_count);
+}
+
+// The linked tables of one parse live in a chain of blocks that grows as needed and goes away all at once.
+// A fixed reservation is never safe here, an empty array costs the parser hundreds of times its source bytes.
+typedef struct _GeTomlScratchBlock {
+    struct _GeTomlScratchBlock *prev;
+    UZ capacity;
+} _GeTomlScratchBlock;
+
+#define _GE_TOML_SCRATCH_FIRST_BLOCK (1024 * 64)
+
+typedef struct _GeTomlScratch {
+    _GeTomlScratchBlock *block;
+    UZ offset;
+    // Offset of the most recent allocation in `block`, which can be grown in place.
+    UZ last_offset;
+} _GeTomlScratch;
+
+HELIOS_INTERNAL void *_GeTomlScratchAlloc(void *user, UZ size) {
+    _GeTomlScratch *scratch = (_GeTomlScratch *)user;
+    UZ offset = HeliosRoundUp(scratch->offset, HELIOS_ARENA_ALIGNMENT);
+
+    if (scratch->block == NULL || offset + size > scratch->block->capacity) {
+        UZ header = HeliosRoundUp(sizeof(_GeTomlScratchBlock), HELIOS_ARENA_ALIGNMENT);
+        UZ capacity = scratch->block != NULL ? scratch->block->capacity * 2 : _GE_TOML_SCRATCH_FIRST_BLOCK;
+        capacity = HeliosRoundUp(HELIOS_MAX(capacity, header + size), HELIOS_PAGE_ALIGNMENT);
+
+        _GeTomlScratchBlock *block = (_GeTomlScratchBlock *)HeliosRawAllocAligned(capacity, HELIOS_PAGE_ALIGNMENT);
+        HELIOS_VERIFY(block != NULL);
+        block->prev = scratch->block;
+        block->capacity = capacity;
+
+        scratch->block = block;
+        offset = header;
+    }
+
+    scratch->last_offset = offset;
+    scratch->offset = offset + size;
+    return (U8 *)scratch->block + offset;
+}
+
+HELIOS_INTERNAL void *_GeTomlScratchAllocZeroed(void *user, UZ size) {
+    void *ptr = _GeTomlScratchAlloc(user, size);
+    memset(ptr, 0, size);
+    return ptr;
+}
+
+HELIOS_INTERNAL void *_GeTomlScratchRealloc(void *user, void *old_ptr, UZ old_size, UZ size) {
+    _GeTomlScratch *scratch = (_GeTomlScratch *)user;
+    if (old_ptr != NULL && (U8 *)old_ptr == (U8 *)scratch->block + scratch->last_offset &&
+        scratch->last_offset + size <= scratch->block->capacity) {
+        scratch->offset = scratch->last_offset + size;
+        return old_ptr;
+    }
+
+    void *new_ptr = _GeTomlScratchAlloc(user, size);
+    if (old_ptr != NULL) memcpy(new_ptr, old_ptr, HELIOS_MIN(old_size, size));
+    return new_ptr;
+}
+
+HELIOS_INTERNAL void _GeTomlScratchFree(void *user, void *ptr, UZ size) {
+    // Everything goes back at once in `_GeTomlScratchRelease`.
+    HELIOS_UNUSED(user);
+    HELIOS_UNUSED(ptr);
+    HELIOS_UNUSED(size);
+}
+
+HELIOS_INTERNAL void _GeTomlScratchRelease(_GeTomlScratch *scratch) {
+    while (scratch->block != NULL) {
+        _GeTomlScratchBlock *prev = scratch->block->prev;
+        HeliosRawFree(scratch->block, scratch->block->capacity);
+        scratch->block = prev;
+    }
+}
+
+HELIOS_DEF B32 GeTomlTapeParseBuffer(GeTomlTape *tape,
+                                     HeliosAllocator allocator,
+                                     const char *buf,
+                                     UZ buf_count,
+                                     char *err_buf,
+                                     UZ err_buf_count) {
+    HELIOS_PROFILE_SCOPE("GeTomlTapeParseBuffer");
+
+    _GeTomlScratch scratch = {0};
+    HeliosAllocator scratch_allocator = {
+        .data = (void *)&scratch,
+        .vtable = (HeliosAllocatorVTable) {
+            .alloc = _GeTomlScratchAlloc,
+            .free = _GeTomlScratchFree,
+            .realloc = _GeTomlScratchRealloc,
+            .alloc_zeroed = _GeTomlScratchAllocZeroed,
+        },
+    };
+
+    // The strings are copied into the tape, so the linked tables can borrow them from the buffer.
+    GeTomlParseOptions options = { .flags = GeTomlParseFlag_BorrowStrings };
+    GeTomlTable *table = GeTomlParseBufferEx(scratch_allocator, buf, buf_count, &options, err_buf, err_buf_count);
+    if (table != NULL) GeTomlTapeFromTable(tape, allocator, table);
+
+    _GeTomlScratchRelease(&scratch);
+    return table != NULL;
+}
+
+HELIOS_DEF void GeTomlTapeFree(GeTomlTape *tape) {
+    HeliosFree(tape->allocator, tape->entries, sizeof(U64) * tape->entry_count);
+    HeliosFree(tape->allocator, tape->strings, tape->strings_count);
+}
+
+HELIOS_DEF B32 GeTomlCursorFindSV(GeTomlCursor table, HeliosStringView key, GeTomlCursor *out) {
+    for (GeTomlCursor cursor = GeTomlCursorFirst(table); !GeTomlCursorAtEnd(cursor); cursor = GeTomlCursorNext(cursor)) {
+        if (HeliosStringViewEqual(GeTomlCursorKey(cursor), key)) {
+            *out = GeTomlCursorValue(cursor);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+HELIOS_DEF B32 GeTomlCursorFind(GeTomlCursor table, const char *key, GeTomlCursor *out) {
+    HeliosStringView sv = { .data = (const U8 *)key, .count = strlen(key) };
+    return GeTomlCursorFindSV(table, sv, out);
+}
+
+HELIOS_DEF UZ _GeTomlCursorCountSlow(GeTomlCursor container) {
+    UZ count = 0;
+    for (GeTomlCursor cursor = GeTomlCursorFirst(container); !GeTomlCursorAtEnd(cursor); cursor = GeTomlCursorNext(cursor)) {
+        ++count;
+    }
+    return count;
+}
+
 #endif // ASTRON_GE_USE_TOML
 #endif // ASTRON_GE_IMPLEMENTATION
 
@@ -5,9 +5,13 @@
 extern "C" {
 #endif // __cplusplus
 
+// Writes out pending log messages before the crash macros below print and abort.
+void _HeliosLogCrashFlush(void);
+
 #ifndef HELIOS_STRIP_ASSERTS
 #    define HELIOS_ASSERT(cond) do {                                        \
             if (!(cond)) {                                                  \
+                _HeliosLogCrashFlush();                                     \
                 fprintf(stderr, "%s:%d: ASSERTION FAILED: %s\n", __FILE__, __LINE__, #cond); \
                 abort();                                                    \
             }                                                               \
@@ -19,6 +23,7 @@ extern "C" {
 
 #define HELIOS_VERIFY(cond) do {                                        \
         if (!(cond)) {                                                  \
+            _HeliosLogCrashFlush();                                     \
             fprintf(stderr, "%s:%d: VERIFICATION FAILED: %s\n", __FILE__, __LINE__, #cond); \
             abort();                                                    \
         }                                                               \
@@ -27,21 +32,25 @@ extern "C" {
 #define HELIOS_UNUSED(x) (void)(x)
 
 #define HELIOS_TODO() do {                                      \
+        _HeliosLogCrashFlush();                                 \
         fprintf(stderr, "%s:%d: TODO\n", __FILE__, __LINE__);     \
         abort();                                                \
     } while (0)
 
 #define HELIOS_PANIC(msg) do {                                      \
+        _HeliosLogCrashFlush();                                     \
         fprintf(stderr, "%s:%d: PROGRAM PANICKED: %s\n", __FILE__, __LINE__, msg);     \
         abort();                                                \
     } while (0)
 
 #define HELIOS_PANIC_FMT(fmt, ...) do {                                     \
+        _HeliosLogCrashFlush();                                             \
         fprintf(stderr, "%s:%d: PROGRAM PANICKED: " fmt "\n", __FILE__, __LINE__, __VA_ARGS__);     \
         abort();                                                \
     } while (0)
 
 #define HELIOS_UNREACHABLE() do {                                      \
+        _HeliosLogCrashFlush();                                        \
         fprintf(stderr, "%s:%d: ENCOUNTERED UNREACHABLE CODE\n", __FILE__, __LINE__);     \
         abort();                                                \
     } while (0)
@@ -61,21 +70,42 @@ extern "C" {
 #    define WIN32_LEAN_AND_MEAN
 #    define _CRT_SECURE_NO_WARNINGS
 #    include <windows.h>
+#    include <intrin.h>
+#    include <io.h>
 #else
 #    define HELIOS_PLATFORM_POSIX
 #    define HELIOS_PAGE_ALIGNMENT (1024 * 4)
 
 #    include <fcntl.h>
 #    include <unistd.h>
+#    include <pthread.h>
+#    include <sched.h>
 #    include <sys/stat.h>
 #    include <sys/mman.h>
+#    include <sys/uio.h>
+
+#    if defined(__linux__)
+#        include <linux/futex.h>
+#        include <sys/syscall.h>
+#    endif // __linux__
+
+#    if defined(__linux__) && defined(__has_include) && !defined(HELIOS_NO_IO_URING)
+#        if __has_include(<linux/io_uring.h>)
+#            include <linux/io_uring.h>
+#            include <sys/syscall.h>
+// Older headers lack the opcodes we need.
+#            if defined(IORING_FEAT_FAST_POLL) && defined(__NR_io_uring_setup)
+#                define HELIOS_HAS_IO_URING
+#            endif
+#        endif
+#    endif // __linux__
 #endif // _WIN32
 
 #if defined(__clang__)
 #    define HELIOS_COMPILER_CLANG
 #elif defined(__GNUC__)
 #    define HELIOS_COMPILER_GCC
-#elif defined(_MSVC_VER)
+#elif defined(_MSC_VER)
 #    define HELIOS_COMPILER_MSVC
 #endif
 
@@ -85,6 +115,23 @@ extern "C" {
 #    define HELIOS_ANNOTATE_PRINTF(fmt, args)
 #endif
 
+#if defined(HELIOS_COMPILER_MSVC)
+#    define HELIOS_THREAD_LOCAL __declspec(thread)
+#else
+#    define HELIOS_THREAD_LOCAL __thread
+#endif // HELIOS_COMPILER_MSVC
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#    define HELIOS_ARCH_X86
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#    define HELIOS_ARCH_ARM64
+#endif // architecture check
+
+#if defined(HELIOS_ARCH_X86) && !defined(HELIOS_COMPILER_MSVC)
+#    include <immintrin.h>
+#    include <cpuid.h>
+#endif // HELIOS_ARCH_X86 && !HELIOS_COMPILER_MSVC
+
 #define HELIOS_INTERNAL static
 
 #ifdef HELIOS_STATIC
@@ -123,6 +170,9 @@ extern "C" {
 #include <string.h>
 #include <ctype.h>
 #include <stdarg.h>
+#include <stddef.h>
+#include <errno.h>
+#include <time.h>
 
 typedef uint8_t  U8;
 typedef uint16_t U16;
@@ -158,10 +208,13 @@ typedef double F64;
 #    error "your 'long' size is crazy"
 #endif // long size check
 
+// NOTE: `alloc` returns memory with unspecified contents. Allocators that can hand out zeroed
+// memory cheaper than a memset (fresh pages, calloc) should also provide `alloc_zeroed`.
 typedef struct HeliosAllocatorVTable {
     void *(*alloc)(void*, UZ);              // required
     void  (*free)(void*, void*, UZ);        // required
     void *(*realloc)(void*, void*, UZ, UZ); // optional
+    void *(*alloc_zeroed)(void*, UZ);       // optional
 } HeliosAllocatorVTable;
 
 typedef struct HeliosAllocator {
@@ -170,11 +223,31 @@ typedef struct HeliosAllocator {
 } HeliosAllocator;
 
 void *HeliosRawAlloc(UZ);
+// Unlike `HeliosRawAlloc`, which hands back whatever mmap returned, this returns NULL on failure.
+void *HeliosRawAllocAligned(UZ, UZ);
+void HeliosRawFree(void *, UZ);
 
-HELIOS_INLINE void *HeliosAlloc(HeliosAllocator allocator, UZ size) {
+// Address space reservation without backing memory. Reserved ranges are released with `HeliosRawFree`.
+void *HeliosRawReserve(UZ size, UZ align);
+B32 HeliosRawCommit(void *, UZ);
+void HeliosRawDecommit(void *, UZ);
+
+HELIOS_INLINE void *HeliosAllocUninit(HeliosAllocator allocator, UZ size) {
     return allocator.vtable.alloc(allocator.data, size);
 }
 
+HELIOS_INLINE void *HeliosAllocZeroed(HeliosAllocator allocator, UZ size) {
+    if (allocator.vtable.alloc_zeroed != NULL)
+        return allocator.vtable.alloc_zeroed(allocator.data, size);
+
+    return memset(allocator.vtable.alloc(allocator.data, size), 0, size);
+}
+
+// Zeroed allocation, use `HeliosAllocUninit` when the memory is going to be overwritten anyway.
+HELIOS_INLINE void *HeliosAlloc(HeliosAllocator allocator, UZ size) {
+    return HeliosAllocZeroed(allocator, size);
+}
+
 HELIOS_INLINE void HeliosFree(HeliosAllocator allocator, void *ptr, UZ size) {
     allocator.vtable.free(allocator.data, ptr, size);
 }
@@ -183,24 +256,657 @@ HELIOS_INLINE void *HeliosRealloc(HeliosAllocator allocator, void *old_ptr, UZ o
     if (allocator.vtable.realloc != NULL)
         return allocator.vtable.realloc(allocator.data, old_ptr, old_size, size);
 
-    void *new_ptr = HeliosAlloc(allocator, size);
-    memcpy(new_ptr, old_ptr, old_size);
+    void *new_ptr = HeliosAllocUninit(allocator, size);
+    memcpy(new_ptr, old_ptr, HELIOS_MIN(old_size, size));
     HeliosFree(allocator, old_ptr, old_size);
     return new_ptr;
 }
 
+typedef struct HeliosCallsite {
+    const char *file;
+    U32 line;
+} HeliosCallsite;
+
+// The source location of the allocation that is currently in flight, only set when compiling with
+// `HELIOS_TRACK_CALLSITES`. Consumed by `HeliosTrackingAllocator`.
+HELIOS_DEF HELIOS_THREAD_LOCAL HeliosCallsite helios_current_callsite;
+
+#ifdef HELIOS_TRACK_CALLSITES
+HELIOS_INLINE void _HeliosSetCallsite(const char *file, U32 line) {
+    helios_current_callsite.file = file;
+    helios_current_callsite.line = line;
+}
+
+#    define HeliosAlloc(allocator, size) (_HeliosSetCallsite(__FILE__, __LINE__), HeliosAlloc((allocator), (size)))
+#    define HeliosAllocUninit(allocator, size) (_HeliosSetCallsite(__FILE__, __LINE__), HeliosAllocUninit((allocator), (size)))
+#    define HeliosAllocZeroed(allocator, size) (_HeliosSetCallsite(__FILE__, __LINE__), HeliosAllocZeroed((allocator), (size)))
+#    define HeliosRealloc(allocator, ptr, old_size, size) \
+    (_HeliosSetCallsite(__FILE__, __LINE__), HeliosRealloc((allocator), (ptr), (old_size), (size)))
+#endif // HELIOS_TRACK_CALLSITES
+
+#define HELIOS_TRACKING_HISTOGRAM_BUCKETS 48
+#define HELIOS_TRACKING_MAX_CALLSITES 1024
+
+typedef struct HeliosTrackingCallsite {
+    HeliosCallsite callsite;
+    U64 count;
+    U64 bytes;
+} HeliosTrackingCallsite;
+
+// Forwards everything to the `inner` allocator and keeps statistics about the traffic. Not thread safe,
+// give every thread its own tracker. Callsites are only known with `HELIOS_TRACK_CALLSITES` defined,
+// otherwise everything is reported under a single unknown callsite.
+typedef struct HeliosTrackingAllocator {
+    HeliosAllocator inner;
+
+    U64 live_bytes;
+    U64 peak_bytes;
+    U64 total_bytes;
+    U64 alloc_count;
+    U64 realloc_count;
+    U64 free_count;
+
+    // Bucket `i` counts allocations with sizes in [2^(i - 1), 2^i), bucket 0 is for empty allocations.
+    U64 histogram[HELIOS_TRACKING_HISTOGRAM_BUCKETS];
+
+    HeliosTrackingCallsite callsites[HELIOS_TRACKING_MAX_CALLSITES];
+    UZ callsites_count;
+} HeliosTrackingAllocator;
+
+HELIOS_DEF void HeliosTrackingAllocatorInit(HeliosTrackingAllocator *, HeliosAllocator inner);
+HELIOS_DEF HeliosAllocator HeliosNewTrackingAllocator(HeliosTrackingAllocator *);
+HELIOS_DEF void HeliosTrackingAllocatorReport(HeliosTrackingAllocator *, FILE *);
+
 HeliosAllocator HeliosNewMallocAllocator(void);
 
 HELIOS_INLINE UZ HeliosRoundUp(UZ size, UZ align) {
     return size + ((align - (size & (align - 1))) & (align - 1));
 }
 
+#if defined(HELIOS_COMPILER_MSVC)
+HELIOS_INLINE U32 HeliosCountTrailingZerosU32(U32 x) {
+    unsigned long index;
+    return _BitScanForward(&index, x) ? (U32)index : 32;
+}
+
+HELIOS_INLINE U32 HeliosCountTrailingZerosU64(U64 x) {
+    unsigned long index;
+    return _BitScanForward64(&index, x) ? (U32)index : 64;
+}
+
+// `__popcnt` needs the instruction to be there, so count by hand.
+HELIOS_INLINE U32 HeliosPopCountU64(U64 x) {
+    x = x - ((x >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (U32)((x * 0x0101010101010101ull) >> 56);
+}
+
+HELIOS_INLINE U32 HeliosPopCountU32(U32 x) {
+    return HeliosPopCountU64(x);
+}
+#else
+HELIOS_INLINE U32 HeliosCountTrailingZerosU32(U32 x) {
+    return x != 0 ? (U32)__builtin_ctz(x) : 32;
+}
+
+HELIOS_INLINE U32 HeliosCountTrailingZerosU64(U64 x) {
+    return x != 0 ? (U32)__builtin_ctzll(x) : 64;
+}
+
+HELIOS_INLINE U32 HeliosPopCountU32(U32 x) {
+    return (U32)__builtin_popcount(x);
+}
+
+HELIOS_INLINE U32 HeliosPopCountU64(U64 x) {
+    return (U32)__builtin_popcountll(x);
+}
+#endif // HELIOS_COMPILER_MSVC
+
 HELIOS_INLINE UZ HeliosRoundDown(UZ size, UZ align) {
     return size - (size & (align - 1));
 }
 
 HeliosAllocator HeliosGetTempAllocator(void);
 
+#define HELIOS_ARENA_ALIGNMENT (sizeof(UZ) * 2)
+
+// A bump allocator over a single block of pages. All of its procedures are inline so it can be
+// used directly as an allocator type for the `_A` ermis generators, `HeliosNewArenaAllocator`
+// wraps it into a regular `HeliosAllocator`.
+typedef struct HeliosArena {
+    U8 *base;
+    UZ capacity;
+    UZ offset;
+    // Offset of the most recent allocation, which can be grown or freed in place.
+    UZ last_offset;
+    // Everything past this offset has never been handed out, and is still zeroed.
+    UZ dirty;
+} HeliosArena;
+
+HELIOS_DEF void HeliosArenaInit(HeliosArena *, UZ);
+HELIOS_DEF void HeliosArenaRelease(HeliosArena *);
+HELIOS_DEF HeliosAllocator HeliosNewArenaAllocator(HeliosArena *);
+
+HELIOS_INLINE void *HeliosArenaAlloc(HeliosArena *arena, UZ size) {
+    UZ offset = HeliosRoundUp(arena->offset, HELIOS_ARENA_ALIGNMENT);
+    HELIOS_VERIFY(offset + size <= arena->capacity);
+
+    arena->last_offset = offset;
+    arena->offset = offset + size;
+    if (arena->offset > arena->dirty) arena->dirty = arena->offset;
+
+    return arena->base + offset;
+}
+
+HELIOS_INLINE void *HeliosArenaAllocZeroed(HeliosArena *arena, UZ size) {
+    UZ dirty = arena->dirty;
+    U8 *ptr = (U8 *)HeliosArenaAlloc(arena, size);
+    UZ offset = arena->last_offset;
+
+    if (offset < dirty) memset(ptr, 0, HELIOS_MIN(size, dirty - offset));
+    return ptr;
+}
+
+HELIOS_INLINE void *HeliosArenaRealloc(HeliosArena *arena, void *old_ptr, UZ old_size, UZ size) {
+    if ((U8 *)old_ptr == arena->base + arena->last_offset && arena->last_offset + size <= arena->capacity) {
+        arena->offset = arena->last_offset + size;
+        if (arena->offset > arena->dirty) arena->dirty = arena->offset;
+        return old_ptr;
+    }
+
+    void *new_ptr = HeliosArenaAlloc(arena, size);
+    memcpy(new_ptr, old_ptr, HELIOS_MIN(old_size, size));
+    return new_ptr;
+}
+
+HELIOS_INLINE void HeliosArenaFree(HeliosArena *arena, void *ptr, UZ size) {
+    HELIOS_UNUSED(size);
+    // Only the most recent allocation can be given back.
+    if ((U8 *)ptr == arena->base + arena->last_offset) arena->offset = arena->last_offset;
+}
+
+HELIOS_INLINE void HeliosArenaReset(HeliosArena *arena) {
+    arena->offset = 0;
+    arena->last_offset = 0;
+}
+
+#define HELIOS_HUGE_PAGE_SIZE (1024 * 1024 * 2)
+#define HELIOS_VIRTUAL_ARENA_COMMIT_STEP (1024 * 64)
+
+typedef U32 HeliosVirtualArenaFlags;
+enum {
+    // Align the reservation and commit steps to 2MiB, and ask for transparent huge pages where possible.
+    HeliosVirtualArenaFlag_HugePages = 1 << 0,
+};
+
+// A bump allocator over a big address space reservation, that is committed step by step as it
+// grows. Popping back does not give memory back to the system, `HeliosVirtualArenaDecommit` does.
+// Just like `HeliosArena`, it can be used as an allocator type for the `_A` ermis generators.
+typedef struct HeliosVirtualArena {
+    U8 *base;
+    UZ reserved;
+    UZ committed;
+    UZ commit_step;
+    UZ offset;
+    UZ last_offset;
+    UZ dirty;
+    HeliosVirtualArenaFlags flags;
+} HeliosVirtualArena;
+
+HELIOS_DEF B32 HeliosVirtualArenaInit(HeliosVirtualArena *, UZ reserve_size, HeliosVirtualArenaFlags);
+HELIOS_DEF void HeliosVirtualArenaRelease(HeliosVirtualArena *);
+HELIOS_DEF void HeliosVirtualArenaCommitUpTo(HeliosVirtualArena *, UZ);
+HELIOS_DEF void HeliosVirtualArenaDecommit(HeliosVirtualArena *, UZ watermark);
+HELIOS_DEF HeliosAllocator HeliosNewVirtualArenaAllocator(HeliosVirtualArena *);
+
+HELIOS_INLINE void *HeliosVirtualArenaAlloc(HeliosVirtualArena *arena, UZ size) {
+    UZ offset = HeliosRoundUp(arena->offset, HELIOS_ARENA_ALIGNMENT);
+    UZ end = offset + size;
+    if (end > arena->committed) HeliosVirtualArenaCommitUpTo(arena, end);
+
+    arena->last_offset = offset;
+    arena->offset = end;
+    if (end > arena->dirty) arena->dirty = end;
+
+    return arena->base + offset;
+}
+
+HELIOS_INLINE void *HeliosVirtualArenaAllocZeroed(HeliosVirtualArena *arena, UZ size) {
+    UZ dirty = arena->dirty;
+    U8 *ptr = (U8 *)HeliosVirtualArenaAlloc(arena, size);
+    UZ offset = arena->last_offset;
+
+    if (offset < dirty) memset(ptr, 0, HELIOS_MIN(size, dirty - offset));
+    return ptr;
+}
+
+HELIOS_INLINE void *HeliosVirtualArenaRealloc(HeliosVirtualArena *arena, void *old_ptr, UZ old_size, UZ size) {
+    if ((U8 *)old_ptr == arena->base + arena->last_offset) {
+        UZ end = arena->last_offset + size;
+        if (end > arena->committed) HeliosVirtualArenaCommitUpTo(arena, end);
+
+        arena->offset = end;
+        if (end > arena->dirty) arena->dirty = end;
+        return old_ptr;
+    }
+
+    void *new_ptr = HeliosVirtualArenaAlloc(arena, size);
+    memcpy(new_ptr, old_ptr, HELIOS_MIN(old_size, size));
+    return new_ptr;
+}
+
+HELIOS_INLINE void HeliosVirtualArenaFree(HeliosVirtualArena *arena, void *ptr, UZ size) {
+    HELIOS_UNUSED(size);
+    if ((U8 *)ptr == arena->base + arena->last_offset) arena->offset = arena->last_offset;
+}
+
+HELIOS_INLINE UZ HeliosVirtualArenaPos(HeliosVirtualArena *arena) {
+    return arena->offset;
+}
+
+HELIOS_INLINE void HeliosVirtualArenaPopTo(HeliosVirtualArena *arena, UZ pos) {
+    HELIOS_ASSERT(pos <= arena->offset);
+    arena->offset = pos;
+    arena->last_offset = pos;
+}
+
+HELIOS_INLINE void HeliosVirtualArenaReset(HeliosVirtualArena *arena) {
+    HeliosVirtualArenaPopTo(arena, 0);
+}
+
+// Memory orders, numbered like the GCC/Clang `__ATOMIC_*` constants so they can be passed straight through.
+// Orders should be constants, so that the calls below collapse into single instructions.
+typedef enum HeliosMemoryOrder {
+    HeliosMemoryOrder_Relaxed = 0,
+    HeliosMemoryOrder_Acquire = 2,
+    HeliosMemoryOrder_Release = 3,
+    HeliosMemoryOrder_AcqRel  = 4,
+    HeliosMemoryOrder_SeqCst  = 5,
+} HeliosMemoryOrder;
+
+// A failed compare-exchange only loads, so it cannot have release semantics.
+HELIOS_INLINE HeliosMemoryOrder _HeliosMemoryOrderOnFailure(HeliosMemoryOrder order) {
+    if (order == HeliosMemoryOrder_Release) return HeliosMemoryOrder_Relaxed;
+    if (order == HeliosMemoryOrder_AcqRel) return HeliosMemoryOrder_Acquire;
+    return order;
+}
+
+#if defined(HELIOS_COMPILER_MSVC)
+// NOTE: Assumes x86/x64, where plain loads already acquire and plain stores already release.
+#    define _HELIOS_DEFINE_ATOMIC(T, name, word, suffix)                                                        \
+        typedef struct HeliosAtomic##name { volatile T value; } HeliosAtomic##name;                              \
+        HELIOS_INLINE T HeliosAtomicLoad##name(const HeliosAtomic##name *a, HeliosMemoryOrder order) {           \
+            (void)order;                                                                                         \
+            T value = a->value;                                                                                  \
+            _ReadWriteBarrier();                                                                                 \
+            return value;                                                                                        \
+        }                                                                                                        \
+        HELIOS_INLINE void HeliosAtomicStore##name(HeliosAtomic##name *a, T value, HeliosMemoryOrder order) {    \
+            if (order == HeliosMemoryOrder_SeqCst) {                                                             \
+                _InterlockedExchange##suffix((volatile word *)&a->value, (word)value);                           \
+            } else {                                                                                             \
+                _ReadWriteBarrier();                                                                             \
+                a->value = value;                                                                                \
+            }                                                                                                    \
+        }                                                                                                        \
+        HELIOS_INLINE T HeliosAtomicExchange##name(HeliosAtomic##name *a, T value, HeliosMemoryOrder order) {    \
+            (void)order;                                                                                         \
+            return (T)_InterlockedExchange##suffix((volatile word *)&a->value, (word)value);                     \
+        }                                                                                                        \
+        HELIOS_INLINE B32 HeliosAtomicCompareExchange##name(HeliosAtomic##name *a, T *expected, T desired,       \
+                                                             HeliosMemoryOrder order) {                          \
+            (void)order;                                                                                         \
+            T old = (T)_InterlockedCompareExchange##suffix((volatile word *)&a->value, (word)desired,            \
+                                                           (word)*expected);                                     \
+            if (old == *expected) return 1;                                                                      \
+            *expected = old;                                                                                     \
+            return 0;                                                                                            \
+        }                                                                                                        \
+        HELIOS_INLINE T HeliosAtomicFetchAdd##name(HeliosAtomic##name *a, T value, HeliosMemoryOrder order) {    \
+            (void)order;                                                                                         \
+            return (T)_InterlockedExchangeAdd##suffix((volatile word *)&a->value, (word)value);                  \
+        }                                                                                                        \
+        HELIOS_INLINE T HeliosAtomicFetchSub##name(HeliosAtomic##name *a, T value, HeliosMemoryOrder order) {    \
+            (void)order;                                                                                         \
+            return (T)_InterlockedExchangeAdd##suffix((volatile word *)&a->value, (word)(0 - value));            \
+        }                                                                                                        \
+        HELIOS_INLINE T HeliosAtomicFetchAnd##name(HeliosAtomic##name *a, T value, HeliosMemoryOrder order) {    \
+            (void)order;                                                                                         \
+            return (T)_InterlockedAnd##suffix((volatile word *)&a->value, (word)value);                          \
+        }                                                                                                        \
+        HELIOS_INLINE T HeliosAtomicFetchOr##name(HeliosAtomic##name *a, T value, HeliosMemoryOrder order) {     \
+            (void)order;                                                                                         \
+            return (T)_InterlockedOr##suffix((volatile word *)&a->value, (word)value);                           \
+        }
+
+_HELIOS_DEFINE_ATOMIC(U32, U32, long, )
+_HELIOS_DEFINE_ATOMIC(S32, S32, long, )
+_HELIOS_DEFINE_ATOMIC(U64, U64, __int64, 64)
+_HELIOS_DEFINE_ATOMIC(S64, S64, __int64, 64)
+
+typedef struct HeliosAtomicPtr { void *volatile value; } HeliosAtomicPtr;
+
+HELIOS_INLINE void *HeliosAtomicLoadPtr(const HeliosAtomicPtr *a, HeliosMemoryOrder order) {
+    (void)order;
+    void *value = a->value;
+    _ReadWriteBarrier();
+    return value;
+}
+
+HELIOS_INLINE void HeliosAtomicStorePtr(HeliosAtomicPtr *a, void *value, HeliosMemoryOrder order) {
+    if (order == HeliosMemoryOrder_SeqCst) {
+        _InterlockedExchangePointer(&a->value, value);
+    } else {
+        _ReadWriteBarrier();
+        a->value = value;
+    }
+}
+
+HELIOS_INLINE void *HeliosAtomicExchangePtr(HeliosAtomicPtr *a, void *value, HeliosMemoryOrder order) {
+    (void)order;
+    return _InterlockedExchangePointer(&a->value, value);
+}
+
+HELIOS_INLINE B32 HeliosAtomicCompareExchangePtr(HeliosAtomicPtr *a, void **expected, void *desired, HeliosMemoryOrder order) {
+    (void)order;
+    void *old = _InterlockedCompareExchangePointer(&a->value, desired, *expected);
+    if (old == *expected) return 1;
+    *expected = old;
+    return 0;
+}
+
+HELIOS_INLINE void HeliosAtomicFence(HeliosMemoryOrder order) {
+    if (order == HeliosMemoryOrder_SeqCst) MemoryBarrier();
+    else _ReadWriteBarrier();
+}
+
+HELIOS_INLINE void HeliosCpuRelax(void) {
+    YieldProcessor();
+}
+#else
+#    define _HELIOS_DEFINE_ATOMIC(T, name)                                                                      \
+        typedef struct HeliosAtomic##name { volatile T value; } HeliosAtomic##name;                              \
+        HELIOS_INLINE T HeliosAtomicLoad##name(const HeliosAtomic##name *a, HeliosMemoryOrder order) {           \
+            return __atomic_load_n(&a->value, order);                                                            \
+        }                                                                                                        \
+        HELIOS_INLINE void HeliosAtomicStore##name(HeliosAtomic##name *a, T value, HeliosMemoryOrder order) {    \
+            __atomic_store_n(&a->value, value, order);                                                           \
+        }                                                                                                        \
+        HELIOS_INLINE T HeliosAtomicExchange##name(HeliosAtomic##name *a, T value, HeliosMemoryOrder order) {    \
+            return __atomic_exchange_n(&a->value, value, order);                                                 \
+        }                                                                                                        \
+        HELIOS_INLINE B32 HeliosAtomicCompareExchange##name(HeliosAtomic##name *a, T *expected, T desired,       \
+                                                             HeliosMemoryOrder order) {                          \
+            return __atomic_compare_exchange_n(&a->value, expected, desired, 0, order,                           \
+                                               _HeliosMemoryOrderOnFailure(order));                              \
+        }                                                                                                        \
+        HELIOS_INLINE T HeliosAtomicFetchAdd##name(HeliosAtomic##name *a, T value, HeliosMemoryOrder order) {    \
+            return __atomic_fetch_add(&a->value, value, order);                                                  \
+        }                                                                                                        \
+        HELIOS_INLINE T HeliosAtomicFetchSub##name(HeliosAtomic##name *a, T value, HeliosMemoryOrder order) {    \
+            return __atomic_fetch_sub(&a->value, value, order);                                                  \
+        }                                                                                                        \
+        HELIOS_INLINE T HeliosAtomicFetchAnd##name(HeliosAtomic##name *a, T value, HeliosMemoryOrder order) {    \
+            return __atomic_fetch_and(&a->value, value, order);                                                  \
+        }                                                                                                        \
+        HELIOS_INLINE T HeliosAtomicFetchOr##name(HeliosAtomic##name *a, T value, HeliosMemoryOrder order) {     \
+            return __atomic_fetch_or(&a->value, value, order);                                                   \
+        }
+
+_HELIOS_DEFINE_ATOMIC(U32, U32)
+_HELIOS_DEFINE_ATOMIC(S32, S32)
+_HELIOS_DEFINE_ATOMIC(U64, U64)
+_HELIOS_DEFINE_ATOMIC(S64, S64)
+
+typedef struct HeliosAtomicPtr { void *volatile value; } HeliosAtomicPtr;
+
+HELIOS_INLINE void *HeliosAtomicLoadPtr(const HeliosAtomicPtr *a, HeliosMemoryOrder order) {
+    return __atomic_load_n(&a->value, order);
+}
+
+HELIOS_INLINE void HeliosAtomicStorePtr(HeliosAtomicPtr *a, void *value, HeliosMemoryOrder order) {
+    __atomic_store_n(&a->value, value, order);
+}
+
+HELIOS_INLINE void *HeliosAtomicExchangePtr(HeliosAtomicPtr *a, void *value, HeliosMemoryOrder order) {
+    return __atomic_exchange_n(&a->value, value, order);
+}
+
+HELIOS_INLINE B32 HeliosAtomicCompareExchangePtr(HeliosAtomicPtr *a, void **expected, void *desired, HeliosMemoryOrder order) {
+    return __atomic_compare_exchange_n(&a->value, expected, desired, 0, order, _HeliosMemoryOrderOnFailure(order));
+}
+
+HELIOS_INLINE void HeliosAtomicFence(HeliosMemoryOrder order) {
+    __atomic_thread_fence(order);
+}
+
+HELIOS_INLINE void HeliosCpuRelax(void) {
+#    if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#    elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#    endif // architecture check
+}
+#endif // HELIOS_COMPILER_MSVC
+
+#define HELIOS_CACHE_LINE_SIZE 64
+
+#define _HELIOS_CONCAT_(a, b) a##b
+#define _HELIOS_CONCAT(a, b) _HELIOS_CONCAT_(a, b)
+
+// Fills up the rest of a cache line after `used` bytes of members, to keep fields written by different
+// threads from sharing one.
+#define HELIOS_CACHE_LINE_PAD(used) U8 _HELIOS_CONCAT(_cache_line_pad, __COUNTER__)[HELIOS_CACHE_LINE_SIZE - (used)]
+
+HELIOS_DEF void HeliosThreadYield(void);
+
+// Test-and-test-and-set with exponential backoff, for short critical sections. Falls back to yielding the
+// thread once the backoff runs out.
+typedef struct HeliosSpinLock {
+    HeliosAtomicU32 state;
+} HeliosSpinLock;
+
+#define HELIOS_SPIN_LOCK_INIT {{0}}
+#define HELIOS_SPIN_LOCK_MAX_BACKOFF 64
+
+HELIOS_INLINE B32 HeliosSpinLockTryAcquire(HeliosSpinLock *lock) {
+    return HeliosAtomicLoadU32(&lock->state, HeliosMemoryOrder_Relaxed) == 0 &&
+           HeliosAtomicExchangeU32(&lock->state, 1, HeliosMemoryOrder_Acquire) == 0;
+}
+
+HELIOS_DEF void HeliosSpinLockAcquire(HeliosSpinLock *);
+
+HELIOS_INLINE void HeliosSpinLockRelease(HeliosSpinLock *lock) {
+    HeliosAtomicStoreU32(&lock->state, 0, HeliosMemoryOrder_Release);
+}
+
+// Blocks while `*address == expected`. May return spuriously, so callers have to recheck their condition.
+// Backed by futex on Linux and WaitOnAddress on Windows. Elsewhere threads park on one of a small table of
+// pthread condition variables, picked by hashing the address.
+HELIOS_DEF void HeliosFutexWait(HeliosAtomicU32 *address, U32 expected);
+HELIOS_DEF void HeliosFutexWake(HeliosAtomicU32 *address, U32 count);
+#define HELIOS_FUTEX_WAKE_ALL UINT32_MAX
+
+// Sleeps in the kernel only when contended. The state is 0 for unlocked, 1 for locked and 2 for locked
+// with possible waiters, which is the only case where unlocking costs a syscall.
+typedef struct HeliosMutex {
+    HeliosAtomicU32 state;
+} HeliosMutex;
+
+#define HELIOS_MUTEX_INIT {{0}}
+
+HELIOS_DEF void HeliosMutexLock(HeliosMutex *);
+HELIOS_DEF B32 HeliosMutexTryLock(HeliosMutex *);
+HELIOS_DEF void HeliosMutexUnlock(HeliosMutex *);
+
+// Waiters sleep on a sequence number bumped by every signal. Like any condition variable, wakeups can be
+// spurious, so wait in a loop.
+typedef struct HeliosCondVar {
+    HeliosAtomicU32 sequence;
+} HeliosCondVar;
+
+#define HELIOS_COND_VAR_INIT {{0}}
+
+HELIOS_DEF void HeliosCondVarWait(HeliosCondVar *, HeliosMutex *);
+HELIOS_DEF void HeliosCondVarSignal(HeliosCondVar *);
+HELIOS_DEF void HeliosCondVarBroadcast(HeliosCondVar *);
+
+// A manual-reset event: once set, every waiter passes until it is reset.
+typedef struct HeliosEvent {
+    HeliosAtomicU32 state;
+} HeliosEvent;
+
+#define HELIOS_EVENT_INIT {{0}}
+
+HELIOS_DEF void HeliosEventSet(HeliosEvent *);
+HELIOS_DEF void HeliosEventReset(HeliosEvent *);
+HELIOS_DEF void HeliosEventWait(HeliosEvent *);
+
+HELIOS_INLINE B32 HeliosEventIsSet(HeliosEvent *event) {
+    return HeliosAtomicLoadU32(&event->state, HeliosMemoryOrder_Acquire) != 0;
+}
+
+// Lets a single function use instructions beyond the baseline the file is compiled for. MSVC hands out
+// every intrinsic regardless, so there it expands to nothing.
+#if defined(HELIOS_COMPILER_MSVC)
+#    define HELIOS_TARGET(features)
+#else
+#    define HELIOS_TARGET(features) __attribute__((target(features)))
+#endif // HELIOS_COMPILER_MSVC
+
+typedef enum HeliosCpuFeature {
+    HeliosCpuFeature_SSE2     = 1 << 0,
+    HeliosCpuFeature_SSE3     = 1 << 1,
+    HeliosCpuFeature_SSSE3    = 1 << 2,
+    HeliosCpuFeature_SSE41    = 1 << 3,
+    HeliosCpuFeature_SSE42    = 1 << 4,
+    HeliosCpuFeature_POPCNT   = 1 << 5,
+    HeliosCpuFeature_AVX      = 1 << 6,
+    HeliosCpuFeature_AVX2     = 1 << 7,
+    HeliosCpuFeature_FMA      = 1 << 8,
+    HeliosCpuFeature_BMI1     = 1 << 9,
+    HeliosCpuFeature_BMI2     = 1 << 10,
+    HeliosCpuFeature_AVX512F  = 1 << 11,
+    HeliosCpuFeature_AVX512BW = 1 << 12,
+    HeliosCpuFeature_AVX512VL = 1 << 13,
+    HeliosCpuFeature_NEON     = 1 << 14,
+} HeliosCpuFeature;
+
+// AVX and AVX-512 are only reported when the OS also saves their registers across context switches.
+typedef struct HeliosCpuFeatures {
+    U32 flags;
+    char vendor[13];
+} HeliosCpuFeatures;
+
+// Runs cpuid once and caches the result.
+HELIOS_DEF const HeliosCpuFeatures *HeliosGetCpuFeatures(void);
+
+HELIOS_INLINE B32 HeliosCpuHas(U32 features) {
+    return (HeliosGetCpuFeatures()->flags & features) == features;
+}
+
+typedef UZ HeliosFindByteKernel(const U8 *data, UZ count, U8 byte);
+typedef UZ HeliosUtf8CountKernel(const U8 *data, UZ count);
+typedef U32 HeliosCrc32cKernel(U32 crc, const U8 *data, UZ count);
+typedef B32 HeliosMemEqualKernel(const U8 *lhs, const U8 *rhs, UZ count);
+typedef B32 HeliosMemEqualIgnoreCaseKernel(const U8 *lhs, const U8 *rhs, UZ count);
+typedef UZ HeliosFindAnyKernel(const U8 *data, UZ count, const U8 *set, UZ set_count);
+typedef UZ HeliosFindSubstringKernel(const U8 *data, UZ count, const U8 *needle, UZ needle_count);
+
+// Hot routines with one implementation per instruction set, picked by `HeliosKernelsInit`. Until then the
+// entries point at stubs that do the picking on first use. Every kernel has a scalar version, and all
+// versions of a kernel return the same results.
+typedef struct HeliosKernels {
+    HeliosFindByteKernel *find_byte;
+    HeliosUtf8CountKernel *utf8_count;
+    HeliosCrc32cKernel *crc32c;
+    HeliosMemEqualKernel *mem_equal;
+    HeliosMemEqualIgnoreCaseKernel *mem_equal_ignore_case;
+    HeliosFindAnyKernel *find_any;
+    HeliosFindSubstringKernel *find_substring;
+} HeliosKernels;
+
+HELIOS_DEF HeliosKernels helios_kernels;
+
+// Entries are loaded and stored one at a time and atomically, since threads may resolve the stubs while
+// others call through the table. Any mix of old and new entries works, the versions agree on every result.
+#if defined(HELIOS_COMPILER_GCC) || defined(HELIOS_COMPILER_CLANG)
+#    define _HELIOS_KERNEL(name) __atomic_load_n(&helios_kernels.name, __ATOMIC_RELAXED)
+#    define _HELIOS_KERNEL_STORE(name, kernel) __atomic_store_n(&helios_kernels.name, (kernel), __ATOMIC_RELAXED)
+#else
+#    define _HELIOS_KERNEL(name) (((volatile HeliosKernels *)&helios_kernels)->name)
+#    define _HELIOS_KERNEL_STORE(name, kernel) (((volatile HeliosKernels *)&helios_kernels)->name = (kernel))
+#endif // HELIOS_COMPILER_GCC || HELIOS_COMPILER_CLANG
+
+// Selects the best kernels available with `features`, a set of `HeliosCpuFeature` flags. Normally called
+// with the detected features, but passing fewer is handy to test the fallbacks. Safe to call while other
+// threads use the kernels.
+HELIOS_DEF void HeliosKernelsInit(U32 features);
+
+// Index of the first `byte` in `data`, or `count` when there is none.
+HELIOS_INLINE UZ HeliosFindByte(const U8 *data, UZ count, U8 byte) {
+    return _HELIOS_KERNEL(find_byte)(data, count, byte);
+}
+
+// Number of code points in valid UTF-8, i.e. bytes that are not continuation bytes.
+HELIOS_INLINE UZ HeliosUtf8Count(const U8 *data, UZ count) {
+    return _HELIOS_KERNEL(utf8_count)(data, count);
+}
+
+// CRC-32C (Castagnoli). Pass 0 to start, or the previous result to continue over more data.
+HELIOS_INLINE U32 HeliosCrc32c(U32 crc, const void *data, UZ count) {
+    return _HELIOS_KERNEL(crc32c)(crc, (const U8 *)data, count);
+}
+
+#define HELIOS_POOL_DEFAULT_SLAB_SIZE HELIOS_PAGE_ALIGNMENT
+#define HELIOS_POOL_CACHE_BATCH 32
+
+typedef struct HeliosPoolSlab {
+    struct HeliosPoolSlab *next;
+    struct HeliosPoolSlab *prev;
+    void *free_list;
+    U32 live;
+    // Objects past this index have never been handed out, so they are not on the free list either.
+    U32 carved;
+} HeliosPoolSlab;
+
+// Hands out objects of a single size, carved out of slabs that are aligned to their own size, so the
+// owning slab of an object is found by masking its address. Slabs that become empty are given back to
+// the system, except for one that is kept around to avoid thrashing on a slab boundary.
+typedef struct HeliosPoolAllocator {
+    UZ object_size;
+    UZ slab_size;
+    UZ first_object_offset;
+    U32 objects_per_slab;
+    HeliosPoolSlab *partial;
+    HeliosPoolSlab *full;
+    HeliosPoolSlab *empty;
+    UZ slab_count;
+    // Only taken by `HeliosPoolCache`s, direct use of the pool is not thread safe.
+    HeliosSpinLock lock;
+} HeliosPoolAllocator;
+
+// A per-thread stash of free objects, refilled from and drained to its pool in batches.
+typedef struct HeliosPoolCache {
+    HeliosPoolAllocator *pool;
+    void *free_list;
+    U32 count;
+} HeliosPoolCache;
+
+HELIOS_DEF void HeliosPoolAllocatorInit(HeliosPoolAllocator *, UZ object_size, UZ slab_size);
+HELIOS_DEF void HeliosPoolAllocatorDestroy(HeliosPoolAllocator *);
+HELIOS_DEF void *HeliosPoolAlloc(HeliosPoolAllocator *);
+HELIOS_DEF void HeliosPoolFree(HeliosPoolAllocator *, void *);
+HELIOS_DEF HeliosAllocator HeliosNewPoolAllocator(HeliosPoolAllocator *);
+
+HELIOS_DEF void HeliosPoolCacheInit(HeliosPoolCache *, HeliosPoolAllocator *);
+HELIOS_DEF void *HeliosPoolCacheAlloc(HeliosPoolCache *);
+HELIOS_DEF void HeliosPoolCacheFree(HeliosPoolCache *, void *);
+HELIOS_DEF void HeliosPoolCacheFlush(HeliosPoolCache *);
+HELIOS_DEF HeliosAllocator HeliosNewPoolCacheAllocator(HeliosPoolCache *);
+
+// `capacity` is the size of the allocation behind `data`, so it counts the NUL terminator, free with it.
 typedef struct HeliosString8 {
     U8 *data;
     UZ count;
@@ -218,52 +924,185 @@ typedef struct HeliosStringView {
 #define HELIOS_SV_LIT(cstr) ((HeliosStringView) {.data = (U8 *)(cstr), .count = strlen((cstr))})
 
 HELIOS_INLINE HeliosStringView HeliosStringViewClone(HeliosAllocator allocator, HeliosStringView sv) {
-    U8 *data = (U8 *)HeliosAlloc(allocator, sv.count);
+    U8 *data = (U8 *)HeliosAllocUninit(allocator, sv.count);
     memcpy(data, sv.data, sv.count);
     return (HeliosStringView) { .data = data, .count = sv.count };
 }
 
 HELIOS_INLINE char *HeliosStringViewCloneToCStr(HeliosAllocator allocator, HeliosStringView sv) {
-    char *data = (char *)HeliosAlloc(allocator, sv.count + 1);
+    char *data = (char *)HeliosAllocUninit(allocator, sv.count + 1);
     memcpy(data, sv.data, sv.count);
+    data[sv.count] = '\0';
     return data;
 }
 
+// The comparisons and searches below go through `helios_kernels`, so they run on SSE2/AVX2 where available.
+// Case-insensitive variants only fold ASCII letters. Searches return -1 when nothing is found.
+
+HELIOS_INLINE B32 HeliosMemEqual(const void *lhs, const void *rhs, UZ count) {
+    return _HELIOS_KERNEL(mem_equal)((const U8 *)lhs, (const U8 *)rhs, count);
+}
+
+HELIOS_INLINE HeliosStringView HeliosStringViewSlice(HeliosStringView sv, UZ begin, UZ end) {
+    HELIOS_ASSERT(begin <= end && end <= sv.count);
+    return (HeliosStringView) { .data = sv.data + begin, .count = end - begin };
+}
+
 HELIOS_INLINE B32 HeliosStringViewStartsWithSV(HeliosStringView sv, HeliosStringView prefix) {
-    if (prefix.count > sv.count) return 0;
+    return prefix.count <= sv.count && HeliosMemEqual(sv.data, prefix.data, prefix.count);
+}
 
-    for (UZ i = 0; i < prefix.count; ++i) {
-        if (sv.data[i] != prefix.data[i]) return 0;
+// Walks `prefix` once instead of measuring it first, prefixes tend to be a couple of bytes long.
+HELIOS_INLINE B32 HeliosStringViewStartsWith(HeliosStringView sv, const char *prefix) {
+    for (UZ i = 0; prefix[i] != '\0'; ++i) {
+        if (i >= sv.count || sv.data[i] != (U8)prefix[i]) return 0;
     }
 
     return 1;
 }
 
-HELIOS_INLINE B32 HeliosStringViewStartsWith(HeliosStringView sv, const char *prefix) {
-    UZ prefix_count = strlen(prefix);
-    HeliosStringView prefix_sv = { .data = (const U8 *)prefix, .count = prefix_count };
-    return HeliosStringViewStartsWithSV(sv, prefix_sv);
+HELIOS_INLINE B32 HeliosStringViewEndsWithSV(HeliosStringView sv, HeliosStringView suffix) {
+    return suffix.count <= sv.count && HeliosMemEqual(sv.data + sv.count - suffix.count, suffix.data, suffix.count);
+}
+
+HELIOS_INLINE B32 HeliosStringViewEndsWith(HeliosStringView sv, const char *suffix) {
+    HeliosStringView suffix_sv = { .data = (const U8 *)suffix, .count = strlen(suffix) };
+    return HeliosStringViewEndsWithSV(sv, suffix_sv);
 }
 
 HELIOS_INLINE B32 HeliosStringViewEqual(HeliosStringView lhs, HeliosStringView rhs) {
-    if (lhs.count != rhs.count) return 0;
+    return lhs.count == rhs.count && HeliosMemEqual(lhs.data, rhs.data, lhs.count);
+}
 
-    for (UZ i = 0; i < lhs.count; ++i) {
-        if (lhs.data[i] != rhs.data[i]) return 0;
+HELIOS_INLINE B32 HeliosStringViewEqualCStr(HeliosStringView sv, const char *cstr) {
+    UZ cstr_len = strlen(cstr);
+    return cstr_len == sv.count && HeliosMemEqual(sv.data, cstr, cstr_len);
+}
+
+HELIOS_INLINE B32 HeliosStringViewEqualIgnoreCase(HeliosStringView lhs, HeliosStringView rhs) {
+    return lhs.count == rhs.count && _HELIOS_KERNEL(mem_equal_ignore_case)(lhs.data, rhs.data, lhs.count);
+}
+
+HELIOS_INLINE SZ HeliosStringViewIndexOfByte(HeliosStringView sv, U8 byte) {
+    UZ index = HeliosFindByte(sv.data, sv.count, byte);
+    return index < sv.count ? (SZ)index : -1;
+}
+
+// Index of the first byte that is any of the bytes in `set`. Sets of up to 16 bytes are matched with SIMD.
+HELIOS_INLINE SZ HeliosStringViewIndexOfAny(HeliosStringView sv, HeliosStringView set) {
+    UZ index = _HELIOS_KERNEL(find_any)(sv.data, sv.count, set.data, set.count);
+    return index < sv.count ? (SZ)index : -1;
+}
+
+HELIOS_INLINE SZ HeliosStringViewIndexOf(HeliosStringView sv, HeliosStringView needle) {
+    if (needle.count > sv.count) return -1;
+    UZ index = _HELIOS_KERNEL(find_substring)(sv.data, sv.count, needle.data, needle.count);
+    return index < sv.count || needle.count == 0 ? (SZ)index : -1;
+}
+
+HELIOS_INLINE B32 HeliosStringViewContains(HeliosStringView sv, HeliosStringView needle) {
+    return HeliosStringViewIndexOf(sv, needle) != -1;
+}
+
+// Splits on every `separator`, so "a,,b" gives "a", "" and "b", and an empty string gives a single empty piece.
+typedef struct HeliosStringSplit {
+    HeliosStringView rest;
+    U8 separator;
+    B32 done;
+} HeliosStringSplit;
+
+HELIOS_INLINE HeliosStringSplit HeliosStringSplitInit(HeliosStringView sv, U8 separator) {
+    return (HeliosStringSplit) { .rest = sv, .separator = separator, .done = 0 };
+}
+
+HELIOS_INLINE B32 HeliosStringSplitNext(HeliosStringSplit *split, HeliosStringView *out) {
+    if (split->done) return 0;
+
+    SZ index = HeliosStringViewIndexOfByte(split->rest, split->separator);
+    if (index == -1) {
+        *out = split->rest;
+        split->done = 1;
+        return 1;
     }
 
+    *out = HeliosStringViewSlice(split->rest, 0, (UZ)index);
+    split->rest = HeliosStringViewSlice(split->rest, (UZ)index + 1, split->rest.count);
     return 1;
 }
 
-HELIOS_INLINE B32 HeliosStringViewEqualCStr(HeliosStringView sv, const char *cstr) {
-    UZ cstr_len = strlen(cstr);
-    if (cstr_len != sv.count) return 0;
+// A fast non-cryptographic 64-bit hash, eight bytes at a time with a murmur-style finalizer. The same on
+// every machine, since it does not depend on the kernels.
+HELIOS_INLINE U64 HeliosHashBytes(const void *data, UZ count) {
+    const U8 *bytes = (const U8 *)data;
+    U64 hash = 0x9E3779B97F4A7C15ull ^ ((U64)count * 0xFF51AFD7ED558CCDull);
+
+    UZ i = 0;
+    for (; i + 8 <= count; i += 8) {
+        U64 word;
+        memcpy(&word, bytes + i, sizeof(word));
+        word *= 0x87C37B91114253D5ull;
+        word = (word << 31) | (word >> 33);
+        hash = (hash ^ word) * 0x4CF5AD432745937Full;
+    }
 
-    for (UZ i = 0; i < sv.count; ++i) {
-        if (sv.data[i] != (U8)cstr[i]) return 0;
+    if (i < count) {
+        U64 word = 0;
+        memcpy(&word, bytes + i, count - i);
+        word *= 0x87C37B91114253D5ull;
+        word = (word << 31) | (word >> 33);
+        hash ^= word;
     }
 
-    return 1;
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+HELIOS_INLINE U64 HeliosStringViewHash(HeliosStringView sv) {
+    return HeliosHashBytes(sv.data, sv.count);
+}
+
+// Maps byte strings to small stable ids, storing every distinct string once. Interned strings are NUL
+// terminated and never move, so two interned views are equal exactly when their `data` pointers are.
+// Not thread safe.
+typedef U32 HeliosInternId;
+#define HELIOS_INTERN_ID_NONE 0
+
+#define HELIOS_INTERNER_DEFAULT_RESERVE ((UZ)1 << 28)
+
+typedef struct HeliosInterner {
+    // The slots and the id table.
+    HeliosAllocator allocator;
+    // The string bytes, each prefixed with its id.
+    HeliosVirtualArena arena;
+    // Open addressing, each slot holds the upper half of the hash next to the id, 0 when empty.
+    U64 *slots;
+    UZ slot_count;
+    HeliosStringView *strings;
+    U32 count;
+    U32 capacity;
+} HeliosInterner;
+
+// Reserves `reserve_size` bytes of address space for the strings, or HELIOS_INTERNER_DEFAULT_RESERVE if 0.
+HELIOS_DEF B32 HeliosInternerInit(HeliosInterner *, HeliosAllocator allocator, UZ reserve_size);
+HELIOS_DEF void HeliosInternerDestroy(HeliosInterner *);
+HELIOS_DEF HeliosInternId HeliosInternerIntern(HeliosInterner *, HeliosStringView);
+// Returns HELIOS_INTERN_ID_NONE for strings that were never interned.
+HELIOS_DEF HeliosInternId HeliosInternerFind(const HeliosInterner *, HeliosStringView);
+
+HELIOS_INLINE HeliosStringView HeliosInternerString(const HeliosInterner *interner, HeliosInternId id) {
+    HELIOS_ASSERT(id != HELIOS_INTERN_ID_NONE && id <= interner->count);
+    return interner->strings[id - 1];
+}
+
+// Only valid for views returned by `HeliosInternerString`.
+HELIOS_INLINE HeliosInternId HeliosInternerIdOf(HeliosStringView interned) {
+    HeliosInternId id;
+    memcpy(&id, interned.data - sizeof(id), sizeof(id));
+    return id;
 }
 
 HELIOS_INLINE HeliosStringView HeliosString8View(HeliosString8 s) {
@@ -274,14 +1113,14 @@ HELIOS_INLINE HeliosStringView HeliosString8View(HeliosString8 s) {
 }
 
 HELIOS_INLINE HeliosString8 HeliosString8FromSV(HeliosAllocator allocator, HeliosStringView sv) {
-    U8 *data = (U8 *)HeliosAlloc(allocator, sv.count + 1);
+    U8 *data = (U8 *)HeliosAllocUninit(allocator, sv.count + 1);
     memcpy(data, sv.data, sv.count);
-    data[sv.count + 1] = '\0';
+    data[sv.count] = '\0';
 
     return (HeliosString8) {
         .data = data,
         .count = sv.count,
-        .capacity = sv.count,
+        .capacity = sv.count + 1,
         .allocator = allocator,
     };
 }
@@ -321,24 +1160,382 @@ HELIOS_DEF void HeliosString8StreamInit(HeliosString8Stream *, const U8 *, UZ);
 HELIOS_DEF B32 HeliosString8StreamCur(HeliosString8Stream *, HeliosChar *);
 HELIOS_DEF B32 HeliosString8StreamNext(HeliosString8Stream *, HeliosChar *);
 HELIOS_DEF void HeliosString8StreamRetreat(HeliosString8Stream *);
+// Moves the stream onto the next `byte`, as if calling `HeliosString8StreamNext` until it returned it, but
+// scanning with the vectorized kernels. `byte` must be ASCII, so that it cannot be part of a longer sequence.
+HELIOS_DEF B32 HeliosString8StreamSkipTo(HeliosString8Stream *, U8 byte);
 
 HELIOS_INLINE HeliosString8 HeliosString8FromStringView(HeliosAllocator allocator, HeliosStringView sv) {
     UZ s_count = sv.count;
 
-    U8 *s_data = (U8 *)HeliosAlloc(allocator, s_count);
+    U8 *s_data = (U8 *)HeliosAllocUninit(allocator, s_count + 1);
     memcpy(s_data, sv.data, s_count);
     s_data[s_count] = '\0';
 
     return (HeliosString8) {
         .data = s_data,
         .count = s_count,
-        .capacity = s_count,
+        .capacity = s_count + 1,
         .allocator = allocator,
     };
 }
 
+// Appends into a list of fixed-size chunks, so growing never copies what was already written. Use
+// `HeliosStringBuilderFinalize` to get one contiguous string, or `HeliosStringBuilderWriteTo` to send
+// the chunks to a file descriptor as they are.
+#define HELIOS_STRING_BUILDER_CHUNK_SIZE (1024 * 4)
+
+typedef struct HeliosStringChunk {
+    struct HeliosStringChunk *next;
+    U8 *data;
+    UZ count;
+    UZ capacity;
+} HeliosStringChunk;
+
+typedef struct HeliosStringBuilder {
+    HeliosAllocator allocator;
+    HeliosStringChunk *first;
+    HeliosStringChunk *last;
+    // The total count of bytes over all chunks.
+    UZ count;
+    UZ chunk_size;
+} HeliosStringBuilder;
+
+// Uses HELIOS_STRING_BUILDER_CHUNK_SIZE if `chunk_size` is 0.
+HELIOS_DEF void HeliosStringBuilderInit(HeliosStringBuilder *, HeliosAllocator allocator, UZ chunk_size);
+HELIOS_DEF void HeliosStringBuilderDestroy(HeliosStringBuilder *);
+// Empties the builder, keeping the chunks around for reuse.
+HELIOS_DEF void HeliosStringBuilderReset(HeliosStringBuilder *);
+// Returns a pointer to at least `size` contiguous writable bytes at the end of the builder. Call
+// `HeliosStringBuilderCommit` with the count of bytes actually written.
+HELIOS_DEF U8 *HeliosStringBuilderReserve(HeliosStringBuilder *, UZ size);
+HELIOS_DEF void HeliosStringBuilderAppend(HeliosStringBuilder *, const void *data, UZ count);
+HELIOS_DEF void HeliosStringBuilderAppendU64(HeliosStringBuilder *, U64);
+HELIOS_DEF void HeliosStringBuilderAppendS64(HeliosStringBuilder *, S64);
+// Fixed notation with `precision` digits after the point, exactly like "%.*f". Values too large for the
+// fast path, and values too close to a tie to round from the scaled double, go through snprintf.
+HELIOS_DEF void HeliosStringBuilderAppendF64(HeliosStringBuilder *, F64, U32 precision);
+HELIOS_DEF void HeliosStringBuilderFormat(HeliosStringBuilder *, const char *, ...) HELIOS_ANNOTATE_PRINTF(2, 3);
+// Copies the contents into one NUL terminated string allocated with `allocator`, whose `capacity` counts the NUL.
+HELIOS_DEF HeliosString8 HeliosStringBuilderFinalize(const HeliosStringBuilder *, HeliosAllocator allocator);
+// Writes all chunks to `fd` without joining them, retrying on partial writes.
+HELIOS_DEF B32 HeliosStringBuilderWriteTo(const HeliosStringBuilder *, int fd);
+
+HELIOS_INLINE void HeliosStringBuilderCommit(HeliosStringBuilder *sb, UZ count) {
+    HELIOS_ASSERT(sb->last->count + count <= sb->last->capacity);
+    sb->last->count += count;
+    sb->count += count;
+}
+
+HELIOS_INLINE void HeliosStringBuilderAppendByte(HeliosStringBuilder *sb, U8 byte) {
+    if (sb->last != NULL && sb->last->count < sb->last->capacity) {
+        sb->last->data[sb->last->count++] = byte;
+        ++sb->count;
+        return;
+    }
+
+    *HeliosStringBuilderReserve(sb, 1) = byte;
+    HeliosStringBuilderCommit(sb, 1);
+}
+
+HELIOS_INLINE void HeliosStringBuilderAppendSV(HeliosStringBuilder *sb, HeliosStringView sv) {
+    HeliosStringBuilderAppend(sb, sv.data, sv.count);
+}
+
+HELIOS_INLINE void HeliosStringBuilderAppendCStr(HeliosStringBuilder *sb, const char *cstr) {
+    HeliosStringBuilderAppend(sb, cstr, strlen(cstr));
+}
+
+// Monotonic wall clock time in nanoseconds, with an unspecified epoch.
+HELIOS_DEF U64 HeliosNowNs(void);
+
+// Instrumentation for hot paths, compiled out unless HELIOS_PROFILE is defined. Each thread records
+// begin/end events into its own lock-free ring of HELIOS_PROFILE_RING_SIZE events, which
+// `HeliosProfileFlush` drains into Chrome trace event JSON (chrome://tracing, ui.perfetto.dev).
+// Events are dropped rather than blocking when a ring is full, and `name` must outlive the flush, so
+// string literals are the way to go. `HELIOS_PROFILE_SCOPE` relies on the cleanup attribute and records
+// nothing on MSVC, use `HELIOS_PROFILE_BEGIN/END` pairs there.
+#ifdef HELIOS_PROFILE
+#    ifndef HELIOS_PROFILE_RING_SIZE
+#        define HELIOS_PROFILE_RING_SIZE (1 << 16)
+#    endif // HELIOS_PROFILE_RING_SIZE
+
+typedef struct HeliosProfileEvent {
+    const char *name;
+    U64 timestamp;
+    // 'B' or 'E', the Chrome trace phase.
+    U8 phase;
+} HeliosProfileEvent;
+
+typedef struct HeliosProfileBuffer {
+    struct HeliosProfileBuffer *next;
+    HeliosProfileEvent *events;
+    U32 thread_index;
+    HeliosAtomicU64 dropped;
+    HELIOS_CACHE_LINE_PAD(sizeof(void *) * 2 + sizeof(U64) * 2);
+    // Only written by the owning thread.
+    HeliosAtomicU64 head;
+    HELIOS_CACHE_LINE_PAD(sizeof(HeliosAtomicU64));
+    // Only written by the flush.
+    HeliosAtomicU64 tail;
+} HeliosProfileBuffer;
+
+HELIOS_DEF HELIOS_THREAD_LOCAL HeliosProfileBuffer *helios_profile_buffer;
+
+// Registers the calling thread's ring on its first event.
+HELIOS_DEF HeliosProfileBuffer *_HeliosProfileThreadBuffer(void);
+
+// Raw timestamp counter ticks on x86, converted to time at flush. Define HELIOS_PROFILE_USE_CLOCK to use
+// the monotonic clock instead, for machines without an invariant TSC.
+HELIOS_INLINE U64 HeliosProfileTimestamp(void) {
+#    if defined(HELIOS_ARCH_X86) && !defined(HELIOS_PROFILE_USE_CLOCK)
+    return __rdtsc();
+#    else
+    return HeliosNowNs();
+#    endif
+}
+
+HELIOS_INLINE void HeliosProfileRecord(const char *name, U8 phase) {
+    HeliosProfileBuffer *buffer = helios_profile_buffer;
+    if (buffer == NULL) buffer = _HeliosProfileThreadBuffer();
+
+    U64 head = HeliosAtomicLoadU64(&buffer->head, HeliosMemoryOrder_Relaxed);
+    if (head - HeliosAtomicLoadU64(&buffer->tail, HeliosMemoryOrder_Acquire) >= HELIOS_PROFILE_RING_SIZE) {
+        HeliosAtomicFetchAddU64(&buffer->dropped, 1, HeliosMemoryOrder_Relaxed);
+        return;
+    }
+
+    HeliosProfileEvent *event = &buffer->events[head & (HELIOS_PROFILE_RING_SIZE - 1)];
+    event->name = name;
+    event->timestamp = HeliosProfileTimestamp();
+    event->phase = phase;
+    HeliosAtomicStoreU64(&buffer->head, head + 1, HeliosMemoryOrder_Release);
+}
+
+HELIOS_INLINE void _HeliosProfileScopeEnd(const char **name) {
+    HeliosProfileRecord(*name, 'E');
+}
+
+// Appends all events recorded since the previous flush as one trace document.
+HELIOS_DEF void HeliosProfileFlush(HeliosStringBuilder *);
+HELIOS_DEF B32 HeliosProfileFlushToFile(HeliosStringView path);
+
+#    define HELIOS_PROFILE_BEGIN(name) HeliosProfileRecord((name), 'B')
+#    define HELIOS_PROFILE_END(name) HeliosProfileRecord((name), 'E')
+#    if defined(HELIOS_COMPILER_GCC) || defined(HELIOS_COMPILER_CLANG)
+#        define HELIOS_PROFILE_SCOPE(name)                                                    \
+            __attribute__((cleanup(_HeliosProfileScopeEnd), unused))                          \
+            const char *_HELIOS_CONCAT(_helios_profile_scope, __COUNTER__) =                  \
+                (HeliosProfileRecord((name), 'B'), (name))
+#    else
+#        define HELIOS_PROFILE_SCOPE(name)
+#    endif
+#else
+#    define HELIOS_PROFILE_BEGIN(name) ((void)0)
+#    define HELIOS_PROFILE_END(name) ((void)0)
+#    define HELIOS_PROFILE_SCOPE(name)
+#endif // HELIOS_PROFILE
+
 HELIOS_DEF HeliosStringView HeliosReadEntireFile(HeliosAllocator, HeliosStringView);
 
+// A read-only view of a whole file, without copying it through a heap buffer.
+typedef struct HeliosMappedFile {
+    HeliosStringView contents;
+#ifdef HELIOS_PLATFORM_WINDOWS
+    HANDLE mapping_handle;
+#endif // HELIOS_PLATFORM_WINDOWS
+} HeliosMappedFile;
+
+HELIOS_DEF B32 HeliosMapFile(HeliosStringView path, HeliosMappedFile *out);
+HELIOS_DEF void HeliosUnmapFile(HeliosMappedFile *);
+
+// Reads all of `paths` into buffers from `allocator`, submitting the I/O for all of them at once through
+// io_uring on Linux and overlapped reads on Windows, and through a small pool of worker threads otherwise. Files that could not
+// be read end up as empty views with a NULL `data`. Returns whether all files were read.
+//
+// Every buffer is NUL terminated and `count + 1` bytes long, so that empty files get a buffer as well.
+HELIOS_DEF B32 HeliosReadFilesBatch(HeliosAllocator allocator, const HeliosStringView *paths, UZ count, HeliosStringView *out);
+
+#define HELIOS_READ_BATCH_MAX_WORKERS 8
+
+typedef void HeliosThreadFunc(void *);
+
+typedef struct HeliosThread {
+    HeliosThreadFunc *func;
+    void *arg;
+#ifdef HELIOS_PLATFORM_WINDOWS
+    HANDLE handle;
+#else
+    pthread_t handle;
+#endif // HELIOS_PLATFORM_WINDOWS
+} HeliosThread;
+
+// The thread struct has to stay alive until the thread is joined.
+HELIOS_DEF B32 HeliosThreadStart(HeliosThread *, HeliosThreadFunc *, void *);
+HELIOS_DEF void HeliosThreadJoin(HeliosThread *);
+HELIOS_DEF U32 HeliosGetCpuCount(void);
+
+// Deferred logging. `HeliosLogWrite` only walks the format string to copy the raw arguments, strings
+// included, into a per-thread lock-free ring, and a background thread started by `HeliosLogInit` formats
+// the records and writes them out in batches, ordered by time across threads. Messages are dropped and
+// counted when a ring is full, nothing ever blocks the logging thread. Before `HeliosLogInit`, and after
+// `HeliosLogShutdown`, messages are formatted and written synchronously to stderr.
+//
+// Supports the printf conversions except for `%n`, a string argument is cut to fit into one record.
+typedef enum HeliosLogLevel {
+    HeliosLogLevel_Debug,
+    HeliosLogLevel_Info,
+    HeliosLogLevel_Warn,
+    HeliosLogLevel_Error,
+} HeliosLogLevel;
+
+// The ring size of each logging thread in bytes, must be a power of two.
+#ifndef HELIOS_LOG_RING_SIZE
+#    define HELIOS_LOG_RING_SIZE (1024 * 64)
+#endif // HELIOS_LOG_RING_SIZE
+#define HELIOS_LOG_MAX_RECORD_SIZE 512
+#define HELIOS_LOG_POLL_INTERVAL_NS 1000000
+
+HELIOS_DEF B32 HeliosLogInit(int fd);
+// Writes out all pending messages and stops the background thread.
+HELIOS_DEF void HeliosLogShutdown(void);
+// Formats and writes all pending messages on the calling thread.
+HELIOS_DEF void HeliosLogFlush(void);
+HELIOS_DEF void HeliosLogWrite(HeliosLogLevel level, const char *file, U32 line, const char *fmt, ...) HELIOS_ANNOTATE_PRINTF(4, 5);
+
+#define HELIOS_LOG_DEBUG(...) HeliosLogWrite(HeliosLogLevel_Debug, __FILE__, __LINE__, __VA_ARGS__)
+#define HELIOS_LOG_INFO(...) HeliosLogWrite(HeliosLogLevel_Info, __FILE__, __LINE__, __VA_ARGS__)
+#define HELIOS_LOG_WARN(...) HeliosLogWrite(HeliosLogLevel_Warn, __FILE__, __LINE__, __VA_ARGS__)
+#define HELIOS_LOG_ERROR(...) HeliosLogWrite(HeliosLogLevel_Error, __FILE__, __LINE__, __VA_ARGS__)
+
+// Micro-benchmarks. A case runs its body `iterations` times per call, the harness warms it up, doubles
+// the iteration count until one sample takes at least `sample_ns`, then collects `samples` samples and
+// reports the min, median and p99 time per iteration.
+typedef void HeliosBenchFunc(void *arg, U64 iterations);
+
+typedef struct HeliosBenchCase {
+    const char *name;
+    HeliosBenchFunc *func;
+    void *arg;
+    // Optional, to also report the time per item and the throughput.
+    U64 items_per_iteration;
+    U64 bytes_per_iteration;
+} HeliosBenchCase;
+
+typedef struct HeliosBenchResult {
+    const char *name;
+    U64 iterations;
+    U32 samples;
+    // Per iteration.
+    F64 min_ns;
+    F64 median_ns;
+    F64 p99_ns;
+    F64 mean_ns;
+} HeliosBenchResult;
+
+#define HELIOS_BENCH_DEFAULT_WARMUP_NS 50000000ull
+#define HELIOS_BENCH_DEFAULT_SAMPLE_NS 1000000ull
+#define HELIOS_BENCH_DEFAULT_SAMPLES 101
+
+typedef struct HeliosBench {
+    U64 warmup_ns;
+    U64 sample_ns;
+    U32 samples;
+    // Only cases with names containing it are run, NULL runs all.
+    const char *filter;
+    // One tab separated line per case instead of the aligned text.
+    B32 tsv;
+    // NULL for no output.
+    FILE *out;
+    HeliosBenchResult last;
+} HeliosBench;
+
+// Accepts `--filter=<substring>`, `--samples=<count>` and `--tsv`.
+HELIOS_DEF void HeliosBenchInit(HeliosBench *, int argc, char **argv);
+// Returns 0 when the case was skipped by the filter, the results are in `last` otherwise.
+HELIOS_DEF B32 HeliosBenchRun(HeliosBench *, const HeliosBenchCase *);
+
+// Makes the compiler assume that the memory at `p` is read and written, so that the computations
+// producing it cannot be optimized out.
+#if defined(HELIOS_COMPILER_GCC) || defined(HELIOS_COMPILER_CLANG)
+HELIOS_INLINE void HeliosBenchDoNotOptimize(const void *p) {
+    __asm__ volatile("" : : "g"(p) : "memory");
+}
+
+// Forces pending writes to memory to actually happen.
+HELIOS_INLINE void HeliosBenchClobber(void) {
+    __asm__ volatile("" : : : "memory");
+}
+#else
+HELIOS_DEF const void *volatile helios_bench_sink;
+
+HELIOS_INLINE void HeliosBenchDoNotOptimize(const void *p) {
+    helios_bench_sink = p;
+    _ReadWriteBarrier();
+}
+
+HELIOS_INLINE void HeliosBenchClobber(void) {
+    _ReadWriteBarrier();
+}
+#endif // HELIOS_COMPILER_GCC || HELIOS_COMPILER_CLANG
+
+// A fixed pool of workers, each with its own Chase-Lev deque of jobs. Workers pop their own deque from the
+// bottom and steal from the top of the others when it runs dry. The thread that calls `HeliosJobsInit`
+// becomes worker 0, and only worker threads may create, submit or wait on jobs.
+//
+// A job counts itself and its unfinished children, so waiting on a parent waits for the whole tree. Waiting
+// never blocks: the waiter runs other jobs until the one it waits on is done.
+//
+// Workers that run out of jobs yield a few times and then sleep on a futex, so an idle pool takes no CPU time.
+// Submitting a job only wakes somebody when a worker might be asleep.
+#define HELIOS_JOBS_MAX_WORKERS 64
+// The capacity of each worker's deque and job ring, must be a power of two.
+#define HELIOS_JOBS_QUEUE_SIZE 4096
+#define HELIOS_JOB_DATA_SIZE 40
+
+typedef struct HeliosJobs HeliosJobs;
+typedef struct HeliosJob HeliosJob;
+
+// `data` points to the bytes copied into the job by `HeliosJobCreate`.
+typedef void HeliosJobFunc(HeliosJobs *, HeliosJob *, void *data);
+
+// Exactly one cache line on 64-bit targets, so that workers finishing neighbouring jobs do not fight over it.
+struct HeliosJob {
+    HeliosJobFunc *func;
+    HeliosJob *parent;
+    U8 data[HELIOS_JOB_DATA_SIZE];
+    HeliosAtomicS32 unfinished;
+};
+
+struct _HeliosJobsWorker;
+
+struct HeliosJobs {
+    HeliosAllocator allocator;
+    struct _HeliosJobsWorker *workers;
+    U32 worker_count;
+    HeliosAtomicU32 running;
+    // Idle workers sleep on `wake`, which submitters only bump when `sleepers` says somebody might be asleep.
+    HeliosAtomicU32 sleepers;
+    HeliosAtomicU32 wake;
+};
+
+// Starts `worker_count - 1` threads, or one less than the CPU count if `worker_count` is zero.
+// All deques and job storage come from `allocator`.
+HELIOS_DEF B32 HeliosJobsInit(HeliosJobs *, HeliosAllocator allocator, U32 worker_count);
+HELIOS_DEF void HeliosJobsDestroy(HeliosJobs *);
+// The index of the calling worker in `[0, worker_count)`, handy for per-worker results.
+HELIOS_DEF U32 HeliosJobsWorkerIndex(HeliosJobs *);
+
+// Jobs live in a per-worker ring, so a job pointer is only valid until its job and everyone waiting on it is done.
+HELIOS_DEF HeliosJob *HeliosJobCreate(HeliosJobs *, HeliosJob *parent, HeliosJobFunc *, const void *data, UZ data_size);
+HELIOS_DEF void HeliosJobSubmit(HeliosJobs *, HeliosJob *);
+HELIOS_DEF void HeliosJobWait(HeliosJobs *, HeliosJob *);
+
+typedef void HeliosParallelForFunc(void *arg, UZ begin, UZ end);
+
+// Calls `func` over disjoint subranges of `[0, count)` no longer than `batch_size`, splitting the range in
+// halves so that idle workers steal big chunks first. A `batch_size` of zero picks one from the worker count.
+HELIOS_DEF void HeliosJobsParallelFor(HeliosJobs *, UZ count, UZ batch_size, HeliosParallelForFunc *func, void *arg);
+
 #ifdef ASTRON_HELIOS_IMPLEMENTATION
 
 HELIOS_DEF B32 _HeliosParseS64Hex(HeliosStringView source, S64 *out) {
@@ -435,9 +1632,9 @@ HELIOS_DEF B32 HeliosParseF64(HeliosStringView source, F64 *out) {
     HeliosAllocator temp_alloc = HeliosGetTempAllocator();
 
     UZ temp_count = source.count + 1;
-    char *temp = (char *)HeliosAlloc(temp_alloc, temp_count);
+    char *temp = (char *)HeliosAllocUninit(temp_alloc, temp_count);
     memcpy(temp, (const void *)source.data, source.count);
-    temp[temp_count] = '\0';
+    temp[source.count] = '\0';
 
     char *d_out;
     *out = strtod(temp, &d_out);
@@ -452,10 +1649,107 @@ HELIOS_DEF void *HeliosRawAlloc(UZ size) {
 #endif // HELIOS_PLATFORM_WINDOWS
 }
 
-HELIOS_INTERNAL void *MallocStub(void *user, UZ size) {
-    HELIOS_UNUSED(user);
-    return memset(malloc(size), 0, size);
-}
+HELIOS_DEF void *HeliosRawAllocAligned(UZ size, UZ align) {
+    if (align <= HELIOS_PAGE_ALIGNMENT) {
+        void *ptr = HeliosRawAlloc(size);
+#ifdef HELIOS_PLATFORM_POSIX
+        if (ptr == MAP_FAILED) return NULL;
+#endif // HELIOS_PLATFORM_POSIX
+        return ptr;
+    }
+
+#ifdef HELIOS_PLATFORM_WINDOWS
+    // Reserve a bigger range to find an aligned address in it, then try to claim just that part.
+    // Another thread can race us for the range, so retry until it works out.
+    while (1) {
+        void *probe = VirtualAlloc(NULL, size + align, MEM_RESERVE, PAGE_NOACCESS);
+        if (probe == NULL) return NULL;
+        VirtualFree(probe, 0, MEM_RELEASE);
+
+        void *aligned = (void *)HeliosRoundUp((UZ)probe, align);
+        void *ptr = VirtualAlloc(aligned, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+        if (ptr != NULL) return ptr;
+    }
+#else
+    U8 *ptr = (U8 *)mmap(NULL, size + align, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+    if (ptr == MAP_FAILED) return NULL;
+
+    U8 *aligned = (U8 *)HeliosRoundUp((UZ)ptr, align);
+    UZ head = (UZ)(aligned - ptr);
+    UZ tail = align - head;
+
+    if (head != 0) munmap(ptr, head);
+    if (tail != 0) munmap(aligned + size, tail);
+    return aligned;
+#endif // HELIOS_PLATFORM_WINDOWS
+}
+
+HELIOS_DEF void HeliosRawFree(void *ptr, UZ size) {
+#ifdef HELIOS_PLATFORM_WINDOWS
+    HELIOS_UNUSED(size);
+    VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+    munmap(ptr, size);
+#endif // HELIOS_PLATFORM_WINDOWS
+}
+
+HELIOS_DEF void *HeliosRawReserve(UZ size, UZ align) {
+    if (align < HELIOS_PAGE_ALIGNMENT) align = HELIOS_PAGE_ALIGNMENT;
+
+#ifdef HELIOS_PLATFORM_WINDOWS
+    if (align == HELIOS_PAGE_ALIGNMENT) return VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS);
+
+    while (1) {
+        void *probe = VirtualAlloc(NULL, size + align, MEM_RESERVE, PAGE_NOACCESS);
+        if (probe == NULL) return NULL;
+        VirtualFree(probe, 0, MEM_RELEASE);
+
+        void *ptr = VirtualAlloc((void *)HeliosRoundUp((UZ)probe, align), size, MEM_RESERVE, PAGE_NOACCESS);
+        if (ptr != NULL) return ptr;
+    }
+#else
+    UZ padding = align == HELIOS_PAGE_ALIGNMENT ? 0 : align;
+    U8 *ptr = (U8 *)mmap(NULL, size + padding, PROT_NONE, MAP_PRIVATE | MAP_ANON | MAP_NORESERVE, -1, 0);
+    if (ptr == MAP_FAILED) return NULL;
+    if (padding == 0) return ptr;
+
+    U8 *aligned = (U8 *)HeliosRoundUp((UZ)ptr, align);
+    UZ head = (UZ)(aligned - ptr);
+    UZ tail = padding - head;
+
+    if (head != 0) munmap(ptr, head);
+    if (tail != 0) munmap(aligned + size, tail);
+    return aligned;
+#endif // HELIOS_PLATFORM_WINDOWS
+}
+
+HELIOS_DEF B32 HeliosRawCommit(void *ptr, UZ size) {
+#ifdef HELIOS_PLATFORM_WINDOWS
+    return VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE) != NULL;
+#else
+    return mprotect(ptr, size, PROT_READ | PROT_WRITE) == 0;
+#endif // HELIOS_PLATFORM_WINDOWS
+}
+
+HELIOS_DEF void HeliosRawDecommit(void *ptr, UZ size) {
+#ifdef HELIOS_PLATFORM_WINDOWS
+    VirtualFree(ptr, size, MEM_DECOMMIT);
+#else
+    // The pages read back as zero once they are touched again.
+    madvise(ptr, size, MADV_DONTNEED);
+    mprotect(ptr, size, PROT_NONE);
+#endif // HELIOS_PLATFORM_WINDOWS
+}
+
+HELIOS_INTERNAL void *MallocStub(void *user, UZ size) {
+    HELIOS_UNUSED(user);
+    return malloc(size);
+}
+
+HELIOS_INTERNAL void *CallocStub(void *user, UZ size) {
+    HELIOS_UNUSED(user);
+    return calloc(1, size);
+}
 
 HELIOS_INTERNAL void FreeStub(void *user, void *ptr, UZ size) {
     HELIOS_UNUSED(user);
@@ -481,6 +1775,7 @@ HELIOS_DEF HeliosAllocator HeliosNewMallocAllocator(void) {
             .alloc = MallocStub,
             .free = FreeStub,
             .realloc = ReallocStub,
+            .alloc_zeroed = CallocStub,
         },
         .data = NULL,
     };
@@ -490,6 +1785,8 @@ typedef struct HeliosDynamicCircleBufferAllocator {
     void *buffer;
     UZ capacity;
     UZ offset;
+    // Everything past this offset is still untouched memory fresh from `HeliosRawAlloc`, and thus zeroed.
+    UZ dirty;
 } HeliosDynamicCircleBufferAllocator;
 
 HELIOS_INTERNAL void *_HeliosDynamicCircleBufferAllocatorAlloc(void *a_ptr, UZ size) {
@@ -497,6 +1794,7 @@ HELIOS_INTERNAL void *_HeliosDynamicCircleBufferAllocatorAlloc(void *a_ptr, UZ s
     if (allocator->buffer == NULL) {
         HELIOS_ASSERT(allocator->capacity % 2 == 0);
         allocator->buffer = HeliosRawAlloc(allocator->capacity);
+        allocator->dirty = 0;
     }
 
     size = HeliosRoundUp(size, sizeof(UZ));
@@ -504,7 +1802,20 @@ HELIOS_INTERNAL void *_HeliosDynamicCircleBufferAllocatorAlloc(void *a_ptr, UZ s
 
     void *ptr = (void *)((U8 *)allocator->buffer + allocator->offset);
     allocator->offset += size;
-    return memset(ptr, 0, size);
+    allocator->dirty = HELIOS_MAX(allocator->dirty, allocator->offset);
+    return ptr;
+}
+
+HELIOS_INTERNAL void *_HeliosDynamicCircleBufferAllocatorAllocZeroed(void *a_ptr, UZ size) {
+    HeliosDynamicCircleBufferAllocator *allocator = (HeliosDynamicCircleBufferAllocator *)a_ptr;
+    UZ dirty = allocator->buffer != NULL ? allocator->dirty : 0;
+
+    U8 *ptr = (U8 *)_HeliosDynamicCircleBufferAllocatorAlloc(a_ptr, size);
+    UZ offset = (UZ)(ptr - (U8 *)allocator->buffer);
+
+    // Only clear the part of the block that has been handed out before.
+    if (offset < dirty) memset(ptr, 0, HELIOS_MIN(size, dirty - offset));
+    return ptr;
 }
 
 HELIOS_DEF HeliosAllocator HeliosNewDynamicCircleBufferAllocator(HeliosDynamicCircleBufferAllocator *allocator, UZ capacity) {
@@ -513,6 +1824,7 @@ HELIOS_DEF HeliosAllocator HeliosNewDynamicCircleBufferAllocator(HeliosDynamicCi
     allocator->buffer = NULL;
     allocator->capacity = capacity;
     allocator->offset = 0;
+    allocator->dirty = 0;
 
     return (HeliosAllocator) {
         .data = (void *)allocator,
@@ -520,6 +1832,7 @@ HELIOS_DEF HeliosAllocator HeliosNewDynamicCircleBufferAllocator(HeliosDynamicCi
             .alloc = _HeliosDynamicCircleBufferAllocatorAlloc,
             .free = _HeliosNopFreeStub,
             .realloc = NULL,
+            .alloc_zeroed = _HeliosDynamicCircleBufferAllocatorAllocZeroed,
         },
     };
 }
@@ -528,6 +1841,7 @@ HELIOS_INTERNAL HeliosDynamicCircleBufferAllocator _helios_temp_impl = {
     .buffer = NULL,
     .capacity = HELIOS_PAGE_SIZE * 20,
     .offset = 0,
+    .dirty = 0,
 };
 
 #if defined(HELIOS_COMPILER_MSVC) || defined(HELIOS_COMPILER_GCC)
@@ -538,6 +1852,7 @@ HELIOS_DEF HeliosAllocator HeliosGetTempAllocator(void) {
             .alloc = _HeliosDynamicCircleBufferAllocatorAlloc,
             .free = _HeliosNopFreeStub,
             .realloc = NULL,
+            .alloc_zeroed = _HeliosDynamicCircleBufferAllocatorAllocZeroed,
         },
     };
 }
@@ -549,6 +1864,7 @@ HELIOS_INTERNAL HeliosAllocator _helios_temp_allocator = {
         .alloc = _HeliosDynamicCircleBufferAllocatorAlloc,
         .free = _HeliosNopFreeStub,
         .realloc = NULL,
+        .alloc_zeroed = _HeliosDynamicCircleBufferAllocatorAllocZeroed,
     },
 };
 
@@ -557,28 +1873,545 @@ HELIOS_DEF HeliosAllocator HeliosGetTempAllocator(void) {
 }
 #endif
 
+HELIOS_DEF void HeliosArenaInit(HeliosArena *arena, UZ capacity) {
+    arena->capacity = HeliosRoundUp(capacity, HELIOS_PAGE_ALIGNMENT);
+    arena->base = (U8 *)HeliosRawAlloc(arena->capacity);
+    arena->offset = 0;
+    arena->last_offset = 0;
+    arena->dirty = 0;
+}
+
+HELIOS_DEF void HeliosArenaRelease(HeliosArena *arena) {
+    HeliosRawFree(arena->base, arena->capacity);
+    arena->base = NULL;
+    arena->capacity = 0;
+    arena->offset = 0;
+}
+
+HELIOS_INTERNAL void *_HeliosArenaAllocStub(void *user, UZ size) {
+    return HeliosArenaAlloc((HeliosArena *)user, size);
+}
+
+HELIOS_INTERNAL void *_HeliosArenaAllocZeroedStub(void *user, UZ size) {
+    return HeliosArenaAllocZeroed((HeliosArena *)user, size);
+}
+
+HELIOS_INTERNAL void *_HeliosArenaReallocStub(void *user, void *ptr, UZ old_size, UZ new_size) {
+    return HeliosArenaRealloc((HeliosArena *)user, ptr, old_size, new_size);
+}
+
+HELIOS_INTERNAL void _HeliosArenaFreeStub(void *user, void *ptr, UZ size) {
+    HeliosArenaFree((HeliosArena *)user, ptr, size);
+}
+
+HELIOS_DEF HeliosAllocator HeliosNewArenaAllocator(HeliosArena *arena) {
+    return (HeliosAllocator) {
+        .data = (void *)arena,
+        .vtable = (HeliosAllocatorVTable) {
+            .alloc = _HeliosArenaAllocStub,
+            .free = _HeliosArenaFreeStub,
+            .realloc = _HeliosArenaReallocStub,
+            .alloc_zeroed = _HeliosArenaAllocZeroedStub,
+        },
+    };
+}
+
+HELIOS_DEF B32 HeliosVirtualArenaInit(HeliosVirtualArena *arena, UZ reserve_size, HeliosVirtualArenaFlags flags) {
+    UZ align = HELIOS_PAGE_ALIGNMENT;
+    UZ commit_step = HELIOS_VIRTUAL_ARENA_COMMIT_STEP;
+
+    if (flags & HeliosVirtualArenaFlag_HugePages) {
+        align = HELIOS_HUGE_PAGE_SIZE;
+        commit_step = HELIOS_HUGE_PAGE_SIZE;
+    }
+
+    reserve_size = HeliosRoundUp(reserve_size, align);
+
+    arena->base = (U8 *)HeliosRawReserve(reserve_size, align);
+    if (arena->base == NULL) return 0;
+
+#if defined(HELIOS_PLATFORM_POSIX) && defined(MADV_HUGEPAGE)
+    // Only a hint, THP might be disabled system-wide.
+    if (flags & HeliosVirtualArenaFlag_HugePages) madvise(arena->base, reserve_size, MADV_HUGEPAGE);
+#endif // MADV_HUGEPAGE
+
+    arena->reserved = reserve_size;
+    arena->committed = 0;
+    arena->commit_step = commit_step;
+    arena->offset = 0;
+    arena->last_offset = 0;
+    arena->dirty = 0;
+    arena->flags = flags;
+    return 1;
+}
+
+HELIOS_DEF void HeliosVirtualArenaRelease(HeliosVirtualArena *arena) {
+    HeliosRawFree(arena->base, arena->reserved);
+    arena->base = NULL;
+    arena->reserved = 0;
+    arena->committed = 0;
+    arena->offset = 0;
+}
+
+HELIOS_DEF void HeliosVirtualArenaCommitUpTo(HeliosVirtualArena *arena, UZ end) {
+    if (end <= arena->committed) return;
+
+    if (end > arena->reserved) {
+        HELIOS_PANIC_FMT("virtual arena of " HELIOS_UZ_FMT " bytes exhausted", arena->reserved);
+    }
+
+    UZ new_committed = HELIOS_MIN(HeliosRoundUp(end, arena->commit_step), arena->reserved);
+    HELIOS_VERIFY(HeliosRawCommit(arena->base + arena->committed, new_committed - arena->committed));
+    arena->committed = new_committed;
+}
+
+HELIOS_DEF void HeliosVirtualArenaDecommit(HeliosVirtualArena *arena, UZ watermark) {
+    UZ keep = HeliosRoundUp(HELIOS_MAX(watermark, arena->offset), arena->commit_step);
+    if (keep >= arena->committed) return;
+
+    HeliosRawDecommit(arena->base + keep, arena->committed - keep);
+    arena->committed = keep;
+    // Decommitted memory comes back zeroed.
+    if (arena->dirty > keep) arena->dirty = keep;
+}
+
+HELIOS_INTERNAL void *_HeliosVirtualArenaAllocStub(void *user, UZ size) {
+    return HeliosVirtualArenaAlloc((HeliosVirtualArena *)user, size);
+}
+
+HELIOS_INTERNAL void *_HeliosVirtualArenaAllocZeroedStub(void *user, UZ size) {
+    return HeliosVirtualArenaAllocZeroed((HeliosVirtualArena *)user, size);
+}
+
+HELIOS_INTERNAL void *_HeliosVirtualArenaReallocStub(void *user, void *ptr, UZ old_size, UZ new_size) {
+    return HeliosVirtualArenaRealloc((HeliosVirtualArena *)user, ptr, old_size, new_size);
+}
+
+HELIOS_INTERNAL void _HeliosVirtualArenaFreeStub(void *user, void *ptr, UZ size) {
+    HeliosVirtualArenaFree((HeliosVirtualArena *)user, ptr, size);
+}
+
+HELIOS_DEF HeliosAllocator HeliosNewVirtualArenaAllocator(HeliosVirtualArena *arena) {
+    return (HeliosAllocator) {
+        .data = (void *)arena,
+        .vtable = (HeliosAllocatorVTable) {
+            .alloc = _HeliosVirtualArenaAllocStub,
+            .free = _HeliosVirtualArenaFreeStub,
+            .realloc = _HeliosVirtualArenaReallocStub,
+            .alloc_zeroed = _HeliosVirtualArenaAllocZeroedStub,
+        },
+    };
+}
+
+#ifdef HELIOS_STATIC
+HELIOS_INTERNAL
+#endif // HELIOS_STATIC
+HELIOS_THREAD_LOCAL HeliosCallsite helios_current_callsite;
+
+HELIOS_DEF void HeliosTrackingAllocatorInit(HeliosTrackingAllocator *tracker, HeliosAllocator inner) {
+    memset(tracker, 0, sizeof(*tracker));
+    tracker->inner = inner;
+}
+
+HELIOS_INTERNAL B32 _HeliosCallsiteFileEqual(const char *a, const char *b) {
+    if (a == b) return 1;
+    if (a == NULL || b == NULL) return 0;
+    return strcmp(a, b) == 0;
+}
+
+HELIOS_INTERNAL void _HeliosTrackingRecord(HeliosTrackingAllocator *tracker, UZ size) {
+    HeliosCallsite callsite = helios_current_callsite;
+    helios_current_callsite = (HeliosCallsite) {0};
+
+    UZ bucket = 0;
+    for (UZ s = size; s != 0; s >>= 1) ++bucket;
+    ++tracker->histogram[HELIOS_MIN(bucket, HELIOS_TRACKING_HISTOGRAM_BUCKETS - 1)];
+
+    tracker->total_bytes += size;
+
+    // Callsites are keyed by the contents of the file name, a header inlined into several translation
+    // units gets a different `__FILE__` literal in each of them.
+    UZ file_count = callsite.file != NULL ? strlen(callsite.file) : 0;
+    UZ hash = (UZ)HeliosHashBytes(callsite.file, file_count) * 31 + callsite.line;
+    UZ idx = (hash * 0x9E3779B97F4A7C15ull) % HELIOS_TRACKING_MAX_CALLSITES;
+
+    for (UZ probes = 0; probes < HELIOS_TRACKING_MAX_CALLSITES; ++probes) {
+        HeliosTrackingCallsite *entry = &tracker->callsites[idx];
+
+        if (entry->count == 0) {
+            entry->callsite = callsite;
+            ++tracker->callsites_count;
+        }
+
+        if (entry->callsite.line == callsite.line && _HeliosCallsiteFileEqual(entry->callsite.file, callsite.file)) {
+            ++entry->count;
+            entry->bytes += size;
+            return;
+        }
+
+        if (++idx == HELIOS_TRACKING_MAX_CALLSITES) idx = 0;
+    }
+
+    // The table is full, the allocation still counts towards the totals.
+}
+
+HELIOS_INTERNAL void _HeliosTrackingGrow(HeliosTrackingAllocator *tracker, UZ size) {
+    tracker->live_bytes += size;
+    if (tracker->live_bytes > tracker->peak_bytes) tracker->peak_bytes = tracker->live_bytes;
+}
+
+HELIOS_INTERNAL void *_HeliosTrackingAllocStub(void *user, UZ size) {
+    HeliosTrackingAllocator *tracker = (HeliosTrackingAllocator *)user;
+    ++tracker->alloc_count;
+    _HeliosTrackingRecord(tracker, size);
+    _HeliosTrackingGrow(tracker, size);
+    return tracker->inner.vtable.alloc(tracker->inner.data, size);
+}
+
+HELIOS_INTERNAL void *_HeliosTrackingAllocZeroedStub(void *user, UZ size) {
+    HeliosTrackingAllocator *tracker = (HeliosTrackingAllocator *)user;
+    ++tracker->alloc_count;
+    _HeliosTrackingRecord(tracker, size);
+    _HeliosTrackingGrow(tracker, size);
+
+    HeliosAllocator inner = tracker->inner;
+    if (inner.vtable.alloc_zeroed != NULL) return inner.vtable.alloc_zeroed(inner.data, size);
+    return memset(inner.vtable.alloc(inner.data, size), 0, size);
+}
+
+HELIOS_INTERNAL void *_HeliosTrackingReallocStub(void *user, void *ptr, UZ old_size, UZ new_size) {
+    HeliosTrackingAllocator *tracker = (HeliosTrackingAllocator *)user;
+    ++tracker->realloc_count;
+    _HeliosTrackingRecord(tracker, new_size);
+    tracker->live_bytes -= old_size;
+    _HeliosTrackingGrow(tracker, new_size);
+
+    HeliosAllocator inner = tracker->inner;
+    if (inner.vtable.realloc != NULL) return inner.vtable.realloc(inner.data, ptr, old_size, new_size);
+
+    void *new_ptr = inner.vtable.alloc(inner.data, new_size);
+    memcpy(new_ptr, ptr, HELIOS_MIN(old_size, new_size));
+    inner.vtable.free(inner.data, ptr, old_size);
+    return new_ptr;
+}
+
+HELIOS_INTERNAL void _HeliosTrackingFreeStub(void *user, void *ptr, UZ size) {
+    HeliosTrackingAllocator *tracker = (HeliosTrackingAllocator *)user;
+    ++tracker->free_count;
+    tracker->live_bytes -= size;
+    tracker->inner.vtable.free(tracker->inner.data, ptr, size);
+}
+
+HELIOS_DEF HeliosAllocator HeliosNewTrackingAllocator(HeliosTrackingAllocator *tracker) {
+    return (HeliosAllocator) {
+        .data = (void *)tracker,
+        .vtable = (HeliosAllocatorVTable) {
+            .alloc = _HeliosTrackingAllocStub,
+            .free = _HeliosTrackingFreeStub,
+            .realloc = _HeliosTrackingReallocStub,
+            .alloc_zeroed = _HeliosTrackingAllocZeroedStub,
+        },
+    };
+}
+
+HELIOS_INTERNAL int _HeliosTrackingCallsiteCompare(const void *lhs_ptr, const void *rhs_ptr) {
+    const HeliosTrackingCallsite *lhs = *(const HeliosTrackingCallsite **)lhs_ptr;
+    const HeliosTrackingCallsite *rhs = *(const HeliosTrackingCallsite **)rhs_ptr;
+    if (lhs->bytes != rhs->bytes) return lhs->bytes < rhs->bytes ? 1 : -1;
+    if (lhs->count != rhs->count) return lhs->count < rhs->count ? 1 : -1;
+    return 0;
+}
+
+HELIOS_DEF void HeliosTrackingAllocatorReport(HeliosTrackingAllocator *tracker, FILE *out) {
+    fprintf(out, "live bytes:  %llu\n", (unsigned long long)tracker->live_bytes);
+    fprintf(out, "peak bytes:  %llu\n", (unsigned long long)tracker->peak_bytes);
+    fprintf(out, "total bytes: %llu\n", (unsigned long long)tracker->total_bytes);
+    fprintf(out, "allocs: %llu, reallocs: %llu, frees: %llu\n",
+            (unsigned long long)tracker->alloc_count,
+            (unsigned long long)tracker->realloc_count,
+            (unsigned long long)tracker->free_count);
+
+    fprintf(out, "size histogram:\n");
+    for (UZ i = 0; i < HELIOS_TRACKING_HISTOGRAM_BUCKETS; ++i) {
+        if (tracker->histogram[i] == 0) continue;
+
+        if (i == 0) fprintf(out, "  %20s: %llu\n", "0", (unsigned long long)tracker->histogram[i]);
+        else fprintf(out, "  %9llu..%-9llu: %llu\n",
+                     (unsigned long long)1 << (i - 1),
+                     ((unsigned long long)1 << i) - 1,
+                     (unsigned long long)tracker->histogram[i]);
+    }
+
+    HeliosAllocator temp = HeliosGetTempAllocator();
+    HeliosTrackingCallsite **sorted = (HeliosTrackingCallsite **)HeliosAllocUninit(temp, sizeof(*sorted) * tracker->callsites_count);
+    UZ sorted_count = 0;
+    for (UZ i = 0; i < HELIOS_TRACKING_MAX_CALLSITES; ++i) {
+        if (tracker->callsites[i].count != 0) sorted[sorted_count++] = &tracker->callsites[i];
+    }
+    qsort(sorted, sorted_count, sizeof(*sorted), _HeliosTrackingCallsiteCompare);
+
+    fprintf(out, "callsites:\n");
+    for (UZ i = 0; i < sorted_count; ++i) {
+        HeliosTrackingCallsite *entry = sorted[i];
+        const char *file = entry->callsite.file != NULL ? entry->callsite.file : "<unknown>";
+        fprintf(out, "  %s:%u: %llu bytes in %llu allocations\n",
+                file,
+                entry->callsite.line,
+                (unsigned long long)entry->bytes,
+                (unsigned long long)entry->count);
+    }
+}
+
+HELIOS_INTERNAL void _HeliosPoolSlabUnlink(HeliosPoolSlab **list, HeliosPoolSlab *slab) {
+    if (slab->prev != NULL) slab->prev->next = slab->next;
+    else *list = slab->next;
+    if (slab->next != NULL) slab->next->prev = slab->prev;
+    slab->next = NULL;
+    slab->prev = NULL;
+}
+
+HELIOS_INTERNAL void _HeliosPoolSlabLink(HeliosPoolSlab **list, HeliosPoolSlab *slab) {
+    slab->prev = NULL;
+    slab->next = *list;
+    if (*list != NULL) (*list)->prev = slab;
+    *list = slab;
+}
+
+HELIOS_DEF void HeliosPoolAllocatorInit(HeliosPoolAllocator *pool, UZ object_size, UZ slab_size) {
+    if (slab_size == 0) slab_size = HELIOS_POOL_DEFAULT_SLAB_SIZE;
+    // Slabs are found by masking object addresses.
+    HELIOS_VERIFY((slab_size & (slab_size - 1)) == 0);
+
+    pool->object_size = HeliosRoundUp(HELIOS_MAX(object_size, sizeof(void *)), sizeof(void *));
+    pool->slab_size = slab_size;
+    pool->first_object_offset = HeliosRoundUp(sizeof(HeliosPoolSlab), sizeof(UZ) * 2);
+    HELIOS_VERIFY(pool->first_object_offset + pool->object_size <= slab_size);
+    pool->objects_per_slab = (U32)((slab_size - pool->first_object_offset) / pool->object_size);
+    pool->partial = NULL;
+    pool->full = NULL;
+    pool->empty = NULL;
+    pool->slab_count = 0;
+    pool->lock = (HeliosSpinLock)HELIOS_SPIN_LOCK_INIT;
+}
+
+HELIOS_DEF void HeliosPoolAllocatorDestroy(HeliosPoolAllocator *pool) {
+    HeliosPoolSlab *lists[] = { pool->partial, pool->full, pool->empty };
+    for (UZ i = 0; i < sizeof(lists) / sizeof(lists[0]); ++i) {
+        HeliosPoolSlab *slab = lists[i];
+        while (slab != NULL) {
+            HeliosPoolSlab *next = slab->next;
+            HeliosRawFree(slab, pool->slab_size);
+            slab = next;
+        }
+    }
+
+    pool->partial = NULL;
+    pool->full = NULL;
+    pool->empty = NULL;
+    pool->slab_count = 0;
+}
+
+HELIOS_DEF void *HeliosPoolAlloc(HeliosPoolAllocator *pool) {
+    HeliosPoolSlab *slab = pool->partial;
+
+    if (slab == NULL) {
+        if (pool->empty != NULL) {
+            slab = pool->empty;
+            pool->empty = NULL;
+        } else {
+            slab = (HeliosPoolSlab *)HeliosRawAllocAligned(pool->slab_size, pool->slab_size);
+            HELIOS_VERIFY(slab != NULL);
+            ++pool->slab_count;
+        }
+
+        slab->free_list = NULL;
+        slab->live = 0;
+        slab->carved = 0;
+        _HeliosPoolSlabLink(&pool->partial, slab);
+    }
+
+    void *ptr;
+    if (slab->free_list != NULL) {
+        ptr = slab->free_list;
+        slab->free_list = *(void **)ptr;
+    } else {
+        ptr = (U8 *)slab + pool->first_object_offset + (UZ)slab->carved * pool->object_size;
+        ++slab->carved;
+    }
+
+    if (++slab->live == pool->objects_per_slab) {
+        _HeliosPoolSlabUnlink(&pool->partial, slab);
+        _HeliosPoolSlabLink(&pool->full, slab);
+    }
+
+    return ptr;
+}
+
+HELIOS_DEF void HeliosPoolFree(HeliosPoolAllocator *pool, void *ptr) {
+    if (ptr == NULL) return;
+
+    HeliosPoolSlab *slab = (HeliosPoolSlab *)HeliosRoundDown((UZ)ptr, pool->slab_size);
+
+    *(void **)ptr = slab->free_list;
+    slab->free_list = ptr;
+
+    if (slab->live-- == pool->objects_per_slab) {
+        _HeliosPoolSlabUnlink(&pool->full, slab);
+        _HeliosPoolSlabLink(&pool->partial, slab);
+    }
+
+    if (slab->live == 0) {
+        _HeliosPoolSlabUnlink(&pool->partial, slab);
+
+        if (pool->empty == NULL) {
+            pool->empty = slab;
+        } else {
+            HeliosRawFree(slab, pool->slab_size);
+            --pool->slab_count;
+        }
+    }
+}
+
+HELIOS_INTERNAL void *_HeliosPoolAllocStub(void *user, UZ size) {
+    HeliosPoolAllocator *pool = (HeliosPoolAllocator *)user;
+    HELIOS_VERIFY(size <= pool->object_size);
+    return HeliosPoolAlloc(pool);
+}
+
+HELIOS_INTERNAL void _HeliosPoolFreeStub(void *user, void *ptr, UZ size) {
+    HELIOS_UNUSED(size);
+    HeliosPoolFree((HeliosPoolAllocator *)user, ptr);
+}
+
+HELIOS_INTERNAL void *_HeliosPoolReallocStub(void *user, void *ptr, UZ old_size, UZ new_size) {
+    HELIOS_UNUSED(old_size);
+    HELIOS_VERIFY(new_size <= ((HeliosPoolAllocator *)user)->object_size);
+    return ptr;
+}
+
+HELIOS_DEF HeliosAllocator HeliosNewPoolAllocator(HeliosPoolAllocator *pool) {
+    return (HeliosAllocator) {
+        .data = (void *)pool,
+        .vtable = (HeliosAllocatorVTable) {
+            .alloc = _HeliosPoolAllocStub,
+            .free = _HeliosPoolFreeStub,
+            .realloc = _HeliosPoolReallocStub,
+            .alloc_zeroed = NULL,
+        },
+    };
+}
+
+HELIOS_DEF void HeliosPoolCacheInit(HeliosPoolCache *cache, HeliosPoolAllocator *pool) {
+    cache->pool = pool;
+    cache->free_list = NULL;
+    cache->count = 0;
+}
+
+HELIOS_DEF void *HeliosPoolCacheAlloc(HeliosPoolCache *cache) {
+    if (cache->free_list == NULL) {
+        HeliosPoolAllocator *pool = cache->pool;
+
+        HeliosSpinLockAcquire(&pool->lock);
+        for (U32 i = 0; i < HELIOS_POOL_CACHE_BATCH; ++i) {
+            void *ptr = HeliosPoolAlloc(pool);
+            *(void **)ptr = cache->free_list;
+            cache->free_list = ptr;
+        }
+        HeliosSpinLockRelease(&pool->lock);
+
+        cache->count = HELIOS_POOL_CACHE_BATCH;
+    }
+
+    void *ptr = cache->free_list;
+    cache->free_list = *(void **)ptr;
+    --cache->count;
+    return ptr;
+}
+
+HELIOS_INTERNAL void _HeliosPoolCacheDrain(HeliosPoolCache *cache, U32 count) {
+    HeliosPoolAllocator *pool = cache->pool;
+
+    HeliosSpinLockAcquire(&pool->lock);
+    for (U32 i = 0; i < count; ++i) {
+        void *ptr = cache->free_list;
+        cache->free_list = *(void **)ptr;
+        HeliosPoolFree(pool, ptr);
+    }
+    HeliosSpinLockRelease(&pool->lock);
+
+    cache->count -= count;
+}
+
+HELIOS_DEF void HeliosPoolCacheFree(HeliosPoolCache *cache, void *ptr) {
+    if (ptr == NULL) return;
+
+    *(void **)ptr = cache->free_list;
+    cache->free_list = ptr;
+    ++cache->count;
+
+    if (cache->count >= HELIOS_POOL_CACHE_BATCH * 2) _HeliosPoolCacheDrain(cache, HELIOS_POOL_CACHE_BATCH);
+}
+
+HELIOS_DEF void HeliosPoolCacheFlush(HeliosPoolCache *cache) {
+    if (cache->count != 0) _HeliosPoolCacheDrain(cache, cache->count);
+}
+
+HELIOS_INTERNAL void *_HeliosPoolCacheAllocStub(void *user, UZ size) {
+    HeliosPoolCache *cache = (HeliosPoolCache *)user;
+    HELIOS_VERIFY(size <= cache->pool->object_size);
+    return HeliosPoolCacheAlloc(cache);
+}
+
+HELIOS_INTERNAL void _HeliosPoolCacheFreeStub(void *user, void *ptr, UZ size) {
+    HELIOS_UNUSED(size);
+    HeliosPoolCacheFree((HeliosPoolCache *)user, ptr);
+}
+
+HELIOS_INTERNAL void *_HeliosPoolCacheReallocStub(void *user, void *ptr, UZ old_size, UZ new_size) {
+    HELIOS_UNUSED(old_size);
+    HELIOS_VERIFY(new_size <= ((HeliosPoolCache *)user)->pool->object_size);
+    return ptr;
+}
+
+HELIOS_DEF HeliosAllocator HeliosNewPoolCacheAllocator(HeliosPoolCache *cache) {
+    return (HeliosAllocator) {
+        .data = (void *)cache,
+        .vtable = (HeliosAllocatorVTable) {
+            .alloc = _HeliosPoolCacheAllocStub,
+            .free = _HeliosPoolCacheFreeStub,
+            .realloc = _HeliosPoolCacheReallocStub,
+            .alloc_zeroed = NULL,
+        },
+    };
+}
+
 HELIOS_DEF void HeliosString8GrowIfNeeded(HeliosString8 *s, UZ size) {
     if (s->capacity >= size) return;
 
     UZ c = ((s->capacity + 1) * 3) >> 1;
     UZ new_cap = HELIOS_MAX(size, c);
-    s->data = HeliosRealloc(s->allocator, s->data, s->count, new_cap);
+    s->data = HeliosRealloc(s->allocator, s->data, s->capacity, new_cap);
     s->capacity = new_cap;
 }
 
 HELIOS_DEF void HeliosString8FormatAppend(HeliosString8 *s, const char *fmt, ...) {
     va_list vargs;
     va_start(vargs, fmt);
-    S32 n = vsnprintf(NULL, 0, fmt, vargs) + 1;
-    va_end(vargs);
 
-    HeliosString8GrowIfNeeded(s, s->count + n);
+    // Try the spare capacity first, the arguments only get formatted twice when they do not fit.
+    UZ space = s->capacity - s->count;
+    va_list copy;
+    va_copy(copy, vargs);
+    S32 n = vsnprintf(space != 0 ? (char *)s->data + s->count : NULL, space, fmt, copy);
+    va_end(copy);
 
-    va_start(vargs, fmt);
-    vsprintf((char *)s->data + s->count, fmt, vargs);
+    if (n >= 0 && (UZ)n >= space) {
+        HeliosString8GrowIfNeeded(s, s->count + (UZ)n + 1);
+        vsnprintf((char *)s->data + s->count, (UZ)n + 1, fmt, vargs);
+    }
     va_end(vargs);
 
-    s->count += n - 1;
+    if (n > 0) s->count += (UZ)n;
 }
 
 HELIOS_DEF void HeliosString8StreamInit(HeliosString8Stream *stream, const U8 *data, UZ count) {
@@ -640,81 +2473,2842 @@ HELIOS_DEF void HeliosString8StreamRetreat(HeliosString8Stream *s) {
     s->last_char_size = -1;
 }
 
-#ifdef HELIOS_PLATFORM_POSIX
-HELIOS_DEF HeliosStringView HeliosReadEntireFile(HeliosAllocator allocator, HeliosStringView path) {
-    HeliosAllocator temp = HeliosGetTempAllocator();
-    char *path_cstr = HeliosStringViewCloneToCStr(temp, path);
+HELIOS_DEF B32 HeliosString8StreamSkipTo(HeliosString8Stream *stream, U8 byte) {
+    HELIOS_ASSERT(byte < 0x80);
 
-    SZ fd = open(path_cstr, O_RDONLY);
-    if (fd == -1) {
-        return (HeliosStringView) {.data = NULL, .count = 0};
+    UZ start = stream->byte_offset + 1;
+    UZ remaining = start < stream->count ? stream->count - start : 0;
+    const U8 *data = stream->data + start;
+
+    UZ index = HeliosFindByte(data, remaining, byte);
+    stream->char_offset += HeliosUtf8Count(data, index < remaining ? index + 1 : remaining);
+
+    if (index < remaining) {
+        stream->byte_offset = start + index;
+        stream->last_char_size = 1;
+        return 1;
     }
 
-    struct stat file_stat;
-    int ret = fstat(fd, &file_stat);
-    if (ret == -1) {
-        return (HeliosStringView) {.data = NULL, .count = 0};
+    // Same as a failed `Next`, the last char read is the last one of the data.
+    if (remaining != 0) {
+        UZ last = stream->count - 1;
+        while (last > start && (stream->data[last] & 0xC0) == 0x80) --last;
+        stream->last_char_size = (S8)(stream->count - last);
     }
+    stream->byte_offset = HELIOS_MAX(start, stream->count);
+    return 0;
+}
 
-    size_t file_size = file_stat.st_size;
-    U8 *file_buf = HeliosAlloc(allocator, file_size);
+#define _HELIOS_INTERNER_MIN_SLOTS 64
 
-    size_t total_bytes_read = 0;
-    while (total_bytes_read != file_size) {
-        ssize_t n = read(fd, &file_buf[total_bytes_read], file_size - total_bytes_read);
-        if (n == -1) {
-            HeliosFree(allocator, file_buf, file_size);
-            return (HeliosStringView) {.data = NULL, .count = 0};
-        }
-        total_bytes_read += (size_t)n;
-    }
+HELIOS_DEF B32 HeliosInternerInit(HeliosInterner *interner, HeliosAllocator allocator, UZ reserve_size) {
+    if (reserve_size == 0) reserve_size = HELIOS_INTERNER_DEFAULT_RESERVE;
+    if (!HeliosVirtualArenaInit(&interner->arena, reserve_size, 0)) return 0;
 
-    return (HeliosStringView) {.data = file_buf, .count = file_size};
+    interner->allocator = allocator;
+    interner->slot_count = _HELIOS_INTERNER_MIN_SLOTS;
+    interner->slots = (U64 *)HeliosAllocZeroed(allocator, sizeof(U64) * interner->slot_count);
+    interner->capacity = _HELIOS_INTERNER_MIN_SLOTS / 2;
+    interner->strings = (HeliosStringView *)HeliosAllocUninit(allocator, sizeof(HeliosStringView) * interner->capacity);
+    interner->count = 0;
+    return 1;
 }
-#endif // HELIOS_PLATFORM_POSIX
 
-#ifdef HELIOS_PLATFORM_WINDOWS
-HELIOS_DEF HeliosStringView HeliosReadEntireFile(HeliosAllocator allocator, HeliosStringView path) {
+HELIOS_DEF void HeliosInternerDestroy(HeliosInterner *interner) {
+    HeliosFree(interner->allocator, interner->slots, sizeof(U64) * interner->slot_count);
+    HeliosFree(interner->allocator, interner->strings, sizeof(HeliosStringView) * interner->capacity);
+    HeliosVirtualArenaRelease(&interner->arena);
+}
+
+// Returns the slot holding `sv`, or the empty slot where it would go.
+HELIOS_INTERNAL UZ _HeliosInternerProbe(const HeliosInterner *interner, HeliosStringView sv, U64 hash) {
+    UZ mask = interner->slot_count - 1;
+    U64 tag = hash & 0xFFFFFFFF00000000ull;
+
+    for (UZ i = (UZ)hash & mask;; i = (i + 1) & mask) {
+        U64 slot = interner->slots[i];
+        if (slot == 0) return i;
+        if ((slot & 0xFFFFFFFF00000000ull) != tag) continue;
+
+        HeliosStringView candidate = interner->strings[(U32)slot - 1];
+        if (HeliosStringViewEqual(candidate, sv)) return i;
+    }
+}
+
+HELIOS_INTERNAL void _HeliosInternerGrow(HeliosInterner *interner) {
+    UZ old_count = interner->slot_count;
+    U64 *old_slots = interner->slots;
+
+    interner->slot_count = old_count * 2;
+    interner->slots = (U64 *)HeliosAllocZeroed(interner->allocator, sizeof(U64) * interner->slot_count);
+
+    // The tag only has the upper half of the hash, so the strings have to be hashed again.
+    UZ mask = interner->slot_count - 1;
+    for (UZ i = 0; i < old_count; ++i) {
+        U64 slot = old_slots[i];
+        if (slot == 0) continue;
+
+        U64 hash = HeliosStringViewHash(interner->strings[(U32)slot - 1]);
+        UZ j = (UZ)hash & mask;
+        while (interner->slots[j] != 0) j = (j + 1) & mask;
+        interner->slots[j] = slot;
+    }
+
+    HeliosFree(interner->allocator, old_slots, sizeof(U64) * old_count);
+}
+
+HELIOS_DEF HeliosInternId HeliosInternerFind(const HeliosInterner *interner, HeliosStringView sv) {
+    U64 slot = interner->slots[_HeliosInternerProbe(interner, sv, HeliosStringViewHash(sv))];
+    return (HeliosInternId)slot;
+}
+
+HELIOS_DEF HeliosInternId HeliosInternerIntern(HeliosInterner *interner, HeliosStringView sv) {
+    U64 hash = HeliosStringViewHash(sv);
+    UZ index = _HeliosInternerProbe(interner, sv, hash);
+    if (interner->slots[index] != 0) return (HeliosInternId)interner->slots[index];
+
+    // Keep the load factor at or below 3/4.
+    if ((UZ)(interner->count + 1) * 4 > interner->slot_count * 3) {
+        _HeliosInternerGrow(interner);
+        index = _HeliosInternerProbe(interner, sv, hash);
+    }
+
+    if (interner->count == interner->capacity) {
+        U32 new_capacity = interner->capacity * 2;
+        interner->strings = (HeliosStringView *)HeliosRealloc(interner->allocator,
+                                                              interner->strings,
+                                                              sizeof(HeliosStringView) * interner->capacity,
+                                                              sizeof(HeliosStringView) * new_capacity);
+        interner->capacity = new_capacity;
+    }
+
+    HeliosInternId id = interner->count + 1;
+
+    U8 *data = (U8 *)HeliosVirtualArenaAlloc(&interner->arena, sizeof(id) + sv.count + 1);
+    memcpy(data, &id, sizeof(id));
+    data += sizeof(id);
+    memcpy(data, sv.data, sv.count);
+    data[sv.count] = '\0';
+
+    interner->strings[interner->count++] = (HeliosStringView) { .data = data, .count = sv.count };
+    interner->slots[index] = (hash & 0xFFFFFFFF00000000ull) | id;
+    return id;
+}
+
+HELIOS_INTERNAL HeliosStringChunk *_HeliosStringBuilderNewChunk(HeliosStringBuilder *sb, UZ capacity) {
+    HeliosStringChunk *chunk = (HeliosStringChunk *)HeliosAllocUninit(sb->allocator, sizeof(HeliosStringChunk) + capacity);
+    chunk->next = NULL;
+    chunk->data = (U8 *)(chunk + 1);
+    chunk->count = 0;
+    chunk->capacity = capacity;
+    return chunk;
+}
+
+HELIOS_DEF void HeliosStringBuilderInit(HeliosStringBuilder *sb, HeliosAllocator allocator, UZ chunk_size) {
+    sb->allocator = allocator;
+    sb->first = NULL;
+    sb->last = NULL;
+    sb->count = 0;
+    sb->chunk_size = chunk_size != 0 ? chunk_size : HELIOS_STRING_BUILDER_CHUNK_SIZE;
+}
+
+HELIOS_DEF void HeliosStringBuilderDestroy(HeliosStringBuilder *sb) {
+    HeliosStringChunk *chunk = sb->first;
+    while (chunk != NULL) {
+        HeliosStringChunk *next = chunk->next;
+        HeliosFree(sb->allocator, chunk, sizeof(HeliosStringChunk) + chunk->capacity);
+        chunk = next;
+    }
+
+    sb->first = NULL;
+    sb->last = NULL;
+    sb->count = 0;
+}
+
+HELIOS_DEF void HeliosStringBuilderReset(HeliosStringBuilder *sb) {
+    for (HeliosStringChunk *chunk = sb->first; chunk != NULL; chunk = chunk->next) chunk->count = 0;
+
+    sb->last = sb->first;
+    sb->count = 0;
+}
+
+HELIOS_DEF U8 *HeliosStringBuilderReserve(HeliosStringBuilder *sb, UZ size) {
+    HeliosStringChunk *last = sb->last;
+    if (last != NULL && last->capacity - last->count >= size) return last->data + last->count;
+
+    if (last == NULL) {
+        sb->first = sb->last = _HeliosStringBuilderNewChunk(sb, HELIOS_MAX(size, sb->chunk_size));
+        return sb->last->data;
+    }
+
+    // Chunks left over from a reset that are too small for this reservation are dropped.
+    while (last->next != NULL && last->next->capacity < size) {
+        HeliosStringChunk *next = last->next;
+        last->next = next->next;
+        HeliosFree(sb->allocator, next, sizeof(HeliosStringChunk) + next->capacity);
+    }
+
+    if (last->next == NULL) last->next = _HeliosStringBuilderNewChunk(sb, HELIOS_MAX(size, sb->chunk_size));
+
+    sb->last = last->next;
+    return sb->last->data;
+}
+
+HELIOS_DEF void HeliosStringBuilderAppend(HeliosStringBuilder *sb, const void *data, UZ count) {
+    const U8 *bytes = (const U8 *)data;
+
+    HeliosStringChunk *last = sb->last;
+    if (last != NULL) {
+        UZ n = HELIOS_MIN(count, last->capacity - last->count);
+        memcpy(last->data + last->count, bytes, n);
+        last->count += n;
+        sb->count += n;
+        bytes += n;
+        count -= n;
+    }
+
+    if (count == 0) return;
+
+    memcpy(HeliosStringBuilderReserve(sb, count), bytes, count);
+    HeliosStringBuilderCommit(sb, count);
+}
+
+HELIOS_INTERNAL const char _helios_digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// Writes the decimal digits of `value` so that they end right before `end`, returns the first digit.
+HELIOS_INTERNAL U8 *_HeliosFormatU64Backwards(U8 *end, U64 value) {
+    while (value >= 100) {
+        U64 pair = (value % 100) * 2;
+        value /= 100;
+        end -= 2;
+        memcpy(end, &_helios_digit_pairs[pair], 2);
+    }
+
+    if (value >= 10) {
+        end -= 2;
+        memcpy(end, &_helios_digit_pairs[value * 2], 2);
+    } else {
+        *--end = (U8)('0' + value);
+    }
+
+    return end;
+}
+
+HELIOS_DEF void HeliosStringBuilderAppendU64(HeliosStringBuilder *sb, U64 value) {
+    U8 buf[20];
+    U8 *start = _HeliosFormatU64Backwards(buf + sizeof(buf), value);
+    HeliosStringBuilderAppend(sb, start, (UZ)(buf + sizeof(buf) - start));
+}
+
+HELIOS_DEF void HeliosStringBuilderAppendS64(HeliosStringBuilder *sb, S64 value) {
+    U8 buf[21];
+    U64 magnitude = value < 0 ? 0 - (U64)value : (U64)value;
+    U8 *start = _HeliosFormatU64Backwards(buf + sizeof(buf), magnitude);
+    if (value < 0) *--start = '-';
+    HeliosStringBuilderAppend(sb, start, (UZ)(buf + sizeof(buf) - start));
+}
+
+#define _HELIOS_F64_FAST_MAX_PRECISION 15
+
+HELIOS_INTERNAL const F64 _helios_f64_powers_of_ten[_HELIOS_F64_FAST_MAX_PRECISION + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+};
+
+HELIOS_DEF void HeliosStringBuilderAppendF64(HeliosStringBuilder *sb, F64 value, U32 precision) {
+    U64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    B32 negative = (B32)(bits >> 63);
+    F64 magnitude = negative ? -value : value;
+
+    // The scaled value must be exactly representable as an integer, NaN and infinities fail the comparison.
+    F64 scaled = precision <= _HELIOS_F64_FAST_MAX_PRECISION ? magnitude * _helios_f64_powers_of_ten[precision] : 0.0;
+    if (precision > _HELIOS_F64_FAST_MAX_PRECISION || !(scaled < 9007199254740992.0)) {
+        HeliosStringBuilderFormat(sb, "%.*f", (int)precision, value);
+        return;
+    }
+
+    // The product is off by at most half an ulp of `scaled`, so the fraction alone only decides the rounding
+    // when it is further than that from one half. Ties and near ties are left to snprintf, which rounds
+    // the exact binary value.
+    U64 n = (U64)scaled;
+    F64 fraction = scaled - (F64)n;
+    F64 error = scaled * 2.220446049250313e-16;
+    if (fraction - 0.5 <= error && 0.5 - fraction <= error) {
+        HeliosStringBuilderFormat(sb, "%.*f", (int)precision, value);
+        return;
+    }
+    if (fraction > 0.5) ++n;
+
+    U64 scale = (U64)_helios_f64_powers_of_ten[precision];
+    U64 int_part = n / scale;
+    U64 frac_part = n % scale;
+
+    // Sign, 16 integer digits, the point and the fraction.
+    U8 buf[1 + 16 + 1 + _HELIOS_F64_FAST_MAX_PRECISION];
+    U8 *end = buf + sizeof(buf);
+    U8 *start = end;
+    if (precision != 0) {
+        start = _HeliosFormatU64Backwards(end, frac_part);
+        while ((UZ)(end - start) < precision) *--start = '0';
+        *--start = '.';
+    }
+    start = _HeliosFormatU64Backwards(start, int_part);
+    if (negative) *--start = '-';
+
+    HeliosStringBuilderAppend(sb, start, (UZ)(end - start));
+}
+
+HELIOS_DEF void HeliosStringBuilderFormat(HeliosStringBuilder *sb, const char *fmt, ...) {
+    va_list vargs;
+    va_start(vargs, fmt);
+
+    // Format straight into the current chunk and only format again when the output did not fit.
+    U8 *dst = HeliosStringBuilderReserve(sb, 1);
+    UZ space = sb->last->capacity - sb->last->count;
+
+    va_list copy;
+    va_copy(copy, vargs);
+    S32 n = vsnprintf((char *)dst, space, fmt, copy);
+    va_end(copy);
+
+    if (n >= 0 && (UZ)n >= space) {
+        dst = HeliosStringBuilderReserve(sb, (UZ)n + 1);
+        vsnprintf((char *)dst, (UZ)n + 1, fmt, vargs);
+    }
+    va_end(vargs);
+
+    if (n > 0) HeliosStringBuilderCommit(sb, (UZ)n);
+}
+
+HELIOS_DEF HeliosString8 HeliosStringBuilderFinalize(const HeliosStringBuilder *sb, HeliosAllocator allocator) {
+    U8 *data = (U8 *)HeliosAllocUninit(allocator, sb->count + 1);
+
+    UZ offset = 0;
+    for (const HeliosStringChunk *chunk = sb->first; chunk != NULL; chunk = chunk->next) {
+        memcpy(data + offset, chunk->data, chunk->count);
+        offset += chunk->count;
+    }
+    data[offset] = '\0';
+
+    return (HeliosString8) {
+        .data = data,
+        .count = offset,
+        .capacity = offset + 1,
+        .allocator = allocator,
+    };
+}
+
+#ifdef HELIOS_PLATFORM_POSIX
+#define _HELIOS_STRING_BUILDER_MAX_IOVECS 64
+
+HELIOS_DEF B32 HeliosStringBuilderWriteTo(const HeliosStringBuilder *sb, int fd) {
+    const HeliosStringChunk *chunk = sb->first;
+    UZ offset = 0;
+
+    for (;;) {
+        struct iovec iovecs[_HELIOS_STRING_BUILDER_MAX_IOVECS];
+        int iovec_count = 0;
+
+        UZ chunk_offset = offset;
+        for (const HeliosStringChunk *c = chunk;
+             c != NULL && iovec_count < _HELIOS_STRING_BUILDER_MAX_IOVECS;
+             c = c->next, chunk_offset = 0) {
+            if (c->count == chunk_offset) continue;
+
+            iovecs[iovec_count].iov_base = c->data + chunk_offset;
+            iovecs[iovec_count].iov_len = c->count - chunk_offset;
+            ++iovec_count;
+        }
+
+        if (iovec_count == 0) return 1;
+
+        ssize_t n = writev(fd, iovecs, iovec_count);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 0;
+
+        UZ written = (UZ)n;
+        while (written != 0) {
+            UZ remaining = chunk->count - offset;
+            if (written < remaining) {
+                offset += written;
+                break;
+            }
+
+            written -= remaining;
+            chunk = chunk->next;
+            offset = 0;
+        }
+    }
+}
+#else
+HELIOS_DEF B32 HeliosStringBuilderWriteTo(const HeliosStringBuilder *sb, int fd) {
+    for (const HeliosStringChunk *chunk = sb->first; chunk != NULL; chunk = chunk->next) {
+        UZ offset = 0;
+        while (offset < chunk->count) {
+            int n = _write(fd, chunk->data + offset, (unsigned)HELIOS_MIN(chunk->count - offset, (UZ)INT_MAX));
+            if (n <= 0) return 0;
+            offset += (UZ)n;
+        }
+    }
+
+    return 1;
+}
+#endif // HELIOS_PLATFORM_POSIX
+
+#ifdef HELIOS_PLATFORM_POSIX
+HELIOS_DEF U64 HeliosNowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (U64)ts.tv_sec * 1000000000ull + (U64)ts.tv_nsec;
+}
+#else
+HELIOS_DEF U64 HeliosNowNs(void) {
+    static LARGE_INTEGER frequency;
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    U64 ticks = (U64)counter.QuadPart;
+    U64 hz = (U64)frequency.QuadPart;
+    return ticks / hz * 1000000000ull + ticks % hz * 1000000000ull / hz;
+}
+#endif // HELIOS_PLATFORM_POSIX
+
+#ifdef HELIOS_PROFILE
+HELIOS_THREAD_LOCAL HeliosProfileBuffer *helios_profile_buffer;
+
+// Guards the buffer list and the flush, never taken when recording.
+HELIOS_INTERNAL HeliosSpinLock _helios_profile_lock = HELIOS_SPIN_LOCK_INIT;
+HELIOS_INTERNAL HeliosProfileBuffer *_helios_profile_buffers;
+HELIOS_INTERNAL U32 _helios_profile_thread_count;
+// The timestamp and the clock at the first event, timestamps are reported relative to it.
+HELIOS_INTERNAL U64 _helios_profile_base_timestamp;
+HELIOS_INTERNAL U64 _helios_profile_base_ns;
+
+// Long enough for the timestamp counter frequency estimate to be accurate to a fraction of a percent.
+#define _HELIOS_PROFILE_MIN_CALIBRATION_NS 10000000ull
+
+HELIOS_DEF HeliosProfileBuffer *_HeliosProfileThreadBuffer(void) {
+    HeliosProfileBuffer *buffer = (HeliosProfileBuffer *)HeliosRawAllocAligned(sizeof(HeliosProfileBuffer), HELIOS_CACHE_LINE_SIZE);
+    HELIOS_VERIFY(buffer != NULL);
+    memset(buffer, 0, sizeof(*buffer));
+    buffer->events = (HeliosProfileEvent *)HeliosRawAllocAligned(sizeof(HeliosProfileEvent) * HELIOS_PROFILE_RING_SIZE, sizeof(U64));
+    HELIOS_VERIFY(buffer->events != NULL);
+
+    HeliosSpinLockAcquire(&_helios_profile_lock);
+    if (_helios_profile_buffers == NULL) {
+        _helios_profile_base_ns = HeliosNowNs();
+        _helios_profile_base_timestamp = HeliosProfileTimestamp();
+    }
+    buffer->thread_index = _helios_profile_thread_count++;
+    buffer->next = _helios_profile_buffers;
+    _helios_profile_buffers = buffer;
+    HeliosSpinLockRelease(&_helios_profile_lock);
+
+    // Never freed, the events may be flushed after the thread is gone.
+    helios_profile_buffer = buffer;
+    return buffer;
+}
+
+// Timestamp units per microsecond.
+HELIOS_INTERNAL F64 _HeliosProfileTimestampFrequency(void) {
+#if defined(HELIOS_ARCH_X86) && !defined(HELIOS_PROFILE_USE_CLOCK)
+    U64 ns = HeliosNowNs();
+    while (ns - _helios_profile_base_ns < _HELIOS_PROFILE_MIN_CALIBRATION_NS) {
+        HeliosCpuRelax();
+        ns = HeliosNowNs();
+    }
+    U64 timestamp = HeliosProfileTimestamp();
+
+    return (F64)(timestamp - _helios_profile_base_timestamp) / ((F64)(ns - _helios_profile_base_ns) / 1000.0);
+#else
+    return 1000.0;
+#endif
+}
+
+HELIOS_DEF void HeliosProfileFlush(HeliosStringBuilder *sb) {
+    HeliosSpinLockAcquire(&_helios_profile_lock);
+
+    F64 frequency = _helios_profile_buffers != NULL ? _HeliosProfileTimestampFrequency() : 1.0;
+    U64 dropped = 0;
+    B32 first = 1;
+
+    HeliosStringBuilderAppendCStr(sb, "{\"traceEvents\":[");
+    for (HeliosProfileBuffer *buffer = _helios_profile_buffers; buffer != NULL; buffer = buffer->next) {
+        U64 tail = HeliosAtomicLoadU64(&buffer->tail, HeliosMemoryOrder_Relaxed);
+        U64 head = HeliosAtomicLoadU64(&buffer->head, HeliosMemoryOrder_Acquire);
+
+        for (; tail != head; ++tail) {
+            const HeliosProfileEvent *event = &buffer->events[tail & (HELIOS_PROFILE_RING_SIZE - 1)];
+            if (!first) HeliosStringBuilderAppendByte(sb, ',');
+            first = 0;
+
+            HeliosStringBuilderAppendCStr(sb, "\n{\"name\":\"");
+            for (const char *c = event->name; *c != '\0'; ++c) {
+                if (*c == '"' || *c == '\\') HeliosStringBuilderAppendByte(sb, '\\');
+                HeliosStringBuilderAppendByte(sb, (U8)*c);
+            }
+            HeliosStringBuilderAppendCStr(sb, "\",\"ph\":\"");
+            HeliosStringBuilderAppendByte(sb, event->phase);
+            HeliosStringBuilderAppendCStr(sb, "\",\"ts\":");
+            // Events recorded before the calibration base are clamped to it.
+            U64 elapsed = event->timestamp > _helios_profile_base_timestamp ? event->timestamp - _helios_profile_base_timestamp : 0;
+            HeliosStringBuilderAppendF64(sb, (F64)elapsed / frequency, 3);
+            HeliosStringBuilderAppendCStr(sb, ",\"pid\":1,\"tid\":");
+            HeliosStringBuilderAppendU64(sb, buffer->thread_index);
+            HeliosStringBuilderAppendByte(sb, '}');
+        }
+
+        HeliosAtomicStoreU64(&buffer->tail, head, HeliosMemoryOrder_Release);
+        dropped += HeliosAtomicExchangeU64(&buffer->dropped, 0, HeliosMemoryOrder_Relaxed);
+    }
+    HeliosStringBuilderAppendCStr(sb, "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_events\":\"");
+    HeliosStringBuilderAppendU64(sb, dropped);
+    HeliosStringBuilderAppendCStr(sb, "\"}}\n");
+
+    HeliosSpinLockRelease(&_helios_profile_lock);
+}
+
+HELIOS_DEF B32 HeliosProfileFlushToFile(HeliosStringView path) {
     HeliosAllocator temp = HeliosGetTempAllocator();
     char *path_cstr = HeliosStringViewCloneToCStr(temp, path);
 
-    DWORD share_mode = FILE_SHARE_READ;
-    SECURITY_ATTRIBUTES *attrs = NULL;
-    HANDLE file_handle = CreateFileA(path_cstr,
-                                     GENERIC_READ,
-                                     share_mode,
-                                     attrs,
-                                     OPEN_EXISTING,
-                                     FILE_ATTRIBUTE_NORMAL,
-                                     NULL);
+    FILE *file = fopen(path_cstr, "wb");
+    if (file == NULL) return 0;
 
-    if (file_handle == INVALID_HANDLE_VALUE) {
-        return (HeliosStringView) {.data = NULL, .count = 0};
+    HeliosStringBuilder sb;
+    HeliosStringBuilderInit(&sb, HeliosNewMallocAllocator(), 1024 * 64);
+    HeliosProfileFlush(&sb);
+    B32 ok = HeliosStringBuilderWriteTo(&sb, fileno(file));
+    HeliosStringBuilderDestroy(&sb);
+
+    return fclose(file) == 0 && ok;
+}
+#endif // HELIOS_PROFILE
+
+typedef struct _HeliosLogRecord {
+    // The whole record including the arguments, rounded up to 8 bytes.
+    U32 size;
+    U32 line;
+    // NULL for the padding in front of a wrap around.
+    const char *fmt;
+    const char *file;
+    U64 timestamp;
+    U32 level;
+    U32 args_size;
+} _HeliosLogRecord;
+
+typedef struct _HeliosLogRing {
+    struct _HeliosLogRing *next;
+    U8 *data;
+    HeliosAtomicU64 dropped;
+    HELIOS_CACHE_LINE_PAD(sizeof(void *) * 2 + sizeof(U64));
+    // Only written by the owning thread.
+    HeliosAtomicU64 head;
+    HELIOS_CACHE_LINE_PAD(sizeof(HeliosAtomicU64));
+    // Only written under the consumer lock.
+    HeliosAtomicU64 tail;
+} _HeliosLogRing;
+
+HELIOS_INTERNAL HELIOS_THREAD_LOCAL _HeliosLogRing *_helios_log_ring;
+// Guards the ring list.
+HELIOS_INTERNAL HeliosSpinLock _helios_log_rings_lock = HELIOS_SPIN_LOCK_INIT;
+HELIOS_INTERNAL _HeliosLogRing *_helios_log_rings;
+// Guards the consuming side of all rings.
+HELIOS_INTERNAL HeliosMutex _helios_log_consumer_lock = HELIOS_MUTEX_INIT;
+HELIOS_INTERNAL HeliosAtomicU32 _helios_log_enabled;
+HELIOS_INTERNAL HeliosAtomicU32 _helios_log_running;
+HELIOS_INTERNAL HeliosThread _helios_log_thread;
+HELIOS_INTERNAL int _helios_log_fd = 2;
+
+HELIOS_INTERNAL const char *_helios_log_level_names[] = {"DEBUG", "INFO", "WARN", "ERROR"};
+
+typedef struct _HeliosLogSpec {
+    const char *flags;
+    U32 flags_count;
+    // -1 when not given, -2 for '*'.
+    S32 width;
+    S32 precision;
+    // 'H' for hh, 'h', 'l', 'q' for ll, 'L', 'j', 'z' and 't'.
+    char length;
+    char conversion;
+} _HeliosLogSpec;
+
+// Parses the conversion spec after a '%', returns the position after it or NULL for unsupported specs.
+HELIOS_INTERNAL const char *_HeliosLogParseSpec(const char *p, _HeliosLogSpec *spec) {
+    spec->flags = p;
+    while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0') ++p;
+    spec->flags_count = (U32)(p - spec->flags);
+
+    spec->width = -1;
+    if (*p == '*') {
+        spec->width = -2;
+        ++p;
+    } else if (HeliosCharIsDigit(*p)) {
+        spec->width = 0;
+        while (HeliosCharIsDigit(*p)) spec->width = spec->width * 10 + (*p++ - '0');
     }
 
-    DWORD high_bits = 0;
-    DWORD low_bits = GetFileSize(file_handle, &high_bits);
-    if (low_bits == INVALID_FILE_SIZE) {
-        return (HeliosStringView) {.data = NULL, .count = 0};
+    spec->precision = -1;
+    if (*p == '.') {
+        ++p;
+        if (*p == '*') {
+            spec->precision = -2;
+            ++p;
+        } else {
+            spec->precision = 0;
+            while (HeliosCharIsDigit(*p)) spec->precision = spec->precision * 10 + (*p++ - '0');
+        }
     }
 
-    U64 file_size = ((U64) high_bits << 32) | (U64) low_bits;
-    void *buffer = HeliosAlloc(allocator, file_size);
+    spec->length = 0;
+    switch (*p) {
+    case 'h':
+        spec->length = p[1] == 'h' ? 'H' : 'h';
+        p += spec->length == 'H' ? 2 : 1;
+        break;
+    case 'l':
+        spec->length = p[1] == 'l' ? 'q' : 'l';
+        p += spec->length == 'q' ? 2 : 1;
+        break;
+    case 'L': case 'j': case 'z': case 't':
+        spec->length = *p++;
+        break;
+    default: break;
+    }
 
-    DWORD n_read = 0;
-    BOOL ok = ReadFile(file_handle,
-                       buffer,
-                       file_size,
-                       &n_read,
-                       NULL);
-    if (!ok) {
-        HeliosFree(allocator, buffer, file_size);
-        return (HeliosStringView) {.data = NULL, .count = 0};
+    spec->conversion = *p;
+    switch (spec->conversion) {
+    case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c':
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+    case 's': case 'p':
+        return p + 1;
+    default:
+        return NULL;
     }
+}
 
-    return (HeliosStringView) {.data = buffer, .count = n_read};
+typedef struct _HeliosLogArgs {
+    U8 *data;
+    UZ count;
+    UZ capacity;
+} _HeliosLogArgs;
+
+HELIOS_INTERNAL B32 _HeliosLogPush(_HeliosLogArgs *args, const void *data, UZ size) {
+    if (args->capacity - args->count < size) return 0;
+    memcpy(args->data + args->count, data, size);
+    args->count += size;
+    return 1;
+}
+
+HELIOS_INTERNAL B32 _HeliosLogPushU64(_HeliosLogArgs *args, U64 value) {
+    return _HeliosLogPush(args, &value, sizeof(value));
+}
+
+HELIOS_INTERNAL B32 _HeliosLogPushF64(_HeliosLogArgs *args, F64 value) {
+    return _HeliosLogPush(args, &value, sizeof(value));
+}
+
+HELIOS_INTERNAL U64 _HeliosLogReadInteger(const _HeliosLogSpec *spec, va_list *vargs) {
+    B32 is_signed = spec->conversion == 'd' || spec->conversion == 'i';
+    switch (spec->length) {
+    case 'H': {
+        int value = va_arg(*vargs, int);
+        return is_signed ? (U64)(S64)(signed char)value : (U64)(unsigned char)value;
+    }
+    case 'h': {
+        int value = va_arg(*vargs, int);
+        return is_signed ? (U64)(S64)(short)value : (U64)(unsigned short)value;
+    }
+    case 'l': return is_signed ? (U64)(S64)va_arg(*vargs, long) : (U64)va_arg(*vargs, unsigned long);
+    case 'q': return is_signed ? (U64)(S64)va_arg(*vargs, long long) : (U64)va_arg(*vargs, unsigned long long);
+    case 'j': return is_signed ? (U64)(S64)va_arg(*vargs, intmax_t) : (U64)va_arg(*vargs, uintmax_t);
+    case 'z': return is_signed ? (U64)(S64)va_arg(*vargs, SZ) : (U64)va_arg(*vargs, UZ);
+    case 't': return is_signed ? (U64)(S64)va_arg(*vargs, ptrdiff_t) : (U64)va_arg(*vargs, UZ);
+    default: return is_signed ? (U64)(S64)va_arg(*vargs, int) : (U64)va_arg(*vargs, unsigned);
+    }
+}
+
+// Copies the raw arguments of `fmt` in order: '*' widths and precisions, integers and pointers as U64,
+// floats as F64 and strings as a U32 count followed by the bytes. Stops early when out of space, the rest
+// of the format is then printed verbatim.
+HELIOS_INTERNAL void _HeliosLogCaptureArgs(_HeliosLogArgs *args, const char *fmt, va_list *vargs) {
+    for (const char *p = fmt; *p != '\0'; ++p) {
+        if (*p != '%') continue;
+        if (p[1] == '%') {
+            ++p;
+            continue;
+        }
+
+        _HeliosLogSpec spec;
+        const char *end = _HeliosLogParseSpec(p + 1, &spec);
+        if (end == NULL) return;
+
+        if (spec.width == -2 && !_HeliosLogPushU64(args, (U64)(S64)va_arg(*vargs, int))) return;
+        S32 precision = spec.precision;
+        if (precision == -2) {
+            precision = va_arg(*vargs, int);
+            if (!_HeliosLogPushU64(args, (U64)(S64)precision)) return;
+        }
+
+        B32 pushed;
+        switch (spec.conversion) {
+        case 'c': pushed = _HeliosLogPushU64(args, (U64)va_arg(*vargs, int)); break;
+        case 'p': pushed = _HeliosLogPushU64(args, (U64)(uintptr_t)va_arg(*vargs, void *)); break;
+        case 's': {
+            const char *s = va_arg(*vargs, const char *);
+            if (s == NULL) s = "(null)";
+
+            UZ count = 0;
+            while ((precision < 0 || count < (UZ)precision) && s[count] != '\0') ++count;
+
+            UZ space = args->capacity - args->count;
+            if (space < sizeof(U32)) return;
+            count = HELIOS_MIN(count, space - sizeof(U32));
+
+            U32 count_u32 = (U32)count;
+            pushed = _HeliosLogPush(args, &count_u32, sizeof(count_u32)) && _HeliosLogPush(args, s, count);
+            break;
+        }
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            pushed = _HeliosLogPushF64(args, spec.length == 'L' ? (F64)va_arg(*vargs, long double) : va_arg(*vargs, double));
+            break;
+        default: pushed = _HeliosLogPushU64(args, _HeliosLogReadInteger(&spec, vargs)); break;
+        }
+
+        if (!pushed) return;
+        p = end - 1;
+    }
+}
+
+HELIOS_INTERNAL B32 _HeliosLogPop(const U8 **args, const U8 *args_end, void *out, UZ size) {
+    if ((UZ)(args_end - *args) < size) return 0;
+    memcpy(out, *args, size);
+    *args += size;
+    return 1;
+}
+
+HELIOS_INTERNAL void _HeliosLogFormatRecord(HeliosStringBuilder *sb, const _HeliosLogRecord *record) {
+    HeliosStringBuilderAppendCStr(sb, record->file);
+    HeliosStringBuilderAppendByte(sb, ':');
+    HeliosStringBuilderAppendU64(sb, record->line);
+    HeliosStringBuilderAppendCStr(sb, ": ");
+    HeliosStringBuilderAppendCStr(sb, _helios_log_level_names[record->level]);
+    HeliosStringBuilderAppendCStr(sb, ": ");
+
+    const U8 *args = (const U8 *)(record + 1);
+    const U8 *args_end = args + record->args_size;
+
+    const char *p = record->fmt;
+    const char *literal = p;
+    while (*p != '\0') {
+        if (*p != '%') {
+            ++p;
+            continue;
+        }
+
+        HeliosStringBuilderAppend(sb, literal, (UZ)(p - literal));
+        if (p[1] == '%') {
+            HeliosStringBuilderAppendByte(sb, '%');
+            p += 2;
+            literal = p;
+            continue;
+        }
+
+        _HeliosLogSpec spec;
+        const char *end = _HeliosLogParseSpec(p + 1, &spec);
+        literal = p;
+        if (end == NULL) break;
+
+        S64 width = spec.width;
+        S64 precision = spec.precision;
+        if (spec.width == -2 && !_HeliosLogPop(&args, args_end, &width, sizeof(width))) break;
+        if (spec.precision == -2 && !_HeliosLogPop(&args, args_end, &precision, sizeof(precision))) break;
+
+        // Rebuilds the spec with the captured widths filled in and the length normalized to the stored type.
+        // A negative '*' width means left alignment, a negative '*' precision means no precision.
+        char spec_buf[64];
+        int n = snprintf(spec_buf, sizeof(spec_buf), "%%%.*s", (int)spec.flags_count, spec.flags);
+        if (spec.width != -1) {
+            if (width < 0) n += snprintf(spec_buf + n, sizeof(spec_buf) - n, "-%d", (int)-width);
+            else n += snprintf(spec_buf + n, sizeof(spec_buf) - n, "%d", (int)width);
+        }
+        // Strings were already cut to their precision when captured.
+        if (spec.precision != -1 && precision >= 0 && spec.conversion != 's') {
+            n += snprintf(spec_buf + n, sizeof(spec_buf) - n, ".%d", (int)precision);
+        }
+
+        switch (spec.conversion) {
+        case 's': {
+            U32 count;
+            if (!_HeliosLogPop(&args, args_end, &count, sizeof(count)) || (UZ)(args_end - args) < count) goto out;
+            snprintf(spec_buf + n, sizeof(spec_buf) - n, ".*s");
+            HeliosStringBuilderFormat(sb, spec_buf, (int)count, (const char *)args);
+            args += count;
+            break;
+        }
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+            F64 value;
+            if (!_HeliosLogPop(&args, args_end, &value, sizeof(value))) goto out;
+            snprintf(spec_buf + n, sizeof(spec_buf) - n, "%c", spec.conversion);
+            HeliosStringBuilderFormat(sb, spec_buf, value);
+            break;
+        }
+        case 'c': case 'p': {
+            U64 value;
+            if (!_HeliosLogPop(&args, args_end, &value, sizeof(value))) goto out;
+            snprintf(spec_buf + n, sizeof(spec_buf) - n, "%c", spec.conversion);
+            if (spec.conversion == 'c') HeliosStringBuilderFormat(sb, spec_buf, (int)value);
+            else HeliosStringBuilderFormat(sb, spec_buf, (void *)(uintptr_t)value);
+            break;
+        }
+        default: {
+            U64 value;
+            if (!_HeliosLogPop(&args, args_end, &value, sizeof(value))) goto out;
+            snprintf(spec_buf + n, sizeof(spec_buf) - n, "ll%c", spec.conversion);
+            HeliosStringBuilderFormat(sb, spec_buf, (unsigned long long)value);
+            break;
+        }
+        }
+
+        p = end;
+        literal = p;
+    }
+
+out:
+    HeliosStringBuilderAppendCStr(sb, literal);
+    HeliosStringBuilderAppendByte(sb, '\n');
+}
+
+// The oldest record of `ring`, skipping over padding.
+HELIOS_INTERNAL const _HeliosLogRecord *_HeliosLogRingFront(_HeliosLogRing *ring) {
+    U64 tail = HeliosAtomicLoadU64(&ring->tail, HeliosMemoryOrder_Relaxed);
+    U64 head = HeliosAtomicLoadU64(&ring->head, HeliosMemoryOrder_Acquire);
+
+    while (tail != head) {
+        UZ offset = (UZ)(tail & (HELIOS_LOG_RING_SIZE - 1));
+        const _HeliosLogRecord *record = (const _HeliosLogRecord *)(ring->data + offset);
+
+        if (HELIOS_LOG_RING_SIZE - offset < sizeof(_HeliosLogRecord)) {
+            tail += HELIOS_LOG_RING_SIZE - offset;
+        } else if (record->fmt == NULL) {
+            tail += record->size;
+        } else {
+            HeliosAtomicStoreU64(&ring->tail, tail, HeliosMemoryOrder_Release);
+            return record;
+        }
+    }
+
+    HeliosAtomicStoreU64(&ring->tail, tail, HeliosMemoryOrder_Release);
+    return NULL;
+}
+
+#define _HELIOS_LOG_WRITE_THRESHOLD (1024 * 32)
+
+// Must hold the consumer lock.
+HELIOS_INTERNAL void _HeliosLogDrain(void) {
+    HeliosStringBuilder sb;
+    HeliosStringBuilderInit(&sb, HeliosNewMallocAllocator(), _HELIOS_LOG_WRITE_THRESHOLD);
+
+    HeliosSpinLockAcquire(&_helios_log_rings_lock);
+    _HeliosLogRing *rings = _helios_log_rings;
+    HeliosSpinLockRelease(&_helios_log_rings_lock);
+
+    U64 dropped = 0;
+    for (_HeliosLogRing *ring = rings; ring != NULL; ring = ring->next) {
+        dropped += HeliosAtomicExchangeU64(&ring->dropped, 0, HeliosMemoryOrder_Relaxed);
+    }
+    if (dropped != 0) HeliosStringBuilderFormat(&sb, "helios: dropped %llu log messages\n", (unsigned long long)dropped);
+
+    for (;;) {
+        _HeliosLogRing *oldest_ring = NULL;
+        const _HeliosLogRecord *oldest = NULL;
+        for (_HeliosLogRing *ring = rings; ring != NULL; ring = ring->next) {
+            const _HeliosLogRecord *record = _HeliosLogRingFront(ring);
+            if (record != NULL && (oldest == NULL || record->timestamp < oldest->timestamp)) {
+                oldest = record;
+                oldest_ring = ring;
+            }
+        }
+        if (oldest == NULL) break;
+
+        _HeliosLogFormatRecord(&sb, oldest);
+        HeliosAtomicFetchAddU64(&oldest_ring->tail, oldest->size, HeliosMemoryOrder_Release);
+
+        if (sb.count >= _HELIOS_LOG_WRITE_THRESHOLD) {
+            HeliosStringBuilderWriteTo(&sb, _helios_log_fd);
+            HeliosStringBuilderReset(&sb);
+        }
+    }
+
+    HeliosStringBuilderWriteTo(&sb, _helios_log_fd);
+    HeliosStringBuilderDestroy(&sb);
+}
+
+HELIOS_INTERNAL void _HeliosLogSleep(U64 ns) {
+#ifdef HELIOS_PLATFORM_POSIX
+    struct timespec ts = {.tv_sec = (time_t)(ns / 1000000000ull), .tv_nsec = (long)(ns % 1000000000ull)};
+    nanosleep(&ts, NULL);
+#else
+    Sleep((DWORD)HELIOS_MAX(ns / 1000000, 1));
+#endif // HELIOS_PLATFORM_POSIX
+}
+
+HELIOS_INTERNAL void _HeliosLogThreadMain(void *arg) {
+    HELIOS_UNUSED(arg);
+
+    while (HeliosAtomicLoadU32(&_helios_log_running, HeliosMemoryOrder_Acquire)) {
+        HeliosMutexLock(&_helios_log_consumer_lock);
+        _HeliosLogDrain();
+        HeliosMutexUnlock(&_helios_log_consumer_lock);
+
+        _HeliosLogSleep(HELIOS_LOG_POLL_INTERVAL_NS);
+    }
+}
+
+HELIOS_DEF B32 HeliosLogInit(int fd) {
+    _helios_log_fd = fd;
+    HeliosAtomicStoreU32(&_helios_log_running, 1, HeliosMemoryOrder_Release);
+    if (!HeliosThreadStart(&_helios_log_thread, _HeliosLogThreadMain, NULL)) {
+        HeliosAtomicStoreU32(&_helios_log_running, 0, HeliosMemoryOrder_Release);
+        return 0;
+    }
+
+    HeliosAtomicStoreU32(&_helios_log_enabled, 1, HeliosMemoryOrder_Release);
+    return 1;
+}
+
+HELIOS_DEF void HeliosLogShutdown(void) {
+    HeliosAtomicStoreU32(&_helios_log_enabled, 0, HeliosMemoryOrder_Release);
+    HeliosAtomicStoreU32(&_helios_log_running, 0, HeliosMemoryOrder_Release);
+    HeliosThreadJoin(&_helios_log_thread);
+    HeliosLogFlush();
+}
+
+HELIOS_DEF void HeliosLogFlush(void) {
+    HeliosMutexLock(&_helios_log_consumer_lock);
+    _HeliosLogDrain();
+    HeliosMutexUnlock(&_helios_log_consumer_lock);
+}
+
+#define _HELIOS_LOG_CRASH_FLUSH_ATTEMPTS 1000
+
+void _HeliosLogCrashFlush(void) {
+    if (!HeliosAtomicLoadU32(&_helios_log_enabled, HeliosMemoryOrder_Acquire)) return;
+
+    // The lock may be held by the crashing thread itself or by a thread that will never let go of it, so
+    // only try for a while.
+    for (U32 i = 0; i < _HELIOS_LOG_CRASH_FLUSH_ATTEMPTS; ++i) {
+        if (HeliosMutexTryLock(&_helios_log_consumer_lock)) {
+            _HeliosLogDrain();
+            HeliosMutexUnlock(&_helios_log_consumer_lock);
+            return;
+        }
+        HeliosThreadYield();
+    }
+}
+
+HELIOS_INTERNAL _HeliosLogRing *_HeliosLogThreadRing(void) {
+    _HeliosLogRing *ring = (_HeliosLogRing *)HeliosRawAllocAligned(sizeof(_HeliosLogRing), HELIOS_CACHE_LINE_SIZE);
+    HELIOS_VERIFY(ring != NULL);
+    memset(ring, 0, sizeof(*ring));
+    ring->data = (U8 *)HeliosRawAllocAligned(HELIOS_LOG_RING_SIZE, sizeof(U64));
+    HELIOS_VERIFY(ring->data != NULL);
+
+    // Never freed, the messages may be written out after the thread is gone.
+    HeliosSpinLockAcquire(&_helios_log_rings_lock);
+    ring->next = _helios_log_rings;
+    _helios_log_rings = ring;
+    HeliosSpinLockRelease(&_helios_log_rings_lock);
+
+    _helios_log_ring = ring;
+    return ring;
+}
+
+HELIOS_DEF void HeliosLogWrite(HeliosLogLevel level, const char *file, U32 line, const char *fmt, ...) {
+    va_list vargs;
+    va_start(vargs, fmt);
+
+    if (!HeliosAtomicLoadU32(&_helios_log_enabled, HeliosMemoryOrder_Acquire)) {
+        fprintf(stderr, "%s:%u: %s: ", file, line, _helios_log_level_names[level]);
+        vfprintf(stderr, fmt, vargs);
+        fputc('\n', stderr);
+        va_end(vargs);
+        return;
+    }
+
+    U64 buf[HELIOS_LOG_MAX_RECORD_SIZE / sizeof(U64)];
+    _HeliosLogRecord *record = (_HeliosLogRecord *)buf;
+    _HeliosLogArgs args = {
+        .data = (U8 *)(record + 1),
+        .count = 0,
+        .capacity = sizeof(buf) - sizeof(*record),
+    };
+    _HeliosLogCaptureArgs(&args, fmt, &vargs);
+    va_end(vargs);
+
+    record->size = (U32)HeliosRoundUp(sizeof(*record) + args.count, sizeof(U64));
+    record->line = line;
+    record->fmt = fmt;
+    record->file = file;
+    record->timestamp = HeliosNowNs();
+    record->level = (U32)level;
+    record->args_size = (U32)args.count;
+
+    _HeliosLogRing *ring = _helios_log_ring;
+    if (ring == NULL) ring = _HeliosLogThreadRing();
+
+    U64 head = HeliosAtomicLoadU64(&ring->head, HeliosMemoryOrder_Relaxed);
+    U64 tail = HeliosAtomicLoadU64(&ring->tail, HeliosMemoryOrder_Acquire);
+
+    // Records never wrap around, the end of the ring is skipped instead.
+    UZ offset = (UZ)(head & (HELIOS_LOG_RING_SIZE - 1));
+    UZ skip = HELIOS_LOG_RING_SIZE - offset < record->size ? HELIOS_LOG_RING_SIZE - offset : 0;
+    if (head + skip + record->size - tail > HELIOS_LOG_RING_SIZE) {
+        HeliosAtomicFetchAddU64(&ring->dropped, 1, HeliosMemoryOrder_Relaxed);
+        return;
+    }
+
+    if (skip >= sizeof(_HeliosLogRecord)) {
+        _HeliosLogRecord *padding = (_HeliosLogRecord *)(ring->data + offset);
+        padding->size = (U32)skip;
+        padding->fmt = NULL;
+    }
+
+    memcpy(ring->data + ((head + skip) & (HELIOS_LOG_RING_SIZE - 1)), record, record->size);
+    HeliosAtomicStoreU64(&ring->head, head + skip + record->size, HeliosMemoryOrder_Release);
+}
+
+#if !defined(HELIOS_COMPILER_GCC) && !defined(HELIOS_COMPILER_CLANG)
+const void *volatile helios_bench_sink;
+#endif // !HELIOS_COMPILER_GCC && !HELIOS_COMPILER_CLANG
+
+HELIOS_DEF void HeliosBenchInit(HeliosBench *bench, int argc, char **argv) {
+    bench->warmup_ns = HELIOS_BENCH_DEFAULT_WARMUP_NS;
+    bench->sample_ns = HELIOS_BENCH_DEFAULT_SAMPLE_NS;
+    bench->samples = HELIOS_BENCH_DEFAULT_SAMPLES;
+    bench->filter = NULL;
+    bench->tsv = 0;
+    bench->out = stdout;
+    memset(&bench->last, 0, sizeof(bench->last));
+
+    for (int i = 1; i < argc; ++i) {
+        HeliosStringView arg = {.data = (const U8 *)argv[i], .count = strlen(argv[i])};
+        S64 samples;
+
+        if (HeliosStringViewEqualCStr(arg, "--tsv")) {
+            bench->tsv = 1;
+        } else if (HeliosStringViewStartsWith(arg, "--filter=")) {
+            bench->filter = argv[i] + strlen("--filter=");
+        } else if (HeliosStringViewStartsWith(arg, "--samples=") &&
+                   HeliosParseS64(HeliosStringViewSlice(arg, strlen("--samples="), arg.count), 10, &samples) &&
+                   samples > 0) {
+            bench->samples = (U32)samples;
+        } else {
+            fprintf(stderr, "usage: %s [--filter=<substring>] [--samples=<count>] [--tsv]\n", argv[0]);
+            exit(1);
+        }
+    }
+}
+
+HELIOS_INTERNAL int _HeliosBenchCompareF64(const void *a, const void *b) {
+    F64 x = *(const F64 *)a;
+    F64 y = *(const F64 *)b;
+    return (x > y) - (x < y);
+}
+
+HELIOS_DEF B32 HeliosBenchRun(HeliosBench *bench, const HeliosBenchCase *bench_case) {
+    if (bench->filter != NULL && strstr(bench_case->name, bench->filter) == NULL) return 0;
+
+    U64 start = HeliosNowNs();
+    U64 iterations = 1;
+    do {
+        bench_case->func(bench_case->arg, 1);
+    } while (HeliosNowNs() - start < bench->warmup_ns);
+
+    for (;;) {
+        start = HeliosNowNs();
+        bench_case->func(bench_case->arg, iterations);
+        if (HeliosNowNs() - start >= bench->sample_ns || iterations >= (1ull << 40)) break;
+        iterations *= 2;
+    }
+
+    HeliosAllocator allocator = HeliosNewMallocAllocator();
+    F64 *samples = (F64 *)HeliosAllocUninit(allocator, sizeof(F64) * bench->samples);
+    F64 total = 0;
+    for (U32 i = 0; i < bench->samples; ++i) {
+        start = HeliosNowNs();
+        bench_case->func(bench_case->arg, iterations);
+        samples[i] = (F64)(HeliosNowNs() - start) / (F64)iterations;
+        total += samples[i];
+    }
+    qsort(samples, bench->samples, sizeof(F64), _HeliosBenchCompareF64);
+
+    HeliosBenchResult *result = &bench->last;
+    result->name = bench_case->name;
+    result->iterations = iterations;
+    result->samples = bench->samples;
+    result->min_ns = samples[0];
+    result->median_ns = samples[bench->samples / 2];
+    result->p99_ns = samples[(bench->samples * 99 + 99) / 100 - 1];
+    result->mean_ns = total / (F64)bench->samples;
+    HeliosFree(allocator, samples, sizeof(F64) * bench->samples);
+
+    if (bench->out == NULL) return 1;
+
+    if (bench->tsv) {
+        fprintf(bench->out, "%s\t%llu\t%u\t%.3f\t%.3f\t%.3f\t%.3f\t%llu\t%llu\n",
+                result->name, (unsigned long long)result->iterations, result->samples,
+                result->min_ns, result->median_ns, result->p99_ns, result->mean_ns,
+                (unsigned long long)bench_case->items_per_iteration,
+                (unsigned long long)bench_case->bytes_per_iteration);
+    } else {
+        fprintf(bench->out, "%-40s median %12.2f ns  min %12.2f ns  p99 %12.2f ns",
+                result->name, result->median_ns, result->min_ns, result->p99_ns);
+        if (bench_case->items_per_iteration != 0) {
+            fprintf(bench->out, "  %9.3f ns/item", result->median_ns / (F64)bench_case->items_per_iteration);
+        }
+        if (bench_case->bytes_per_iteration != 0) {
+            fprintf(bench->out, "  %9.2f MB/s", (F64)bench_case->bytes_per_iteration * 1e3 / result->median_ns);
+        }
+        fputc('\n', bench->out);
+    }
+    fflush(bench->out);
+
+    return 1;
+}
+
+#ifdef HELIOS_PLATFORM_POSIX
+HELIOS_DEF HeliosStringView HeliosReadEntireFile(HeliosAllocator allocator, HeliosStringView path) {
+    HeliosAllocator temp = HeliosGetTempAllocator();
+    char *path_cstr = HeliosStringViewCloneToCStr(temp, path);
+
+    SZ fd = open(path_cstr, O_RDONLY);
+    if (fd == -1) {
+        return (HeliosStringView) {.data = NULL, .count = 0};
+    }
+
+    struct stat file_stat;
+    int ret = fstat(fd, &file_stat);
+    if (ret == -1) {
+        close(fd);
+        return (HeliosStringView) {.data = NULL, .count = 0};
+    }
+
+    size_t file_size = file_stat.st_size;
+    U8 *file_buf = HeliosAllocUninit(allocator, file_size);
+
+    size_t total_bytes_read = 0;
+    while (total_bytes_read != file_size) {
+        ssize_t n = read(fd, &file_buf[total_bytes_read], file_size - total_bytes_read);
+        if (n == -1) {
+            close(fd);
+            HeliosFree(allocator, file_buf, file_size);
+            return (HeliosStringView) {.data = NULL, .count = 0};
+        }
+        // The file got truncated under us.
+        if (n == 0) break;
+        total_bytes_read += (size_t)n;
+    }
+
+    close(fd);
+    return (HeliosStringView) {.data = file_buf, .count = total_bytes_read};
+}
+
+HELIOS_DEF B32 HeliosMapFile(HeliosStringView path, HeliosMappedFile *out) {
+    HeliosAllocator temp = HeliosGetTempAllocator();
+    char *path_cstr = HeliosStringViewCloneToCStr(temp, path);
+
+    int fd = open(path_cstr, O_RDONLY);
+    if (fd == -1) return 0;
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == -1) {
+        close(fd);
+        return 0;
+    }
+
+    UZ file_size = (UZ)file_stat.st_size;
+    // Mapping zero bytes is an error.
+    if (file_size == 0) {
+        close(fd);
+        out->contents = (HeliosStringView) {.data = (const U8 *)"", .count = 0};
+        return 1;
+    }
+
+    int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+    // Fault everything in right away instead of page by page while parsing.
+    flags |= MAP_POPULATE;
+#endif // MAP_POPULATE
+
+    void *data = mmap(NULL, file_size, PROT_READ, flags, fd, 0);
+    // The mapping stays valid after the descriptor is closed.
+    close(fd);
+    if (data == MAP_FAILED) return 0;
+
+    madvise(data, file_size, MADV_SEQUENTIAL);
+
+    out->contents = (HeliosStringView) {.data = (const U8 *)data, .count = file_size};
+    return 1;
+}
+
+HELIOS_DEF void HeliosUnmapFile(HeliosMappedFile *file) {
+    if (file->contents.count != 0) munmap((void *)file->contents.data, file->contents.count);
+    file->contents = (HeliosStringView) {.data = NULL, .count = 0};
+}
+#endif // HELIOS_PLATFORM_POSIX
+
+#ifdef HELIOS_PLATFORM_WINDOWS
+HELIOS_DEF HeliosStringView HeliosReadEntireFile(HeliosAllocator allocator, HeliosStringView path) {
+    HeliosAllocator temp = HeliosGetTempAllocator();
+    char *path_cstr = HeliosStringViewCloneToCStr(temp, path);
+
+    DWORD share_mode = FILE_SHARE_READ;
+    SECURITY_ATTRIBUTES *attrs = NULL;
+    HANDLE file_handle = CreateFileA(path_cstr,
+                                     GENERIC_READ,
+                                     share_mode,
+                                     attrs,
+                                     OPEN_EXISTING,
+                                     FILE_ATTRIBUTE_NORMAL,
+                                     NULL);
+
+    if (file_handle == INVALID_HANDLE_VALUE) {
+        return (HeliosStringView) {.data = NULL, .count = 0};
+    }
+
+    DWORD high_bits = 0;
+    DWORD low_bits = GetFileSize(file_handle, &high_bits);
+    if (low_bits == INVALID_FILE_SIZE) {
+        CloseHandle(file_handle);
+        return (HeliosStringView) {.data = NULL, .count = 0};
+    }
+
+    U64 file_size = ((U64) high_bits << 32) | (U64) low_bits;
+    void *buffer = HeliosAllocUninit(allocator, file_size);
+
+    DWORD n_read = 0;
+    BOOL ok = ReadFile(file_handle,
+                       buffer,
+                       file_size,
+                       &n_read,
+                       NULL);
+    CloseHandle(file_handle);
+    if (!ok) {
+        HeliosFree(allocator, buffer, file_size);
+        return (HeliosStringView) {.data = NULL, .count = 0};
+    }
+
+    return (HeliosStringView) {.data = buffer, .count = n_read};
+}
+
+HELIOS_DEF B32 HeliosMapFile(HeliosStringView path, HeliosMappedFile *out) {
+    HeliosAllocator temp = HeliosGetTempAllocator();
+    char *path_cstr = HeliosStringViewCloneToCStr(temp, path);
+
+    HANDLE file_handle = CreateFileA(path_cstr,
+                                     GENERIC_READ,
+                                     FILE_SHARE_READ,
+                                     NULL,
+                                     OPEN_EXISTING,
+                                     FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                                     NULL);
+    if (file_handle == INVALID_HANDLE_VALUE) return 0;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file_handle, &file_size)) {
+        CloseHandle(file_handle);
+        return 0;
+    }
+
+    if (file_size.QuadPart == 0) {
+        CloseHandle(file_handle);
+        out->contents = (HeliosStringView) {.data = (const U8 *)"", .count = 0};
+        out->mapping_handle = NULL;
+        return 1;
+    }
+
+    HANDLE mapping_handle = CreateFileMappingA(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    // The mapping object keeps the file open.
+    CloseHandle(file_handle);
+    if (mapping_handle == NULL) return 0;
+
+    void *data = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+    if (data == NULL) {
+        CloseHandle(mapping_handle);
+        return 0;
+    }
+
+    out->contents = (HeliosStringView) {.data = (const U8 *)data, .count = (UZ)file_size.QuadPart};
+    out->mapping_handle = mapping_handle;
+    return 1;
+}
+
+HELIOS_DEF void HeliosUnmapFile(HeliosMappedFile *file) {
+    if (file->contents.count != 0) {
+        UnmapViewOfFile(file->contents.data);
+        CloseHandle(file->mapping_handle);
+    }
+    file->contents = (HeliosStringView) {.data = NULL, .count = 0};
+}
+#endif // HELIOS_PLATFORM_WINDOWS
+
+#ifdef HELIOS_PLATFORM_WINDOWS
+HELIOS_INTERNAL DWORD WINAPI _HeliosThreadTrampoline(LPVOID arg) {
+    HeliosThread *thread = (HeliosThread *)arg;
+    thread->func(thread->arg);
+    return 0;
+}
+
+HELIOS_DEF B32 HeliosThreadStart(HeliosThread *thread, HeliosThreadFunc *func, void *arg) {
+    thread->func = func;
+    thread->arg = arg;
+    thread->handle = CreateThread(NULL, 0, _HeliosThreadTrampoline, thread, 0, NULL);
+    return thread->handle != NULL;
+}
+
+HELIOS_DEF void HeliosThreadJoin(HeliosThread *thread) {
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+}
+
+HELIOS_DEF U32 HeliosGetCpuCount(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (U32)info.dwNumberOfProcessors;
+}
+
+HELIOS_DEF void HeliosThreadYield(void) {
+    SwitchToThread();
+}
+#else
+HELIOS_INTERNAL void *_HeliosThreadTrampoline(void *arg) {
+    HeliosThread *thread = (HeliosThread *)arg;
+    thread->func(thread->arg);
+    return NULL;
+}
+
+HELIOS_DEF B32 HeliosThreadStart(HeliosThread *thread, HeliosThreadFunc *func, void *arg) {
+    thread->func = func;
+    thread->arg = arg;
+    return pthread_create(&thread->handle, NULL, _HeliosThreadTrampoline, thread) == 0;
+}
+
+HELIOS_DEF void HeliosThreadJoin(HeliosThread *thread) {
+    pthread_join(thread->handle, NULL);
+}
+
+HELIOS_DEF U32 HeliosGetCpuCount(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (U32)count : 1;
+}
+
+HELIOS_DEF void HeliosThreadYield(void) {
+    sched_yield();
+}
+#endif // HELIOS_PLATFORM_WINDOWS
+
+HELIOS_DEF void HeliosSpinLockAcquire(HeliosSpinLock *lock) {
+    U32 backoff = 1;
+    while (!HeliosSpinLockTryAcquire(lock)) {
+        // Spin on plain loads, so the cache line stays shared until the lock looks free.
+        do {
+            if (backoff <= HELIOS_SPIN_LOCK_MAX_BACKOFF) {
+                for (U32 i = 0; i < backoff; ++i) HeliosCpuRelax();
+                backoff *= 2;
+            } else {
+                HeliosThreadYield();
+            }
+        } while (HeliosAtomicLoadU32(&lock->state, HeliosMemoryOrder_Relaxed) != 0);
+    }
+}
+
+#if defined(__linux__)
+HELIOS_DEF void HeliosFutexWait(HeliosAtomicU32 *address, U32 expected) {
+    syscall(SYS_futex, &address->value, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+HELIOS_DEF void HeliosFutexWake(HeliosAtomicU32 *address, U32 count) {
+    syscall(SYS_futex, &address->value, FUTEX_WAKE_PRIVATE, (int)HELIOS_MIN(count, (U32)INT_MAX), NULL, NULL, 0);
+}
+#elif defined(HELIOS_PLATFORM_WINDOWS)
+#    if defined(HELIOS_COMPILER_MSVC) || defined(HELIOS_COMPILER_CLANG)
+#        pragma comment(lib, "Synchronization.lib")
+#    endif // HELIOS_COMPILER_MSVC || HELIOS_COMPILER_CLANG
+
+HELIOS_DEF void HeliosFutexWait(HeliosAtomicU32 *address, U32 expected) {
+    WaitOnAddress((volatile VOID *)&address->value, &expected, sizeof(expected), INFINITE);
+}
+
+HELIOS_DEF void HeliosFutexWake(HeliosAtomicU32 *address, U32 count) {
+    if (count == 1) WakeByAddressSingle((PVOID)&address->value);
+    else WakeByAddressAll((PVOID)&address->value);
+}
+#else
+// Addresses share buckets, so a wake has to wake the whole bucket and the others go back to sleep.
+#define _HELIOS_FUTEX_BUCKET_BITS 6
+
+typedef struct _HeliosFutexBucket {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+} _HeliosFutexBucket;
+
+HELIOS_INTERNAL _HeliosFutexBucket _helios_futex_buckets[1 << _HELIOS_FUTEX_BUCKET_BITS];
+HELIOS_INTERNAL pthread_once_t _helios_futex_buckets_once = PTHREAD_ONCE_INIT;
+
+HELIOS_INTERNAL void _HeliosFutexInitBuckets(void) {
+    for (UZ i = 0; i < (1 << _HELIOS_FUTEX_BUCKET_BITS); ++i) {
+        pthread_mutex_init(&_helios_futex_buckets[i].mutex, NULL);
+        pthread_cond_init(&_helios_futex_buckets[i].cond, NULL);
+    }
+}
+
+HELIOS_INTERNAL _HeliosFutexBucket *_HeliosFutexGetBucket(HeliosAtomicU32 *address) {
+    pthread_once(&_helios_futex_buckets_once, _HeliosFutexInitBuckets);
+    U64 hash = (U64)(UZ)address * 0x9E3779B97F4A7C15ull;
+    return &_helios_futex_buckets[hash >> (64 - _HELIOS_FUTEX_BUCKET_BITS)];
+}
+
+HELIOS_DEF void HeliosFutexWait(HeliosAtomicU32 *address, U32 expected) {
+    _HeliosFutexBucket *bucket = _HeliosFutexGetBucket(address);
+    pthread_mutex_lock(&bucket->mutex);
+    // Wakers change the value before they take the bucket lock, so either we see the new value here or
+    // their broadcast finds us waiting.
+    if (HeliosAtomicLoadU32(address, HeliosMemoryOrder_SeqCst) == expected) {
+        pthread_cond_wait(&bucket->cond, &bucket->mutex);
+    }
+    pthread_mutex_unlock(&bucket->mutex);
+}
+
+HELIOS_DEF void HeliosFutexWake(HeliosAtomicU32 *address, U32 count) {
+    HELIOS_UNUSED(count);
+    _HeliosFutexBucket *bucket = _HeliosFutexGetBucket(address);
+    pthread_mutex_lock(&bucket->mutex);
+    pthread_cond_broadcast(&bucket->cond);
+    pthread_mutex_unlock(&bucket->mutex);
+}
+#endif // __linux__
+
+HELIOS_DEF B32 HeliosMutexTryLock(HeliosMutex *mutex) {
+    U32 expected = 0;
+    return HeliosAtomicCompareExchangeU32(&mutex->state, &expected, 1, HeliosMemoryOrder_Acquire);
+}
+
+HELIOS_DEF void HeliosMutexLock(HeliosMutex *mutex) {
+    if (HeliosMutexTryLock(mutex)) return;
+
+    // Always mark the mutex as contended, since we cannot know whether somebody else is still sleeping on it.
+    while (HeliosAtomicExchangeU32(&mutex->state, 2, HeliosMemoryOrder_Acquire) != 0) {
+        HeliosFutexWait(&mutex->state, 2);
+    }
+}
+
+HELIOS_DEF void HeliosMutexUnlock(HeliosMutex *mutex) {
+    if (HeliosAtomicExchangeU32(&mutex->state, 0, HeliosMemoryOrder_Release) == 2) {
+        HeliosFutexWake(&mutex->state, 1);
+    }
+}
+
+HELIOS_DEF void HeliosCondVarWait(HeliosCondVar *cond, HeliosMutex *mutex) {
+    U32 sequence = HeliosAtomicLoadU32(&cond->sequence, HeliosMemoryOrder_Relaxed);
+
+    HeliosMutexUnlock(mutex);
+    // A signal sent after the unlock changes the sequence, so the wait returns right away instead of missing it.
+    HeliosFutexWait(&cond->sequence, sequence);
+
+    while (HeliosAtomicExchangeU32(&mutex->state, 2, HeliosMemoryOrder_Acquire) != 0) {
+        HeliosFutexWait(&mutex->state, 2);
+    }
+}
+
+HELIOS_DEF void HeliosCondVarSignal(HeliosCondVar *cond) {
+    HeliosAtomicFetchAddU32(&cond->sequence, 1, HeliosMemoryOrder_Relaxed);
+    HeliosFutexWake(&cond->sequence, 1);
+}
+
+HELIOS_DEF void HeliosCondVarBroadcast(HeliosCondVar *cond) {
+    HeliosAtomicFetchAddU32(&cond->sequence, 1, HeliosMemoryOrder_Relaxed);
+    HeliosFutexWake(&cond->sequence, HELIOS_FUTEX_WAKE_ALL);
+}
+
+HELIOS_DEF void HeliosEventSet(HeliosEvent *event) {
+    if (HeliosAtomicExchangeU32(&event->state, 1, HeliosMemoryOrder_Release) == 0) {
+        HeliosFutexWake(&event->state, HELIOS_FUTEX_WAKE_ALL);
+    }
+}
+
+HELIOS_DEF void HeliosEventReset(HeliosEvent *event) {
+    HeliosAtomicStoreU32(&event->state, 0, HeliosMemoryOrder_Relaxed);
+}
+
+HELIOS_DEF void HeliosEventWait(HeliosEvent *event) {
+    while (HeliosAtomicLoadU32(&event->state, HeliosMemoryOrder_Acquire) == 0) {
+        HeliosFutexWait(&event->state, 0);
+    }
+}
+
+#if defined(HELIOS_ARCH_X86)
+HELIOS_INTERNAL void _HeliosCpuid(U32 leaf, U32 subleaf, U32 regs[4]) {
+#    if defined(HELIOS_COMPILER_MSVC)
+    int out[4];
+    __cpuidex(out, (int)leaf, (int)subleaf);
+    for (U32 i = 0; i < 4; ++i) regs[i] = (U32)out[i];
+#    else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#    endif // HELIOS_COMPILER_MSVC
+}
+
+HELIOS_INTERNAL U64 _HeliosXgetbv(void) {
+#    if defined(HELIOS_COMPILER_MSVC)
+    return _xgetbv(0);
+#    else
+    // The intrinsic wants -mxsave, the instruction itself does not.
+    U32 lo, hi;
+    __asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((U64)hi << 32) | lo;
+#    endif // HELIOS_COMPILER_MSVC
+}
+
+HELIOS_INTERNAL void _HeliosDetectCpuFeatures(HeliosCpuFeatures *features) {
+    U32 regs[4];
+    _HeliosCpuid(0, 0, regs);
+    U32 max_leaf = regs[0];
+    memcpy(features->vendor + 0, &regs[1], 4);
+    memcpy(features->vendor + 4, &regs[3], 4);
+    memcpy(features->vendor + 8, &regs[2], 4);
+    features->vendor[12] = '\0';
+
+    if (max_leaf < 1) return;
+
+    _HeliosCpuid(1, 0, regs);
+    U32 ecx = regs[2], edx = regs[3];
+    if (edx & (1u << 26)) features->flags |= HeliosCpuFeature_SSE2;
+    if (ecx & (1u << 0))  features->flags |= HeliosCpuFeature_SSE3;
+    if (ecx & (1u << 9))  features->flags |= HeliosCpuFeature_SSSE3;
+    if (ecx & (1u << 19)) features->flags |= HeliosCpuFeature_SSE41;
+    if (ecx & (1u << 20)) features->flags |= HeliosCpuFeature_SSE42;
+    if (ecx & (1u << 23)) features->flags |= HeliosCpuFeature_POPCNT;
+
+    // XMM and YMM state, then opmask and both halves of ZMM state.
+    U64 xcr0 = (ecx & (1u << 27)) ? _HeliosXgetbv() : 0;
+    B32 os_avx = (xcr0 & 0x06) == 0x06;
+    B32 os_avx512 = (xcr0 & 0xE6) == 0xE6;
+
+    if (os_avx && (ecx & (1u << 28))) features->flags |= HeliosCpuFeature_AVX;
+    if (os_avx && (ecx & (1u << 12))) features->flags |= HeliosCpuFeature_FMA;
+
+    if (max_leaf < 7) return;
+
+    _HeliosCpuid(7, 0, regs);
+    U32 ebx = regs[1];
+    if (ebx & (1u << 3))             features->flags |= HeliosCpuFeature_BMI1;
+    if (ebx & (1u << 8))             features->flags |= HeliosCpuFeature_BMI2;
+    if (os_avx && (ebx & (1u << 5))) features->flags |= HeliosCpuFeature_AVX2;
+    if (os_avx512 && (ebx & (1u << 16))) features->flags |= HeliosCpuFeature_AVX512F;
+    if (os_avx512 && (ebx & (1u << 30))) features->flags |= HeliosCpuFeature_AVX512BW;
+    if (os_avx512 && (ebx & (1u << 31))) features->flags |= HeliosCpuFeature_AVX512VL;
+}
+#elif defined(HELIOS_ARCH_ARM64)
+HELIOS_INTERNAL void _HeliosDetectCpuFeatures(HeliosCpuFeatures *features) {
+    // Mandatory on AArch64.
+    features->flags |= HeliosCpuFeature_NEON;
+}
+#else
+HELIOS_INTERNAL void _HeliosDetectCpuFeatures(HeliosCpuFeatures *features) {
+    (void)features;
+}
+#endif // HELIOS_ARCH_X86
+
+HELIOS_DEF const HeliosCpuFeatures *HeliosGetCpuFeatures(void) {
+    static HeliosCpuFeatures features;
+    // 0 before detection, 1 while one thread detects and 2 once `features` can be read.
+    static HeliosAtomicU32 state;
+
+    if (HeliosAtomicLoadU32(&state, HeliosMemoryOrder_Acquire) != 2) {
+        U32 expected = 0;
+        if (HeliosAtomicCompareExchangeU32(&state, &expected, 1, HeliosMemoryOrder_Acquire)) {
+            HeliosCpuFeatures result = {0};
+            _HeliosDetectCpuFeatures(&result);
+            features = result;
+            HeliosAtomicStoreU32(&state, 2, HeliosMemoryOrder_Release);
+        } else {
+            // Detection takes a handful of cpuid instructions.
+            while (HeliosAtomicLoadU32(&state, HeliosMemoryOrder_Acquire) != 2) HeliosCpuRelax();
+        }
+    }
+
+    return &features;
+}
+
+HELIOS_INTERNAL UZ _HeliosFindByteScalar(const U8 *data, UZ count, U8 byte) {
+    for (UZ i = 0; i < count; ++i) {
+        if (data[i] == byte) return i;
+    }
+    return count;
+}
+
+HELIOS_INTERNAL UZ _HeliosUtf8CountScalar(const U8 *data, UZ count) {
+    UZ result = 0;
+    for (UZ i = 0; i < count; ++i) result += (data[i] & 0xC0) != 0x80;
+    return result;
+}
+
+// Reflected CRC-32C, one entry per byte value.
+HELIOS_INTERNAL const U32 _helios_crc32c_table[256] = {
+    0x00000000, 0xF26B8303, 0xE13B70F7, 0x1350F3F4, 0xC79A971F, 0x35F1141C, 0x26A1E7E8, 0xD4CA64EB,
+    0x8AD958CF, 0x78B2DBCC, 0x6BE22838, 0x9989AB3B, 0x4D43CFD0, 0xBF284CD3, 0xAC78BF27, 0x5E133C24,
+    0x105EC76F, 0xE235446C, 0xF165B798, 0x030E349B, 0xD7C45070, 0x25AFD373, 0x36FF2087, 0xC494A384,
+    0x9A879FA0, 0x68EC1CA3, 0x7BBCEF57, 0x89D76C54, 0x5D1D08BF, 0xAF768BBC, 0xBC267848, 0x4E4DFB4B,
+    0x20BD8EDE, 0xD2D60DDD, 0xC186FE29, 0x33ED7D2A, 0xE72719C1, 0x154C9AC2, 0x061C6936, 0xF477EA35,
+    0xAA64D611, 0x580F5512, 0x4B5FA6E6, 0xB93425E5, 0x6DFE410E, 0x9F95C20D, 0x8CC531F9, 0x7EAEB2FA,
+    0x30E349B1, 0xC288CAB2, 0xD1D83946, 0x23B3BA45, 0xF779DEAE, 0x05125DAD, 0x1642AE59, 0xE4292D5A,
+    0xBA3A117E, 0x4851927D, 0x5B016189, 0xA96AE28A, 0x7DA08661, 0x8FCB0562, 0x9C9BF696, 0x6EF07595,
+    0x417B1DBC, 0xB3109EBF, 0xA0406D4B, 0x522BEE48, 0x86E18AA3, 0x748A09A0, 0x67DAFA54, 0x95B17957,
+    0xCBA24573, 0x39C9C670, 0x2A993584, 0xD8F2B687, 0x0C38D26C, 0xFE53516F, 0xED03A29B, 0x1F682198,
+    0x5125DAD3, 0xA34E59D0, 0xB01EAA24, 0x42752927, 0x96BF4DCC, 0x64D4CECF, 0x77843D3B, 0x85EFBE38,
+    0xDBFC821C, 0x2997011F, 0x3AC7F2EB, 0xC8AC71E8, 0x1C661503, 0xEE0D9600, 0xFD5D65F4, 0x0F36E6F7,
+    0x61C69362, 0x93AD1061, 0x80FDE395, 0x72966096, 0xA65C047D, 0x5437877E, 0x4767748A, 0xB50CF789,
+    0xEB1FCBAD, 0x197448AE, 0x0A24BB5A, 0xF84F3859, 0x2C855CB2, 0xDEEEDFB1, 0xCDBE2C45, 0x3FD5AF46,
+    0x7198540D, 0x83F3D70E, 0x90A324FA, 0x62C8A7F9, 0xB602C312, 0x44694011, 0x5739B3E5, 0xA55230E6,
+    0xFB410CC2, 0x092A8FC1, 0x1A7A7C35, 0xE811FF36, 0x3CDB9BDD, 0xCEB018DE, 0xDDE0EB2A, 0x2F8B6829,
+    0x82F63B78, 0x709DB87B, 0x63CD4B8F, 0x91A6C88C, 0x456CAC67, 0xB7072F64, 0xA457DC90, 0x563C5F93,
+    0x082F63B7, 0xFA44E0B4, 0xE9141340, 0x1B7F9043, 0xCFB5F4A8, 0x3DDE77AB, 0x2E8E845F, 0xDCE5075C,
+    0x92A8FC17, 0x60C37F14, 0x73938CE0, 0x81F80FE3, 0x55326B08, 0xA759E80B, 0xB4091BFF, 0x466298FC,
+    0x1871A4D8, 0xEA1A27DB, 0xF94AD42F, 0x0B21572C, 0xDFEB33C7, 0x2D80B0C4, 0x3ED04330, 0xCCBBC033,
+    0xA24BB5A6, 0x502036A5, 0x4370C551, 0xB11B4652, 0x65D122B9, 0x97BAA1BA, 0x84EA524E, 0x7681D14D,
+    0x2892ED69, 0xDAF96E6A, 0xC9A99D9E, 0x3BC21E9D, 0xEF087A76, 0x1D63F975, 0x0E330A81, 0xFC588982,
+    0xB21572C9, 0x407EF1CA, 0x532E023E, 0xA145813D, 0x758FE5D6, 0x87E466D5, 0x94B49521, 0x66DF1622,
+    0x38CC2A06, 0xCAA7A905, 0xD9F75AF1, 0x2B9CD9F2, 0xFF56BD19, 0x0D3D3E1A, 0x1E6DCDEE, 0xEC064EED,
+    0xC38D26C4, 0x31E6A5C7, 0x22B65633, 0xD0DDD530, 0x0417B1DB, 0xF67C32D8, 0xE52CC12C, 0x1747422F,
+    0x49547E0B, 0xBB3FFD08, 0xA86F0EFC, 0x5A048DFF, 0x8ECEE914, 0x7CA56A17, 0x6FF599E3, 0x9D9E1AE0,
+    0xD3D3E1AB, 0x21B862A8, 0x32E8915C, 0xC083125F, 0x144976B4, 0xE622F5B7, 0xF5720643, 0x07198540,
+    0x590AB964, 0xAB613A67, 0xB831C993, 0x4A5A4A90, 0x9E902E7B, 0x6CFBAD78, 0x7FAB5E8C, 0x8DC0DD8F,
+    0xE330A81A, 0x115B2B19, 0x020BD8ED, 0xF0605BEE, 0x24AA3F05, 0xD6C1BC06, 0xC5914FF2, 0x37FACCF1,
+    0x69E9F0D5, 0x9B8273D6, 0x88D28022, 0x7AB90321, 0xAE7367CA, 0x5C18E4C9, 0x4F48173D, 0xBD23943E,
+    0xF36E6F75, 0x0105EC76, 0x12551F82, 0xE03E9C81, 0x34F4F86A, 0xC69F7B69, 0xD5CF889D, 0x27A40B9E,
+    0x79B737BA, 0x8BDCB4B9, 0x988C474D, 0x6AE7C44E, 0xBE2DA0A5, 0x4C4623A6, 0x5F16D052, 0xAD7D5351,
+};
+
+HELIOS_INTERNAL U32 _HeliosCrc32cScalar(U32 crc, const U8 *data, UZ count) {
+    crc = ~crc;
+    for (UZ i = 0; i < count; ++i) crc = _helios_crc32c_table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+HELIOS_INTERNAL B32 _HeliosMemEqualScalar(const U8 *lhs, const U8 *rhs, UZ count) {
+    UZ i = 0;
+    for (; i + 8 <= count; i += 8) {
+        U64 a, b;
+        memcpy(&a, lhs + i, sizeof(a));
+        memcpy(&b, rhs + i, sizeof(b));
+        if (a != b) return 0;
+    }
+    for (; i < count; ++i) {
+        if (lhs[i] != rhs[i]) return 0;
+    }
+    return 1;
+}
+
+HELIOS_INTERNAL HELIOS_INLINE U8 _HeliosAsciiToLower(U8 c) {
+    return (U8)(c - 'A') < 26 ? c | 0x20 : c;
+}
+
+HELIOS_INTERNAL B32 _HeliosMemEqualIgnoreCaseScalar(const U8 *lhs, const U8 *rhs, UZ count) {
+    for (UZ i = 0; i < count; ++i) {
+        if (_HeliosAsciiToLower(lhs[i]) != _HeliosAsciiToLower(rhs[i])) return 0;
+    }
+    return 1;
+}
+
+HELIOS_INTERNAL UZ _HeliosFindAnyScalar(const U8 *data, UZ count, const U8 *set, UZ set_count) {
+    U64 table[4] = {0};
+    for (UZ i = 0; i < set_count; ++i) table[set[i] >> 6] |= (U64)1 << (set[i] & 63);
+
+    for (UZ i = 0; i < count; ++i) {
+        if (table[data[i] >> 6] & ((U64)1 << (data[i] & 63))) return i;
+    }
+    return count;
+}
+
+HELIOS_INTERNAL UZ _HeliosFindSubstringScalar(const U8 *data, UZ count, const U8 *needle, UZ needle_count) {
+    if (needle_count == 0) return 0;
+    if (needle_count > count) return count;
+
+    UZ last_start = count - needle_count;
+    for (UZ i = 0; i <= last_start;) {
+        UZ found = i + _HELIOS_KERNEL(find_byte)(data + i, last_start + 1 - i, needle[0]);
+        if (found > last_start) break;
+        if (_HeliosMemEqualScalar(data + found + 1, needle + 1, needle_count - 1)) return found;
+        i = found + 1;
+    }
+    return count;
+}
+
+#if defined(HELIOS_ARCH_X86)
+HELIOS_INTERNAL HELIOS_TARGET("sse2") UZ _HeliosFindByteSSE2(const U8 *data, UZ count, U8 byte) {
+    __m128i needle = _mm_set1_epi8((char)byte);
+    UZ i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(data + i));
+        U32 mask = (U32)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle));
+        if (mask != 0) return i + HeliosCountTrailingZerosU32(mask);
+    }
+    return i + _HeliosFindByteScalar(data + i, count - i, byte);
+}
+
+HELIOS_INTERNAL HELIOS_TARGET("avx2") UZ _HeliosFindByteAVX2(const U8 *data, UZ count, U8 byte) {
+    __m256i needle = _mm256_set1_epi8((char)byte);
+    UZ i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *)(data + i));
+        U32 mask = (U32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle));
+        if (mask != 0) return i + HeliosCountTrailingZerosU32(mask);
+    }
+    return i + _HeliosFindByteSSE2(data + i, count - i, byte);
+}
+
+HELIOS_INTERNAL HELIOS_TARGET("avx512f,avx512bw") UZ _HeliosFindByteAVX512(const U8 *data, UZ count, U8 byte) {
+    __m512i needle = _mm512_set1_epi8((char)byte);
+    for (UZ i = 0; i < count; i += 64) {
+        // Masked loads do not fault on the bytes left out, so the tail needs no scalar loop.
+        UZ left = count - i;
+        __mmask64 valid = left >= 64 ? ~(__mmask64)0 : (((__mmask64)1 << left) - 1);
+        __m512i chunk = _mm512_maskz_loadu_epi8(valid, data + i);
+        U64 mask = (U64)_mm512_mask_cmpeq_epi8_mask(valid, chunk, needle);
+        if (mask != 0) return i + HeliosCountTrailingZerosU64(mask);
+    }
+    return count;
+}
+
+// Continuation bytes are 0x80..0xBF, which are exactly the signed bytes below -64.
+HELIOS_INTERNAL HELIOS_TARGET("sse2") UZ _HeliosUtf8CountSSE2(const U8 *data, UZ count) {
+    __m128i threshold = _mm_set1_epi8(-65);
+    UZ result = 0;
+    UZ i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(data + i));
+        result += HeliosPopCountU32((U32)_mm_movemask_epi8(_mm_cmpgt_epi8(chunk, threshold)));
+    }
+    return result + _HeliosUtf8CountScalar(data + i, count - i);
+}
+
+HELIOS_INTERNAL HELIOS_TARGET("avx2,popcnt") UZ _HeliosUtf8CountAVX2(const U8 *data, UZ count) {
+    __m256i threshold = _mm256_set1_epi8(-65);
+    UZ result = 0;
+    UZ i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *)(data + i));
+        result += (UZ)_mm_popcnt_u32((U32)_mm256_movemask_epi8(_mm256_cmpgt_epi8(chunk, threshold)));
+    }
+    return result + _HeliosUtf8CountScalar(data + i, count - i);
+}
+
+HELIOS_INTERNAL HELIOS_TARGET("sse4.2") U32 _HeliosCrc32cSSE42(U32 crc, const U8 *data, UZ count) {
+    crc = ~crc;
+    UZ i = 0;
+#    if defined(HELIOS_BITS_64)
+    U64 crc64 = crc;
+    for (; i + 8 <= count; i += 8) {
+        U64 word;
+        memcpy(&word, data + i, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = (U32)crc64;
+#    endif // HELIOS_BITS_64
+    for (; i < count; ++i) crc = _mm_crc32_u8(crc, data[i]);
+    return ~crc;
+}
+
+// The last chunk overlaps the one before it instead of dropping to a scalar tail.
+HELIOS_INTERNAL HELIOS_TARGET("sse2") B32 _HeliosMemEqualSSE2(const U8 *lhs, const U8 *rhs, UZ count) {
+    if (count < 16) return _HeliosMemEqualScalar(lhs, rhs, count);
+
+    for (UZ i = 0;; i += 16) {
+        if (i + 16 > count) i = count - 16;
+        __m128i a = _mm_loadu_si128((const __m128i *)(lhs + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(rhs + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) != 0xFFFF) return 0;
+        if (i + 16 == count) return 1;
+    }
+}
+
+HELIOS_INTERNAL HELIOS_TARGET("avx2") B32 _HeliosMemEqualAVX2(const U8 *lhs, const U8 *rhs, UZ count) {
+    if (count < 32) return _HeliosMemEqualSSE2(lhs, rhs, count);
+
+    for (UZ i = 0;; i += 32) {
+        if (i + 32 > count) i = count - 32;
+        __m256i a = _mm256_loadu_si256((const __m256i *)(lhs + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(rhs + i));
+        if ((U32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)) != 0xFFFFFFFFu) return 0;
+        if (i + 32 == count) return 1;
+    }
+}
+
+// 'A'..'Z' are shifted to the bottom of the signed range, where a single compare picks them out.
+HELIOS_INTERNAL HELIOS_TARGET("sse2") __m128i _HeliosAsciiToLowerSSE2(__m128i x) {
+    __m128i shifted = _mm_add_epi8(x, _mm_set1_epi8((char)(128 - 'A')));
+    __m128i upper = _mm_cmplt_epi8(shifted, _mm_set1_epi8(-128 + 26));
+    return _mm_or_si128(x, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+HELIOS_INTERNAL HELIOS_TARGET("sse2") B32 _HeliosMemEqualIgnoreCaseSSE2(const U8 *lhs, const U8 *rhs, UZ count) {
+    if (count < 16) return _HeliosMemEqualIgnoreCaseScalar(lhs, rhs, count);
+
+    for (UZ i = 0;; i += 16) {
+        if (i + 16 > count) i = count - 16;
+        __m128i a = _HeliosAsciiToLowerSSE2(_mm_loadu_si128((const __m128i *)(lhs + i)));
+        __m128i b = _HeliosAsciiToLowerSSE2(_mm_loadu_si128((const __m128i *)(rhs + i)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) != 0xFFFF) return 0;
+        if (i + 16 == count) return 1;
+    }
+}
+
+HELIOS_INTERNAL HELIOS_TARGET("avx2") __m256i _HeliosAsciiToLowerAVX2(__m256i x) {
+    __m256i shifted = _mm256_add_epi8(x, _mm256_set1_epi8((char)(128 - 'A')));
+    __m256i upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(-128 + 26), shifted);
+    return _mm256_or_si256(x, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+
+HELIOS_INTERNAL HELIOS_TARGET("avx2") B32 _HeliosMemEqualIgnoreCaseAVX2(const U8 *lhs, const U8 *rhs, UZ count) {
+    if (count < 32) return _HeliosMemEqualIgnoreCaseSSE2(lhs, rhs, count);
+
+    for (UZ i = 0;; i += 32) {
+        if (i + 32 > count) i = count - 32;
+        __m256i a = _HeliosAsciiToLowerAVX2(_mm256_loadu_si256((const __m256i *)(lhs + i)));
+        __m256i b = _HeliosAsciiToLowerAVX2(_mm256_loadu_si256((const __m256i *)(rhs + i)));
+        if ((U32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)) != 0xFFFFFFFFu) return 0;
+        if (i + 32 == count) return 1;
+    }
+}
+
+#define _HELIOS_FIND_ANY_SIMD_MAX 16
+
+HELIOS_INTERNAL HELIOS_TARGET("sse2") UZ _HeliosFindAnySSE2(const U8 *data, UZ count, const U8 *set, UZ set_count) {
+    if (set_count == 1) return _HELIOS_KERNEL(find_byte)(data, count, set[0]);
+    if (set_count > _HELIOS_FIND_ANY_SIMD_MAX) return _HeliosFindAnyScalar(data, count, set, set_count);
+
+    __m128i needles[_HELIOS_FIND_ANY_SIMD_MAX];
+    for (UZ j = 0; j < set_count; ++j) needles[j] = _mm_set1_epi8((char)set[j]);
+
+    UZ i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(data + i));
+        __m128i hits = _mm_setzero_si128();
+        for (UZ j = 0; j < set_count; ++j) hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, needles[j]));
+
+        U32 mask = (U32)_mm_movemask_epi8(hits);
+        if (mask != 0) return i + HeliosCountTrailingZerosU32(mask);
+    }
+    return i + _HeliosFindAnyScalar(data + i, count - i, set, set_count);
+}
+
+HELIOS_INTERNAL HELIOS_TARGET("avx2") UZ _HeliosFindAnyAVX2(const U8 *data, UZ count, const U8 *set, UZ set_count) {
+    if (set_count == 1) return _HELIOS_KERNEL(find_byte)(data, count, set[0]);
+    if (set_count > _HELIOS_FIND_ANY_SIMD_MAX) return _HeliosFindAnyScalar(data, count, set, set_count);
+
+    __m256i needles[_HELIOS_FIND_ANY_SIMD_MAX];
+    for (UZ j = 0; j < set_count; ++j) needles[j] = _mm256_set1_epi8((char)set[j]);
+
+    UZ i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *)(data + i));
+        __m256i hits = _mm256_setzero_si256();
+        for (UZ j = 0; j < set_count; ++j) hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(chunk, needles[j]));
+
+        U32 mask = (U32)_mm256_movemask_epi8(hits);
+        if (mask != 0) return i + HeliosCountTrailingZerosU32(mask);
+    }
+    return i + _HeliosFindAnySSE2(data + i, count - i, set, set_count);
+}
+
+// Matches the first and the last byte of the needle at every position of a chunk at once, and only
+// compares the whole needle where both agree.
+HELIOS_INTERNAL HELIOS_TARGET("sse2") UZ _HeliosFindSubstringSSE2(const U8 *data, UZ count, const U8 *needle, UZ needle_count) {
+    if (needle_count < 2) {
+        return needle_count == 0 ? 0 : _HELIOS_KERNEL(find_byte)(data, count, needle[0]);
+    }
+    if (needle_count > count) return count;
+
+    __m128i first = _mm_set1_epi8((char)needle[0]);
+    __m128i last = _mm_set1_epi8((char)needle[needle_count - 1]);
+
+    UZ i = 0;
+    for (; i + needle_count - 1 + 16 <= count; i += 16) {
+        __m128i block_first = _mm_loadu_si128((const __m128i *)(data + i));
+        __m128i block_last = _mm_loadu_si128((const __m128i *)(data + i + needle_count - 1));
+        U32 mask = (U32)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first),
+                                                        _mm_cmpeq_epi8(block_last, last)));
+        while (mask != 0) {
+            UZ candidate = i + HeliosCountTrailingZerosU32(mask);
+            if (_HeliosMemEqualSSE2(data + candidate + 1, needle + 1, needle_count - 2)) return candidate;
+            mask &= mask - 1;
+        }
+    }
+
+    UZ found = _HeliosFindSubstringScalar(data + i, count - i, needle, needle_count);
+    return found < count - i ? i + found : count;
+}
+
+HELIOS_INTERNAL HELIOS_TARGET("avx2") UZ _HeliosFindSubstringAVX2(const U8 *data, UZ count, const U8 *needle, UZ needle_count) {
+    if (needle_count < 2) {
+        return needle_count == 0 ? 0 : _HELIOS_KERNEL(find_byte)(data, count, needle[0]);
+    }
+    if (needle_count > count) return count;
+
+    __m256i first = _mm256_set1_epi8((char)needle[0]);
+    __m256i last = _mm256_set1_epi8((char)needle[needle_count - 1]);
+
+    UZ i = 0;
+    for (; i + needle_count - 1 + 32 <= count; i += 32) {
+        __m256i block_first = _mm256_loadu_si256((const __m256i *)(data + i));
+        __m256i block_last = _mm256_loadu_si256((const __m256i *)(data + i + needle_count - 1));
+        U32 mask = (U32)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(block_first, first),
+                                                              _mm256_cmpeq_epi8(block_last, last)));
+        while (mask != 0) {
+            UZ candidate = i + HeliosCountTrailingZerosU32(mask);
+            if (_HeliosMemEqualAVX2(data + candidate + 1, needle + 1, needle_count - 2)) return candidate;
+            mask &= mask - 1;
+        }
+    }
+
+    UZ found = _HeliosFindSubstringSSE2(data + i, count - i, needle, needle_count);
+    return found < count - i ? i + found : count;
+}
+#endif // HELIOS_ARCH_X86
+
+HELIOS_DEF void HeliosKernelsInit(U32 features) {
+    HeliosKernels kernels = {
+        .find_byte = _HeliosFindByteScalar,
+        .utf8_count = _HeliosUtf8CountScalar,
+        .crc32c = _HeliosCrc32cScalar,
+        .mem_equal = _HeliosMemEqualScalar,
+        .mem_equal_ignore_case = _HeliosMemEqualIgnoreCaseScalar,
+        .find_any = _HeliosFindAnyScalar,
+        .find_substring = _HeliosFindSubstringScalar,
+    };
+
+#if defined(HELIOS_ARCH_X86)
+    if (features & HeliosCpuFeature_SSE2) {
+        kernels.find_byte = _HeliosFindByteSSE2;
+        kernels.utf8_count = _HeliosUtf8CountSSE2;
+        kernels.mem_equal = _HeliosMemEqualSSE2;
+        kernels.mem_equal_ignore_case = _HeliosMemEqualIgnoreCaseSSE2;
+        kernels.find_any = _HeliosFindAnySSE2;
+        kernels.find_substring = _HeliosFindSubstringSSE2;
+    }
+    if ((features & (HeliosCpuFeature_AVX2 | HeliosCpuFeature_POPCNT)) == (HeliosCpuFeature_AVX2 | HeliosCpuFeature_POPCNT)) {
+        kernels.utf8_count = _HeliosUtf8CountAVX2;
+    }
+    if (features & HeliosCpuFeature_AVX2) {
+        kernels.find_byte = _HeliosFindByteAVX2;
+        kernels.mem_equal = _HeliosMemEqualAVX2;
+        kernels.mem_equal_ignore_case = _HeliosMemEqualIgnoreCaseAVX2;
+        kernels.find_any = _HeliosFindAnyAVX2;
+        kernels.find_substring = _HeliosFindSubstringAVX2;
+    }
+    if (features & HeliosCpuFeature_AVX512BW) kernels.find_byte = _HeliosFindByteAVX512;
+    if (features & HeliosCpuFeature_SSE42) kernels.crc32c = _HeliosCrc32cSSE42;
+#else
+    (void)features;
+#endif // HELIOS_ARCH_X86
+
+    _HELIOS_KERNEL_STORE(find_byte, kernels.find_byte);
+    _HELIOS_KERNEL_STORE(utf8_count, kernels.utf8_count);
+    _HELIOS_KERNEL_STORE(crc32c, kernels.crc32c);
+    _HELIOS_KERNEL_STORE(mem_equal, kernels.mem_equal);
+    _HELIOS_KERNEL_STORE(mem_equal_ignore_case, kernels.mem_equal_ignore_case);
+    _HELIOS_KERNEL_STORE(find_any, kernels.find_any);
+    _HELIOS_KERNEL_STORE(find_substring, kernels.find_substring);
+}
+
+HELIOS_INTERNAL UZ _HeliosFindByteResolve(const U8 *data, UZ count, U8 byte) {
+    HeliosKernelsInit(HeliosGetCpuFeatures()->flags);
+    return _HELIOS_KERNEL(find_byte)(data, count, byte);
+}
+
+HELIOS_INTERNAL UZ _HeliosUtf8CountResolve(const U8 *data, UZ count) {
+    HeliosKernelsInit(HeliosGetCpuFeatures()->flags);
+    return _HELIOS_KERNEL(utf8_count)(data, count);
+}
+
+HELIOS_INTERNAL U32 _HeliosCrc32cResolve(U32 crc, const U8 *data, UZ count) {
+    HeliosKernelsInit(HeliosGetCpuFeatures()->flags);
+    return _HELIOS_KERNEL(crc32c)(crc, data, count);
+}
+
+HELIOS_INTERNAL B32 _HeliosMemEqualResolve(const U8 *lhs, const U8 *rhs, UZ count) {
+    HeliosKernelsInit(HeliosGetCpuFeatures()->flags);
+    return _HELIOS_KERNEL(mem_equal)(lhs, rhs, count);
+}
+
+HELIOS_INTERNAL B32 _HeliosMemEqualIgnoreCaseResolve(const U8 *lhs, const U8 *rhs, UZ count) {
+    HeliosKernelsInit(HeliosGetCpuFeatures()->flags);
+    return _HELIOS_KERNEL(mem_equal_ignore_case)(lhs, rhs, count);
+}
+
+HELIOS_INTERNAL UZ _HeliosFindAnyResolve(const U8 *data, UZ count, const U8 *set, UZ set_count) {
+    HeliosKernelsInit(HeliosGetCpuFeatures()->flags);
+    return _HELIOS_KERNEL(find_any)(data, count, set, set_count);
+}
+
+HELIOS_INTERNAL UZ _HeliosFindSubstringResolve(const U8 *data, UZ count, const U8 *needle, UZ needle_count) {
+    HeliosKernelsInit(HeliosGetCpuFeatures()->flags);
+    return _HELIOS_KERNEL(find_substring)(data, count, needle, needle_count);
+}
+
+#ifdef HELIOS_STATIC
+HELIOS_INTERNAL
+#endif // HELIOS_STATIC
+HeliosKernels helios_kernels = {
+    .find_byte = _HeliosFindByteResolve,
+    .utf8_count = _HeliosUtf8CountResolve,
+    .crc32c = _HeliosCrc32cResolve,
+    .mem_equal = _HeliosMemEqualResolve,
+    .mem_equal_ignore_case = _HeliosMemEqualIgnoreCaseResolve,
+    .find_any = _HeliosFindAnyResolve,
+    .find_substring = _HeliosFindSubstringResolve,
+};
+
+// Single reads are limited to 32 bits, bigger files take several rounds.
+#define _HELIOS_BATCH_MAX_READ (1u << 30)
+
+// Terminates a buffer of `capacity` bytes holding `size` bytes of a file, shrinking it first when the file
+// turned out shorter than when the buffer was allocated.
+HELIOS_INTERNAL HeliosStringView _HeliosBatchFinishBuffer(HeliosAllocator allocator, U8 *buffer, UZ capacity, UZ size) {
+    if (size + 1 != capacity) buffer = (U8 *)HeliosRealloc(allocator, buffer, capacity, size + 1);
+    buffer[size] = '\0';
+    return (HeliosStringView) {.data = buffer, .count = size};
+}
+
+#ifdef HELIOS_PLATFORM_POSIX
+typedef struct _HeliosBatchFile {
+    const char *path;
+    int fd;
+    U8 *buffer;
+    // The size of `buffer`, which stays put when the file shrinks and `size` drops to what could be read.
+    UZ capacity;
+    UZ size;
+    UZ done;
+} _HeliosBatchFile;
+
+// Opens everything, then allocates all buffers on the calling thread, since allocators need not be thread safe.
+HELIOS_INTERNAL void _HeliosBatchAllocBuffers(HeliosAllocator allocator, _HeliosBatchFile *files, UZ count) {
+    for (UZ i = 0; i < count; ++i) {
+        _HeliosBatchFile *file = &files[i];
+        if (file->fd < 0) continue;
+
+        struct stat file_stat;
+        if (fstat(file->fd, &file_stat) == -1) {
+            close(file->fd);
+            file->fd = -1;
+            continue;
+        }
+
+        file->size = (UZ)file_stat.st_size;
+        file->capacity = file->size + 1;
+        file->buffer = (U8 *)HeliosAllocUninit(allocator, file->capacity);
+    }
+}
+
+#ifdef HELIOS_HAS_IO_URING
+typedef struct _HeliosIoUring {
+    int fd;
+    U32 entries;
+
+    U32 *sq_head;
+    U32 *sq_tail;
+    U32 *sq_mask;
+    U32 *sq_array;
+    struct io_uring_sqe *sqes;
+
+    U32 *cq_head;
+    U32 *cq_tail;
+    U32 *cq_mask;
+    struct io_uring_cqe *cqes;
+
+    void *sq_ring;
+    UZ sq_ring_size;
+    void *cq_ring;
+    UZ cq_ring_size;
+    UZ sqes_size;
+} _HeliosIoUring;
+
+HELIOS_INTERNAL B32 _HeliosIoUringInit(_HeliosIoUring *ring, U32 entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    // Old kernels, seccomp filters and io_uring_disabled all end up here.
+    if (ring->fd < 0) return 0;
+
+    ring->entries = params.sq_entries;
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(U32);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    B32 single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+        ring->sq_ring_size = HELIOS_MAX(ring->sq_ring_size, ring->cq_ring_size);
+        ring->cq_ring_size = ring->sq_ring_size;
+    }
+
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED) {
+        close(ring->fd);
+        return 0;
+    }
+
+    if (single_mmap) {
+        ring->cq_ring = ring->sq_ring;
+    } else {
+        ring->cq_ring = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+        if (ring->cq_ring == MAP_FAILED) {
+            munmap(ring->sq_ring, ring->sq_ring_size);
+            close(ring->fd);
+            return 0;
+        }
+    }
+
+    ring->sqes = (struct io_uring_sqe *)mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        if (!single_mmap) munmap(ring->cq_ring, ring->cq_ring_size);
+        munmap(ring->sq_ring, ring->sq_ring_size);
+        close(ring->fd);
+        return 0;
+    }
+
+    U8 *sq = (U8 *)ring->sq_ring;
+    ring->sq_head = (U32 *)(sq + params.sq_off.head);
+    ring->sq_tail = (U32 *)(sq + params.sq_off.tail);
+    ring->sq_mask = (U32 *)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (U32 *)(sq + params.sq_off.array);
+
+    U8 *cq = (U8 *)ring->cq_ring;
+    ring->cq_head = (U32 *)(cq + params.cq_off.head);
+    ring->cq_tail = (U32 *)(cq + params.cq_off.tail);
+    ring->cq_mask = (U32 *)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+
+    return 1;
+}
+
+HELIOS_INTERNAL void _HeliosIoUringDestroy(_HeliosIoUring *ring) {
+    munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_ring != ring->sq_ring) munmap(ring->cq_ring, ring->cq_ring_size);
+    munmap(ring->sq_ring, ring->sq_ring_size);
+    close(ring->fd);
+}
+
+HELIOS_INTERNAL struct io_uring_sqe *_HeliosIoUringPushSqe(_HeliosIoUring *ring) {
+    U32 tail = *ring->sq_tail;
+    U32 idx = tail & *ring->sq_mask;
+
+    struct io_uring_sqe *sqe = &ring->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    ring->sq_array[idx] = idx;
+
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    return sqe;
+}
+
+typedef enum _HeliosIoUringResult {
+    _HeliosIoUringResult_Done,
+    // Nothing is left in flight, but not everything was submitted.
+    _HeliosIoUringResult_Failed,
+    // Some submitted entries never completed, the kernel may still write into their buffers.
+    _HeliosIoUringResult_Abandoned,
+} _HeliosIoUringResult;
+
+HELIOS_INTERNAL U32 _HeliosIoUringReap(_HeliosIoUring *ring, void (*on_complete)(void *, U64, S32), void *user) {
+    U32 reaped = 0;
+    U32 head = *ring->cq_head;
+    while (head != __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)) {
+        struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+        on_complete(user, cqe->user_data, cqe->res);
+        ++head;
+        ++reaped;
+    }
+    __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+    return reaped;
+}
+
+// Submits `count` queued entries and waits for all of their completions. When submitting fails, whatever
+// did reach the kernel is still waited for, so that the caller can free its buffers.
+HELIOS_INTERNAL _HeliosIoUringResult _HeliosIoUringSubmitAndWait(_HeliosIoUring *ring, U32 count,
+                                                                 void (*on_complete)(void *, U64, S32), void *user) {
+    U32 submitted = 0;
+    U32 completed = 0;
+
+    while (completed < count) {
+        U32 to_submit = count - submitted;
+        int ret = (int)syscall(__NR_io_uring_enter, ring->fd, to_submit, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+        if (ret < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        submitted += (U32)ret;
+        completed += _HeliosIoUringReap(ring, on_complete, user);
+    }
+    if (completed == count) return _HeliosIoUringResult_Done;
+
+    completed += _HeliosIoUringReap(ring, on_complete, user);
+    while (completed < submitted) {
+        int ret = (int)syscall(__NR_io_uring_enter, ring->fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+        if (ret < 0 && errno != EINTR) return _HeliosIoUringResult_Abandoned;
+        completed += _HeliosIoUringReap(ring, on_complete, user);
+    }
+    return _HeliosIoUringResult_Failed;
+}
+
+HELIOS_INTERNAL void _HeliosBatchOnOpen(void *user, U64 idx, S32 res) {
+    _HeliosBatchFile *files = (_HeliosBatchFile *)user;
+    files[idx].fd = res;
+}
+
+HELIOS_INTERNAL void _HeliosBatchOnRead(void *user, U64 idx, S32 res) {
+    _HeliosBatchFile *files = (_HeliosBatchFile *)user;
+    _HeliosBatchFile *file = &files[idx];
+
+    if (res < 0) {
+        close(file->fd);
+        file->fd = -1;
+    } else if (res == 0) {
+        // Truncated under us.
+        file->size = file->done;
+    } else {
+        file->done += (UZ)res;
+    }
+}
+
+// Returns `_HeliosIoUringResult_Abandoned` when the buffers must not be freed, since reads into them may still be
+// in flight.
+HELIOS_INTERNAL _HeliosIoUringResult _HeliosReadFilesIoUring(HeliosAllocator allocator, _HeliosBatchFile *files, UZ count) {
+    U32 entries = 1;
+    while (entries < count && entries < 256) entries <<= 1;
+
+    _HeliosIoUring ring;
+    if (!_HeliosIoUringInit(&ring, entries)) return _HeliosIoUringResult_Failed;
+
+    for (UZ base = 0; base < count; base += ring.entries) {
+        U32 chunk = (U32)HELIOS_MIN(count - base, (UZ)ring.entries);
+        for (U32 i = 0; i < chunk; ++i) {
+            struct io_uring_sqe *sqe = _HeliosIoUringPushSqe(&ring);
+            sqe->opcode = IORING_OP_OPENAT;
+            sqe->fd = AT_FDCWD;
+            sqe->addr = (U64)(UZ)files[base + i].path;
+            sqe->open_flags = O_RDONLY;
+            sqe->user_data = base + i;
+        }
+
+        _HeliosIoUringResult result = _HeliosIoUringSubmitAndWait(&ring, chunk, _HeliosBatchOnOpen, files);
+        if (result != _HeliosIoUringResult_Done) {
+            // No buffers exist yet, an abandoned open can only leak its descriptor.
+            _HeliosIoUringDestroy(&ring);
+            return _HeliosIoUringResult_Failed;
+        }
+    }
+
+    for (UZ i = 0; i < count; ++i) {
+        // The kernel does not know IORING_OP_OPENAT.
+        if (files[i].fd == -EINVAL) {
+            _HeliosIoUringDestroy(&ring);
+            return _HeliosIoUringResult_Failed;
+        }
+    }
+
+    _HeliosBatchAllocBuffers(allocator, files, count);
+
+    while (1) {
+        U32 queued = 0;
+        for (UZ i = 0; i < count; ++i) {
+            _HeliosBatchFile *file = &files[i];
+            if (file->fd < 0 || file->done >= file->size) continue;
+
+            struct io_uring_sqe *sqe = _HeliosIoUringPushSqe(&ring);
+            sqe->opcode = IORING_OP_READ;
+            sqe->fd = file->fd;
+            sqe->addr = (U64)(UZ)(file->buffer + file->done);
+            sqe->len = (U32)HELIOS_MIN(file->size - file->done, (UZ)_HELIOS_BATCH_MAX_READ);
+            sqe->off = file->done;
+            sqe->user_data = i;
+
+            if (++queued == ring.entries) break;
+        }
+
+        if (queued == 0) break;
+
+        _HeliosIoUringResult result = _HeliosIoUringSubmitAndWait(&ring, queued, _HeliosBatchOnRead, files);
+        if (result != _HeliosIoUringResult_Done) {
+            _HeliosIoUringDestroy(&ring);
+            return result;
+        }
+    }
+
+    _HeliosIoUringDestroy(&ring);
+    return _HeliosIoUringResult_Done;
+}
+#endif // HELIOS_HAS_IO_URING
+
+typedef struct _HeliosBatchWork {
+    _HeliosBatchFile *files;
+    UZ count;
+    HeliosAtomicU64 next;
+    B32 reading;
+} _HeliosBatchWork;
+
+HELIOS_INTERNAL void _HeliosBatchWorker(void *arg) {
+    _HeliosBatchWork *work = (_HeliosBatchWork *)arg;
+
+    while (1) {
+        UZ idx = (UZ)HeliosAtomicFetchAddU64(&work->next, 1, HeliosMemoryOrder_Relaxed);
+        if (idx >= work->count) return;
+
+        _HeliosBatchFile *file = &work->files[idx];
+
+        if (!work->reading) {
+            file->fd = open(file->path, O_RDONLY);
+            continue;
+        }
+
+        if (file->fd < 0) continue;
+
+        while (file->done < file->size) {
+            ssize_t n = pread(file->fd, file->buffer + file->done, file->size - file->done, (off_t)file->done);
+            if (n == -1) {
+                close(file->fd);
+                file->fd = -1;
+                break;
+            }
+            if (n == 0) {
+                file->size = file->done;
+                break;
+            }
+            file->done += (UZ)n;
+        }
+    }
+}
+
+HELIOS_INTERNAL void _HeliosBatchRunWorkers(_HeliosBatchWork *work) {
+    HeliosThread threads[HELIOS_READ_BATCH_MAX_WORKERS];
+    UZ threads_count = HELIOS_MIN(work->count, (UZ)HELIOS_READ_BATCH_MAX_WORKERS) - 1;
+    HeliosAtomicStoreU64(&work->next, 0, HeliosMemoryOrder_Relaxed);
+
+    UZ started = 0;
+    for (; started < threads_count; ++started) {
+        if (!HeliosThreadStart(&threads[started], _HeliosBatchWorker, work)) break;
+    }
+
+    // The calling thread pitches in as well, and picks up everything if no thread could be started.
+    _HeliosBatchWorker(work);
+
+    for (UZ i = 0; i < started; ++i) HeliosThreadJoin(&threads[i]);
+}
+
+HELIOS_DEF B32 HeliosReadFilesBatch(HeliosAllocator allocator, const HeliosStringView *paths, UZ count, HeliosStringView *out) {
+    if (count == 0) return 1;
+
+    // Paths have to stay around for the whole batch, so they do not go on the temp allocator.
+    HeliosAllocator scratch = HeliosNewMallocAllocator();
+    UZ scratch_size = sizeof(_HeliosBatchFile) * count;
+    for (UZ i = 0; i < count; ++i) scratch_size += paths[i].count + 1;
+
+    U8 *scratch_data = (U8 *)HeliosAllocUninit(scratch, scratch_size);
+    _HeliosBatchFile *files = (_HeliosBatchFile *)scratch_data;
+    char *path_data = (char *)(files + count);
+
+    for (UZ i = 0; i < count; ++i) {
+        memcpy(path_data, paths[i].data, paths[i].count);
+        path_data[paths[i].count] = '\0';
+
+        files[i] = (_HeliosBatchFile) {.path = path_data, .fd = -1};
+        path_data += paths[i].count + 1;
+    }
+
+    B32 done = 0;
+#ifdef HELIOS_HAS_IO_URING
+    _HeliosIoUringResult result = _HeliosReadFilesIoUring(allocator, files, count);
+    done = result == _HeliosIoUringResult_Done;
+#endif // HELIOS_HAS_IO_URING
+
+    if (!done) {
+        // Start over, io_uring might have failed half way through.
+        for (UZ i = 0; i < count; ++i) {
+            if (files[i].fd >= 0) close(files[i].fd);
+#ifdef HELIOS_HAS_IO_URING
+            // Leaking the buffers is all we can do when the kernel might still be reading into them.
+            if (result != _HeliosIoUringResult_Abandoned && files[i].buffer != NULL) {
+                HeliosFree(allocator, files[i].buffer, files[i].capacity);
+            }
+#endif // HELIOS_HAS_IO_URING
+            files[i] = (_HeliosBatchFile) {.path = files[i].path, .fd = -1};
+        }
+
+        _HeliosBatchWork work = {.files = files, .count = count, .next = {0}, .reading = 0};
+        _HeliosBatchRunWorkers(&work);
+        _HeliosBatchAllocBuffers(allocator, files, count);
+        work.reading = 1;
+        _HeliosBatchRunWorkers(&work);
+    }
+
+    B32 all_ok = 1;
+    for (UZ i = 0; i < count; ++i) {
+        _HeliosBatchFile *file = &files[i];
+
+        if (file->fd < 0) {
+            if (file->buffer != NULL) HeliosFree(allocator, file->buffer, file->capacity);
+            out[i] = (HeliosStringView) {.data = NULL, .count = 0};
+            all_ok = 0;
+            continue;
+        }
+
+        close(file->fd);
+        out[i] = _HeliosBatchFinishBuffer(allocator, file->buffer, file->capacity, file->size);
+    }
+
+    HeliosFree(scratch, scratch_data, scratch_size);
+    return all_ok;
+}
+#endif // HELIOS_PLATFORM_POSIX
+
+#ifdef HELIOS_PLATFORM_WINDOWS
+typedef struct _HeliosBatchFile {
+    OVERLAPPED overlapped;
+    HANDLE handle;
+    U8 *buffer;
+    // The size of `buffer`, which stays put when the file shrinks and `size` drops to what could be read.
+    UZ capacity;
+    UZ size;
+    UZ done;
+} _HeliosBatchFile;
+
+// Starts reading the next piece of `file`. Returns 0 when there is nothing left to read, or the read failed
+// and closed the file.
+HELIOS_INTERNAL B32 _HeliosBatchQueueRead(_HeliosBatchFile *file) {
+    if (file->done >= file->size) return 0;
+
+    memset(&file->overlapped, 0, sizeof(file->overlapped));
+    file->overlapped.Offset = (DWORD)file->done;
+    file->overlapped.OffsetHigh = (DWORD)((U64)file->done >> 32);
+
+    // Reads finishing right away still post their completion to the port.
+    DWORD to_read = (DWORD)HELIOS_MIN(file->size - file->done, (UZ)_HELIOS_BATCH_MAX_READ);
+    if (ReadFile(file->handle, file->buffer + file->done, to_read, NULL, &file->overlapped)) return 1;
+
+    DWORD error = GetLastError();
+    if (error == ERROR_IO_PENDING) return 1;
+
+    if (error == ERROR_HANDLE_EOF) {
+        // Truncated under us.
+        file->size = file->done;
+    } else {
+        CloseHandle(file->handle);
+        file->handle = INVALID_HANDLE_VALUE;
+    }
+    return 0;
+}
+
+HELIOS_DEF B32 HeliosReadFilesBatch(HeliosAllocator allocator, const HeliosStringView *paths, UZ count, HeliosStringView *out) {
+    if (count == 0) return 1;
+
+    HeliosAllocator scratch = HeliosNewMallocAllocator();
+    _HeliosBatchFile *files = (_HeliosBatchFile *)HeliosAllocZeroed(scratch, sizeof(_HeliosBatchFile) * count);
+    HANDLE port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 1);
+
+    // Every file gets one read in flight at a time, the port hands back whichever finishes first.
+    HeliosAllocator temp = HeliosGetTempAllocator();
+    UZ in_flight = 0;
+    for (UZ i = 0; i < count; ++i) {
+        _HeliosBatchFile *file = &files[i];
+        file->handle = INVALID_HANDLE_VALUE;
+        if (port == NULL) continue;
+
+        char *path_cstr = HeliosStringViewCloneToCStr(temp, paths[i]);
+        HANDLE handle = CreateFileA(path_cstr,
+                                    GENERIC_READ,
+                                    FILE_SHARE_READ,
+                                    NULL,
+                                    OPEN_EXISTING,
+                                    FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN,
+                                    NULL);
+        if (handle == INVALID_HANDLE_VALUE) continue;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(handle, &size) || CreateIoCompletionPort(handle, port, (ULONG_PTR)i, 0) == NULL) {
+            CloseHandle(handle);
+            continue;
+        }
+
+        file->handle = handle;
+        file->size = (UZ)size.QuadPart;
+        file->capacity = file->size + 1;
+        file->buffer = (U8 *)HeliosAllocUninit(allocator, file->capacity);
+        if (_HeliosBatchQueueRead(file)) ++in_flight;
+    }
+
+    while (in_flight > 0) {
+        DWORD transferred = 0;
+        ULONG_PTR key = 0;
+        OVERLAPPED *overlapped = NULL;
+        BOOL ok = GetQueuedCompletionStatus(port, &transferred, &key, &overlapped, INFINITE);
+        // Only a broken port comes back without a request, and then the reads may still write into the buffers.
+        HELIOS_VERIFY(overlapped != NULL);
+        --in_flight;
+
+        _HeliosBatchFile *file = &files[key];
+        if (!ok) {
+            if (GetLastError() == ERROR_HANDLE_EOF) {
+                file->size = file->done;
+            } else {
+                CloseHandle(file->handle);
+                file->handle = INVALID_HANDLE_VALUE;
+            }
+            continue;
+        }
+
+        if (transferred == 0) {
+            file->size = file->done;
+            continue;
+        }
+
+        file->done += transferred;
+        if (_HeliosBatchQueueRead(file)) ++in_flight;
+    }
+
+    B32 all_ok = 1;
+    for (UZ i = 0; i < count; ++i) {
+        _HeliosBatchFile *file = &files[i];
+
+        if (file->handle == INVALID_HANDLE_VALUE) {
+            if (file->buffer != NULL) HeliosFree(allocator, file->buffer, file->capacity);
+            out[i] = (HeliosStringView) {.data = NULL, .count = 0};
+            all_ok = 0;
+            continue;
+        }
+
+        CloseHandle(file->handle);
+        out[i] = _HeliosBatchFinishBuffer(allocator, file->buffer, file->capacity, file->size);
+    }
+
+    if (port != NULL) CloseHandle(port);
+    HeliosFree(scratch, files, sizeof(_HeliosBatchFile) * count);
+    return all_ok;
+}
+#endif // HELIOS_PLATFORM_WINDOWS
+
+#define _HELIOS_JOBS_QUEUE_MASK (HELIOS_JOBS_QUEUE_SIZE - 1)
+// How many times an idle worker yields before it goes to sleep.
+#define _HELIOS_JOBS_IDLE_SPINS 64
+
+// `top` is written by thieves and `bottom` only by the owner, so they get separate cache lines.
+typedef struct _HeliosJobsWorker {
+    HeliosAtomicS64 top;
+    HELIOS_CACHE_LINE_PAD(sizeof(HeliosAtomicS64));
+    HeliosAtomicS64 bottom;
+    HELIOS_CACHE_LINE_PAD(sizeof(HeliosAtomicS64));
+
+    HeliosAtomicPtr *deque;
+    HeliosJob *jobs;
+    UZ next_job;
+    U64 rng;
+    U32 index;
+    HeliosJobs *owner;
+    HeliosThread thread;
+} _HeliosJobsWorker;
+
+HELIOS_INTERNAL HELIOS_THREAD_LOCAL _HeliosJobsWorker *_helios_jobs_worker;
+
+HELIOS_INTERNAL _HeliosJobsWorker *_HeliosJobsCurrentWorker(HeliosJobs *jobs) {
+    _HeliosJobsWorker *worker = _helios_jobs_worker;
+    HELIOS_VERIFY(worker != NULL && worker->owner == jobs);
+    return worker;
+}
+
+// Returns 0 if the deque is full.
+HELIOS_INTERNAL B32 _HeliosJobsPush(_HeliosJobsWorker *worker, HeliosJob *job) {
+    S64 bottom = HeliosAtomicLoadS64(&worker->bottom, HeliosMemoryOrder_Relaxed);
+    S64 top = HeliosAtomicLoadS64(&worker->top, HeliosMemoryOrder_Acquire);
+    if (bottom - top >= HELIOS_JOBS_QUEUE_SIZE) return 0;
+
+    HeliosAtomicStorePtr(&worker->deque[bottom & _HELIOS_JOBS_QUEUE_MASK], job, HeliosMemoryOrder_Relaxed);
+    HeliosAtomicStoreS64(&worker->bottom, bottom + 1, HeliosMemoryOrder_Release);
+    return 1;
+}
+
+HELIOS_INTERNAL HeliosJob *_HeliosJobsPop(_HeliosJobsWorker *worker) {
+    S64 bottom = HeliosAtomicLoadS64(&worker->bottom, HeliosMemoryOrder_Relaxed) - 1;
+    HeliosAtomicStoreS64(&worker->bottom, bottom, HeliosMemoryOrder_Relaxed);
+    HeliosAtomicFence(HeliosMemoryOrder_SeqCst);
+    S64 top = HeliosAtomicLoadS64(&worker->top, HeliosMemoryOrder_Relaxed);
+
+    if (top > bottom) {
+        HeliosAtomicStoreS64(&worker->bottom, bottom + 1, HeliosMemoryOrder_Relaxed);
+        return NULL;
+    }
+
+    HeliosJob *job = (HeliosJob *)HeliosAtomicLoadPtr(&worker->deque[bottom & _HELIOS_JOBS_QUEUE_MASK], HeliosMemoryOrder_Relaxed);
+    if (top == bottom) {
+        // The last job, race the thieves for it.
+        if (!HeliosAtomicCompareExchangeS64(&worker->top, &top, top + 1, HeliosMemoryOrder_SeqCst)) job = NULL;
+        HeliosAtomicStoreS64(&worker->bottom, bottom + 1, HeliosMemoryOrder_Relaxed);
+    }
+
+    return job;
+}
+
+HELIOS_INTERNAL HeliosJob *_HeliosJobsSteal(_HeliosJobsWorker *victim) {
+    S64 top = HeliosAtomicLoadS64(&victim->top, HeliosMemoryOrder_Acquire);
+    HeliosAtomicFence(HeliosMemoryOrder_SeqCst);
+    S64 bottom = HeliosAtomicLoadS64(&victim->bottom, HeliosMemoryOrder_Acquire);
+    if (top >= bottom) return NULL;
+
+    HeliosJob *job = (HeliosJob *)HeliosAtomicLoadPtr(&victim->deque[top & _HELIOS_JOBS_QUEUE_MASK], HeliosMemoryOrder_Relaxed);
+    if (!HeliosAtomicCompareExchangeS64(&victim->top, &top, top + 1, HeliosMemoryOrder_SeqCst)) return NULL;
+
+    return job;
+}
+
+HELIOS_INTERNAL HeliosJob *_HeliosJobsFindWork(HeliosJobs *jobs, _HeliosJobsWorker *worker) {
+    HeliosJob *job = _HeliosJobsPop(worker);
+    if (job != NULL || jobs->worker_count == 1) return job;
+
+    // Start from a random victim, so that thieves spread out instead of all hammering worker 0.
+    worker->rng ^= worker->rng << 13;
+    worker->rng ^= worker->rng >> 7;
+    worker->rng ^= worker->rng << 17;
+    U32 start = (U32)(worker->rng % jobs->worker_count);
+
+    for (U32 i = 0; i < jobs->worker_count; ++i) {
+        _HeliosJobsWorker *victim = &jobs->workers[(start + i) % jobs->worker_count];
+        if (victim == worker) continue;
+
+        job = _HeliosJobsSteal(victim);
+        if (job != NULL) return job;
+    }
+
+    return NULL;
+}
+
+HELIOS_INTERNAL void _HeliosJobFinish(HeliosJob *job) {
+    while (job != NULL) {
+        // Read the parent first: once the counter hits zero the owner may reuse the slot.
+        HeliosJob *parent = job->parent;
+        if (HeliosAtomicFetchSubS32(&job->unfinished, 1, HeliosMemoryOrder_AcqRel) != 1) break;
+        job = parent;
+    }
+}
+
+HELIOS_INTERNAL void _HeliosJobExecute(HeliosJobs *jobs, HeliosJob *job) {
+    job->func(jobs, job, job->data);
+    _HeliosJobFinish(job);
+}
+
+// Runs one job, if there is any to be found. Returns whether it did.
+HELIOS_INTERNAL B32 _HeliosJobsHelp(HeliosJobs *jobs, _HeliosJobsWorker *worker) {
+    HeliosJob *job = _HeliosJobsFindWork(jobs, worker);
+    if (job == NULL) return 0;
+
+    _HeliosJobExecute(jobs, job);
+    return 1;
+}
+
+HELIOS_INTERNAL void _HeliosJobsSleep(HeliosJobs *jobs, _HeliosJobsWorker *worker) {
+    HeliosAtomicFetchAddU32(&jobs->sleepers, 1, HeliosMemoryOrder_SeqCst);
+    U32 wake = HeliosAtomicLoadU32(&jobs->wake, HeliosMemoryOrder_SeqCst);
+
+    // Whoever pushed a job before we counted ourselves as a sleeper did not bump `wake`, so look once more.
+    HeliosJob *job = _HeliosJobsFindWork(jobs, worker);
+    if (job == NULL && HeliosAtomicLoadU32(&jobs->running, HeliosMemoryOrder_Acquire)) {
+        HeliosFutexWait(&jobs->wake, wake);
+    }
+
+    HeliosAtomicFetchSubU32(&jobs->sleepers, 1, HeliosMemoryOrder_Relaxed);
+    if (job != NULL) _HeliosJobExecute(jobs, job);
+}
+
+HELIOS_INTERNAL void _HeliosJobsWake(HeliosJobs *jobs, U32 count) {
+    // Pairs with the increment of `sleepers`: either we see the sleeper, or it sees our job.
+    HeliosAtomicFence(HeliosMemoryOrder_SeqCst);
+    if (HeliosAtomicLoadU32(&jobs->sleepers, HeliosMemoryOrder_Relaxed) == 0) return;
+
+    HeliosAtomicFetchAddU32(&jobs->wake, 1, HeliosMemoryOrder_Release);
+    HeliosFutexWake(&jobs->wake, count);
+}
+
+HELIOS_INTERNAL void _HeliosJobsWorkerMain(void *arg) {
+    _HeliosJobsWorker *worker = (_HeliosJobsWorker *)arg;
+    HeliosJobs *jobs = worker->owner;
+    _helios_jobs_worker = worker;
+
+    U32 idle = 0;
+    while (HeliosAtomicLoadU32(&jobs->running, HeliosMemoryOrder_Acquire)) {
+        if (_HeliosJobsHelp(jobs, worker)) {
+            idle = 0;
+        } else if (++idle < _HELIOS_JOBS_IDLE_SPINS) {
+            HeliosThreadYield();
+        } else {
+            _HeliosJobsSleep(jobs, worker);
+            idle = 0;
+        }
+    }
+
+    _helios_jobs_worker = NULL;
+}
+
+HELIOS_DEF B32 HeliosJobsInit(HeliosJobs *jobs, HeliosAllocator allocator, U32 worker_count) {
+    HELIOS_VERIFY(_helios_jobs_worker == NULL);
+
+    if (worker_count == 0) worker_count = HeliosGetCpuCount();
+    worker_count = HELIOS_MIN(HELIOS_MAX(worker_count, 1), HELIOS_JOBS_MAX_WORKERS);
+
+    jobs->allocator = allocator;
+    jobs->worker_count = worker_count;
+    jobs->running = (HeliosAtomicU32) {1};
+    jobs->sleepers = (HeliosAtomicU32) {0};
+    jobs->wake = (HeliosAtomicU32) {0};
+    jobs->workers = (_HeliosJobsWorker *)HeliosAlloc(allocator, sizeof(_HeliosJobsWorker) * worker_count);
+
+    for (U32 i = 0; i < worker_count; ++i) {
+        _HeliosJobsWorker *worker = &jobs->workers[i];
+        worker->deque = (HeliosAtomicPtr *)HeliosAlloc(allocator, sizeof(HeliosAtomicPtr) * HELIOS_JOBS_QUEUE_SIZE);
+        // Zeroed, so every slot in the ring starts out free.
+        worker->jobs = (HeliosJob *)HeliosAlloc(allocator, sizeof(HeliosJob) * HELIOS_JOBS_QUEUE_SIZE);
+        worker->rng = 0x9E3779B97F4A7C15ull * (i + 1);
+        worker->index = i;
+        worker->owner = jobs;
+    }
+
+    _helios_jobs_worker = &jobs->workers[0];
+
+    for (U32 i = 1; i < worker_count; ++i) {
+        if (HeliosThreadStart(&jobs->workers[i].thread, _HeliosJobsWorkerMain, &jobs->workers[i])) continue;
+
+        // Stealing from workers that never started is harmless, their deques stay empty.
+        jobs->workers[i].thread.func = NULL;
+        HeliosJobsDestroy(jobs);
+        return 0;
+    }
+
+    return 1;
+}
+
+HELIOS_DEF void HeliosJobsDestroy(HeliosJobs *jobs) {
+    _HeliosJobsWorker *self = _HeliosJobsCurrentWorker(jobs);
+    HELIOS_VERIFY(self->index == 0);
+
+    HeliosAtomicStoreU32(&jobs->running, 0, HeliosMemoryOrder_SeqCst);
+    HeliosAtomicFetchAddU32(&jobs->wake, 1, HeliosMemoryOrder_SeqCst);
+    HeliosFutexWake(&jobs->wake, HELIOS_FUTEX_WAKE_ALL);
+
+    for (U32 i = 1; i < jobs->worker_count; ++i) {
+        _HeliosJobsWorker *worker = &jobs->workers[i];
+        // Workers that failed to start have never had their thread set.
+        if (worker->thread.func != NULL) HeliosThreadJoin(&worker->thread);
+    }
+
+    for (U32 i = 0; i < jobs->worker_count; ++i) {
+        _HeliosJobsWorker *worker = &jobs->workers[i];
+        HeliosFree(jobs->allocator, worker->deque, sizeof(HeliosAtomicPtr) * HELIOS_JOBS_QUEUE_SIZE);
+        HeliosFree(jobs->allocator, worker->jobs, sizeof(HeliosJob) * HELIOS_JOBS_QUEUE_SIZE);
+    }
+
+    HeliosFree(jobs->allocator, jobs->workers, sizeof(_HeliosJobsWorker) * jobs->worker_count);
+    jobs->workers = NULL;
+    jobs->worker_count = 0;
+    _helios_jobs_worker = NULL;
+}
+
+HELIOS_DEF U32 HeliosJobsWorkerIndex(HeliosJobs *jobs) {
+    return _HeliosJobsCurrentWorker(jobs)->index;
+}
+
+HELIOS_DEF HeliosJob *HeliosJobCreate(HeliosJobs *jobs, HeliosJob *parent, HeliosJobFunc *func, const void *data, UZ data_size) {
+    HELIOS_VERIFY(data_size <= HELIOS_JOB_DATA_SIZE);
+    _HeliosJobsWorker *worker = _HeliosJobsCurrentWorker(jobs);
+
+    // Once the ring wraps around, skip over jobs still in flight, such as a parent spawning children
+    // from this very ring. If every slot is taken, make ourselves useful until one frees up.
+    HeliosJob *job = NULL;
+    for (;;) {
+        for (UZ i = 0; i < HELIOS_JOBS_QUEUE_SIZE; ++i) {
+            HeliosJob *slot = &worker->jobs[worker->next_job++ & _HELIOS_JOBS_QUEUE_MASK];
+            if (HeliosAtomicLoadS32(&slot->unfinished, HeliosMemoryOrder_Acquire) == 0) {
+                job = slot;
+                break;
+            }
+        }
+        if (job != NULL) break;
+
+        if (!_HeliosJobsHelp(jobs, worker)) HeliosThreadYield();
+    }
+
+    job->func = func;
+    job->parent = parent;
+    HeliosAtomicStoreS32(&job->unfinished, 1, HeliosMemoryOrder_Relaxed);
+    if (data_size != 0) memcpy(job->data, data, data_size);
+
+    if (parent != NULL) HeliosAtomicFetchAddS32(&parent->unfinished, 1, HeliosMemoryOrder_Relaxed);
+
+    return job;
+}
+
+HELIOS_DEF void HeliosJobSubmit(HeliosJobs *jobs, HeliosJob *job) {
+    _HeliosJobsWorker *worker = _HeliosJobsCurrentWorker(jobs);
+    if (_HeliosJobsPush(worker, job)) _HeliosJobsWake(jobs, 1);
+    else _HeliosJobExecute(jobs, job);
+}
+
+HELIOS_DEF void HeliosJobWait(HeliosJobs *jobs, HeliosJob *job) {
+    _HeliosJobsWorker *worker = _HeliosJobsCurrentWorker(jobs);
+    while (HeliosAtomicLoadS32(&job->unfinished, HeliosMemoryOrder_Acquire) != 0) {
+        if (!_HeliosJobsHelp(jobs, worker)) HeliosThreadYield();
+    }
+}
+
+typedef struct _HeliosParallelForRange {
+    HeliosParallelForFunc *func;
+    void *arg;
+    UZ begin;
+    UZ end;
+    UZ batch_size;
+} _HeliosParallelForRange;
+
+HELIOS_INTERNAL void _HeliosParallelForJob(HeliosJobs *jobs, HeliosJob *job, void *data) {
+    _HeliosParallelForRange range = *(_HeliosParallelForRange *)data;
+
+    // Hand the upper half off until what is left is small enough to run here.
+    while (range.end - range.begin > range.batch_size) {
+        UZ mid = range.begin + (range.end - range.begin) / 2;
+
+        _HeliosParallelForRange upper = range;
+        upper.begin = mid;
+        HeliosJobSubmit(jobs, HeliosJobCreate(jobs, job, _HeliosParallelForJob, &upper, sizeof(upper)));
+
+        range.end = mid;
+    }
+
+    range.func(range.arg, range.begin, range.end);
+}
+
+HELIOS_DEF void HeliosJobsParallelFor(HeliosJobs *jobs, UZ count, UZ batch_size, HeliosParallelForFunc *func, void *arg) {
+    if (count == 0) return;
+    if (batch_size == 0) batch_size = HELIOS_MAX(count / ((UZ)jobs->worker_count * 4), 1);
+
+    _HeliosParallelForRange range = {.func = func, .arg = arg, .begin = 0, .end = count, .batch_size = batch_size};
+    HeliosJob *root = HeliosJobCreate(jobs, NULL, _HeliosParallelForJob, &range, sizeof(range));
+    HeliosJobSubmit(jobs, root);
+    HeliosJobWait(jobs, root);
 }
-#endif // HELIOS_PLATFORM_WINDOWS
 
 #endif // HELIOS_IMPLEMENTATION
 
@@ -1,4 +1,5 @@
 #define ASTRON_HELIOS_IMPLEMENTATION
+#define ERMIS_HASHMAP_COUNTERS
 #include "../helios.h"
 #include "../ermis.h"
 
@@ -8,6 +9,51 @@ ERMIS_IMPL_ARRAY(S32, IntArray)
 ERMIS_DECL_HASHMAP(U32, U32, IntsMap)
 ERMIS_IMPL_HASHMAP(U32, U32, IntsMap, ErmisEqFuncU32, ErmisHashFuncU32)
 
+ERMIS_DECL_HASHMAP(HeliosStringView, U64, NamesMap)
+ERMIS_IMPL_HASHMAP(HeliosStringView, U64, NamesMap, ErmisEqFuncStringView, ErmisHashFuncStringView)
+
+ERMIS_DECL_BLOOM(U64, U64Bloom)
+ERMIS_IMPL_BLOOM(U64, U64Bloom, ErmisHashFuncU64)
+
+ERMIS_DECL_XORFILTER_A(U32, ArenaU32XorFilter, HeliosArena)
+ERMIS_IMPL_XORFILTER_A(U32, ArenaU32XorFilter, ErmisHashFuncU32, HeliosArena)
+
+#define IntLess(a, b) ((a) < (b))
+ERMIS_DECL_HEAP(S32, IntHeap)
+ERMIS_IMPL_HEAP(S32, IntHeap, IntLess, ErmisHeapIndexNone)
+
+typedef struct Timer {
+    U64 deadline;
+    UZ heap_index;
+} Timer;
+
+#define TimerLess(a, b) ((a)->deadline < (b)->deadline)
+#define TimerSetIndex(item, index) ((*(item))->heap_index = (index))
+ERMIS_DECL_HEAP_A(Timer *, ArenaTimerHeap, HeliosArena)
+ERMIS_IMPL_HEAP_A(Timer *, ArenaTimerHeap, TimerLess, TimerSetIndex, HeliosArena)
+
+ERMIS_DECL_BTREE(U64, U64, U64Tree)
+ERMIS_IMPL_BTREE_SEARCH(U64, U64, U64Tree, ErmisLessFuncU64, ErmisBTreeSearchU64)
+
+ERMIS_DECL_BTREE(HeliosStringView, U32, NamesTree)
+ERMIS_IMPL_BTREE(HeliosStringView, U32, NamesTree, ErmisLessFuncStringView)
+
+ERMIS_DECL_BITSET(FlagSet, 1000)
+
+ERMIS_DECL_HAMT(U64, U64, U64Hamt)
+ERMIS_IMPL_HAMT(U64, U64, U64Hamt, ErmisEqFuncU64, ErmisHashFuncU64)
+
+// Every key hashes the same, which sends all of them to one collision node.
+#define ConstantHash(key) ((void)(key), (U64)0)
+ERMIS_DECL_HAMT(U32, U32, CollidingHamt)
+ERMIS_IMPL_HAMT(U32, U32, CollidingHamt, ErmisEqFuncU32, ConstantHash)
+
+ERMIS_DECL_ARRAY_A(S32, ArenaIntArray, HeliosArena)
+ERMIS_IMPL_ARRAY_A(S32, ArenaIntArray, HeliosArena)
+
+ERMIS_DECL_HASHMAP_A(U32, U32, ArenaIntsMap, HeliosArena)
+ERMIS_IMPL_HASHMAP_A(U32, U32, ArenaIntsMap, ErmisEqFuncU32, ErmisHashFuncU32, HeliosArena)
+
 void test_array(void) {
     UZ ints_count = 10;
 
@@ -49,8 +95,594 @@ void test_hashmap(void) {
     HELIOS_VERIFY(map.count == 351);
 }
 
+void test_hashmap_string_keys_and_misses(void) {
+    HeliosAllocator malloc_allocator = HeliosNewMallocAllocator();
+    NamesMap map;
+    NamesMapInit(&map, malloc_allocator, 0);
+
+    const char *names[] = {"alpha", "beta", "gamma", "delta", "epsilon"};
+    for (U64 i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+        HELIOS_VERIFY(NamesMapInsert(&map, HELIOS_SV_LIT(names[i]), i));
+    }
+    HELIOS_VERIFY(!NamesMapInsert(&map, HELIOS_SV_LIT("gamma"), 20));
+
+    U64 value;
+    HELIOS_VERIFY(NamesMapFind(&map, HELIOS_SV_LIT("gamma"), &value) && value == 20);
+    HELIOS_VERIFY(NamesMapFind(&map, HELIOS_SV_LIT("epsilon"), &value) && value == 4);
+    HELIOS_VERIFY(!NamesMapFind(&map, HELIOS_SV_LIT("zeta"), &value));
+    NamesMapFree(&map);
+
+    // A miss on a completely full table still terminates.
+    IntsMap full;
+    IntsMapInit(&full, malloc_allocator, 1);
+    HELIOS_VERIFY(IntsMapInsert(&full, 7, 1));
+    HELIOS_VERIFY(full.count == full.capacity);
+    HELIOS_VERIFY(IntsMapFindPtr(&full, 8) == NULL);
+    HELIOS_VERIFY(IntsMapFindPtr(&full, 7) != NULL);
+    IntsMapFree(&full);
+}
+
+void test_hashmap_stats(void) {
+    HeliosAllocator malloc_allocator = HeliosNewMallocAllocator();
+    IntsMap map;
+    IntsMapInit(&map, malloc_allocator, 0);
+
+    // Multiples of the capacity all hash to slot 0 with the identity hash, and form one long cluster.
+    for (U32 i = 0; i < 20; ++i) HELIOS_VERIFY(IntsMapInsert(&map, i * ERMIS_HASHMAP_DEFAULT_CAP, i));
+
+    ErmisHashMapStats stats;
+    IntsMapStats(&map, &stats);
+    HELIOS_VERIFY(stats.count == 20 && stats.capacity == ERMIS_HASHMAP_DEFAULT_CAP);
+    HELIOS_VERIFY(stats.max_probe == 20);
+    HELIOS_VERIFY(stats.avg_probe == 10.5);
+    HELIOS_VERIFY(stats.probe_histogram[0] == 1);
+    HELIOS_VERIFY(stats.probe_histogram[ERMIS_HASHMAP_PROBE_HISTOGRAM_BUCKETS - 1] == 20 - ERMIS_HASHMAP_PROBE_HISTOGRAM_BUCKETS + 1);
+    HELIOS_VERIFY(stats.cluster_count == 1 && stats.max_cluster == 20);
+    // 20 * 23 / 2 + 1 probes for misses starting in the cluster or right after it, 1 for the other 26 slots.
+    HELIOS_VERIFY(stats.avg_miss_probe == (F64)(20 * 23 / 2 + 1 + 26) / ERMIS_HASHMAP_DEFAULT_CAP);
+    HELIOS_VERIFY(stats.resize_count == 0);
+
+    HELIOS_VERIFY(IntsMapFindPtr(&map, 19 * ERMIS_HASHMAP_DEFAULT_CAP) != NULL);
+    HELIOS_VERIFY(IntsMapFindPtr(&map, 20 * ERMIS_HASHMAP_DEFAULT_CAP) == NULL);
+    HELIOS_VERIFY(IntsMapFindPtr(&map, 30) == NULL);
+    IntsMapStats(&map, &stats);
+    HELIOS_VERIFY(stats.counters.hits == 1 && stats.counters.hit_probes == 20);
+    HELIOS_VERIFY(stats.counters.misses == 2 && stats.counters.miss_probes == 21 + 1);
+    IntsMapFree(&map);
+
+    // Sequential keys sit in their home slots, and the counters survive resizes.
+    IntsMapInit(&map, malloc_allocator, 0);
+    for (U32 i = 0; i < 1000; ++i) {
+        HELIOS_VERIFY(IntsMapInsert(&map, i, i));
+        HELIOS_VERIFY(IntsMapFindPtr(&map, i) != NULL);
+    }
+
+    IntsMapStats(&map, &stats);
+    // 47 -> 141 -> 423 -> 1269 -> 3807 slots, growing at 70% load.
+    HELIOS_VERIFY(stats.resize_count == 4 && stats.capacity == 3807);
+    HELIOS_VERIFY(stats.max_probe == 1 && stats.avg_probe == 1.0);
+    HELIOS_VERIFY(stats.cluster_count == 1 && stats.max_cluster == 1000);
+    HELIOS_VERIFY(stats.counters.hits == 1000 && stats.counters.hit_probes == 1000);
+    IntsMapFree(&map);
+}
+
+void test_bloom_filter(void) {
+    U64Bloom filter;
+    U64BloomInit(&filter, HeliosNewMallocAllocator(), 10000, 10);
+    HELIOS_VERIFY(((UZ)filter.blocks & 63) == 0);
+
+    // Sequential keys, which the identity hash alone would spread terribly.
+    for (U64 i = 0; i < 10000; ++i) U64BloomAdd(&filter, i);
+    for (U64 i = 0; i < 10000; ++i) HELIOS_VERIFY(U64BloomMayContain(&filter, i));
+
+    // The SIMD and the scalar test agree on every key, and both stay near the expected 1% false positives.
+    B32 simd = filter.simd;
+    U64 false_positives = 0;
+    for (U64 i = 10000; i < 110000; ++i) {
+        filter.simd = 0;
+        B32 scalar_result = U64BloomMayContain(&filter, i);
+        filter.simd = simd;
+        HELIOS_VERIFY(U64BloomMayContain(&filter, i) == scalar_result);
+        false_positives += scalar_result;
+    }
+    HELIOS_VERIFY(false_positives < 2000);
+
+    U64BloomFree(&filter);
+}
+
+void test_xor_filter(void) {
+    HeliosArena arena;
+    HeliosArenaInit(&arena, HELIOS_PAGE_SIZE * 512);
+
+    U32 keys[20000];
+    for (U32 i = 0; i < 20000; ++i) keys[i] = i * 7;
+
+    ArenaU32XorFilter filter;
+    HELIOS_VERIFY(ArenaU32XorFilterBuild(&filter, &arena, keys, 20000));
+    for (U32 i = 0; i < 20000; ++i) HELIOS_VERIFY(ArenaU32XorFilterMayContain(&filter, keys[i]));
+
+    // Expecting 1/256 false positives, about 390 here.
+    U32 false_positives = 0;
+    for (U32 i = 0; i < 100000; ++i) false_positives += ArenaU32XorFilterMayContain(&filter, i * 7 + 3);
+    HELIOS_VERIFY(false_positives < 600);
+    ArenaU32XorFilterFree(&filter);
+
+    // Duplicate keys can never be peeled apart, the build drops them.
+    for (U32 i = 0; i < 1000; ++i) keys[i] = i % 300;
+    HELIOS_VERIFY(ArenaU32XorFilterBuild(&filter, &arena, keys, 1000));
+    for (U32 i = 0; i < 300; ++i) HELIOS_VERIFY(ArenaU32XorFilterMayContain(&filter, i));
+    ArenaU32XorFilterFree(&filter);
+
+    HeliosArenaRelease(&arena);
+}
+
+void test_heap(void) {
+    IntHeap heap;
+    IntHeapInit(&heap, HeliosNewMallocAllocator(), 0);
+
+    for (S32 i = 0; i < 1000; ++i) IntHeapPush(&heap, (i * 7919) % 1000);
+    for (S32 i = 0; i < 1000; ++i) HELIOS_VERIFY(IntHeapPop(&heap) == i);
+    HELIOS_VERIFY(heap.count == 0);
+    IntHeapFree(&heap);
+
+    S32 items[1000];
+    for (S32 i = 0; i < 1000; ++i) items[i] = 999 - i;
+    IntHeapInitFrom(&heap, HeliosNewMallocAllocator(), items, 1000);
+    HELIOS_VERIFY(IntHeapPeek(&heap) == 0);
+    for (UZ i = 1; i < heap.count; ++i) HELIOS_VERIFY(heap.items[ERMIS_HEAP_PARENT(i)] <= heap.items[i]);
+    for (S32 i = 0; i < 1000; ++i) HELIOS_VERIFY(IntHeapPop(&heap) == i);
+    IntHeapFree(&heap);
+
+    // The 10 greatest of a shuffled 0..999, the least of them on top.
+    IntHeapInit(&heap, HeliosNewMallocAllocator(), 10);
+    for (S32 i = 0; i < 1000; ++i) IntHeapPushBounded(&heap, (i * 7919) % 1000, 10);
+    HELIOS_VERIFY(heap.count == 10 && heap.capacity == 10);
+    HELIOS_VERIFY(!IntHeapPushBounded(&heap, 5, 10));
+    for (S32 i = 990; i < 1000; ++i) HELIOS_VERIFY(IntHeapPop(&heap) == i);
+    IntHeapFree(&heap);
+}
+
+void test_heap_index_tracking(void) {
+    HeliosArena arena;
+    HeliosArenaInit(&arena, HELIOS_PAGE_SIZE * 16);
+
+    Timer timers[500];
+    ArenaTimerHeap heap;
+    ArenaTimerHeapInit(&heap, &arena, 1);
+    for (U64 i = 0; i < 500; ++i) {
+        timers[i].deadline = (i * 263) % 500 + 1000;
+        ArenaTimerHeapPush(&heap, &timers[i]);
+    }
+
+    // Rescheduling moves a timer either way, cancelling takes it out from the middle.
+    for (U64 i = 0; i < 500; i += 5) {
+        timers[i].deadline = i % 2 ? timers[i].deadline - 1000 : timers[i].deadline + 1000;
+        ArenaTimerHeapUpdate(&heap, timers[i].heap_index);
+    }
+    for (U64 i = 1; i < 500; i += 5) {
+        HELIOS_VERIFY(ArenaTimerHeapRemove(&heap, timers[i].heap_index) == &timers[i]);
+    }
+    HELIOS_VERIFY(heap.count == 400);
+
+    for (UZ i = 0; i < heap.count; ++i) HELIOS_VERIFY(heap.items[i]->heap_index == i);
+
+    U64 previous = 0;
+    while (heap.count != 0) {
+        Timer *timer = ArenaTimerHeapPop(&heap);
+        HELIOS_VERIFY(timer->deadline >= previous && (timer - timers) % 5 != 1);
+        previous = timer->deadline;
+    }
+
+    ArenaTimerHeapFree(&heap);
+    HeliosArenaRelease(&arena);
+}
+
+void test_btree_search(void) {
+    U32 keys32[ERMIS_BTREE_CAPACITY(U32)];
+    U64 keys64[ERMIS_BTREE_CAPACITY(U64)];
+
+    for (U32 count = 0; count <= ERMIS_BTREE_CAPACITY(U32); ++count) {
+        // Across the sign bit, which the AVX2 compares have to get right, and all ones past the keys, as
+        // in tree nodes.
+        for (U32 i = 0; i < ERMIS_BTREE_CAPACITY(U32); ++i) {
+            keys32[i] = i < count ? 0x7FFFFFF0U + i * 2 : 0xFFFFFFFFU;
+            if (i < ERMIS_BTREE_CAPACITY(U64)) keys64[i] = i < count ? 0x7FFFFFFFFFFFFFF0ULL + i * 2 : ~0ULL;
+        }
+
+        for (U32 i = 0; i < 2 * count + 2; ++i) {
+            UZ expected = HELIOS_MIN((i + 1) / 2, count);
+            for (B32 simd = 0; simd <= ErmisSimdAvailable(); ++simd) {
+                HELIOS_VERIFY(ErmisBTreeSearchU32(keys32, count, 0x7FFFFFF0U + i, simd) == expected);
+                if (count <= ERMIS_BTREE_CAPACITY(U64)) {
+                    HELIOS_VERIFY(ErmisBTreeSearchU64(keys64, count, 0x7FFFFFFFFFFFFFF0ULL + i, simd) == expected);
+                }
+            }
+        }
+    }
+}
+
+void test_btree(void) {
+    U64Tree tree;
+    U64TreeInit(&tree);
+
+    for (U64 i = 0; i < 20000; ++i) HELIOS_VERIFY(U64TreeInsert(&tree, (i * 7919) % 20000 * 3, i));
+    HELIOS_VERIFY(!U64TreeInsert(&tree, 3, 42));
+    HELIOS_VERIFY(tree.count == 20000 && tree.height >= 2);
+
+    U64 value;
+    HELIOS_VERIFY(U64TreeFind(&tree, 3, &value) && value == 42);
+    HELIOS_VERIFY(U64TreeFindPtr(&tree, 4) == NULL && U64TreeFindPtr(&tree, 60000) == NULL);
+
+    U64 expected = 0;
+    for (U64TreeIter it = U64TreeFirst(&tree); U64TreeIterValid(&it); U64TreeIterNext(&it)) {
+        HELIOS_VERIFY(U64TreeIterKey(&it) == expected);
+        expected += 3;
+    }
+    HELIOS_VERIFY(expected == 60000);
+    for (U64TreeIter it = U64TreeLast(&tree); U64TreeIterValid(&it); U64TreeIterPrev(&it)) {
+        expected -= 3;
+        HELIOS_VERIFY(U64TreeIterKey(&it) == expected);
+    }
+    HELIOS_VERIFY(expected == 0);
+
+    // Keys in between start at the next stored key, which can be in the next leaf.
+    for (U64 key = 0; key < 60000; ++key) {
+        U64TreeIter it = U64TreeLowerBound(&tree, key);
+        if (key > 59997) HELIOS_VERIFY(!U64TreeIterValid(&it));
+        else HELIOS_VERIFY(U64TreeIterKey(&it) == (key + 2) / 3 * 3);
+    }
+
+    tree.simd = 0;
+    for (U64 i = 0; i < 20000; ++i) HELIOS_VERIFY(U64TreeFindPtr(&tree, i * 3) != NULL);
+    U64TreeFree(&tree);
+
+    // Ascending inserts fill every leaf before starting the next one.
+    U64TreeInit(&tree);
+    for (U64 i = 0; i < 10000; ++i) U64TreeInsert(&tree, i, i);
+    UZ leaf_count = 0;
+    for (U64TreeLeaf *leaf = tree.first; leaf != NULL; leaf = leaf->next) ++leaf_count;
+    HELIOS_VERIFY(leaf_count == (10000 + ERMIS_BTREE_CAPACITY(U64) - 1) / ERMIS_BTREE_CAPACITY(U64));
+    U64TreeFree(&tree);
+}
+
+void test_btree_bulk_load(void) {
+    U64 *keys = (U64 *)malloc(sizeof(U64) * 100000);
+    for (U64 i = 0; i < 100000; ++i) keys[i] = i * 2;
+
+    U64Tree tree;
+    U64TreeInit(&tree);
+    U64TreeBulkLoad(&tree, keys, keys, 100000);
+    HELIOS_VERIFY(tree.count == 100000 && tree.height == 3);
+    for (U64 i = 0; i < 100000; ++i) HELIOS_VERIFY(*U64TreeFindPtr(&tree, i * 2) == i * 2);
+
+    // Inserts go into the full leaves of the bulk load.
+    for (U64 i = 0; i < 1000; ++i) HELIOS_VERIFY(U64TreeInsert(&tree, i * 200 + 1, i));
+    U64 previous = 0;
+    UZ count = 0;
+    for (U64TreeIter it = U64TreeFirst(&tree); U64TreeIterValid(&it); U64TreeIterNext(&it), ++count) {
+        HELIOS_VERIFY(count == 0 || U64TreeIterKey(&it) > previous);
+        previous = U64TreeIterKey(&it);
+    }
+    HELIOS_VERIFY(count == 101000);
+
+    U64TreeFree(&tree);
+    free(keys);
+}
+
+void test_btree_string_keys(void) {
+    const char *names[] = {"user/ada", "team/core", "user/bob", "user", "users/x", "user/alan", "team/web"};
+    NamesTree tree;
+    NamesTreeInit(&tree);
+    for (U32 i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+        NamesTreeInsert(&tree, HELIOS_SV_LIT(names[i]), i);
+    }
+
+    // A prefix scan starts at the prefix itself and stops at the first key without it.
+    HeliosStringView prefix = HELIOS_SV_LIT("user/");
+    U32 found[4];
+    UZ count = 0;
+    for (NamesTreeIter it = NamesTreeLowerBound(&tree, prefix);
+         NamesTreeIterValid(&it) && HeliosStringViewStartsWithSV(NamesTreeIterKey(&it), prefix); NamesTreeIterNext(&it)) {
+        found[count++] = *NamesTreeIterValue(&it);
+    }
+    HELIOS_VERIFY(count == 3 && found[0] == 0 && found[1] == 5 && found[2] == 2);
+
+    NamesTreeFree(&tree);
+}
+
+void test_bitset(void) {
+    FlagSet a, b;
+    FlagSetClearAll(&a);
+    FlagSetClearAll(&b);
+
+    // Multiples of 3 and of 5, so that every op has both kinds of words.
+    UZ count_a = 0;
+    for (UZ i = 0; i < 1000; i += 3, ++count_a) FlagSetSet(&a, i);
+    for (UZ i = 0; i < 1000; i += 5) FlagSetSet(&b, i);
+    HELIOS_VERIFY(FlagSetCount(&a) == count_a && FlagSetTest(&a, 999) && !FlagSetTest(&a, 998));
+
+    FlagSet result = a;
+    FlagSetAnd(&result, &b);
+    for (UZ i = 0; i < 1000; ++i) HELIOS_VERIFY(FlagSetTest(&result, i) == (i % 15 == 0));
+    result = a;
+    FlagSetOr(&result, &b);
+    for (UZ i = 0; i < 1000; ++i) HELIOS_VERIFY(FlagSetTest(&result, i) == (i % 3 == 0 || i % 5 == 0));
+    result = a;
+    FlagSetXor(&result, &b);
+    for (UZ i = 0; i < 1000; ++i) HELIOS_VERIFY(FlagSetTest(&result, i) == ((i % 3 == 0) != (i % 5 == 0)));
+    result = a;
+    FlagSetAndNot(&result, &b);
+    for (UZ i = 0; i < 1000; ++i) HELIOS_VERIFY(FlagSetTest(&result, i) == (i % 3 == 0 && i % 5 != 0));
+
+    FlagSetClear(&result, 3);
+    HELIOS_VERIFY(FlagSetNext(&result, 1) == 6);
+    HELIOS_VERIFY(FlagSetNext(&result, 999) == 999 && FlagSetNext(&result, 1000) == 1000);
+
+    UZ expected = 0;
+    ERMIS_BITS_FOREACH(a.words, ERMIS_BITS_WORDS(1000), i, {
+        HELIOS_VERIFY(i == expected);
+        expected += 3;
+    });
+    HELIOS_VERIFY(expected == count_a * 3);
+
+    FlagSetBuildRank(&a);
+    for (UZ k = 0; k < count_a; ++k) {
+        HELIOS_VERIFY(FlagSetSelect(&a, k) == k * 3);
+        HELIOS_VERIFY(FlagSetRank(&a, k * 3) == k && FlagSetRank(&a, k * 3 + 1) == k + 1);
+    }
+    HELIOS_VERIFY(FlagSetRank(&a, 1000) == count_a && FlagSetSelect(&a, count_a) == 1000);
+}
+
+void test_bitset_dynamic(void) {
+    ErmisBitset set, other;
+    // 2 blocks of the rank directory and an odd tail, enough words for the AVX2 loops and their tails.
+    ErmisBitsetInit(&set, HeliosNewMallocAllocator(), 64 * 13 + 7);
+    ErmisBitsetInit(&other, HeliosNewMallocAllocator(), 64 * 13 + 7);
+
+    // Dense and sparse words, so that select has to look inside bytes with many bits.
+    U64 state = 1;
+    for (UZ i = 0; i < set.bit_count; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        if ((i / 64) % 3 == 0 ? (state >> 60) != 0 : (state >> 60) == 0) ErmisBitsetSet(&set, i);
+        if ((state >> 33) & 1) ErmisBitsetSet(&other, i);
+    }
+
+    UZ count = 0;
+    for (UZ i = 0; i < set.bit_count; ++i) count += ErmisBitsetTest(&set, i);
+    HELIOS_VERIFY(ErmisBitsetCount(&set) == count);
+
+    ErmisBitsetBuildRank(&set);
+    UZ rank = 0;
+    for (UZ i = ErmisBitsetNext(&set, 0); i < set.bit_count; i = ErmisBitsetNext(&set, i + 1), ++rank) {
+        HELIOS_VERIFY(ErmisBitsetRank(&set, i) == rank && ErmisBitsetSelect(&set, rank) == i);
+    }
+    HELIOS_VERIFY(rank == count && ErmisBitsetSelect(&set, count) == set.bit_count);
+
+    ErmisBitset copy;
+    ErmisBitsetInit(&copy, HeliosNewMallocAllocator(), set.bit_count);
+    memcpy(copy.words, set.words, sizeof(U64) * ErmisBitsetWordCount(&set));
+    ErmisBitsetXor(&copy, &other);
+    for (UZ i = 0; i < set.bit_count; ++i) {
+        HELIOS_VERIFY(ErmisBitsetTest(&copy, i) == (ErmisBitsetTest(&set, i) != ErmisBitsetTest(&other, i)));
+    }
+
+    // Shrinking clears the bits past the end, growing back brings them back clear.
+    ErmisBitsetSet(&copy, 100);
+    ErmisBitsetResize(&copy, 101);
+    HELIOS_VERIFY(copy.rank == NULL && ErmisBitsetTest(&copy, 100));
+    ErmisBitsetResize(&copy, 64 * 20);
+    HELIOS_VERIFY(ErmisBitsetNext(&copy, 101) == copy.bit_count);
+
+    ErmisBitsetFree(&copy);
+    ErmisBitsetFree(&other);
+    ErmisBitsetFree(&set);
+}
+
+void test_hamt(void) {
+    HeliosTrackingAllocator tracker;
+    HeliosTrackingAllocatorInit(&tracker, HeliosNewMallocAllocator());
+
+    U64Hamt empty;
+    U64HamtInit(&empty, HeliosNewTrackingAllocator(&tracker));
+    HELIOS_VERIFY(U64HamtFindPtr(&empty, 1) == NULL);
+
+    // Every tenth version is kept, to check that later updates leave them alone.
+    U64Hamt versions[11];
+    U64Hamt map = U64HamtRetain(&empty);
+    for (U64 i = 0; i < 10000; ++i) {
+        if (i % 1000 == 0) versions[i / 1000] = U64HamtRetain(&map);
+        U64Hamt next = U64HamtInsert(&map, i, i * 2);
+        U64HamtRelease(&map);
+        map = next;
+    }
+    versions[10] = map;
+
+    for (UZ v = 0; v <= 10; ++v) {
+        HELIOS_VERIFY(versions[v].count == v * 1000);
+        for (U64 i = 0; i < 10000; i += 7) {
+            const U64 *value = U64HamtFindPtr(&versions[v], i);
+            HELIOS_VERIFY(i < v * 1000 ? value != NULL && *value == i * 2 : value == NULL);
+        }
+    }
+
+    // Replacing keeps the count, removing a missing key gives back the same nodes.
+    U64Hamt replaced = U64HamtInsert(&versions[10], 5, 55);
+    HELIOS_VERIFY(replaced.count == 10000 && *U64HamtFindPtr(&replaced, 5) == 55 && *U64HamtFindPtr(&versions[10], 5) == 10);
+    U64Hamt same = U64HamtRemove(&replaced, 20000);
+    HELIOS_VERIFY(same.root == replaced.root && same.count == 10000);
+    U64HamtRelease(&same);
+
+    U64Hamt shrunk = U64HamtRetain(&replaced);
+    for (U64 i = 0; i < 10000; i += 2) {
+        U64Hamt next = U64HamtRemove(&shrunk, i);
+        U64HamtRelease(&shrunk);
+        shrunk = next;
+    }
+    HELIOS_VERIFY(shrunk.count == 5000 && U64HamtFindPtr(&replaced, 4) != NULL);
+
+    U64 seen = 0;
+    U64 sum = 0;
+    U64HamtIter it;
+    for (U64HamtIterInit(&it, &shrunk); U64HamtIterValid(&it); U64HamtIterNext(&it)) {
+        U64 key = U64HamtIterKey(&it);
+        HELIOS_VERIFY(key % 2 == 1 && *U64HamtIterValue(&it) == (key == 5 ? 55 : key * 2));
+        ++seen;
+        sum += key;
+    }
+    HELIOS_VERIFY(seen == 5000 && sum == 5000 * 5000);
+
+    for (U64 i = 1; i < 10000; i += 2) {
+        U64Hamt next = U64HamtRemove(&shrunk, i);
+        U64HamtRelease(&shrunk);
+        shrunk = next;
+    }
+    HELIOS_VERIFY(shrunk.count == 0 && shrunk.root == NULL);
+
+    U64HamtRelease(&replaced);
+    for (UZ v = 0; v <= 10; ++v) U64HamtRelease(&versions[v]);
+    U64HamtRelease(&empty);
+    HELIOS_VERIFY(tracker.live_bytes == 0);
+}
+
+void test_hamt_collisions(void) {
+    HeliosTrackingAllocator tracker;
+    HeliosTrackingAllocatorInit(&tracker, HeliosNewMallocAllocator());
+
+    CollidingHamt map;
+    CollidingHamtInit(&map, HeliosNewTrackingAllocator(&tracker));
+    for (U32 i = 0; i < 20; ++i) {
+        CollidingHamt next = CollidingHamtInsert(&map, i, i + 100);
+        CollidingHamtRelease(&map);
+        map = next;
+    }
+
+    HELIOS_VERIFY(map.count == 20);
+    for (U32 i = 0; i < 20; ++i) HELIOS_VERIFY(*CollidingHamtFindPtr(&map, i) == i + 100);
+    HELIOS_VERIFY(CollidingHamtFindPtr(&map, 20) == NULL);
+
+    // Down to one key, which moves back up into the root.
+    for (U32 i = 1; i < 20; ++i) {
+        CollidingHamt next = CollidingHamtRemove(&map, i);
+        CollidingHamtRelease(&map);
+        map = next;
+    }
+    HELIOS_VERIFY(map.count == 1 && *CollidingHamtFindPtr(&map, 0) == 100);
+    HELIOS_VERIFY(map.root->entry_count == 1 && map.root->child_map == 0);
+
+    CollidingHamtRelease(&map);
+    HELIOS_VERIFY(tracker.live_bytes == 0);
+}
+
+#define HAMT_CELL_VERSIONS 2000
+
+typedef struct HamtCellTest {
+    U64HamtCell cell;
+    HeliosAtomicU32 done;
+} HamtCellTest;
+
+static void HamtCellReader(void *arg) {
+    HamtCellTest *test = (HamtCellTest *)arg;
+    while (!HeliosAtomicLoadU32(&test->done, HeliosMemoryOrder_Acquire)) {
+        // Version `n` holds the keys below `n`, each mapping to itself.
+        U64Hamt snapshot = U64HamtCellLoad(&test->cell);
+        U64 count = snapshot.count;
+        HELIOS_VERIFY(U64HamtFindPtr(&snapshot, count) == NULL);
+        if (count > 0) HELIOS_VERIFY(*U64HamtFindPtr(&snapshot, count - 1) == count - 1);
+        U64HamtRelease(&snapshot);
+    }
+}
+
+void test_hamt_cell(void) {
+    HamtCellTest test;
+    U64Hamt map;
+    U64HamtInit(&map, HeliosNewMallocAllocator());
+    U64HamtCellInit(&test.cell, U64HamtRetain(&map));
+    HeliosAtomicStoreU32(&test.done, 0, HeliosMemoryOrder_Relaxed);
+
+    HeliosThread reader;
+    HELIOS_VERIFY(HeliosThreadStart(&reader, HamtCellReader, &test));
+    for (U64 i = 0; i < HAMT_CELL_VERSIONS; ++i) {
+        U64Hamt next = U64HamtInsert(&map, i, i);
+        U64HamtRelease(&map);
+        map = next;
+        U64HamtCellStore(&test.cell, U64HamtRetain(&map));
+    }
+    HeliosAtomicStoreU32(&test.done, 1, HeliosMemoryOrder_Release);
+    HeliosThreadJoin(&reader);
+
+    U64Hamt last = U64HamtCellLoad(&test.cell);
+    HELIOS_VERIFY(last.root == map.root && last.count == HAMT_CELL_VERSIONS);
+    U64HamtRelease(&last);
+    U64HamtRelease(&map);
+    U64HamtCellFree(&test.cell);
+}
+
+void test_array_static_allocator(void) {
+    HeliosArena arena;
+    HeliosArenaInit(&arena, HELIOS_PAGE_SIZE * 4);
+
+    ArenaIntArray ints;
+    ArenaIntArrayInit(&ints, &arena, 1);
+
+    for (S32 i = 0; i < 1000; ++i) {
+        ArenaIntArrayPush(&ints, i);
+    }
+
+    // The array is the only thing living in the arena, so every grow happens in place.
+    HELIOS_VERIFY((U8 *)ints.items == arena.base);
+    HELIOS_VERIFY(arena.offset == sizeof(S32) * ints.capacity);
+
+    for (S32 i = 0; i < 1000; ++i) {
+        HELIOS_VERIFY(ArenaIntArrayAt(&ints, i) == i);
+    }
+
+    ArenaIntArrayFree(&ints);
+    HELIOS_VERIFY(arena.offset == 0);
+
+    HeliosArenaRelease(&arena);
+}
+
+void test_hashmap_static_allocator(void) {
+    HeliosArena arena;
+    HeliosArenaInit(&arena, HELIOS_PAGE_SIZE * 16);
+
+    ArenaIntsMap map;
+    ArenaIntsMapInit(&map, &arena, 0);
+
+    for (U32 i = 0; i < 200; ++i) {
+        HELIOS_VERIFY(ArenaIntsMapInsert(&map, i, i * 3));
+    }
+
+    HELIOS_VERIFY(map.count == 200);
+
+    for (U32 i = 0; i < 200; ++i) {
+        U32 value;
+        HELIOS_VERIFY(ArenaIntsMapFind(&map, i, &value));
+        HELIOS_VERIFY(value == i * 3);
+    }
+
+    HeliosArenaRelease(&arena);
+}
+
 int main(void) {
     test_array();
     test_hashmap();
+    test_hashmap_string_keys_and_misses();
+    test_hashmap_stats();
+    test_bloom_filter();
+    test_xor_filter();
+    test_heap();
+    test_heap_index_tracking();
+    test_btree_search();
+    test_btree();
+    test_btree_bulk_load();
+    test_btree_string_keys();
+    test_bitset();
+    test_bitset_dynamic();
+    test_hamt();
+    test_hamt_collisions();
+    test_hamt_cell();
+    test_array_static_allocator();
+    test_hashmap_static_allocator();
     return 0;
 }
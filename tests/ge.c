@@ -123,11 +123,216 @@ void Integers(void) {
     HELIOS_VERIFY(table->next->next->next->value.i == 0xABCD);
 }
 
+// Where tests write their fixtures, the source tree may well be read-only.
+static const char *TempDir(void) {
+    const char *names[] = {"TMPDIR", "TEMP", "TMP"};
+    for (UZ i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+        const char *dir = getenv(names[i]);
+        if (dir != NULL && dir[0] != '\0') return dir;
+    }
+#ifdef HELIOS_PLATFORM_WINDOWS
+    return ".";
+#else
+    return "/tmp";
+#endif
+}
+
+void ParseFileBorrowsStrings(void) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/ge_parse_file_borrows_strings.toml", TempDir());
+    const char *contents = "name = \"astron\"\n[server]\nport = 8080\n";
+
+    FILE *f = fopen(path, "wb");
+    HELIOS_VERIFY(f != NULL);
+    fwrite(contents, 1, strlen(contents), f);
+    fclose(f);
+
+    HeliosAllocator allocator = HeliosNewMallocAllocator();
+    char err_buf[512];
+    HeliosMappedFile file;
+    GeTomlTable *table = GeTomlParseFile(allocator, HELIOS_SV_LIT(path), &file, err_buf, sizeof(err_buf));
+    HELIOS_VERIFY(table != NULL);
+
+    const U8 *begin = file.contents.data;
+    const U8 *end = begin + file.contents.count;
+
+    GeTomlValue *name = GeTomlTableFind(table, "name");
+    HELIOS_VERIFY(name != NULL && name->type == GeTomlValueType_String);
+    HELIOS_VERIFY(HeliosStringViewEqualCStr(name->s, "astron"));
+    HELIOS_VERIFY(name->s.data >= begin && name->s.data < end);
+    HELIOS_VERIFY(table->key.data >= begin && table->key.data < end);
+
+    GeTomlValue *server = GeTomlTableFind(table, "server");
+    HELIOS_VERIFY(server != NULL && server->type == GeTomlValueType_Table);
+    GeTomlValue *port = GeTomlTableFind(server->t, "port");
+    HELIOS_VERIFY(port != NULL && port->i == 8080);
+
+    HeliosUnmapFile(&file);
+    remove(path);
+
+    HELIOS_VERIFY(GeTomlParseFile(allocator, HELIOS_SV_LIT(path), &file, err_buf, sizeof(err_buf)) == NULL);
+    HELIOS_VERIFY(strncmp(err_buf, "could not map file", 18) == 0);
+}
+
+void ParseWithInternedKeys(void) {
+    HeliosAllocator allocator = HeliosNewMallocAllocator();
+    HeliosInterner interner;
+    HELIOS_VERIFY(HeliosInternerInit(&interner, allocator, 0));
+
+    const char *buf = "name = \"a\"\n[first]\nname = \"b\"\nport = 1\n[second]\nname = \"c\"\nport = 2\n";
+    GeTomlParseOptions options = { .interner = &interner };
+    char err_buf[512];
+    GeTomlTable *table = GeTomlParseBufferEx(allocator, buf, strlen(buf), &options, err_buf, sizeof(err_buf));
+    HELIOS_VERIFY(table != NULL);
+
+    // name, first, port and second.
+    HELIOS_VERIFY(interner.count == 4);
+
+    HeliosInternId name_id = HeliosInternerFind(&interner, HELIOS_SV_LIT("name"));
+    HeliosInternId port_id = HeliosInternerFind(&interner, HELIOS_SV_LIT("port"));
+    HELIOS_VERIFY(name_id != HELIOS_INTERN_ID_NONE && port_id != HELIOS_INTERN_ID_NONE);
+    HELIOS_VERIFY(HeliosInternerFind(&interner, HELIOS_SV_LIT("missing")) == HELIOS_INTERN_ID_NONE);
+
+    GeTomlTable *first = GeTomlTableFind(table, "first")->t;
+    GeTomlTable *second = GeTomlTableFindId(table, HeliosInternerFind(&interner, HELIOS_SV_LIT("second")))->t;
+    HELIOS_VERIFY(first->key.data == second->key.data);
+    HELIOS_VERIFY(HeliosStringViewEqualCStr(GeTomlTableFindId(first, name_id)->s, "b"));
+    HELIOS_VERIFY(GeTomlTableFindId(second, port_id)->i == 2);
+
+    const char *duplicate = "[t]\nkey = 1\n[t.key]\n";
+    HELIOS_VERIFY(GeTomlParseBufferEx(allocator, duplicate, strlen(duplicate), &options, err_buf, sizeof(err_buf)) == NULL);
+
+    HeliosInternerDestroy(&interner);
+}
+
+// Sums the integers below `cursor` and counts the entries visited, checking the links on the way.
+static S64 SumTapeInts(GeTomlCursor cursor, UZ *visited) {
+    ++*visited;
+    switch (GeTomlCursorType(cursor)) {
+    case GeTomlValueType_Int: return GeTomlCursorInt(cursor);
+    case GeTomlValueType_Array: {
+        S64 sum = 0;
+        UZ count = 0;
+        GeTomlCursor item = GeTomlCursorFirst(cursor);
+        for (; !GeTomlCursorAtEnd(item); item = GeTomlCursorNext(item), ++count) sum += SumTapeInts(item, visited);
+        HELIOS_VERIFY(GeTomlCursorTag(item) == GeTomlTapeTag_ArrayEnd && count == GeTomlCursorCount(cursor));
+        HELIOS_VERIFY(GE_TOML_TAPE_PAYLOAD(cursor.tape->entries[item.index]) == cursor.index);
+        return sum;
+    }
+    case GeTomlValueType_Table: {
+        S64 sum = 0;
+        UZ count = 0;
+        GeTomlCursor key = GeTomlCursorFirst(cursor);
+        for (; !GeTomlCursorAtEnd(key); key = GeTomlCursorNext(key), ++count) sum += SumTapeInts(GeTomlCursorValue(key), visited);
+        HELIOS_VERIFY(GeTomlCursorTag(key) == GeTomlTapeTag_TableEnd && count == GeTomlCursorCount(cursor));
+        return sum;
+    }
+    default: return 0;
+    }
+}
+
+void Tape(void) {
+    HeliosAllocator allocator = HeliosNewMallocAllocator();
+    const char *buf = "name = \"astron\"\nenabled = true\n[server.http]\nport = 8080\nhosts = [\"a\", \"bc\", \"\"]\n"
+                      "[server.limits]\nsizes = [[1, 2], [3], []]\ninline = { x = 4, y = { z = 5 } }\nempty = []\n";
+    char err_buf[512];
+    GeTomlTape tape;
+    HELIOS_VERIFY(GeTomlTapeParseBuffer(&tape, allocator, buf, strlen(buf), err_buf, sizeof(err_buf)));
+
+    GeTomlCursor root = GeTomlTapeRoot(&tape);
+    HELIOS_VERIFY(GeTomlCursorType(root) == GeTomlValueType_Table && GeTomlCursorCount(root) == 3);
+    HELIOS_VERIFY(GE_TOML_TAPE_PAYLOAD(tape.entries[0]) == ((U64)3 << 32 | (tape.entry_count - 1)));
+
+    GeTomlCursor name, enabled, server, http, port, hosts, limits, missing;
+    HELIOS_VERIFY(GeTomlCursorFind(root, "name", &name) && HeliosStringViewEqualCStr(GeTomlCursorString(name), "astron"));
+    // Strings are NUL terminated in the tape.
+    HELIOS_VERIFY(strcmp((const char *)GeTomlCursorString(name).data, "astron") == 0);
+    HELIOS_VERIFY(GeTomlCursorFind(root, "enabled", &enabled) && GeTomlCursorBool(enabled));
+    HELIOS_VERIFY(!GeTomlCursorFind(root, "port", &missing));
+
+    HELIOS_VERIFY(GeTomlCursorFind(root, "server", &server) && GeTomlCursorCount(server) == 2);
+    HELIOS_VERIFY(GeTomlCursorFind(server, "http", &http) && GeTomlCursorFind(http, "port", &port));
+    HELIOS_VERIFY(GeTomlCursorType(port) == GeTomlValueType_Int && GeTomlCursorInt(port) == 8080);
+
+    HELIOS_VERIFY(GeTomlCursorFind(http, "hosts", &hosts) && GeTomlCursorCount(hosts) == 3);
+    const char *expected_hosts[] = {"a", "bc", ""};
+    UZ i = 0;
+    for (GeTomlCursor host = GeTomlCursorFirst(hosts); !GeTomlCursorAtEnd(host); host = GeTomlCursorNext(host), ++i) {
+        HELIOS_VERIFY(HeliosStringViewEqualCStr(GeTomlCursorString(host), expected_hosts[i]));
+    }
+    HELIOS_VERIFY(i == 3);
+
+    HELIOS_VERIFY(GeTomlCursorFind(server, "limits", &limits) && GeTomlCursorCount(limits) == 3);
+    GeTomlCursor sizes, empty;
+    HELIOS_VERIFY(GeTomlCursorFind(limits, "sizes", &sizes) && _GeTomlCursorCountSlow(sizes) == 3);
+    HELIOS_VERIFY(GeTomlCursorFind(limits, "empty", &empty) && GeTomlCursorCount(empty) == 0);
+    HELIOS_VERIFY(GeTomlCursorAtEnd(GeTomlCursorFirst(empty)));
+
+    // Every entry is reached once, values that take two entries count once.
+    UZ visited = 0;
+    HELIOS_VERIFY(SumTapeInts(root, &visited) == 8080 + 1 + 2 + 3 + 4 + 5);
+    HELIOS_VERIFY(visited == 23);
+
+    GeTomlTapeFree(&tape);
+
+    HELIOS_VERIFY(!GeTomlTapeParseBuffer(&tape, allocator, "key = ", 6, err_buf, sizeof(err_buf)));
+    HELIOS_VERIFY(strstr(err_buf, "unexpected EOF") != NULL);
+
+    // Every empty array costs the parser far more than its three bytes of source.
+    UZ array_count = 100000;
+    UZ source_size = 5 + array_count * 3 + 1;
+    char *source = (char *)HeliosAllocUninit(allocator, source_size);
+    memcpy(source, "a = [", 5);
+    for (UZ j = 0; j < array_count; ++j) memcpy(source + 5 + j * 3, "[],", 3);
+    memcpy(source + source_size - 2, "]\n", 2);
+    HELIOS_VERIFY(GeTomlTapeParseBuffer(&tape, allocator, source, source_size, err_buf, sizeof(err_buf)));
+
+    GeTomlCursor arrays;
+    HELIOS_VERIFY(GeTomlCursorFind(GeTomlTapeRoot(&tape), "a", &arrays) && GeTomlCursorCount(arrays) == array_count);
+    HELIOS_VERIFY(tape.entry_count == 1 + 1 + 1 + array_count * 2 + 1 + 1);
+
+    GeTomlTapeFree(&tape);
+    HeliosFree(allocator, source, source_size);
+}
+
+void TapeFromTable(void) {
+    // The linked tables are never freed one by one, they all go away with the arena.
+    HeliosArena arena;
+    HeliosArenaInit(&arena, HELIOS_PAGE_SIZE * 16);
+    HeliosAllocator table_allocator = HeliosNewArenaAllocator(&arena);
+    HeliosAllocator allocator = HeliosNewMallocAllocator();
+    const char *buf = "two = 0b11\neight = 0o777\n[nested]\nvalues = [1, 2, 3]\n";
+    char err_buf[512];
+    GeTomlTable *table = GeTomlParseBuffer(table_allocator, buf, strlen(buf), err_buf, sizeof(err_buf));
+    HELIOS_VERIFY(table != NULL);
+
+    GeTomlTape tape;
+    GeTomlTapeFromTable(&tape, allocator, table);
+
+    // The keys come in the order of the linked tables, minus the empty node fresh tables start with.
+    GeTomlCursor key = GeTomlCursorFirst(GeTomlTapeRoot(&tape));
+    for (GeTomlTable *node = table; node != NULL; node = node->next) {
+        if (node->key.data == NULL) continue;
+        HELIOS_VERIFY(!GeTomlCursorAtEnd(key));
+        HELIOS_VERIFY(HeliosStringViewEqual(GeTomlCursorKey(key), node->key));
+        HELIOS_VERIFY(GeTomlCursorType(GeTomlCursorValue(key)) == node->value.type);
+        key = GeTomlCursorNext(key);
+    }
+    HELIOS_VERIFY(GeTomlCursorAtEnd(key));
+
+    GeTomlTapeFree(&tape);
+    HeliosArenaRelease(&arena);
+}
+
 int main(void) {
     EofError();
     TokenMismatchError();
     Basic();
     Nested();
     Integers();
+    ParseFileBorrowsStrings();
+    ParseWithInternedKeys();
+    Tape();
+    TapeFromTable();
     return 0;
 }
@@ -1,4 +1,6 @@
 #define ASTRON_HELIOS_IMPLEMENTATION
+#define HELIOS_TRACK_CALLSITES
+#define HELIOS_PROFILE
 #include "../helios.h"
 
 void ReadFileSuccess(void) {
@@ -9,6 +11,89 @@ void ReadFileSuccess(void) {
     HELIOS_VERIFY(HeliosStringViewStartsWith(file_contents, "#define ASTRON_HELIOS_IMPLEMENTATION"));
 }
 
+void ReadFileClosesDescriptor(void) {
+#ifndef HELIOS_PLATFORM_WINDOWS
+    HeliosAllocator allocator = HeliosNewMallocAllocator();
+
+    int fd_before = dup(0);
+    close(fd_before);
+
+    HeliosStringView file_contents = HeliosReadEntireFile(allocator, HELIOS_SV_LIT(__FILE__));
+    HELIOS_VERIFY(file_contents.data != NULL);
+
+    int fd_after = dup(0);
+    close(fd_after);
+    HELIOS_VERIFY(fd_before == fd_after);
+#endif
+}
+
+void MapFileMatchesRead(void) {
+    HeliosAllocator allocator = HeliosNewMallocAllocator();
+    HeliosStringView read_contents = HeliosReadEntireFile(allocator, HELIOS_SV_LIT(__FILE__));
+
+    HeliosMappedFile file;
+    HELIOS_VERIFY(HeliosMapFile(HELIOS_SV_LIT(__FILE__), &file));
+    HELIOS_VERIFY(HeliosStringViewEqual(file.contents, read_contents));
+    HeliosUnmapFile(&file);
+
+    HELIOS_VERIFY(!HeliosMapFile(HELIOS_SV_LIT("this/file/does/not/exist"), &file));
+}
+
+// Where tests write their fixtures, the source tree may well be read-only.
+static const char *TempDir(void) {
+    const char *names[] = {"TMPDIR", "TEMP", "TMP"};
+    for (UZ i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+        const char *dir = getenv(names[i]);
+        if (dir != NULL && dir[0] != '\0') return dir;
+    }
+#ifdef HELIOS_PLATFORM_WINDOWS
+    return ".";
+#else
+    return "/tmp";
+#endif
+}
+
+void ReadFilesBatchMatchesRead(void) {
+    HeliosAllocator allocator = HeliosNewMallocAllocator();
+    HeliosStringView expected = HeliosReadEntireFile(allocator, HELIOS_SV_LIT(__FILE__));
+
+    HeliosStringView paths[20];
+    for (UZ i = 0; i < 20; ++i) paths[i] = HELIOS_SV_LIT(__FILE__);
+    paths[7] = HELIOS_SV_LIT("this/file/does/not/exist");
+
+    HeliosStringView contents[20];
+    HELIOS_VERIFY(!HeliosReadFilesBatch(allocator, paths, 20, contents));
+
+    for (UZ i = 0; i < 20; ++i) {
+        if (i == 7) {
+            HELIOS_VERIFY(contents[i].data == NULL);
+            continue;
+        }
+
+        HELIOS_VERIFY(HeliosStringViewEqual(contents[i], expected));
+        HELIOS_VERIFY(contents[i].data[contents[i].count] == '\0');
+        HeliosFree(allocator, (void *)contents[i].data, contents[i].count + 1);
+    }
+
+    HELIOS_VERIFY(HeliosReadFilesBatch(allocator, paths, 5, contents));
+    for (UZ i = 0; i < 5; ++i) HeliosFree(allocator, (void *)contents[i].data, contents[i].count + 1);
+
+    // Empty files still get a buffer, holding just the terminator.
+    char empty_path[512];
+    snprintf(empty_path, sizeof(empty_path), "%s/helios_read_files_batch_empty", TempDir());
+    FILE *empty = fopen(empty_path, "wb");
+    HELIOS_VERIFY(empty != NULL);
+    fclose(empty);
+
+    paths[1] = HELIOS_SV_LIT(empty_path);
+    HELIOS_VERIFY(HeliosReadFilesBatch(allocator, paths, 3, contents));
+    HELIOS_VERIFY(contents[1].data != NULL && contents[1].count == 0 && contents[1].data[0] == '\0');
+    HELIOS_VERIFY(HeliosStringViewEqual(contents[0], expected) && HeliosStringViewEqual(contents[2], expected));
+    for (UZ i = 0; i < 3; ++i) HeliosFree(allocator, (void *)contents[i].data, contents[i].count + 1);
+    HeliosFree(allocator, (void *)expected.data, expected.count);
+    remove(empty_path);
+}
+
 void FormatAppendCorrect(void) {
     HeliosAllocator alloc = HeliosNewMallocAllocator();
     HeliosString8 s = {.allocator = alloc};
@@ -17,9 +102,823 @@ void FormatAppendCorrect(void) {
     HELIOS_VERIFY(strcmp((char *)s.data, "hello 1") == 0);
     HeliosString8FormatAppend(&s, " world %s", "yes");
     HELIOS_VERIFY(strcmp((char *)s.data, "hello 1 world yes") == 0);
+    HeliosFree(alloc, s.data, s.capacity);
+}
+
+void String8CapacityCountsTerminator(void) {
+    HeliosTrackingAllocator tracker;
+    HeliosTrackingAllocatorInit(&tracker, HeliosNewMallocAllocator());
+    HeliosAllocator alloc = HeliosNewTrackingAllocator(&tracker);
+
+    HeliosString8 a = HeliosString8FromSV(alloc, HELIOS_SV_LIT("abc"));
+    HeliosString8 b = HeliosString8FromStringView(alloc, HELIOS_SV_LIT("defg"));
+    HELIOS_VERIFY(tracker.live_bytes == a.capacity + b.capacity);
+
+    HeliosString8FormatAppend(&a, "%s", "-a longer tail-");
+    HeliosString8FormatAppend(&b, "%d", 5);
+    HELIOS_VERIFY(strcmp((char *)a.data, "abc-a longer tail-") == 0);
+    HELIOS_VERIFY(strcmp((char *)b.data, "defg5") == 0);
+    HELIOS_VERIFY(tracker.live_bytes == a.capacity + b.capacity);
+
+    HeliosFree(alloc, a.data, a.capacity);
+    HeliosFree(alloc, b.data, b.capacity);
+    HELIOS_VERIFY(tracker.live_bytes == 0);
+}
+
+void StringBuilderMatchesFormatAppend(void) {
+    HeliosAllocator alloc = HeliosNewMallocAllocator();
+    HeliosString8 expected = {.allocator = alloc};
+
+    // Tiny chunks, so that most appends straddle a chunk boundary.
+    HeliosStringBuilder sb;
+    HeliosStringBuilderInit(&sb, alloc, 16);
+
+    for (U32 round = 0; round < 2; ++round) {
+        expected.count = 0;
+        HeliosStringBuilderReset(&sb);
+
+        U64 u64s[] = {0, 9, 10, 99, 100, 12345678901ull, UINT64_MAX};
+        for (UZ i = 0; i < sizeof(u64s) / sizeof(u64s[0]); ++i) {
+            HeliosStringBuilderAppendU64(&sb, u64s[i]);
+            HeliosStringBuilderAppendByte(&sb, ',');
+            HeliosString8FormatAppend(&expected, "%llu,", (unsigned long long)u64s[i]);
+        }
+
+        S64 s64s[] = {0, -1, 42, -1000, INT64_MAX, INT64_MIN};
+        for (UZ i = 0; i < sizeof(s64s) / sizeof(s64s[0]); ++i) {
+            HeliosStringBuilderAppendS64(&sb, s64s[i]);
+            HeliosStringBuilderAppendCStr(&sb, "; ");
+            HeliosString8FormatAppend(&expected, "%lld; ", (long long)s64s[i]);
+        }
+
+        // Exact ties, and values whose scaled double lands on or right next to a tie.
+        F64 f64s[] = {0.0, -0.0, 1.0, -2.75, 3.14159265358979, 1234.5678, 0.0001, 1e300, 1e-300, 123456789.987654321,
+                      0.125, 2.5, -0.375, 0.995, 2.9249999999999998, 512.535, -1.005, 1.0000000000000002};
+        U32 precisions[] = {0, 1, 2, 3, 6, 9, 15, 20};
+        for (UZ i = 0; i < sizeof(f64s) / sizeof(f64s[0]); ++i) {
+            for (UZ j = 0; j < sizeof(precisions) / sizeof(precisions[0]); ++j) {
+                HeliosStringBuilderAppendF64(&sb, f64s[i], precisions[j]);
+                HeliosStringBuilderAppendByte(&sb, ' ');
+                HeliosString8FormatAppend(&expected, "%.*f ", (int)precisions[j], f64s[i]);
+            }
+        }
+
+        HeliosStringBuilderFormat(&sb, "[%s|%d]", "a string longer than a single chunk", 7);
+        HeliosString8FormatAppend(&expected, "[%s|%d]", "a string longer than a single chunk", 7);
+        HeliosStringBuilderAppendSV(&sb, HELIOS_SV_LIT("end"));
+        HeliosString8FormatAppend(&expected, "end");
+
+        HeliosString8 result = HeliosStringBuilderFinalize(&sb, alloc);
+        HELIOS_VERIFY(result.count == sb.count && result.count == expected.count && result.capacity == result.count + 1);
+        HELIOS_VERIFY(strcmp((char *)result.data, (char *)expected.data) == 0);
+        HeliosFree(alloc, result.data, result.capacity);
+    }
+
+    FILE *file = tmpfile();
+    HELIOS_VERIFY(file != NULL);
+    HELIOS_VERIFY(HeliosStringBuilderWriteTo(&sb, fileno(file)));
+
+    char buf[16384];
+    rewind(file);
+    UZ n = fread(buf, 1, sizeof(buf), file);
+    HELIOS_VERIFY(n == expected.count && memcmp(buf, expected.data, n) == 0);
+    fclose(file);
+
+    HeliosStringBuilderDestroy(&sb);
+}
+
+void AllocZeroedAfterReuse(void) {
+    HeliosDynamicCircleBufferAllocator impl;
+    HeliosAllocator alloc = HeliosNewDynamicCircleBufferAllocator(&impl, HELIOS_PAGE_SIZE);
+
+    U8 *dirty = (U8 *)HeliosAllocUninit(alloc, HELIOS_PAGE_SIZE - 64);
+    memset(dirty, 0xAB, HELIOS_PAGE_SIZE - 64);
+
+    // Wraps around into the memory we have just dirtied, and partially past it.
+    U8 *zeroed = (U8 *)HeliosAllocZeroed(alloc, HELIOS_PAGE_SIZE - 32);
+    HELIOS_VERIFY(zeroed == dirty);
+    for (UZ i = 0; i < HELIOS_PAGE_SIZE - 32; ++i) {
+        HELIOS_VERIFY(zeroed[i] == 0);
+    }
+}
+
+void CloneToCStrTerminates(void) {
+    HeliosAllocator alloc = HeliosNewMallocAllocator();
+    U8 junk[] = "hello world";
+    HeliosStringView sv = { .data = junk, .count = 5 };
+
+    char *cstr = HeliosStringViewCloneToCStr(alloc, sv);
+    HELIOS_VERIFY(strcmp(cstr, "hello") == 0);
+    HeliosFree(alloc, cstr, sv.count + 1);
+}
+
+typedef struct PoolNode {
+    struct PoolNode *next;
+    U64 payload[5];
+} PoolNode;
+
+void PoolAllocatorReusesAndReleasesSlabs(void) {
+    HeliosPoolAllocator pool;
+    HeliosPoolAllocatorInit(&pool, sizeof(PoolNode), 0);
+
+    UZ nodes_count = pool.objects_per_slab * 3 + 1;
+    PoolNode *head = NULL;
+    for (UZ i = 0; i < nodes_count; ++i) {
+        PoolNode *node = (PoolNode *)HeliosPoolAlloc(&pool);
+        HELIOS_VERIFY(((UZ)node & (sizeof(void *) - 1)) == 0);
+        node->next = head;
+        node->payload[0] = i;
+        head = node;
+    }
+
+    HELIOS_VERIFY(pool.slab_count == 4);
+
+    UZ expected = nodes_count;
+    while (head != NULL) {
+        PoolNode *next = head->next;
+        HELIOS_VERIFY(head->payload[0] == --expected);
+        HeliosPoolFree(&pool, head);
+        head = next;
+    }
+
+    // All but one of the emptied slabs go back to the system.
+    HELIOS_VERIFY(pool.slab_count == 1);
+    HELIOS_VERIFY(pool.empty != NULL);
+
+    void *reused = HeliosPoolAlloc(&pool);
+    HELIOS_VERIFY(HeliosRoundDown((UZ)reused, pool.slab_size) == (UZ)pool.partial);
+    HELIOS_VERIFY(pool.slab_count == 1);
+
+    HeliosPoolAllocatorDestroy(&pool);
+}
+
+void PoolCacheThroughVTable(void) {
+    HeliosPoolAllocator pool;
+    HeliosPoolAllocatorInit(&pool, sizeof(PoolNode), 0);
+
+    HeliosPoolCache cache;
+    HeliosPoolCacheInit(&cache, &pool);
+    HeliosAllocator alloc = HeliosNewPoolCacheAllocator(&cache);
+
+    PoolNode *nodes[HELIOS_POOL_CACHE_BATCH * 3];
+    for (UZ i = 0; i < HELIOS_POOL_CACHE_BATCH * 3; ++i) {
+        nodes[i] = (PoolNode *)HeliosAllocZeroed(alloc, sizeof(PoolNode));
+        HELIOS_VERIFY(nodes[i]->next == NULL && nodes[i]->payload[4] == 0);
+        nodes[i]->payload[4] = i;
+    }
+
+    for (UZ i = 0; i < HELIOS_POOL_CACHE_BATCH * 3; ++i) {
+        HELIOS_VERIFY(nodes[i]->payload[4] == i);
+        HeliosFree(alloc, nodes[i], sizeof(PoolNode));
+    }
+
+    HELIOS_VERIFY(cache.count < HELIOS_POOL_CACHE_BATCH * 2);
+    HeliosPoolCacheFlush(&cache);
+    HELIOS_VERIFY(cache.count == 0);
+    HELIOS_VERIFY(pool.partial == NULL && pool.full == NULL);
+
+    HeliosPoolAllocatorDestroy(&pool);
+}
+
+void VirtualArenaCommitsAndDecommits(void) {
+    HeliosVirtualArena arena;
+    HELIOS_VERIFY(HeliosVirtualArenaInit(&arena, (UZ)1 << 30, 0));
+    HELIOS_VERIFY(arena.committed == 0);
+
+    U8 *first = (U8 *)HeliosVirtualArenaAlloc(&arena, 100);
+    HELIOS_VERIFY(arena.committed == HELIOS_VIRTUAL_ARENA_COMMIT_STEP);
+
+    UZ big_size = HELIOS_VIRTUAL_ARENA_COMMIT_STEP * 10;
+    U8 *big = (U8 *)HeliosVirtualArenaAlloc(&arena, big_size);
+    memset(big, 0xCD, big_size);
+    HELIOS_VERIFY(arena.committed >= HeliosVirtualArenaPos(&arena));
+
+    HeliosVirtualArenaPopTo(&arena, 100);
+    HeliosVirtualArenaDecommit(&arena, 0);
+    HELIOS_VERIFY(arena.committed == HELIOS_VIRTUAL_ARENA_COMMIT_STEP);
+
+    // Everything past the first commit step has been given back, and comes back zeroed.
+    U8 *again = (U8 *)HeliosVirtualArenaAllocZeroed(&arena, big_size);
+    HELIOS_VERIFY(again == big);
+    for (UZ i = 0; i < big_size; ++i) {
+        HELIOS_VERIFY(again[i] == 0);
+    }
+
+    HELIOS_VERIFY(first == arena.base);
+    HeliosVirtualArenaRelease(&arena);
+}
+
+void VirtualArenaHugePages(void) {
+    HeliosVirtualArena arena;
+    HELIOS_VERIFY(HeliosVirtualArenaInit(&arena, HELIOS_HUGE_PAGE_SIZE * 8, HeliosVirtualArenaFlag_HugePages));
+    HELIOS_VERIFY(((UZ)arena.base & (HELIOS_HUGE_PAGE_SIZE - 1)) == 0);
+
+    HeliosAllocator alloc = HeliosNewVirtualArenaAllocator(&arena);
+    U64 *values = (U64 *)HeliosAllocUninit(alloc, sizeof(U64) * 1024);
+    for (U64 i = 0; i < 1024; ++i) values[i] = i;
+    values = (U64 *)HeliosRealloc(alloc, values, sizeof(U64) * 1024, sizeof(U64) * 2048);
+    HELIOS_VERIFY(values[1023] == 1023);
+    HELIOS_VERIFY(arena.committed == HELIOS_HUGE_PAGE_SIZE);
+
+    HeliosVirtualArenaRelease(&arena);
+}
+
+void TrackingAllocatorStatistics(void) {
+    HeliosTrackingAllocator tracker;
+    HeliosTrackingAllocatorInit(&tracker, HeliosNewMallocAllocator());
+    HeliosAllocator alloc = HeliosNewTrackingAllocator(&tracker);
+
+    void *small[10];
+    for (UZ i = 0; i < 10; ++i) small[i] = HeliosAllocUninit(alloc, 24);
+    U32 big_line = __LINE__ + 1;
+    void *big = HeliosAllocZeroed(alloc, 4000);
+    big = HeliosRealloc(alloc, big, 4000, 5000);
+
+    HELIOS_VERIFY(tracker.alloc_count == 11);
+    HELIOS_VERIFY(tracker.realloc_count == 1);
+    HELIOS_VERIFY(tracker.live_bytes == 10 * 24 + 5000);
+    HELIOS_VERIFY(tracker.peak_bytes == tracker.live_bytes);
+    HELIOS_VERIFY(tracker.histogram[5] == 10);
+    HELIOS_VERIFY(tracker.callsites_count == 3);
+
+    B32 found_big = 0;
+    for (UZ i = 0; i < HELIOS_TRACKING_MAX_CALLSITES; ++i) {
+        HeliosTrackingCallsite *entry = &tracker.callsites[i];
+        if (entry->count == 0 || entry->callsite.line != big_line) continue;
+
+        HELIOS_VERIFY(strcmp(entry->callsite.file, __FILE__) == 0);
+        HELIOS_VERIFY(entry->bytes == 4000);
+        found_big = 1;
+    }
+    HELIOS_VERIFY(found_big);
+
+    for (UZ i = 0; i < 10; ++i) HeliosFree(alloc, small[i], 24);
+    HeliosFree(alloc, big, 5000);
+
+    HELIOS_VERIFY(tracker.live_bytes == 0);
+    HELIOS_VERIFY(tracker.free_count == 11);
+    HELIOS_VERIFY(tracker.peak_bytes == 10 * 24 + 5000);
+
+    // The same file seen from two translation units, through two different `__FILE__` literals.
+    char file_copy[] = __FILE__;
+    _HeliosSetCallsite(__FILE__, 1);
+    void *first = (HeliosAllocUninit)(alloc, 8);
+    _HeliosSetCallsite(file_copy, 1);
+    void *second = (HeliosAllocUninit)(alloc, 8);
+    HELIOS_VERIFY(tracker.callsites_count == 4);
+
+    B32 found_merged = 0;
+    for (UZ i = 0; i < HELIOS_TRACKING_MAX_CALLSITES; ++i) {
+        HeliosTrackingCallsite *entry = &tracker.callsites[i];
+        if (entry->count == 0 || entry->callsite.line != 1) continue;
+
+        HELIOS_VERIFY(entry->count == 2 && entry->bytes == 16);
+        found_merged = 1;
+    }
+    HELIOS_VERIFY(found_merged);
+
+    HeliosFree(alloc, first, 8);
+    HeliosFree(alloc, second, 8);
+}
+
+void KernelsAgreeAcrossFeatureSets(void) {
+    U32 detected = HeliosGetCpuFeatures()->flags;
+    U32 feature_sets[] = {0, HeliosCpuFeature_SSE2, detected};
+
+    U8 buffer[300];
+    for (UZ i = 0; i < sizeof(buffer); ++i) buffer[i] = (U8)('a' + i % 26);
+
+    // "zażółć gęślą jaźń" has 17 code points in 26 bytes.
+    const char *polish = "za\xc5\xbc\xc3\xb3\xc5\x82\xc4\x87 g\xc4\x99\xc5\x9bl\xc4\x85 ja\xc5\xba\xc5\x84";
+
+    for (UZ set = 0; set < sizeof(feature_sets) / sizeof(feature_sets[0]); ++set) {
+        HeliosKernelsInit(feature_sets[set]);
+
+        for (UZ count = 0; count < 200; count += 7) {
+            for (UZ at = 0; at < count; at += 5) {
+                buffer[at] = '#';
+                HELIOS_VERIFY(HeliosFindByte(buffer, count, '#') == at);
+                buffer[at] = (U8)('a' + at % 26);
+            }
+            HELIOS_VERIFY(HeliosFindByte(buffer, count, '#') == count);
+        }
+
+        HELIOS_VERIFY(HeliosUtf8Count((const U8 *)polish, strlen(polish)) == 17);
+        HELIOS_VERIFY(HeliosUtf8Count(buffer, sizeof(buffer)) == sizeof(buffer));
+
+        HELIOS_VERIFY(HeliosCrc32c(0, "123456789", 9) == 0xE3069283);
+        HELIOS_VERIFY(HeliosCrc32c(HeliosCrc32c(0, "1234", 4), "56789", 5) == 0xE3069283);
+    }
+
+    HeliosKernelsInit(detected);
+}
+
+static void KernelsCheckLoop(void *arg) {
+    HeliosAtomicU32 *stop = (HeliosAtomicU32 *)arg;
+    while (!HeliosAtomicLoadU32(stop, HeliosMemoryOrder_Acquire)) {
+        HELIOS_VERIFY(HeliosCrc32c(0, "123456789", 9) == 0xE3069283);
+        HELIOS_VERIFY(HeliosStringViewEqual(HELIOS_SV_LIT("kernels"), HELIOS_SV_LIT("kernels")));
+        HELIOS_VERIFY(HeliosStringViewIndexOf(HELIOS_SV_LIT("switching kernels"), HELIOS_SV_LIT("ker")) == 10);
+    }
+}
+
+void KernelsInitWhileInUse(void) {
+    U32 detected = HeliosGetCpuFeatures()->flags;
+    HeliosAtomicU32 stop = {0};
+
+    HeliosThread threads[3];
+    for (UZ i = 0; i < 3; ++i) HELIOS_VERIFY(HeliosThreadStart(&threads[i], KernelsCheckLoop, &stop));
+
+    for (UZ i = 0; i < 2000; ++i) {
+        HeliosKernelsInit(i % 2 == 0 ? 0 : detected);
+        HeliosThreadYield();
+    }
+
+    HeliosAtomicStoreU32(&stop, 1, HeliosMemoryOrder_Release);
+    for (UZ i = 0; i < 3; ++i) HeliosThreadJoin(&threads[i]);
+    HeliosKernelsInit(detected);
+}
+
+static SZ NaiveIndexOf(HeliosStringView sv, HeliosStringView needle) {
+    for (UZ i = 0; i + needle.count <= sv.count; ++i) {
+        if (memcmp(sv.data + i, needle.data, needle.count) == 0) return (SZ)i;
+    }
+    return -1;
+}
+
+void StringViewPrimitivesAcrossFeatureSets(void) {
+    U32 detected = HeliosGetCpuFeatures()->flags;
+    U32 feature_sets[] = {0, HeliosCpuFeature_SSE2, detected};
+
+    U8 text[200];
+    U8 upper[200];
+    U32 state = 12345;
+    for (UZ i = 0; i < sizeof(text); ++i) {
+        state = state * 1103515245 + 12345;
+        text[i] = (U8)('a' + (state >> 16) % 4);
+        upper[i] = (U8)(text[i] - 'a' + 'A');
+    }
+
+    for (UZ set = 0; set < sizeof(feature_sets) / sizeof(feature_sets[0]); ++set) {
+        HeliosKernelsInit(feature_sets[set]);
+
+        for (UZ count = 0; count <= sizeof(text); count += 13) {
+            HeliosStringView sv = {.data = text, .count = count};
+            HeliosStringView upper_sv = {.data = upper, .count = count};
+
+            HELIOS_VERIFY(HeliosStringViewEqual(sv, HeliosStringViewSlice(sv, 0, count)));
+            HELIOS_VERIFY(HeliosStringViewEqualIgnoreCase(sv, upper_sv));
+            HELIOS_VERIFY(count == 0 || !HeliosStringViewEqual(sv, upper_sv));
+
+            if (count > 0) {
+                U8 saved = upper[count - 1];
+                upper[count - 1] = '@';
+                HELIOS_VERIFY(!HeliosStringViewEqualIgnoreCase(sv, upper_sv));
+                upper[count - 1] = saved;
+            }
+
+            for (UZ len = 0; len <= 9 && len <= count; len += 3) {
+                HeliosStringView needle = HeliosStringViewSlice(sv, count - len, count);
+                HELIOS_VERIFY(HeliosStringViewIndexOf(sv, needle) == NaiveIndexOf(sv, needle));
+                HELIOS_VERIFY(HeliosStringViewEndsWithSV(sv, needle));
+                HELIOS_VERIFY(HeliosStringViewStartsWithSV(sv, HeliosStringViewSlice(sv, 0, len)));
+            }
+
+            HELIOS_VERIFY(HeliosStringViewIndexOf(sv, HELIOS_SV_LIT("abcd")) == NaiveIndexOf(sv, HELIOS_SV_LIT("abcd")));
+            HELIOS_VERIFY(HeliosStringViewIndexOf(sv, HELIOS_SV_LIT("dd")) == NaiveIndexOf(sv, HELIOS_SV_LIT("dd")));
+            HELIOS_VERIFY(HeliosStringViewIndexOf(sv, HELIOS_SV_LIT("x")) == -1);
+
+            SZ first_c = HeliosStringViewIndexOfByte(sv, 'c');
+            SZ first_d = HeliosStringViewIndexOfByte(sv, 'd');
+            SZ expected_any = first_c == -1 ? first_d : first_d == -1 ? first_c : HELIOS_MIN(first_c, first_d);
+            HELIOS_VERIFY(HeliosStringViewIndexOfAny(sv, HELIOS_SV_LIT("xdyc")) == expected_any);
+            HELIOS_VERIFY(HeliosStringViewIndexOfAny(sv, HELIOS_SV_LIT("0123456789ABCDEFGHIJdc")) == expected_any);
+        }
+    }
+
+    HeliosKernelsInit(detected);
+
+    HELIOS_VERIFY(HeliosStringViewStartsWith(HELIOS_SV_LIT("0x1F"), "0x"));
+    HELIOS_VERIFY(!HeliosStringViewStartsWith(HELIOS_SV_LIT("0"), "0x"));
+    HELIOS_VERIFY(HeliosStringViewEndsWith(HELIOS_SV_LIT("config.toml"), ".toml"));
+    HELIOS_VERIFY(HeliosStringViewHash(HELIOS_SV_LIT("key")) == HeliosHashBytes("key", 3));
+    HELIOS_VERIFY(HeliosStringViewHash(HELIOS_SV_LIT("key")) != HeliosStringViewHash(HELIOS_SV_LIT("kez")));
+
+    const char *expected[] = {"a", "", "bc", ""};
+    HeliosStringSplit split = HeliosStringSplitInit(HELIOS_SV_LIT("a,,bc,"), ',');
+    HeliosStringView piece;
+    UZ pieces = 0;
+    while (HeliosStringSplitNext(&split, &piece)) {
+        HELIOS_VERIFY(pieces < 4 && HeliosStringViewEqualCStr(piece, expected[pieces]));
+        ++pieces;
+    }
+    HELIOS_VERIFY(pieces == 4);
+}
+
+#define PROFILE_THREADS 3
+#define PROFILE_ITERATIONS 100
+
+void ProfileWorker(void *arg) {
+    HELIOS_UNUSED(arg);
+    for (UZ i = 0; i < PROFILE_ITERATIONS; ++i) {
+        HELIOS_PROFILE_SCOPE("outer");
+        HELIOS_PROFILE_BEGIN("inner \"quoted\"");
+        HELIOS_PROFILE_END("inner \"quoted\"");
+    }
+}
+
+UZ CountOccurrences(HeliosStringView haystack, const char *needle) {
+    UZ count = 0;
+    HeliosStringView n = {.data = (const U8 *)needle, .count = strlen(needle)};
+    for (SZ at; (at = HeliosStringViewIndexOf(haystack, n)) != -1;) {
+        ++count;
+        haystack = HeliosStringViewSlice(haystack, (UZ)at + n.count, haystack.count);
+    }
+    return count;
+}
+
+void ProfileFlushesChromeTrace(void) {
+    HeliosThread threads[PROFILE_THREADS];
+    for (UZ i = 0; i < PROFILE_THREADS; ++i) HELIOS_VERIFY(HeliosThreadStart(&threads[i], ProfileWorker, NULL));
+    for (UZ i = 0; i < PROFILE_THREADS; ++i) HeliosThreadJoin(&threads[i]);
+
+    HeliosAllocator alloc = HeliosNewMallocAllocator();
+    HeliosStringBuilder sb;
+    HeliosStringBuilderInit(&sb, alloc, 0);
+    HeliosProfileFlush(&sb);
+    HeliosString8 trace = HeliosStringBuilderFinalize(&sb, alloc);
+    HeliosStringView view = HeliosString8View(trace);
+
+    UZ events = PROFILE_THREADS * PROFILE_ITERATIONS * 2;
+    HELIOS_VERIFY(HeliosStringViewStartsWith(view, "{\"traceEvents\":["));
+    HELIOS_VERIFY(CountOccurrences(view, "\"ph\":\"B\"") == events);
+    HELIOS_VERIFY(CountOccurrences(view, "\"ph\":\"E\"") == events);
+    HELIOS_VERIFY(CountOccurrences(view, "\"name\":\"outer\"") == events);
+    HELIOS_VERIFY(CountOccurrences(view, "\"name\":\"inner \\\"quoted\\\"\"") == events);
+    HELIOS_VERIFY(CountOccurrences(view, "\"dropped_events\":\"0\"") == 1);
+
+    // Everything was drained by the first flush.
+    HeliosStringBuilderReset(&sb);
+    HeliosProfileFlush(&sb);
+    HeliosString8 empty = HeliosStringBuilderFinalize(&sb, alloc);
+    HELIOS_VERIFY(CountOccurrences(HeliosString8View(empty), "\"ph\"") == 0);
+
+    HeliosStringBuilderDestroy(&sb);
+}
+
+#define LOG_BURST 20000
+
+void LogWorker(void *arg) {
+    HELIOS_UNUSED(arg);
+    for (U32 i = 0; i < LOG_BURST; ++i) HELIOS_LOG_DEBUG("burst %u", i);
+}
+
+void LogFormatsDeferred(void) {
+    FILE *file = tmpfile();
+    HELIOS_VERIFY(file != NULL);
+    HELIOS_VERIFY(HeliosLogInit(fileno(file)));
+
+    HeliosThread worker;
+    HELIOS_VERIFY(HeliosThreadStart(&worker, LogWorker, NULL));
+
+    char expected[4096];
+    int n = 0;
+    // The string is a stack buffer that gets overwritten right away, so it has to be captured by value.
+    char name[16] = "first";
+    HELIOS_LOG_INFO("hello %s, %d%% done", name, 42);
+    n += snprintf(expected + n, sizeof(expected) - n, "%s:%d: INFO: hello %s, %d%% done\n", __FILE__, __LINE__ - 1, name, 42);
+    strcpy(name, "second");
+
+    HELIOS_LOG_WARN("%5.2f|%-6s|%*d|%.*s|%c|%hhd|%hu|%lld|%zu|%#x|%e", 3.14159, "ab", 4, 7, 2, "xyz", 'q',
+                    (signed char)-3, (unsigned short)65535, (long long)INT64_MIN, (UZ)123, 255u, 1e-10);
+    n += snprintf(expected + n, sizeof(expected) - n, "%s:%d: WARN: %5.2f|%-6s|%*d|%.*s|%c|%hhd|%hu|%lld|%zu|%#x|%e\n",
+                  __FILE__, __LINE__ - 3, 3.14159, "ab", 4, 7, 2, "xyz", 'q',
+                  (signed char)-3, (unsigned short)65535, (long long)INT64_MIN, (UZ)123, 255u, 1e-10);
+
+    HELIOS_LOG_ERROR("%*s|%.*f|%s", -4, "l", -1, 0.5, "end");
+    n += snprintf(expected + n, sizeof(expected) - n, "%s:%d: ERROR: %-4s|%f|end\n", __FILE__, __LINE__ - 1, "l", 0.5);
+
+    HeliosThreadJoin(&worker);
+    HeliosLogShutdown();
+
+    HeliosAllocator alloc = HeliosNewMallocAllocator();
+    fflush(file);
+    rewind(file);
+    HeliosString8 contents = {.allocator = alloc};
+    char buf[4096];
+    for (UZ read; (read = fread(buf, 1, sizeof(buf), file)) != 0;) HeliosString8FormatAppend(&contents, "%.*s", (int)read, buf);
+    fclose(file);
+
+    // The main thread's messages come out in order, interleaved with the burst.
+    HeliosStringSplit lines = HeliosStringSplitInit(HeliosString8View(contents), '\n');
+    HeliosStringSplit expected_lines = HeliosStringSplitInit((HeliosStringView) {.data = (const U8 *)expected, .count = (UZ)n}, '\n');
+    UZ burst_lines = 0;
+    U64 dropped = 0;
+    for (HeliosStringView line; HeliosStringSplitNext(&lines, &line);) {
+        if (line.count == 0) continue;
+        if (HeliosStringViewContains(line, HELIOS_SV_LIT(": DEBUG: burst "))) {
+            ++burst_lines;
+            continue;
+        }
+
+        HeliosStringView dropped_prefix = HELIOS_SV_LIT("helios: dropped ");
+        if (HeliosStringViewStartsWithSV(line, dropped_prefix)) {
+            S64 count;
+            HeliosStringView rest = HeliosStringViewSlice(line, dropped_prefix.count, line.count);
+            rest = HeliosStringViewSlice(rest, 0, (UZ)HeliosStringViewIndexOfByte(rest, ' '));
+            HELIOS_VERIFY(HeliosParseS64(rest, 10, &count));
+            dropped += (U64)count;
+            continue;
+        }
+
+        HeliosStringView expected_line;
+        HELIOS_VERIFY(HeliosStringSplitNext(&expected_lines, &expected_line));
+        HELIOS_VERIFY(HeliosStringViewEqual(line, expected_line));
+    }
+
+    HeliosStringView rest;
+    HELIOS_VERIFY(!HeliosStringSplitNext(&expected_lines, &rest) || rest.count == 0);
+    HELIOS_VERIFY(burst_lines + dropped == LOG_BURST);
+}
+
+void BenchSum(void *arg, U64 iterations) {
+    U64 sum = 0;
+    for (U64 i = 0; i < iterations; ++i) {
+        sum += i * *(U64 *)arg;
+        HeliosBenchDoNotOptimize(&sum);
+    }
+}
+
+void BenchReportsOrderedStats(void) {
+    char *argv[] = {"bench", "--filter=sum", "--samples=7", "--tsv"};
+    HeliosBench bench;
+    HeliosBenchInit(&bench, sizeof(argv) / sizeof(argv[0]), argv);
+    HELIOS_VERIFY(bench.tsv && bench.samples == 7 && strcmp(bench.filter, "sum") == 0);
+
+    bench.warmup_ns = 1000;
+    bench.sample_ns = 100000;
+    bench.out = NULL;
+
+    U64 factor = 3;
+    HELIOS_VERIFY(!HeliosBenchRun(&bench, &(HeliosBenchCase) {.name = "skipped", .func = BenchSum, .arg = &factor}));
+    HELIOS_VERIFY(HeliosBenchRun(&bench, &(HeliosBenchCase) {.name = "bench/sum", .func = BenchSum, .arg = &factor}));
+
+    HeliosBenchResult *result = &bench.last;
+    HELIOS_VERIFY(strcmp(result->name, "bench/sum") == 0);
+    HELIOS_VERIFY(result->samples == 7 && result->iterations > 1);
+    HELIOS_VERIFY(result->min_ns > 0);
+    HELIOS_VERIFY(result->min_ns <= result->median_ns && result->median_ns <= result->p99_ns);
+    HELIOS_VERIFY(result->min_ns <= result->mean_ns && result->mean_ns <= result->p99_ns);
+}
+
+void InternerDeduplicatesAndGrows(void) {
+    HeliosInterner interner;
+    HELIOS_VERIFY(HeliosInternerInit(&interner, HeliosNewMallocAllocator(), 0));
+
+    HeliosInternId ids[1000];
+    const U8 *pointers[1000];
+    char buf[32];
+    for (UZ i = 0; i < 1000; ++i) {
+        snprintf(buf, sizeof(buf), "key_%d", (int)i);
+        ids[i] = HeliosInternerIntern(&interner, HELIOS_SV_LIT(buf));
+        pointers[i] = HeliosInternerString(&interner, ids[i]).data;
+        HELIOS_VERIFY(HeliosInternerIdOf(HeliosInternerString(&interner, ids[i])) == ids[i]);
+    }
+    HELIOS_VERIFY(interner.count == 1000);
+
+    for (UZ i = 0; i < 1000; ++i) {
+        snprintf(buf, sizeof(buf), "key_%d", (int)i);
+        HELIOS_VERIFY(HeliosInternerIntern(&interner, HELIOS_SV_LIT(buf)) == ids[i]);
+        HELIOS_VERIFY(HeliosInternerFind(&interner, HELIOS_SV_LIT(buf)) == ids[i]);
+
+        HeliosStringView interned = HeliosInternerString(&interner, ids[i]);
+        HELIOS_VERIFY(interned.data == pointers[i] && strcmp((const char *)interned.data, buf) == 0);
+    }
+    HELIOS_VERIFY(interner.count == 1000);
+    HELIOS_VERIFY(HeliosInternerFind(&interner, HELIOS_SV_LIT("key_1000")) == HELIOS_INTERN_ID_NONE);
+    HELIOS_VERIFY(HeliosInternerIntern(&interner, HELIOS_SV_LIT("")) != HELIOS_INTERN_ID_NONE);
+
+    HeliosInternerDestroy(&interner);
+}
+
+void StreamSkipToMatchesNext(void) {
+    const char *text = "ab\xc5\xbc\"x\xc4\x99";
+    UZ count = strlen(text);
+
+    HeliosString8Stream skipped, stepped;
+    HeliosString8StreamInit(&skipped, (const U8 *)text, count);
+    HeliosString8StreamInit(&stepped, (const U8 *)text, count);
+
+    HELIOS_VERIFY(HeliosString8StreamSkipTo(&skipped, '"'));
+    HeliosChar c;
+    while (HeliosString8StreamNext(&stepped, &c) && c != '"');
+    HELIOS_VERIFY(skipped.byte_offset == stepped.byte_offset && skipped.char_offset == stepped.char_offset);
+
+    HELIOS_VERIFY(!HeliosString8StreamSkipTo(&skipped, '"'));
+    while (HeliosString8StreamNext(&stepped, &c) && c != '"');
+    HELIOS_VERIFY(skipped.byte_offset == stepped.byte_offset && skipped.char_offset == stepped.char_offset);
+    HELIOS_VERIFY(skipped.last_char_size == stepped.last_char_size);
+}
+
+#define LOCK_THREADS 4
+#define LOCK_ITERATIONS 20000
+
+typedef struct LockCounter {
+    HeliosSpinLock spin_lock;
+    HeliosMutex mutex;
+    U64 spin_count;
+    U64 mutex_count;
+    HeliosAtomicU64 atomic_count;
+} LockCounter;
+
+static void LockCounterWorker(void *arg) {
+    LockCounter *counter = (LockCounter *)arg;
+    for (UZ i = 0; i < LOCK_ITERATIONS; ++i) {
+        HeliosSpinLockAcquire(&counter->spin_lock);
+        ++counter->spin_count;
+        HeliosSpinLockRelease(&counter->spin_lock);
+
+        HeliosMutexLock(&counter->mutex);
+        ++counter->mutex_count;
+        HeliosMutexUnlock(&counter->mutex);
+
+        HeliosAtomicFetchAddU64(&counter->atomic_count, 1, HeliosMemoryOrder_Relaxed);
+    }
+}
+
+void LocksAndAtomicsCount(void) {
+    LockCounter counter = {.spin_lock = HELIOS_SPIN_LOCK_INIT, .mutex = HELIOS_MUTEX_INIT};
+    HeliosThread threads[LOCK_THREADS];
+    for (UZ i = 0; i < LOCK_THREADS; ++i) HELIOS_VERIFY(HeliosThreadStart(&threads[i], LockCounterWorker, &counter));
+    for (UZ i = 0; i < LOCK_THREADS; ++i) HeliosThreadJoin(&threads[i]);
+
+    HELIOS_VERIFY(counter.spin_count == LOCK_THREADS * LOCK_ITERATIONS);
+    HELIOS_VERIFY(counter.mutex_count == LOCK_THREADS * LOCK_ITERATIONS);
+    HELIOS_VERIFY(HeliosAtomicLoadU64(&counter.atomic_count, HeliosMemoryOrder_Relaxed) == LOCK_THREADS * LOCK_ITERATIONS);
+
+    U32 expected = 1;
+    HeliosAtomicU32 value = {0};
+    HELIOS_VERIFY(!HeliosAtomicCompareExchangeU32(&value, &expected, 2, HeliosMemoryOrder_AcqRel));
+    HELIOS_VERIFY(expected == 0);
+    HELIOS_VERIFY(HeliosAtomicCompareExchangeU32(&value, &expected, 2, HeliosMemoryOrder_AcqRel));
+    HELIOS_VERIFY(HeliosAtomicLoadU32(&value, HeliosMemoryOrder_Acquire) == 2);
+}
+
+#define HANDOFF_ROUNDS 1000
+
+typedef struct Handoff {
+    HeliosMutex mutex;
+    HeliosCondVar cond;
+    HeliosEvent done;
+    U32 value;
+    B32 full;
+} Handoff;
+
+static void HandoffConsumer(void *arg) {
+    Handoff *handoff = (Handoff *)arg;
+    for (U32 i = 0; i < HANDOFF_ROUNDS; ++i) {
+        HeliosMutexLock(&handoff->mutex);
+        while (!handoff->full) HeliosCondVarWait(&handoff->cond, &handoff->mutex);
+        HELIOS_VERIFY(handoff->value == i);
+        handoff->full = 0;
+        HeliosCondVarBroadcast(&handoff->cond);
+        HeliosMutexUnlock(&handoff->mutex);
+    }
+    HeliosEventSet(&handoff->done);
+}
+
+void CondVarAndEventHandoff(void) {
+    Handoff handoff = {.mutex = HELIOS_MUTEX_INIT, .cond = HELIOS_COND_VAR_INIT, .done = HELIOS_EVENT_INIT};
+    HeliosThread consumer;
+    HELIOS_VERIFY(HeliosThreadStart(&consumer, HandoffConsumer, &handoff));
+
+    for (U32 i = 0; i < HANDOFF_ROUNDS; ++i) {
+        HeliosMutexLock(&handoff.mutex);
+        while (handoff.full) HeliosCondVarWait(&handoff.cond, &handoff.mutex);
+        handoff.value = i;
+        handoff.full = 1;
+        HeliosCondVarSignal(&handoff.cond);
+        HeliosMutexUnlock(&handoff.mutex);
+    }
+
+    HeliosEventWait(&handoff.done);
+    HELIOS_VERIFY(HeliosEventIsSet(&handoff.done));
+    HeliosThreadJoin(&consumer);
+
+    HeliosEventReset(&handoff.done);
+    HELIOS_VERIFY(!HeliosEventIsSet(&handoff.done));
+}
+
+#define JOBS_SUM_COUNT 100000
+
+typedef struct JobsSum {
+    const U32 *values;
+    U64 partial[HELIOS_JOBS_MAX_WORKERS];
+    HeliosJobs *jobs;
+} JobsSum;
+
+static void JobsSumRange(void *arg, UZ begin, UZ end) {
+    JobsSum *sum = (JobsSum *)arg;
+    U64 *partial = &sum->partial[HeliosJobsWorkerIndex(sum->jobs)];
+    for (UZ i = begin; i < end; ++i) *partial += sum->values[i];
+}
+
+void JobsParallelForSums(void) {
+    HeliosAllocator allocator = HeliosNewMallocAllocator();
+    HeliosJobs jobs;
+    HELIOS_VERIFY(HeliosJobsInit(&jobs, allocator, 4));
+    HELIOS_VERIFY(jobs.worker_count == 4);
+
+    U32 *values = (U32 *)HeliosAllocUninit(allocator, sizeof(U32) * JOBS_SUM_COUNT);
+    for (UZ i = 0; i < JOBS_SUM_COUNT; ++i) values[i] = (U32)i;
+
+    JobsSum sum = {.values = values, .jobs = &jobs};
+    HeliosJobsParallelFor(&jobs, JOBS_SUM_COUNT, 64, JobsSumRange, &sum);
+
+    U64 total = 0;
+    for (UZ i = 0; i < HELIOS_JOBS_MAX_WORKERS; ++i) total += sum.partial[i];
+    HELIOS_VERIFY(total == (U64)JOBS_SUM_COUNT * (JOBS_SUM_COUNT - 1) / 2);
+
+    HeliosFree(allocator, values, sizeof(U32) * JOBS_SUM_COUNT);
+    HeliosJobsDestroy(&jobs);
+}
+
+static void JobsCountLeaf(HeliosJobs *jobs, HeliosJob *job, void *data) {
+    (void)jobs;
+    (void)job;
+    HeliosAtomicFetchAddS32(*(HeliosAtomicS32 **)data, 1, HeliosMemoryOrder_Relaxed);
+}
+
+static void JobsSpawnLeaves(HeliosJobs *jobs, HeliosJob *job, void *data) {
+    // More children than fit in the ring, so that job slots get recycled along the way.
+    for (UZ i = 0; i < HELIOS_JOBS_QUEUE_SIZE * 2; ++i) {
+        HeliosJobSubmit(jobs, HeliosJobCreate(jobs, job, JobsCountLeaf, data, sizeof(HeliosAtomicS32 *)));
+    }
+}
+
+void JobsWaitCoversChildren(void) {
+    HeliosJobs jobs;
+    HELIOS_VERIFY(HeliosJobsInit(&jobs, HeliosNewMallocAllocator(), 3));
+
+    HeliosAtomicS32 counter = {0};
+    HeliosAtomicS32 *counter_ptr = &counter;
+
+    HeliosJob *root = HeliosJobCreate(&jobs, NULL, JobsSpawnLeaves, &counter_ptr, sizeof(counter_ptr));
+    HeliosJobSubmit(&jobs, root);
+    HeliosJobWait(&jobs, root);
+    HELIOS_VERIFY(HeliosAtomicLoadS32(&counter, HeliosMemoryOrder_Relaxed) == HELIOS_JOBS_QUEUE_SIZE * 2);
+
+    HeliosJobsDestroy(&jobs);
+}
+
+void JobsIdleWorkersSleep(void) {
+    HeliosJobs jobs;
+    HELIOS_VERIFY(HeliosJobsInit(&jobs, HeliosNewMallocAllocator(), 4));
+
+    for (U32 round = 0; round < 3; ++round) {
+        // Every worker thread but the caller has to end up asleep instead of spinning.
+        for (UZ i = 0; i < 10000000 && HeliosAtomicLoadU32(&jobs.sleepers, HeliosMemoryOrder_Acquire) != 3; ++i) {
+            HeliosThreadYield();
+        }
+        HELIOS_VERIFY(HeliosAtomicLoadU32(&jobs.sleepers, HeliosMemoryOrder_Acquire) == 3);
+
+        HeliosAtomicS32 counter = {0};
+        HeliosAtomicS32 *counter_ptr = &counter;
+        HeliosJob *root = HeliosJobCreate(&jobs, NULL, JobsSpawnLeaves, &counter_ptr, sizeof(counter_ptr));
+        HeliosJobSubmit(&jobs, root);
+        HeliosJobWait(&jobs, root);
+        HELIOS_VERIFY(HeliosAtomicLoadS32(&counter, HeliosMemoryOrder_Relaxed) == HELIOS_JOBS_QUEUE_SIZE * 2);
+    }
+
+    HeliosJobsDestroy(&jobs);
 }
 
 int main(void) {
     ReadFileSuccess();
+    ReadFileClosesDescriptor();
+    MapFileMatchesRead();
+    ReadFilesBatchMatchesRead();
     FormatAppendCorrect();
+    String8CapacityCountsTerminator();
+    StringBuilderMatchesFormatAppend();
+    AllocZeroedAfterReuse();
+    CloneToCStrTerminates();
+    PoolAllocatorReusesAndReleasesSlabs();
+    PoolCacheThroughVTable();
+    VirtualArenaCommitsAndDecommits();
+    VirtualArenaHugePages();
+    TrackingAllocatorStatistics();
+    KernelsAgreeAcrossFeatureSets();
+    KernelsInitWhileInUse();
+    StringViewPrimitivesAcrossFeatureSets();
+    StreamSkipToMatchesNext();
+    InternerDeduplicatesAndGrows();
+    ProfileFlushesChromeTrace();
+    LogFormatsDeferred();
+    BenchReportsOrderedStats();
+    LocksAndAtomicsCount();
+    CondVarAndEventHandoff();
+    JobsParallelForSums();
+    JobsWaitCoversChildren();
+    JobsIdleWorkersSleep();
 }